@@ -0,0 +1,47 @@
+#pragma once
+
+#include <boost/asio/executor_work_guard.hpp>
+#include <boost/asio/io_context.hpp>
+#include <boost/asio/ip/tcp.hpp>
+#include <cstddef>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "echo_client/echo_client_pool.hpp"
+
+namespace mori_echo::client {
+
+// Runs a pool on a thread of its own, for callers outside of coroutines. Can
+// be called from any thread; concurrent calls are pipelined on the pool.
+class [[nodiscard]] blocking_echo_client {
+public:
+  // Connects and logs in every connection of the pool.
+  blocking_echo_client(const boost::asio::ip::tcp::endpoint& server,
+                       client_credentials credentials,
+                       pool_options options = {});
+
+  blocking_echo_client(const blocking_echo_client&) = delete;
+  auto operator=(const blocking_echo_client&) -> blocking_echo_client& = delete;
+
+  ~blocking_echo_client();
+
+  [[nodiscard]] auto echo(std::vector<std::byte> message)
+      -> std::vector<std::byte>;
+
+  // Pipelines every message at once, and returns the echoes in their order.
+  [[nodiscard]] auto echo_all(std::vector<std::vector<std::byte>> messages)
+      -> std::vector<std::vector<std::byte>>;
+
+private:
+  boost::asio::io_context io_context{1};
+
+  boost::asio::executor_work_guard<boost::asio::io_context::executor_type>
+      work = boost::asio::make_work_guard(io_context);
+
+  std::thread thread;
+
+  std::shared_ptr<echo_client_pool> pool;
+};
+
+} // namespace mori_echo::client
@@ -0,0 +1,63 @@
+#pragma once
+
+#include <boost/asio/any_io_executor.hpp>
+#include <boost/asio/awaitable.hpp>
+#include <boost/asio/ip/tcp.hpp>
+#include <boost/asio/steady_timer.hpp>
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+#include "echo_client/echo_connection.hpp"
+
+namespace mori_echo::client {
+
+struct pool_options {
+  std::size_t connections = 4;
+
+  connection_options connection = {};
+};
+
+// Spreads echoes over a fixed number of logged-in connections, each taking
+// the next echo while it has the fewest in flight. A connection that failed
+// is replaced by the next echo it would have been given, and echoes finding
+// every connection being replaced wait for one of them.
+//
+// Like its connections, must only be used from its executor.
+class [[nodiscard]] echo_client_pool {
+public:
+  [[nodiscard]] static auto connect(boost::asio::any_io_executor executor,
+                                    boost::asio::ip::tcp::endpoint server,
+                                    client_credentials credentials,
+                                    pool_options options = {})
+      -> boost::asio::awaitable<std::shared_ptr<echo_client_pool>>;
+
+  [[nodiscard]] auto echo(std::vector<std::byte> message)
+      -> boost::asio::awaitable<std::vector<std::byte>>;
+
+  auto close() -> void;
+
+private:
+  echo_client_pool(boost::asio::any_io_executor executor,
+                   boost::asio::ip::tcp::endpoint server,
+                   client_credentials credentials, pool_options options);
+
+  // The least busy open connection, or else a failed one to replace, or else
+  // `connections.size()` while every connection is being replaced.
+  [[nodiscard]] auto pick_connection() const -> std::size_t;
+
+  boost::asio::any_io_executor executor;
+  boost::asio::ip::tcp::endpoint server;
+  client_credentials credentials;
+  pool_options options;
+
+  std::vector<std::shared_ptr<echo_connection>> connections;
+
+  // Connections being replaced, which no other echo picks meanwhile.
+  std::vector<bool> is_reconnecting;
+
+  // Woken, every waiter at once, as replacements end.
+  boost::asio::steady_timer reconnected;
+};
+
+} // namespace mori_echo::client
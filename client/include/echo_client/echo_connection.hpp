@@ -0,0 +1,128 @@
+#pragma once
+
+#include <array>
+#include <boost/asio/any_io_executor.hpp>
+#include <boost/asio/awaitable.hpp>
+#include <boost/asio/ip/tcp.hpp>
+#include <boost/asio/steady_timer.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <memory>
+#include <span>
+#include <string>
+#include <vector>
+
+namespace mori_echo::client {
+
+struct client_credentials {
+  std::string username;
+  std::string password;
+};
+
+struct connection_options {
+  // Echoes sent on a connection ahead of their responses, at most 255 as each
+  // holds a sequence number until answered.
+  std::size_t max_in_flight = 64;
+
+  // Encrypts payloads, for servers that decrypt echo requests and so echo the
+  // original message back.
+  bool encrypt = true;
+};
+
+// A logged-in connection on which concurrent echoes are pipelined: each is
+// sent as soon as a sequence number is free, and matched to its response by
+// that number. Frames queued while a write is in progress go out together.
+//
+// Dropping the last `shared_ptr` to it closes the socket, as does `close()`.
+// Echoes in flight hold one until they complete.
+//
+// Must only be used from its executor, which must not run handlers
+// concurrently, like a single-threaded io_context or a strand.
+class [[nodiscard]] echo_connection
+    : public std::enable_shared_from_this<echo_connection> {
+public:
+  // Connects and logs in, throwing a `client_error` if the login is
+  // rejected.
+  [[nodiscard]] static auto connect(boost::asio::any_io_executor executor,
+                                    boost::asio::ip::tcp::endpoint server,
+                                    client_credentials credentials,
+                                    connection_options options = {})
+      -> boost::asio::awaitable<std::shared_ptr<echo_connection>>;
+
+  echo_connection(const echo_connection&) = delete;
+  auto operator=(const echo_connection&) -> echo_connection& = delete;
+
+  // Returns the payload echoed by the server. Throws once the connection
+  // fails, along with every other echo in flight on it.
+  [[nodiscard]] auto echo(std::vector<std::byte> message)
+      -> boost::asio::awaitable<std::vector<std::byte>>;
+
+  [[nodiscard]] auto in_flight() const -> std::size_t {
+    return in_flight_count;
+  }
+
+  [[nodiscard]] auto is_open() const -> bool { return !failure; }
+
+  // Fails the echoes in flight and closes the socket.
+  auto close() -> void;
+
+private:
+  struct pending_echo {
+    explicit pending_echo(const boost::asio::any_io_executor& executor)
+        : done{executor, boost::asio::steady_timer::time_point::max()} {}
+
+    // Cancelled once the echo completes.
+    boost::asio::steady_timer done;
+
+    std::vector<std::byte> response;
+    std::exception_ptr failure;
+
+    bool is_complete = false;
+  };
+
+  echo_connection(boost::asio::ip::tcp::socket socket,
+                  connection_options options, std::uint8_t username_sum,
+                  std::uint8_t password_sum);
+
+  [[nodiscard]] auto acquire_sequence() -> boost::asio::awaitable<std::uint8_t>;
+
+  auto queue_frame(std::uint8_t sequence, const std::vector<std::byte>& payload)
+      -> void;
+
+  [[nodiscard]] static auto write_frames(std::shared_ptr<echo_connection> self)
+      -> boost::asio::awaitable<void>;
+
+  [[nodiscard]] static auto read_responses(std::weak_ptr<echo_connection> weak)
+      -> boost::asio::awaitable<void>;
+
+  // Parses the complete frames at the front of `data`, returning how many
+  // bytes they took.
+  [[nodiscard]] auto dispatch_responses(std::span<const std::byte> data)
+      -> std::size_t;
+
+  auto complete(std::uint8_t sequence, std::vector<std::byte> response) -> void;
+
+  auto fail(std::exception_ptr error) -> void;
+
+  boost::asio::ip::tcp::socket socket;
+  connection_options options;
+
+  std::uint8_t username_sum;
+  std::uint8_t password_sum;
+
+  std::array<pending_echo*, 256> pending = {};
+  std::size_t in_flight_count = 0;
+  std::uint8_t next_sequence = 1;
+
+  // Woken, one waiter at a time, as sequence numbers are released.
+  boost::asio::steady_timer sequence_released;
+
+  std::vector<std::byte> outbox;
+  std::vector<std::byte> sending;
+  bool is_writing = false;
+
+  std::exception_ptr failure;
+};
+
+} // namespace mori_echo::client
@@ -0,0 +1,67 @@
+#include "echo_client/blocking_echo_client.hpp"
+
+#include <boost/asio/co_spawn.hpp>
+#include <boost/asio/post.hpp>
+#include <boost/asio/use_future.hpp>
+#include <future>
+#include <utility>
+
+namespace mori_echo::client {
+
+blocking_echo_client::blocking_echo_client(
+    const boost::asio::ip::tcp::endpoint& server,
+    client_credentials credentials, pool_options options)
+    : thread{[this] { io_context.run(); }} {
+  try {
+    pool = boost::asio::co_spawn(
+               io_context,
+               echo_client_pool::connect(io_context.get_executor(), server,
+                                         std::move(credentials), options),
+               boost::asio::use_future)
+               .get();
+  } catch (...) {
+    work.reset();
+    io_context.stop();
+    thread.join();
+
+    throw;
+  }
+}
+
+blocking_echo_client::~blocking_echo_client() {
+  // Closing the connections ends their readers, and with them the thread.
+  boost::asio::post(io_context, [pool = std::move(pool)] { pool->close(); });
+
+  work.reset();
+  thread.join();
+}
+
+auto blocking_echo_client::echo(std::vector<std::byte> message)
+    -> std::vector<std::byte> {
+  return boost::asio::co_spawn(io_context, pool->echo(std::move(message)),
+                               boost::asio::use_future)
+      .get();
+}
+
+auto blocking_echo_client::echo_all(
+    std::vector<std::vector<std::byte>> messages)
+    -> std::vector<std::vector<std::byte>> {
+  auto pending = std::vector<std::future<std::vector<std::byte>>>{};
+  pending.reserve(messages.size());
+
+  for (auto& message : messages) {
+    pending.push_back(boost::asio::co_spawn(
+        io_context, pool->echo(std::move(message)), boost::asio::use_future));
+  }
+
+  auto echoes = std::vector<std::vector<std::byte>>{};
+  echoes.reserve(pending.size());
+
+  for (auto& each : pending) {
+    echoes.push_back(each.get());
+  }
+
+  return echoes;
+}
+
+} // namespace mori_echo::client
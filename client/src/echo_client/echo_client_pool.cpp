@@ -0,0 +1,108 @@
+#include "echo_client/echo_client_pool.hpp"
+
+#include <boost/asio/redirect_error.hpp>
+#include <boost/asio/use_awaitable.hpp>
+#include <limits>
+#include <utility>
+
+#include "exceptions/client_error.hpp"
+
+namespace mori_echo::client {
+
+auto echo_client_pool::connect(boost::asio::any_io_executor executor,
+                               boost::asio::ip::tcp::endpoint server,
+                               client_credentials credentials,
+                               pool_options options)
+    -> boost::asio::awaitable<std::shared_ptr<echo_client_pool>> {
+  if (options.connections == 0) {
+    throw exceptions::client_error{"A pool needs at least one connection."};
+  }
+
+  auto pool = std::shared_ptr<echo_client_pool>{new echo_client_pool{
+      executor, std::move(server), std::move(credentials), options}};
+
+  for (auto& connection : pool->connections) {
+    connection = co_await echo_connection::connect(
+        executor, pool->server, pool->credentials, options.connection);
+  }
+
+  co_return pool;
+}
+
+echo_client_pool::echo_client_pool(boost::asio::any_io_executor executor,
+                                   boost::asio::ip::tcp::endpoint server,
+                                   client_credentials credentials,
+                                   pool_options options)
+    : executor{std::move(executor)}, server{std::move(server)},
+      credentials{std::move(credentials)}, options{options},
+      connections(options.connections),
+      is_reconnecting(options.connections, false),
+      reconnected{this->executor,
+                  boost::asio::steady_timer::time_point::max()} {}
+
+auto echo_client_pool::echo(std::vector<std::byte> message)
+    -> boost::asio::awaitable<std::vector<std::byte>> {
+  auto index = pick_connection();
+
+  while (index == connections.size()) {
+    auto error = boost::system::error_code{};
+    co_await reconnected.async_wait(
+        boost::asio::redirect_error(boost::asio::use_awaitable, error));
+
+    index = pick_connection();
+  }
+
+  if (!connections[index]->is_open()) {
+    is_reconnecting[index] = true;
+
+    try {
+      connections[index] = co_await echo_connection::connect(
+          executor, server, credentials, options.connection);
+    } catch (...) {
+      is_reconnecting[index] = false;
+      reconnected.cancel();
+      throw;
+    }
+
+    is_reconnecting[index] = false;
+    reconnected.cancel();
+  }
+
+  // Held here, as the pool may replace it before the echo completes.
+  const auto connection = connections[index];
+
+  co_return co_await connection->echo(std::move(message));
+}
+
+auto echo_client_pool::close() -> void {
+  for (const auto& connection : connections) {
+    if (connection) {
+      connection->close();
+    }
+  }
+}
+
+auto echo_client_pool::pick_connection() const -> std::size_t {
+  auto best = connections.size();
+  auto best_in_flight = std::numeric_limits<std::size_t>::max();
+
+  auto failed = connections.size();
+
+  for (auto i = std::size_t{0}; i < connections.size(); ++i) {
+    if (is_reconnecting[i]) {
+      continue;
+    }
+
+    if (!connections[i]->is_open()) {
+      failed = i;
+    } else if (connections[i]->in_flight() < best_in_flight) {
+      best = i;
+      best_in_flight = connections[i]->in_flight();
+    }
+  }
+
+  // Replacing failed connections first keeps the pool at its size.
+  return failed != connections.size() ? failed : best;
+}
+
+} // namespace mori_echo::client
@@ -0,0 +1,407 @@
+#include "echo_client/echo_connection.hpp"
+
+#include <algorithm>
+#include <boost/asio/co_spawn.hpp>
+#include <boost/asio/read.hpp>
+#include <boost/asio/redirect_error.hpp>
+#include <boost/asio/use_awaitable.hpp>
+#include <boost/asio/write.hpp>
+#include <boost/system/system_error.hpp>
+#include <utility>
+
+#include "client_crypto/client_crypto.hpp"
+#include "exceptions/client_error.hpp"
+#include "exceptions/server_error.hpp"
+#include "message_codec/message_codec.hpp"
+#include "message_types/echo_request.hpp"
+#include "message_types/echo_response.hpp"
+#include "message_types/login_request.hpp"
+#include "message_types/login_response.hpp"
+#include "mori_echo/server_config.hpp"
+#include "mori_status/login_status.hpp"
+
+namespace mori_echo::client {
+
+inline constexpr auto login_sequence = std::uint8_t{0};
+
+// Initial size of the response buffer, grown for larger frames.
+inline constexpr auto receive_buffer_size = std::size_t{64 * 1024};
+
+[[nodiscard]] auto make_login_layout(const client_credentials& credentials)
+    -> messages::message_schema<messages::login_request>::layout {
+  if (credentials.username.size() >= config::username_size) {
+    throw exceptions::client_error{"Username too long."};
+  }
+
+  if (credentials.password.size() >= config::password_size) {
+    throw exceptions::client_error{"Password too long."};
+  }
+
+  auto layout = messages::message_schema<messages::login_request>::layout{};
+
+  const auto to_byte = [](char each) { return static_cast<std::byte>(each); };
+
+  std::transform(credentials.username.begin(), credentials.username.end(),
+                 layout.username.begin(), to_byte);
+
+  std::transform(credentials.password.begin(), credentials.password.end(),
+                 layout.password.begin(), to_byte);
+
+  return layout;
+}
+
+[[nodiscard]] auto decode_response_header(std::span<const std::byte> data)
+    -> messages::header_layout {
+  return decode_layout<messages::header_layout>(
+      data.first<messages::header_size>(), header_fields);
+}
+
+auto echo_connection::connect(boost::asio::any_io_executor executor,
+                              boost::asio::ip::tcp::endpoint server,
+                              client_credentials credentials,
+                              connection_options options)
+    -> boost::asio::awaitable<std::shared_ptr<echo_connection>> {
+  if (options.max_in_flight == 0 || options.max_in_flight > 255) {
+    throw exceptions::client_error{"Echoes in flight out of range."};
+  }
+
+  const auto login = encode_frame_prefix<messages::login_request>(
+      login_sequence, make_login_layout(credentials));
+
+  auto socket = boost::asio::ip::tcp::socket{executor};
+
+  co_await socket.async_connect(server, boost::asio::use_awaitable);
+
+  // Pipelined frames are written as soon as they are queued.
+  socket.set_option(boost::asio::ip::tcp::no_delay{true});
+
+  co_await boost::asio::async_write(socket, boost::asio::buffer(login),
+                                    boost::asio::use_awaitable);
+
+  auto response =
+      std::array<std::byte, frame_prefix_size<messages::login_response>>{};
+
+  co_await boost::asio::async_read(socket, boost::asio::buffer(response),
+                                   boost::asio::use_awaitable);
+
+  const auto header = decode_response_header(response);
+
+  if (header.type !=
+          static_cast<std::uint8_t>(messages::message_type::LOGIN_RESPONSE) ||
+      header.total_size != response.size() ||
+      header.sequence != login_sequence) {
+    throw exceptions::server_error{"Malformed login response."};
+  }
+
+  const auto layout = decode_fixed_part<messages::login_response>(
+      std::span{response}
+          .subspan<messages::header_size,
+                   messages::layout_size<messages::login_response>>());
+
+  if (layout.status_code !=
+      static_cast<std::uint16_t>(mori_status::login_status::OK)) {
+    throw exceptions::client_error{"Login failed."};
+  }
+
+  auto connection = std::shared_ptr<echo_connection>{new echo_connection{
+      std::move(socket), options,
+      crypto::calculate_checksum(credentials.username),
+      crypto::calculate_checksum(credentials.password)}};
+
+  boost::asio::co_spawn(executor, read_responses(connection),
+                        [](std::exception_ptr error) {
+                          if (error) {
+                            std::rethrow_exception(error);
+                          }
+                        });
+
+  co_return connection;
+}
+
+echo_connection::echo_connection(boost::asio::ip::tcp::socket socket,
+                                 connection_options options,
+                                 std::uint8_t username_sum,
+                                 std::uint8_t password_sum)
+    : socket{std::move(socket)}, options{options}, username_sum{username_sum},
+      password_sum{password_sum},
+      sequence_released{this->socket.get_executor(),
+                        boost::asio::steady_timer::time_point::max()} {}
+
+auto echo_connection::echo(std::vector<std::byte> message)
+    -> boost::asio::awaitable<std::vector<std::byte>> {
+  if (message.size() > max_extended_payload_size<messages::echo_request>) {
+    throw exceptions::client_error{"Message too long."};
+  }
+
+  // Keeps the connection alive while this echo waits on it.
+  const auto self = shared_from_this();
+
+  const auto sequence = co_await acquire_sequence();
+
+  auto entry = pending_echo{socket.get_executor()};
+  pending[sequence] = &entry;
+
+  if (options.encrypt) {
+    message = crypto::encrypt(
+        {
+            .username_sum = username_sum,
+            .password_sum = password_sum,
+            .sequence = sequence,
+        },
+        std::move(message));
+  }
+
+  queue_frame(sequence, message);
+
+  while (!entry.is_complete) {
+    auto error = boost::system::error_code{};
+    co_await entry.done.async_wait(
+        boost::asio::redirect_error(boost::asio::use_awaitable, error));
+  }
+
+  if (entry.failure) {
+    std::rethrow_exception(entry.failure);
+  }
+
+  co_return std::move(entry.response);
+}
+
+auto echo_connection::close() -> void {
+  fail(std::make_exception_ptr(
+      exceptions::client_error{"Connection closed."}));
+}
+
+auto echo_connection::acquire_sequence()
+    -> boost::asio::awaitable<std::uint8_t> {
+  while (!failure && in_flight_count >= options.max_in_flight) {
+    auto error = boost::system::error_code{};
+    co_await sequence_released.async_wait(
+        boost::asio::redirect_error(boost::asio::use_awaitable, error));
+  }
+
+  if (failure) {
+    std::rethrow_exception(failure);
+  }
+
+  // Fewer than 256 are in flight, so a free one is always found.
+  while (pending[next_sequence] != nullptr) {
+    ++next_sequence;
+  }
+
+  ++in_flight_count;
+
+  co_return next_sequence++;
+}
+
+auto echo_connection::queue_frame(std::uint8_t sequence,
+                                  const std::vector<std::byte>& payload)
+    -> void {
+  if (payload.size() <= max_payload_size<messages::echo_request>) {
+    const auto prefix = encode_frame_prefix<messages::echo_request>(
+        sequence, {.message_size = static_cast<std::uint16_t>(payload.size())},
+        payload.size());
+
+    outbox.insert(outbox.end(), prefix.begin(), prefix.end());
+  } else {
+    const auto prefix = encode_extended_frame_prefix<messages::echo_request>(
+        sequence, {.message_size = static_cast<std::uint32_t>(payload.size())},
+        payload.size());
+
+    outbox.insert(outbox.end(), prefix.begin(), prefix.end());
+  }
+
+  outbox.insert(outbox.end(), payload.begin(), payload.end());
+
+  if (!is_writing) {
+    is_writing = true;
+
+    boost::asio::co_spawn(socket.get_executor(),
+                          write_frames(shared_from_this()),
+                          [](std::exception_ptr error) {
+                            if (error) {
+                              std::rethrow_exception(error);
+                            }
+                          });
+  }
+}
+
+auto echo_connection::write_frames(std::shared_ptr<echo_connection> self)
+    -> boost::asio::awaitable<void> {
+  auto error = boost::system::error_code{};
+
+  while (!self->outbox.empty() && !self->failure) {
+    // Frames queued during this write go out with the next one.
+    std::swap(self->outbox, self->sending);
+
+    co_await boost::asio::async_write(
+        self->socket, boost::asio::buffer(self->sending),
+        boost::asio::redirect_error(boost::asio::use_awaitable, error));
+
+    self->sending.clear();
+
+    if (error) {
+      self->fail(
+          std::make_exception_ptr(boost::system::system_error{error}));
+    }
+  }
+
+  self->is_writing = false;
+}
+
+auto echo_connection::read_responses(std::weak_ptr<echo_connection> weak)
+    -> boost::asio::awaitable<void> {
+  auto buffer = std::vector<std::byte>(receive_buffer_size);
+  auto filled = std::size_t{0};
+
+  auto error = boost::system::error_code{};
+
+  for (;;) {
+    auto* socket = static_cast<boost::asio::ip::tcp::socket*>(nullptr);
+
+    if (const auto self = weak.lock(); self && !self->failure) {
+      socket = &self->socket;
+    } else {
+      co_return;
+    }
+
+    // Only full of a frame larger than the buffer.
+    if (filled == buffer.size()) {
+      buffer.resize(buffer.size() * 2);
+    }
+
+    // Holds no reference to the connection while waiting, so that dropping
+    // the last one closes the socket and aborts this read.
+    filled += co_await socket->async_read_some(
+        boost::asio::buffer(buffer.data() + filled, buffer.size() - filled),
+        boost::asio::redirect_error(boost::asio::use_awaitable, error));
+
+    const auto self = weak.lock();
+
+    if (!self) {
+      co_return;
+    }
+
+    if (error) {
+      self->fail(
+          std::make_exception_ptr(boost::system::system_error{error}));
+      co_return;
+    }
+
+    try {
+      const auto consumed = self->dispatch_responses(
+          std::span<const std::byte>{buffer.data(), filled});
+
+      std::copy(buffer.begin() + static_cast<std::ptrdiff_t>(consumed),
+                buffer.begin() + static_cast<std::ptrdiff_t>(filled),
+                buffer.begin());
+
+      filled -= consumed;
+    } catch (const std::exception&) {
+      self->fail(std::current_exception());
+      co_return;
+    }
+  }
+}
+
+auto echo_connection::dispatch_responses(std::span<const std::byte> data)
+    -> std::size_t {
+  using schema = messages::message_schema<messages::echo_response>;
+
+  auto consumed = std::size_t{0};
+
+  for (;;) {
+    const auto frame = data.subspan(consumed);
+
+    if (frame.size() < messages::header_size) {
+      return consumed;
+    }
+
+    const auto header = decode_response_header(frame);
+
+    auto total_size = std::size_t{header.total_size};
+    auto prefix_size = frame_prefix_size<messages::echo_response>;
+
+    if (header.total_size == messages::extended_frame_marker) {
+      if (frame.size() < messages::extended_header_size) {
+        return consumed;
+      }
+
+      total_size = decode_layout<messages::extended_size_layout>(
+                       frame.subspan<messages::header_size,
+                                     sizeof(messages::extended_size_layout)>(),
+                       extended_size_fields)
+                       .total_size;
+
+      prefix_size = extended_frame_prefix_size<messages::echo_response>;
+    }
+
+    if (header.type !=
+            static_cast<std::uint8_t>(messages::message_type::ECHO_RESPONSE) ||
+        total_size < prefix_size || pending[header.sequence] == nullptr) {
+      throw exceptions::server_error{"Unexpected response."};
+    }
+
+    if (frame.size() < total_size) {
+      return consumed;
+    }
+
+    const auto message_size =
+        header.total_size == messages::extended_frame_marker
+            ? std::size_t{decode_extended_fixed_part<messages::echo_response>(
+                              frame.subspan<messages::extended_header_size,
+                                            sizeof(schema::extended_layout)>())
+                              .*schema::extended_payload_size}
+            : std::size_t{decode_fixed_part<messages::echo_response>(
+                              frame.subspan<messages::header_size,
+                                            sizeof(schema::layout)>())
+                              .*schema::payload_size};
+
+    if (message_size != total_size - prefix_size) {
+      throw exceptions::server_error{"Message size mismatch."};
+    }
+
+    const auto payload = frame.subspan(prefix_size, message_size);
+
+    complete(header.sequence, {payload.begin(), payload.end()});
+
+    consumed += total_size;
+  }
+}
+
+auto echo_connection::complete(std::uint8_t sequence,
+                               std::vector<std::byte> response) -> void {
+  auto* entry = std::exchange(pending[sequence], nullptr);
+
+  entry->response = std::move(response);
+  entry->is_complete = true;
+  entry->done.cancel();
+
+  --in_flight_count;
+  sequence_released.cancel_one();
+}
+
+auto echo_connection::fail(std::exception_ptr error) -> void {
+  if (failure) {
+    return;
+  }
+
+  failure = error;
+
+  for (auto& entry : pending) {
+    if (entry != nullptr) {
+      entry->failure = error;
+      entry->is_complete = true;
+      entry->done.cancel();
+
+      entry = nullptr;
+    }
+  }
+
+  in_flight_count = 0;
+  sequence_released.cancel();
+
+  auto ignored = boost::system::error_code{};
+  socket.close(ignored);
+}
+
+} // namespace mori_echo::client
@@ -0,0 +1,30 @@
+#pragma once
+
+#include <cstdint>
+#include <span>
+#include <string_view>
+#include <vector>
+
+#include "crypto_message_params.hpp"
+
+namespace mori_echo::crypto {
+
+// Key stream position of a message being decrypted in chunks.
+struct cipher_state {
+  std::uint32_t key = {};
+};
+
+auto calculate_checksum(std::string_view data) -> std::uint8_t;
+
+auto make_cipher_state(crypto_message_params args) -> cipher_state;
+
+auto decrypt_chunk(cipher_state& state, std::span<std::byte> chunk) -> void;
+
+auto decrypt(crypto_message_params args, std::vector<std::byte> message)
+    -> std::vector<std::byte>;
+
+// The cipher is symmetric, so clients encrypt with the same key stream.
+auto encrypt(crypto_message_params args, std::vector<std::byte> message)
+    -> std::vector<std::byte>;
+
+} // namespace mori_echo::crypto
@@ -0,0 +1,340 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <boost/endian/conversion.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <span>
+#include <string_view>
+#include <tuple>
+#include <type_traits>
+
+#include "message_types/echo_request.hpp"
+#include "message_types/echo_response.hpp"
+#include "message_types/login_request.hpp"
+#include "message_types/login_response.hpp"
+#include "message_types/message_header.hpp"
+#include "message_types/message_schema.hpp"
+#include "mori_echo/server_config.hpp"
+#include "mori_status/login_status.hpp"
+
+// Codecs generated from the `message_schema` of each message. Frames are
+// built from a few fixed-layout parts, each copied as a whole and then having
+// its integer fields converted, so new message types only need a schema.
+
+namespace mori_echo {
+
+static_assert(config::byte_order == config::endian_mode::LITTLE_ENDIAN_MODE ||
+                  config::byte_order == config::endian_mode::BIG_ENDIAN_MODE,
+              "Invalid byte order configuration.");
+
+using message_list =
+    std::tuple<messages::login_request, messages::login_response,
+               messages::echo_request, messages::echo_response>;
+
+template <typename T>
+[[nodiscard]] constexpr auto native_to_protocol(T value) -> T {
+  if constexpr (config::byte_order == config::endian_mode::LITTLE_ENDIAN_MODE) {
+    return boost::endian::native_to_little(value);
+  } else {
+    return boost::endian::native_to_big(value);
+  }
+}
+
+template <typename T>
+[[nodiscard]] constexpr auto protocol_to_native(T value) -> T {
+  if constexpr (config::byte_order == config::endian_mode::LITTLE_ENDIAN_MODE) {
+    return boost::endian::little_to_native(value);
+  } else {
+    return boost::endian::big_to_native(value);
+  }
+}
+
+inline constexpr auto header_fields =
+    std::tuple{&messages::header_layout::total_size};
+
+inline constexpr auto extended_size_fields =
+    std::tuple{&messages::extended_size_layout::total_size};
+
+template <messages::WireLayout Layout, typename Fields>
+[[nodiscard]] constexpr auto encode_layout(Layout layout, const Fields& fields)
+    -> std::array<std::byte, sizeof(Layout)> {
+  std::apply(
+      [&](auto... field) {
+        ((layout.*field = native_to_protocol(layout.*field)), ...);
+      },
+      fields);
+
+  return std::bit_cast<std::array<std::byte, sizeof(Layout)>>(layout);
+}
+
+template <messages::WireLayout Layout, typename Fields>
+[[nodiscard]] auto decode_layout(std::span<const std::byte, sizeof(Layout)> data,
+                                 const Fields& fields) -> Layout {
+  auto layout = Layout{};
+  std::memcpy(&layout, data.data(), sizeof(Layout));
+
+  std::apply(
+      [&](auto... field) {
+        ((layout.*field = protocol_to_native(layout.*field)), ...);
+      },
+      fields);
+
+  return layout;
+}
+
+template <messages::MoriEchoMessage T>
+[[nodiscard]] auto decode_fixed_part(
+    std::span<const std::byte, messages::layout_size<T>> data) ->
+    typename messages::message_schema<T>::layout {
+  using schema = messages::message_schema<T>;
+
+  return decode_layout<typename schema::layout>(data, schema::integer_fields);
+}
+
+template <messages::MoriEchoMessage T>
+  requires messages::ExtendedSchema<messages::message_schema<T>>
+[[nodiscard]] auto decode_extended_fixed_part(
+    std::span<const std::byte,
+              sizeof(typename messages::message_schema<T>::extended_layout)>
+        data) -> typename messages::message_schema<T>::extended_layout {
+  using schema = messages::message_schema<T>;
+
+  return decode_layout<typename schema::extended_layout>(
+      data, schema::extended_integer_fields);
+}
+
+// Everything of a frame but its payload.
+template <messages::MoriEchoMessage T>
+inline constexpr auto frame_prefix_size =
+    messages::header_size + messages::layout_size<T>;
+
+template <messages::MoriEchoMessage T>
+  requires messages::ExtendedSchema<messages::message_schema<T>>
+inline constexpr auto extended_frame_prefix_size =
+    messages::extended_header_size +
+    sizeof(typename messages::message_schema<T>::extended_layout);
+
+template <messages::MoriEchoMessage T>
+  requires messages::PayloadSchema<messages::message_schema<T>>
+inline constexpr auto max_payload_size =
+    messages::max_regular_frame_size - frame_prefix_size<T>;
+
+template <messages::MoriEchoMessage T>
+  requires messages::ExtendedSchema<messages::message_schema<T>>
+inline constexpr auto max_extended_payload_size =
+    std::size_t{std::numeric_limits<std::uint32_t>::max()} -
+    extended_frame_prefix_size<T>;
+
+template <std::size_t Size, std::size_t... Sizes>
+[[nodiscard]] constexpr auto concat(const std::array<std::byte, Sizes>&... parts)
+    -> std::array<std::byte, Size> {
+  static_assert((Sizes + ...) == Size);
+
+  auto result = std::array<std::byte, Size>{};
+  auto out = result.begin();
+
+  ((out = std::copy(parts.begin(), parts.end(), out)), ...);
+
+  return result;
+}
+
+// Encodes a frame up to its payload of `payload_size` bytes, which the caller
+// checked against `max_payload_size`.
+template <messages::MoriEchoMessage T>
+[[nodiscard]] constexpr auto
+encode_frame_prefix(std::uint8_t sequence,
+                    const typename messages::message_schema<T>::layout& layout,
+                    std::size_t payload_size = 0)
+    -> std::array<std::byte, frame_prefix_size<T>> {
+  using schema = messages::message_schema<T>;
+
+  const auto header = messages::header_layout{
+      .total_size =
+          static_cast<std::uint16_t>(frame_prefix_size<T> + payload_size),
+      .type = static_cast<std::uint8_t>(schema::type),
+      .sequence = sequence,
+  };
+
+  return concat<frame_prefix_size<T>>(
+      encode_layout(header, header_fields),
+      encode_layout(layout, schema::integer_fields));
+}
+
+template <messages::MoriEchoMessage T>
+  requires messages::ExtendedSchema<messages::message_schema<T>>
+[[nodiscard]] constexpr auto encode_extended_frame_prefix(
+    std::uint8_t sequence,
+    const typename messages::message_schema<T>::extended_layout& layout,
+    std::size_t payload_size) -> std::array<std::byte,
+                                            extended_frame_prefix_size<T>> {
+  using schema = messages::message_schema<T>;
+
+  const auto header = messages::header_layout{
+      .total_size = messages::extended_frame_marker,
+      .type = static_cast<std::uint8_t>(schema::type),
+      .sequence = sequence,
+  };
+
+  const auto extended_size = messages::extended_size_layout{
+      .total_size = static_cast<std::uint32_t>(extended_frame_prefix_size<T> +
+                                               payload_size),
+  };
+
+  return concat<extended_frame_prefix_size<T>>(
+      encode_layout(header, header_fields),
+      encode_layout(extended_size, extended_size_fields),
+      encode_layout(layout, schema::extended_integer_fields));
+}
+
+// Whether `header` sizes exactly the fixed part of `T` and `payload_size`.
+template <messages::MoriEchoMessage T>
+  requires messages::PayloadSchema<messages::message_schema<T>>
+[[nodiscard]] constexpr auto sizes_payload(const messages::message_header& header,
+                                           std::size_t payload_size) -> bool {
+  if constexpr (messages::ExtendedSchema<messages::message_schema<T>>) {
+    if (header.is_extended) {
+      return header.total_size == extended_frame_prefix_size<T> + payload_size;
+    }
+  }
+
+  return !header.is_extended &&
+         header.total_size == frame_prefix_size<T> + payload_size;
+}
+
+// Constant responses are encoded at compile time, then only have their
+// sequence patched in.
+template <mori_status::login_status Status>
+inline constexpr auto login_response_frame =
+    encode_frame_prefix<messages::login_response>(
+        0, {.status_code = static_cast<std::uint16_t>(Status)});
+
+inline constexpr auto sequence_offset =
+    offsetof(messages::header_layout, sequence);
+
+[[nodiscard]] constexpr auto
+make_login_response_frame(std::uint8_t sequence,
+                          mori_status::login_status status_code)
+    -> std::array<std::byte, frame_prefix_size<messages::login_response>> {
+  auto frame = status_code == mori_status::login_status::OK
+                   ? login_response_frame<mori_status::login_status::OK>
+                   : login_response_frame<mori_status::login_status::FAILED>;
+
+  frame[sequence_offset] = std::byte{sequence};
+
+  return frame;
+}
+
+struct frame_limits {
+  std::size_t min_size = {};
+  std::size_t max_size = {};
+
+  [[nodiscard]] constexpr auto is_allowed() const -> bool {
+    return max_size != 0;
+  }
+};
+
+struct message_limits {
+  frame_limits regular;
+  frame_limits extended;
+};
+
+template <messages::MoriEchoMessage T>
+[[nodiscard]] constexpr auto make_message_limits() -> message_limits {
+  using schema = messages::message_schema<T>;
+
+  auto limits = message_limits{};
+
+  limits.regular.min_size = frame_prefix_size<T>;
+  limits.regular.max_size = messages::PayloadSchema<schema>
+                                ? messages::max_regular_frame_size
+                                : frame_prefix_size<T>;
+
+  if constexpr (messages::ExtendedSchema<schema>) {
+    limits.extended.min_size = extended_frame_prefix_size<T>;
+    limits.extended.max_size = std::numeric_limits<std::uint32_t>::max();
+  }
+
+  return limits;
+}
+
+// Frame size limits of every message, indexed by message type.
+inline constexpr auto message_limits_table =
+    []<typename... T>(std::type_identity<std::tuple<T...>>) {
+      auto table = std::array<message_limits, sizeof...(T)>{};
+
+      ((table.at(static_cast<std::size_t>(messages::message_schema<T>::type)) =
+            make_message_limits<T>()),
+       ...);
+
+      return table;
+    }(std::type_identity<message_list>{});
+
+static_assert(std::ranges::all_of(message_limits_table,
+                                  [](const message_limits& limits) {
+                                    return limits.regular.is_allowed();
+                                  }),
+              "Message types must be numbered densely from zero.");
+
+enum class frame_error {
+  NONE,
+  INVALID_TYPE,
+  UNEXPECTED_EXTENDED,
+  TOO_SHORT,
+  TOO_LONG,
+};
+
+// Validates a frame header with a single lookup of its message type.
+[[nodiscard]] constexpr auto check_frame(std::uint8_t type,
+                                         std::uint32_t total_size,
+                                         bool is_extended) -> frame_error {
+  if (type >= message_limits_table.size()) {
+    return frame_error::INVALID_TYPE;
+  }
+
+  const auto& limits = is_extended ? message_limits_table[type].extended
+                                   : message_limits_table[type].regular;
+
+  if (!limits.is_allowed()) {
+    return frame_error::UNEXPECTED_EXTENDED;
+  } else if (total_size < limits.min_size) {
+    return frame_error::TOO_SHORT;
+  } else if (total_size > limits.max_size) {
+    return frame_error::TOO_LONG;
+  }
+
+  return frame_error::NONE;
+}
+
+[[nodiscard]] constexpr auto describe(frame_error error) -> std::string_view {
+  switch (error) {
+    case frame_error::NONE:
+      return "No error.";
+    case frame_error::INVALID_TYPE:
+      return "Invalid message type.";
+    case frame_error::UNEXPECTED_EXTENDED:
+      return "Unexpected extended frame.";
+    case frame_error::TOO_SHORT:
+      return "Message too short.";
+    case frame_error::TOO_LONG:
+      return "Message too long.";
+  }
+
+  return "Unknown frame error.";
+}
+
+static_assert(frame_prefix_size<messages::login_request> ==
+              messages::header_size + config::username_size +
+                  config::password_size);
+static_assert(frame_prefix_size<messages::echo_request> == 6);
+static_assert(extended_frame_prefix_size<messages::echo_request> == 12);
+static_assert(check_frame(2, 6, false) == frame_error::NONE);
+static_assert(check_frame(0, 69, false) == frame_error::TOO_LONG);
+static_assert(check_frame(0, 68, true) == frame_error::UNEXPECTED_EXTENDED);
+static_assert(check_frame(4, 6, false) == frame_error::INVALID_TYPE);
+
+} // namespace mori_echo
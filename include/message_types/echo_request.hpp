@@ -1,14 +1,36 @@
 #pragma once
 
+#include <cstdint>
+#include <tuple>
 #include <vector>
 
 #include "message_base.hpp"
+#include "message_schema.hpp"
 
 namespace mori_echo::messages {
 
 struct echo_request : public message_base {
-  std::uint16_t message_size = {};
+  std::uint32_t message_size = {};
   std::vector<std::byte> cipher_message;
 };
 
+template <> struct message_schema<echo_request> {
+  static constexpr auto type = message_type::ECHO_REQUEST;
+
+  struct layout {
+    std::uint16_t message_size;
+  };
+
+  struct extended_layout {
+    std::uint32_t message_size;
+  };
+
+  static constexpr auto integer_fields = std::tuple{&layout::message_size};
+  static constexpr auto payload_size = &layout::message_size;
+
+  static constexpr auto extended_integer_fields =
+      std::tuple{&extended_layout::message_size};
+  static constexpr auto extended_payload_size = &extended_layout::message_size;
+};
+
 } // namespace mori_echo::messages
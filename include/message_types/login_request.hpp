@@ -1,8 +1,13 @@
 #pragma once
 
+#include <array>
+#include <cstddef>
 #include <string>
+#include <tuple>
 
 #include "message_base.hpp"
+#include "message_schema.hpp"
+#include "mori_echo/server_config.hpp"
 
 namespace mori_echo::messages {
 
@@ -11,4 +16,15 @@ struct login_request : public message_base {
   std::string password;
 };
 
+template <> struct message_schema<login_request> {
+  static constexpr auto type = message_type::LOGIN_REQUEST;
+
+  struct layout {
+    std::array<std::byte, config::username_size> username;
+    std::array<std::byte, config::password_size> password;
+  };
+
+  static constexpr auto integer_fields = std::tuple{};
+};
+
 } // namespace mori_echo::messages
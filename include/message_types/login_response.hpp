@@ -1,6 +1,10 @@
 #pragma once
 
+#include <cstdint>
+#include <tuple>
+
 #include "message_base.hpp"
+#include "message_schema.hpp"
 #include "mori_status/login_status.hpp"
 
 namespace mori_echo::messages {
@@ -9,4 +13,14 @@ struct login_response : public message_base {
   mori_status::login_status status_code = {};
 };
 
+template <> struct message_schema<login_response> {
+  static constexpr auto type = message_type::LOGIN_RESPONSE;
+
+  struct layout {
+    std::uint16_t status_code;
+  };
+
+  static constexpr auto integer_fields = std::tuple{&layout::status_code};
+};
+
 } // namespace mori_echo::messages
@@ -6,10 +6,15 @@
 
 namespace mori_echo::messages {
 
+// A zero `total_size` can never describe a valid frame, so on the wire it
+// flags an extended frame whose 32-bit size follows the sequence field.
+inline constexpr auto extended_frame_marker = std::uint16_t{0};
+
 struct message_header {
-  std::uint16_t total_size = {};
+  std::uint32_t total_size = {};
   message_type type = {};
   std::uint8_t sequence = {};
+  bool is_extended = false;
 };
 
 } // namespace mori_echo::messages
@@ -0,0 +1,63 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <tuple>
+#include <type_traits>
+
+#include "message_base.hpp"
+
+namespace mori_echo::messages {
+
+// Wire layouts are copied to and from the wire as a whole, then have their
+// integer fields converted from or to the protocol byte order. So they must
+// be trivially copyable and have no padding.
+template <typename T>
+concept WireLayout = std::is_trivially_copyable_v<T> &&
+                     std::has_unique_object_representations_v<T>;
+
+struct header_layout {
+  std::uint16_t total_size;
+  std::uint8_t type;
+  std::uint8_t sequence;
+};
+
+// Follows `header_layout` when its `total_size` is the extended frame marker.
+struct extended_size_layout {
+  std::uint32_t total_size;
+};
+
+inline constexpr auto header_size = sizeof(header_layout);
+
+inline constexpr auto extended_header_size =
+    header_size + sizeof(extended_size_layout);
+
+inline constexpr auto max_regular_frame_size =
+    std::size_t{std::numeric_limits<std::uint16_t>::max()};
+
+// Describes a message, specialized next to each message type:
+// - `type`: its message type.
+// - `layout`: the fixed-layout part following the header.
+// - `integer_fields`: the members of `layout` in protocol byte order.
+// - `payload_size` (optional): the member of `layout` sizing a payload that
+//   follows it.
+// - `extended_layout` (optional): replaces `layout` in extended frames, with
+//   its own `extended_integer_fields` and `extended_payload_size`.
+template <MoriEchoMessage T> struct message_schema;
+
+template <typename Schema>
+concept PayloadSchema = requires { Schema::payload_size; };
+
+template <typename Schema>
+concept ExtendedSchema = requires { typename Schema::extended_layout; };
+
+template <MoriEchoMessage T>
+inline constexpr auto layout_size =
+    sizeof(typename message_schema<T>::layout);
+
+static_assert(WireLayout<header_layout>);
+static_assert(WireLayout<extended_size_layout>);
+static_assert(header_size == 4);
+
+} // namespace mori_echo::messages
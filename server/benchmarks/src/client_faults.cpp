@@ -0,0 +1,173 @@
+#include <array>
+#include <boost/asio/co_spawn.hpp>
+#include <boost/asio/io_context.hpp>
+#include <boost/asio/ip/tcp.hpp>
+#include <boost/asio/read.hpp>
+#include <boost/asio/redirect_error.hpp>
+#include <boost/asio/use_awaitable.hpp>
+#include <boost/asio/write.hpp>
+#include <boost/test/unit_test.hpp>
+#include <chrono>
+#include <ctime>
+#include <pthread.h>
+#include <spdlog/spdlog.h>
+#include <thread>
+
+#include "client_authenticator/allow_all_client_authenticator.hpp"
+#include "echo_server/echo_server.hpp"
+#include "message_sender/message_sender.hpp"
+#include "message_sender/test_message_sender.hpp"
+
+namespace mori_echo::benchmark {
+
+inline constexpr auto storm_clients = std::size_t{2000};
+inline constexpr auto concurrent_clients = std::size_t{50};
+
+enum class storm_kind {
+  // Clients log in and then close their connection.
+  DISCONNECT,
+
+  // Clients log in and then send a header of an unknown message type.
+  BAD_FRAME,
+};
+
+struct storm_results {
+  std::chrono::steady_clock::duration elapsed = {};
+  std::chrono::nanoseconds server_cpu_time = {};
+};
+
+[[nodiscard]] auto thread_cpu_time(std::thread& thread)
+    -> std::chrono::nanoseconds {
+  auto clock = clockid_t{};
+  pthread_getcpuclockid(thread.native_handle(), &clock);
+
+  auto now = timespec{};
+  clock_gettime(clock, &now);
+
+  return std::chrono::seconds{now.tv_sec} +
+         std::chrono::nanoseconds{now.tv_nsec};
+}
+
+// Runs `count` faulty clients one after the other against `port`.
+[[nodiscard]] auto faulty_clients(boost::asio::io_context& io_context,
+                                  std::uint16_t port, storm_kind kind,
+                                  std::size_t count)
+    -> boost::asio::awaitable<void> {
+  const auto login = encode_login_request(0, "benchuser", "benchpass");
+
+  // The type byte follows the 16-bit size in either byte order.
+  const auto bad_header = std::array<std::byte, 4>{
+      std::byte{4}, std::byte{0}, std::byte{0xEE}, std::byte{1}};
+
+  for (auto i = std::size_t{0}; i < count; ++i) {
+    auto socket = boost::asio::ip::tcp::socket{io_context};
+
+    co_await socket.async_connect(
+        {boost::asio::ip::address_v4::loopback(), port},
+        boost::asio::use_awaitable);
+
+    co_await boost::asio::async_write(socket, boost::asio::buffer(login),
+                                      boost::asio::use_awaitable);
+
+    auto login_response = std::array<std::byte, login_response_frame_size>{};
+
+    co_await boost::asio::async_read(socket,
+                                     boost::asio::buffer(login_response),
+                                     boost::asio::use_awaitable);
+
+    if (kind == storm_kind::BAD_FRAME) {
+      co_await boost::asio::async_write(socket,
+                                        boost::asio::buffer(bad_header),
+                                        boost::asio::use_awaitable);
+
+      // Wait for the server to drop the connection.
+      auto error = boost::system::error_code{};
+      auto byte = std::array<std::byte, 1>{};
+
+      co_await socket.async_read_some(
+          boost::asio::buffer(byte),
+          boost::asio::redirect_error(boost::asio::use_awaitable, error));
+
+      BOOST_REQUIRE(error == boost::asio::error::eof);
+    }
+  }
+}
+
+[[nodiscard]] auto run_storm(storm_kind kind) -> storm_results {
+  auto server_context = boost::asio::io_context{1};
+
+  const auto endpoint = mori_echo::spawn_server(
+      server_context.get_executor(),
+      {
+          .port = 0,
+          .authenticator =
+              mori_echo::auth::allow_all_client_authenticator::create(),
+      });
+
+  auto server_work = boost::asio::make_work_guard(server_context);
+  auto server_thread = std::thread{[&] { server_context.run(); }};
+
+  auto client_context = boost::asio::io_context{1};
+
+  for (auto i = std::size_t{0}; i < concurrent_clients; ++i) {
+    boost::asio::co_spawn(
+        client_context,
+        faulty_clients(client_context, endpoint.port(), kind,
+                       storm_clients / concurrent_clients),
+        [](std::exception_ptr error) {
+          if (error) {
+            std::rethrow_exception(error);
+          }
+        });
+  }
+
+  const auto cpu_start = thread_cpu_time(server_thread);
+  const auto start = std::chrono::steady_clock::now();
+
+  client_context.run();
+
+  // Let the server see the last disconnects through.
+  std::this_thread::sleep_for(std::chrono::milliseconds{100});
+
+  const auto results = storm_results{
+      .elapsed = std::chrono::steady_clock::now() - start,
+      .server_cpu_time = thread_cpu_time(server_thread) - cpu_start,
+  };
+
+  server_context.stop();
+  server_thread.join();
+
+  return results;
+}
+
+auto report_storm(std::string_view name, const storm_results& results)
+    -> void {
+  const auto seconds =
+      std::chrono::duration<double>(results.elapsed).count() - 0.1;
+
+  spdlog::info("{} storm: {:.0f} clients/s, {:.2f}us server CPU per client",
+               name, static_cast<double>(storm_clients) / seconds,
+               std::chrono::duration<double, std::micro>(
+                   results.server_cpu_time)
+                       .count() /
+                   static_cast<double>(storm_clients));
+}
+
+BOOST_AUTO_TEST_SUITE(client_faults)
+
+BOOST_AUTO_TEST_CASE(disconnect_and_bad_frame_storms) {
+  // Every drop is logged; keep the sink out of the measurement.
+  spdlog::set_level(spdlog::level::off);
+
+  const auto disconnects = run_storm(storm_kind::DISCONNECT);
+  const auto bad_frames = run_storm(storm_kind::BAD_FRAME);
+
+  spdlog::set_level(spdlog::level::info);
+
+  report_storm("disconnect", disconnects);
+  report_storm("bad frame", bad_frames);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+} // namespace mori_echo::benchmark
@@ -0,0 +1,198 @@
+#include <boost/asio/co_spawn.hpp>
+#include <boost/asio/io_context.hpp>
+#include <boost/asio/ip/tcp.hpp>
+#include <boost/asio/use_awaitable.hpp>
+#include <boost/test/unit_test.hpp>
+#include <chrono>
+#include <memory>
+#include <spdlog/spdlog.h>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#include "client_authenticator/allow_all_client_authenticator.hpp"
+#include "client_channel/client_channel.hpp"
+#include "client_crypto/client_crypto.hpp"
+#include "echo_client/echo_client_pool.hpp"
+#include "echo_server/echo_server.hpp"
+#include "message_receiver/test_message_receiver.hpp"
+#include "message_sender/test_message_sender.hpp"
+#include "message_types/echo_response.hpp"
+#include "message_types/login_response.hpp"
+
+namespace mori_echo::benchmark {
+
+inline constexpr auto client_bench_connections = std::size_t{4};
+inline constexpr auto client_bench_payload_size = std::size_t{32};
+
+inline constexpr auto client_bench_username = std::string_view{"benchuser"};
+inline constexpr auto client_bench_password = std::string_view{"benchpass"};
+
+// One echo at a time per connection, waiting for each response before
+// sending the next request.
+[[nodiscard]] auto naive_echo_client(boost::asio::io_context& io_context,
+                                     std::uint16_t port, std::size_t echo_count)
+    -> boost::asio::awaitable<void> {
+  auto socket = boost::asio::ip::tcp::socket{io_context};
+
+  co_await socket.async_connect(
+      {boost::asio::ip::address_v4::loopback(), port},
+      boost::asio::use_awaitable);
+
+  socket.set_option(boost::asio::ip::tcp::no_delay{true});
+
+  auto channel = client_channel{std::move(socket)};
+
+  co_await send_message<messages::login_request>{}(
+      channel, 0, client_bench_username, client_bench_password);
+
+  const auto login_response =
+      co_await receive_message<messages::login_response>(
+          channel, co_await receive_response_header(channel));
+
+  BOOST_REQUIRE(login_response.status_code == mori_status::login_status::OK);
+
+  const auto payload = crypto::encrypt(
+      {
+          .username_sum = crypto::calculate_checksum(client_bench_username),
+          .password_sum = crypto::calculate_checksum(client_bench_password),
+          .sequence = 1,
+      },
+      std::vector<std::byte>(client_bench_payload_size, std::byte{'C'}));
+
+  for (auto i = std::size_t{0}; i < echo_count; ++i) {
+    co_await send_message<messages::echo_request>{}(channel, 1, payload);
+
+    const auto echo_response =
+        co_await receive_message<messages::echo_response>(
+            channel, co_await receive_response_header(channel));
+
+    BOOST_REQUIRE(echo_response.message_size == client_bench_payload_size);
+  }
+}
+
+[[nodiscard]] auto pooled_echo(std::shared_ptr<client::echo_client_pool> pool,
+                               std::shared_ptr<std::size_t> remaining)
+    -> boost::asio::awaitable<void> {
+  const auto echo = co_await pool->echo(
+      std::vector<std::byte>(client_bench_payload_size, std::byte{'C'}));
+
+  BOOST_REQUIRE(echo.size() == client_bench_payload_size);
+
+  if (--*remaining == 0) {
+    pool->close();
+  }
+}
+
+// Every echo at once, pipelined by the pool over its connections.
+[[nodiscard]] auto pooled_echo_clients(boost::asio::io_context& io_context,
+                                       std::uint16_t port,
+                                       std::size_t echo_count)
+    -> boost::asio::awaitable<void> {
+  // Built outside the co_await expression: GCC 12 destroys temporaries with
+  // non-trivial destructors there twice.
+  auto credentials = client::client_credentials{
+      .username = std::string{client_bench_username},
+      .password = std::string{client_bench_password},
+  };
+
+  const auto pool = co_await client::echo_client_pool::connect(
+      io_context.get_executor(),
+      {boost::asio::ip::address_v4::loopback(), port},
+      std::move(credentials), {.connections = client_bench_connections});
+
+  // Shared by the echoes, which outlive this frame.
+  const auto remaining = std::make_shared<std::size_t>(echo_count);
+
+  for (auto i = std::size_t{0}; i < echo_count; ++i) {
+    boost::asio::co_spawn(io_context, pooled_echo(pool, remaining),
+                          [](std::exception_ptr error) {
+                            if (error) {
+                              std::rethrow_exception(error);
+                            }
+                          });
+  }
+}
+
+// Runs `spawn_clients` on this thread against the port of a server on a
+// thread of its own, and returns the echoes per second.
+template <typename SpawnClients>
+[[nodiscard]] auto measure_client_throughput(std::size_t echo_count,
+                                             SpawnClients spawn_clients)
+    -> double {
+  auto server_context = boost::asio::io_context{1};
+
+  const auto endpoint = mori_echo::spawn_server(
+      server_context.get_executor(),
+      {
+          .port = 0,
+          .enable_decryption = true,
+          .authenticator =
+              mori_echo::auth::allow_all_client_authenticator::create(),
+      });
+
+  auto server_work = boost::asio::make_work_guard(server_context);
+  auto server_thread = std::thread{[&] { server_context.run(); }};
+
+  auto client_context = boost::asio::io_context{1};
+
+  spawn_clients(client_context, endpoint.port());
+
+  const auto start = std::chrono::steady_clock::now();
+
+  client_context.run();
+
+  const auto elapsed = std::chrono::steady_clock::now() - start;
+
+  server_context.stop();
+  server_thread.join();
+
+  return static_cast<double>(echo_count) /
+         std::chrono::duration<double>(elapsed).count();
+}
+
+BOOST_AUTO_TEST_SUITE(client_throughput)
+
+BOOST_AUTO_TEST_CASE(naive_and_pooled_clients) {
+  constexpr auto naive_echoes_per_connection = std::size_t{100};
+  constexpr auto pooled_echoes = std::size_t{5'000};
+
+  spdlog::set_level(spdlog::level::warn);
+
+  const auto naive = measure_client_throughput(
+      client_bench_connections * naive_echoes_per_connection,
+      [](boost::asio::io_context& io_context, std::uint16_t port) {
+        for (auto i = std::size_t{0}; i < client_bench_connections; ++i) {
+          boost::asio::co_spawn(
+              io_context,
+              naive_echo_client(io_context, port, naive_echoes_per_connection),
+              [](std::exception_ptr error) {
+                if (error) {
+                  std::rethrow_exception(error);
+                }
+              });
+        }
+      });
+
+  const auto pooled = measure_client_throughput(
+      pooled_echoes, [](boost::asio::io_context& io_context,
+                        std::uint16_t port) {
+        boost::asio::co_spawn(
+            io_context, pooled_echo_clients(io_context, port, pooled_echoes),
+            [](std::exception_ptr error) {
+              if (error) {
+                std::rethrow_exception(error);
+              }
+            });
+      });
+
+  spdlog::set_level(spdlog::level::info);
+
+  spdlog::info("Echo throughput over {} connections: {:.0f} msgs/s one at a "
+               "time, {:.0f} msgs/s pipelined by echo_client_pool",
+               client_bench_connections, naive, pooled);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+} // namespace mori_echo::benchmark
@@ -0,0 +1,210 @@
+#include <algorithm>
+#include <atomic>
+#include <boost/asio/co_spawn.hpp>
+#include <boost/asio/io_context.hpp>
+#include <boost/asio/local/stream_protocol.hpp>
+#include <boost/asio/use_awaitable.hpp>
+#include <boost/test/unit_test.hpp>
+#include <chrono>
+#include <spdlog/spdlog.h>
+#include <thread>
+#include <vector>
+
+#include "client_authenticator/allow_all_client_authenticator.hpp"
+#include "client_channel/client_channel.hpp"
+#include "client_crypto/test_client_crypto.hpp"
+#include "compute_pool/compute_pool.hpp"
+#include "echo_server/echo_server.hpp"
+#include "message_receiver/test_message_receiver.hpp"
+#include "message_sender/test_message_sender.hpp"
+#include "message_types/echo_response.hpp"
+#include "message_types/login_response.hpp"
+#include "test_endpoints/test_endpoints.hpp"
+
+namespace mori_echo::benchmark {
+
+inline constexpr auto offload_bench_username = std::string_view{"benchuser"};
+inline constexpr auto offload_bench_password = std::string_view{"benchpass"};
+
+inline constexpr auto small_payload_size = std::size_t{32};
+inline constexpr auto small_round_trips = std::size_t{300};
+
+inline constexpr auto large_payload_size = std::size_t{64000};
+inline constexpr auto large_clients = std::size_t{2};
+
+[[nodiscard]] auto offload_bench_socket_path() -> std::string {
+  return unique_temp_path("bench_offload.sock");
+}
+
+[[nodiscard]] auto offload_bench_payload(std::size_t size, std::uint8_t sequence)
+    -> std::vector<std::byte> {
+  return crypto::encrypt(
+      {
+          .username_sum = crypto::calculate_checksum(offload_bench_username),
+          .password_sum = crypto::calculate_checksum(offload_bench_password),
+          .sequence = sequence,
+      },
+      std::vector<std::byte>(size, std::byte{'M'}));
+}
+
+[[nodiscard]] auto connect_client(boost::asio::io_context& io_context)
+    -> boost::asio::awaitable<local_client_channel> {
+  auto socket = boost::asio::local::stream_protocol::socket{io_context};
+
+  co_await socket.async_connect({offload_bench_socket_path()},
+                                boost::asio::use_awaitable);
+
+  auto channel = local_client_channel{std::move(socket)};
+
+  co_await send_message<messages::login_request>{}(
+      channel, 0, offload_bench_username, offload_bench_password);
+
+  const auto login_response =
+      co_await receive_message<messages::login_response>(
+          channel, co_await receive_response_header(channel));
+
+  BOOST_REQUIRE(login_response.status_code == mori_status::login_status::OK);
+
+  co_return channel;
+}
+
+// Echoes large payloads back to back until `is_done` is set.
+[[nodiscard]] auto large_echoes(boost::asio::io_context& io_context,
+                                const std::atomic<bool>& is_done)
+    -> boost::asio::awaitable<void> {
+  auto channel = co_await connect_client(io_context);
+
+  const auto payload = offload_bench_payload(large_payload_size, 1);
+
+  while (!is_done) {
+    co_await send_message<messages::echo_request>{}(channel, 1, payload);
+
+    [[maybe_unused]] const auto echo_response =
+        co_await receive_message<messages::echo_response>(
+            channel, co_await receive_response_header(channel));
+  }
+}
+
+[[nodiscard]] auto small_echoes(boost::asio::io_context& io_context)
+    -> boost::asio::awaitable<std::vector<std::chrono::nanoseconds>> {
+  auto channel = co_await connect_client(io_context);
+
+  const auto payload = offload_bench_payload(small_payload_size, 1);
+
+  auto latencies = std::vector<std::chrono::nanoseconds>{};
+  latencies.reserve(small_round_trips);
+
+  for (auto i = std::size_t{0}; i < small_round_trips; ++i) {
+    const auto sent = std::chrono::steady_clock::now();
+
+    co_await send_message<messages::echo_request>{}(channel, 1, payload);
+
+    const auto echo_response =
+        co_await receive_message<messages::echo_response>(
+            channel, co_await receive_response_header(channel));
+
+    latencies.push_back(std::chrono::steady_clock::now() - sent);
+
+    BOOST_REQUIRE(echo_response.message_size == small_payload_size);
+  }
+
+  co_return latencies;
+}
+
+// Measures small echoes while other clients keep the server busy decrypting
+// large ones, on a server running on its own thread.
+[[nodiscard]] auto measure_mixed_workload(std::shared_ptr<compute_pool> pool)
+    -> std::vector<std::chrono::nanoseconds> {
+  auto server_context = boost::asio::io_context{1};
+
+  mori_echo::spawn_server(
+      server_context.get_executor(),
+      {
+          .port = 0,
+          .local_socket_path = offload_bench_socket_path(),
+          .enable_decryption = true,
+          .authenticator =
+              mori_echo::auth::allow_all_client_authenticator::create(),
+          .compute = std::move(pool),
+      });
+
+  // Let the local socket listener bind before any client connects. Only the
+  // TCP one is bound by the time spawn_server() returns.
+  server_context.poll();
+
+  auto server_work = boost::asio::make_work_guard(server_context);
+  auto server_thread = std::thread{[&] { server_context.run(); }};
+
+  auto client_context = boost::asio::io_context{1};
+
+  auto is_done = std::atomic<bool>{false};
+  auto latencies = std::vector<std::chrono::nanoseconds>{};
+
+  const auto rethrow = [](std::exception_ptr error) {
+    if (error) {
+      std::rethrow_exception(error);
+    }
+  };
+
+  for (auto i = std::size_t{0}; i < large_clients; ++i) {
+    boost::asio::co_spawn(client_context, large_echoes(client_context, is_done),
+                          rethrow);
+  }
+
+  boost::asio::co_spawn(
+      client_context,
+      [&]() -> boost::asio::awaitable<void> {
+        latencies = co_await small_echoes(client_context);
+        is_done = true;
+      },
+      rethrow);
+
+  client_context.run();
+
+  server_context.stop();
+  server_thread.join();
+
+  return latencies;
+}
+
+auto report_small_echoes(std::string_view name,
+                         std::vector<std::chrono::nanoseconds> latencies)
+    -> void {
+  std::sort(latencies.begin(), latencies.end());
+
+  const auto percentile = [&](double fraction) {
+    const auto index = static_cast<std::size_t>(
+        fraction * static_cast<double>(latencies.size() - 1));
+
+    return std::chrono::duration<double, std::micro>(latencies[index]).count();
+  };
+
+  spdlog::info("{} small echo latency: p50 {:.2f}us p99 {:.2f}us", name,
+               percentile(0.50), percentile(0.99));
+}
+
+BOOST_AUTO_TEST_SUITE(decrypt_offload)
+
+BOOST_AUTO_TEST_CASE(small_echoes_under_large_decrypts) {
+  spdlog::set_level(spdlog::level::warn);
+
+  const auto inline_latencies = measure_mixed_workload(nullptr);
+
+  const auto pool = compute_pool::create(2, 64);
+  const auto offload_latencies = measure_mixed_workload(pool);
+
+  spdlog::set_level(spdlog::level::info);
+
+  report_small_echoes("inline decryption", inline_latencies);
+  report_small_echoes("offloaded decryption", offload_latencies);
+
+  const auto metrics = pool->metrics();
+
+  spdlog::info("compute pool: {} offloaded, {} inline, peak queue depth {}",
+               metrics.offloaded, metrics.ran_inline,
+               metrics.peak_queue_depth);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+} // namespace mori_echo::benchmark
@@ -0,0 +1,32 @@
+#include <boost/test/unit_test.hpp>
+#include <chrono>
+#include <spdlog/spdlog.h>
+
+#include "flight_recorder/flight_recorder.hpp"
+
+namespace mori_echo::benchmark {
+
+BOOST_AUTO_TEST_SUITE(flight_recording)
+
+BOOST_AUTO_TEST_CASE(record_cost) {
+  constexpr auto event_count = std::uint32_t{10'000'000};
+
+  // Claims the ring of this thread outside of the measurement.
+  flight::record(flight::event_kind::ACCEPT, 0);
+
+  const auto start = std::chrono::steady_clock::now();
+
+  for (auto i = std::uint32_t{0}; i < event_count; ++i) {
+    flight::record(flight::event_kind::SLOW_ECHO, i, i);
+  }
+
+  const auto elapsed = std::chrono::steady_clock::now() - start;
+
+  spdlog::info("Flight recorder: {:.1f} ns per event",
+               std::chrono::duration<double, std::nano>(elapsed).count() /
+                   event_count);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+} // namespace mori_echo::benchmark
@@ -0,0 +1,274 @@
+#include <algorithm>
+#include <boost/asio/co_spawn.hpp>
+#include <boost/asio/io_context.hpp>
+#include <boost/asio/ip/tcp.hpp>
+#include <boost/asio/local/stream_protocol.hpp>
+#include <boost/asio/use_awaitable.hpp>
+#include <boost/test/unit_test.hpp>
+#include <chrono>
+#include <spdlog/spdlog.h>
+#include <thread>
+#include <vector>
+
+#include "client_authenticator/allow_all_client_authenticator.hpp"
+#include "client_channel/client_channel.hpp"
+#include "client_crypto/test_client_crypto.hpp"
+#include "echo_server/echo_server.hpp"
+#include "memory_transport/memory_acceptor.hpp"
+#include "message_receiver/test_message_receiver.hpp"
+#include "message_sender/test_message_sender.hpp"
+#include "message_types/echo_response.hpp"
+#include "message_types/login_response.hpp"
+#include "test_endpoints/test_endpoints.hpp"
+
+namespace mori_echo::benchmark {
+
+inline constexpr auto local_bench_username = std::string_view{"benchuser"};
+inline constexpr auto local_bench_password = std::string_view{"benchpass"};
+
+inline constexpr auto latency_payload_size = std::size_t{32};
+inline constexpr auto latency_round_trips = std::size_t{500};
+
+inline constexpr auto throughput_payload_size = std::size_t{60000};
+inline constexpr auto throughput_round_trips = std::size_t{200};
+
+[[nodiscard]] auto local_bench_socket_path() -> std::string {
+  return unique_temp_path("bench.sock");
+}
+
+struct round_trip_results {
+  std::vector<std::chrono::nanoseconds> latencies = {};
+  std::chrono::steady_clock::duration elapsed = {};
+};
+
+// Logs in once, then echoes `payload_size` bytes `count` times back to back.
+template <typename AsyncStream>
+[[nodiscard]] auto ping_pong(basic_client_channel<AsyncStream> channel,
+                             std::size_t payload_size, std::size_t count)
+    -> boost::asio::awaitable<round_trip_results> {
+  co_await send_message<messages::login_request>{}(
+      channel, 0, local_bench_username, local_bench_password);
+
+  const auto login_response =
+      co_await receive_message<messages::login_response>(
+          channel, co_await receive_response_header(channel));
+
+  BOOST_REQUIRE(login_response.status_code == mori_status::login_status::OK);
+
+  const auto payload = crypto::encrypt(
+      {
+          .username_sum = crypto::calculate_checksum(local_bench_username),
+          .password_sum = crypto::calculate_checksum(local_bench_password),
+          .sequence = 1,
+      },
+      std::vector<std::byte>(payload_size, std::byte{'M'}));
+
+  auto results = round_trip_results{};
+  results.latencies.reserve(count);
+
+  const auto start = std::chrono::steady_clock::now();
+
+  for (auto i = std::size_t{0}; i < count; ++i) {
+    const auto sent = std::chrono::steady_clock::now();
+
+    co_await send_message<messages::echo_request>{}(channel, 1, payload);
+
+    const auto echo_response =
+        co_await receive_message<messages::echo_response>(
+            channel, co_await receive_response_header(channel));
+
+    results.latencies.push_back(std::chrono::steady_clock::now() - sent);
+
+    BOOST_REQUIRE(echo_response.message_size == payload_size);
+  }
+
+  results.elapsed = std::chrono::steady_clock::now() - start;
+
+  co_return results;
+}
+
+template <typename Connect>
+[[nodiscard]] auto run_ping_pong(Connect connect, std::size_t payload_size,
+                                 std::size_t count) -> round_trip_results {
+  auto io_context = boost::asio::io_context{1};
+
+  auto results = round_trip_results{};
+
+  boost::asio::co_spawn(
+      io_context,
+      [&]() -> boost::asio::awaitable<void> {
+        results = co_await ping_pong(co_await connect(io_context),
+                                     payload_size, count);
+      },
+      [](std::exception_ptr error) {
+        if (error) {
+          std::rethrow_exception(error);
+        }
+      });
+
+  io_context.run();
+
+  return results;
+}
+
+[[nodiscard]] auto connect_tcp(boost::asio::io_context& io_context,
+                               std::uint16_t port)
+    -> boost::asio::awaitable<client_channel> {
+  auto socket = boost::asio::ip::tcp::socket{io_context};
+
+  co_await socket.async_connect(
+      {boost::asio::ip::address_v4::loopback(), port},
+      boost::asio::use_awaitable);
+
+  socket.set_option(boost::asio::ip::tcp::no_delay{true});
+
+  co_return client_channel{std::move(socket)};
+}
+
+[[nodiscard]] auto connect_local(boost::asio::io_context& io_context)
+    -> boost::asio::awaitable<local_client_channel> {
+  auto socket = boost::asio::local::stream_protocol::socket{io_context};
+
+  co_await socket.async_connect({local_bench_socket_path()},
+                                boost::asio::use_awaitable);
+
+  co_return local_client_channel{std::move(socket)};
+}
+
+auto report_latency(std::string_view name, round_trip_results results)
+    -> void {
+  std::sort(results.latencies.begin(), results.latencies.end());
+
+  const auto percentile = [&](double fraction) {
+    const auto index = static_cast<std::size_t>(
+        fraction * static_cast<double>(results.latencies.size() - 1));
+
+    return std::chrono::duration<double, std::micro>(results.latencies[index])
+        .count();
+  };
+
+  const auto average =
+      std::chrono::duration<double, std::micro>(results.elapsed).count() /
+      static_cast<double>(results.latencies.size());
+
+  spdlog::info("{} latency: avg {:.1f}us p50 {:.1f}us p99 {:.1f}us", name,
+               average, percentile(0.50), percentile(0.99));
+}
+
+auto report_throughput(std::string_view name,
+                       const round_trip_results& results) -> void {
+  const auto seconds = std::chrono::duration<double>(results.elapsed).count();
+
+  // Every payload byte crosses the transport twice.
+  const auto bytes = 2.0 * static_cast<double>(throughput_payload_size) *
+                     static_cast<double>(results.latencies.size());
+
+  spdlog::info("{} throughput: {:.1f} MiB/s", name,
+               bytes / seconds / (1024.0 * 1024.0));
+}
+
+BOOST_AUTO_TEST_SUITE(local_transport)
+
+BOOST_AUTO_TEST_CASE(tcp_vs_local_socket) {
+  spdlog::set_level(spdlog::level::warn);
+
+  auto server_context = boost::asio::io_context{1};
+
+  const auto endpoint = mori_echo::spawn_server(
+      server_context.get_executor(),
+      {
+          .port = 0,
+          .local_socket_path = local_bench_socket_path(),
+          .enable_decryption = true,
+          .authenticator =
+              mori_echo::auth::allow_all_client_authenticator::create(),
+      });
+
+  // Let the local socket listener bind before any client connects. Only the
+  // TCP one is bound by the time spawn_server() returns.
+  server_context.poll();
+
+  auto server_work = boost::asio::make_work_guard(server_context);
+  auto server_thread = std::thread{[&] { server_context.run(); }};
+
+  const auto connect_ephemeral = [&](boost::asio::io_context& io_context) {
+    return connect_tcp(io_context, endpoint.port());
+  };
+
+  const auto tcp_latency = run_ping_pong(
+      connect_ephemeral, latency_payload_size, latency_round_trips);
+  const auto local_latency =
+      run_ping_pong(connect_local, latency_payload_size, latency_round_trips);
+
+  const auto tcp_throughput = run_ping_pong(
+      connect_ephemeral, throughput_payload_size, throughput_round_trips);
+  const auto local_throughput = run_ping_pong(
+      connect_local, throughput_payload_size, throughput_round_trips);
+
+  spdlog::set_level(spdlog::level::info);
+
+  report_latency("tcp loopback", tcp_latency);
+  report_latency("unix socket", local_latency);
+
+  report_throughput("tcp loopback", tcp_throughput);
+  report_throughput("unix socket", local_throughput);
+
+  server_context.stop();
+  server_thread.join();
+}
+
+// Against a server whose in-process clients skip the kernel altogether.
+BOOST_AUTO_TEST_CASE(tcp_vs_memory) {
+  spdlog::set_level(spdlog::level::warn);
+
+  auto server_context = boost::asio::io_context{1};
+  const auto acceptor = memory_acceptor::create();
+
+  const auto endpoint = mori_echo::spawn_server(
+      server_context.get_executor(),
+      {
+          .port = 0,
+          .memory = acceptor,
+          .enable_decryption = true,
+          .authenticator =
+              mori_echo::auth::allow_all_client_authenticator::create(),
+      });
+
+  auto server_work = boost::asio::make_work_guard(server_context);
+  auto server_thread = std::thread{[&] { server_context.run(); }};
+
+  const auto connect_ephemeral = [&](boost::asio::io_context& io_context) {
+    return connect_tcp(io_context, endpoint.port());
+  };
+
+  const auto connect_memory = [&](boost::asio::io_context& io_context)
+      -> boost::asio::awaitable<memory_client_channel> {
+    co_return memory_client_channel{
+        acceptor->connect(io_context.get_executor())};
+  };
+
+  const auto tcp_latency = run_ping_pong(
+      connect_ephemeral, latency_payload_size, latency_round_trips);
+  const auto memory_latency =
+      run_ping_pong(connect_memory, latency_payload_size, latency_round_trips);
+
+  const auto tcp_throughput = run_ping_pong(
+      connect_ephemeral, throughput_payload_size, throughput_round_trips);
+  const auto memory_throughput = run_ping_pong(
+      connect_memory, throughput_payload_size, throughput_round_trips);
+
+  spdlog::set_level(spdlog::level::info);
+
+  report_latency("tcp loopback", tcp_latency);
+  report_latency("in memory", memory_latency);
+
+  report_throughput("tcp loopback", tcp_throughput);
+  report_throughput("in memory", memory_throughput);
+
+  server_context.stop();
+  server_thread.join();
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+} // namespace mori_echo::benchmark
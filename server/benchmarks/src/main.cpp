@@ -0,0 +1,3 @@
+#define BOOST_TEST_MODULE mori_echo_benchmarks
+
+#include <boost/test/unit_test.hpp>
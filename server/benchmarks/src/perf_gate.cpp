@@ -0,0 +1,395 @@
+#include <algorithm>
+#include <array>
+#include <boost/asio/co_spawn.hpp>
+#include <boost/asio/io_context.hpp>
+#include <boost/asio/ip/tcp.hpp>
+#include <boost/asio/local/stream_protocol.hpp>
+#include <boost/asio/use_awaitable.hpp>
+#include <boost/test/unit_test.hpp>
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <optional>
+#include <sstream>
+#include <spdlog/spdlog.h>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "client_authenticator/allow_all_client_authenticator.hpp"
+#include "client_channel/client_channel.hpp"
+#include "client_crypto/test_client_crypto.hpp"
+#include "echo_server/echo_server.hpp"
+#include "message_receiver/test_message_receiver.hpp"
+#include "message_sender/test_message_sender.hpp"
+#include "message_types/echo_response.hpp"
+#include "message_types/login_response.hpp"
+#include "test_endpoints/test_endpoints.hpp"
+
+namespace mori_echo::benchmark {
+
+inline constexpr auto perf_gate_username = std::string_view{"perfuser"};
+inline constexpr auto perf_gate_password = std::string_view{"perfpass"};
+
+enum class perf_transport { TCP, LOCAL };
+
+// A fixed amount of echo traffic. Changing any of these invalidates the
+// baseline of the workload.
+struct perf_workload {
+  std::string_view name;
+  perf_transport transport;
+
+  std::size_t clients;
+  std::size_t round_trips;
+  std::size_t payload_size;
+};
+
+inline constexpr auto perf_workloads = std::array{
+    perf_workload{
+        .name = "tcp_small_echo",
+        .transport = perf_transport::TCP,
+        .clients = 8,
+        .round_trips = 100,
+        .payload_size = 32,
+    },
+    perf_workload{
+        .name = "tcp_large_echo",
+        .transport = perf_transport::TCP,
+        .clients = 4,
+        .round_trips = 50,
+        .payload_size = 16 * 1024,
+    },
+    perf_workload{
+        .name = "local_small_echo",
+        .transport = perf_transport::LOCAL,
+        .clients = 8,
+        .round_trips = 1000,
+        .payload_size = 32,
+    },
+};
+
+// Each workload runs this many times, and its median results are gated.
+inline constexpr auto perf_gate_repetitions = std::size_t{3};
+
+struct perf_result {
+  double msgs_per_second = {};
+  double p99_us = {};
+};
+
+struct perf_baseline {
+  // Allowed throughput drop and p99 growth, as fractions of the baseline.
+  double throughput_tolerance = 0.30;
+  double latency_tolerance = 2.00;
+
+  std::map<std::string, perf_result, std::less<>> results = {};
+};
+
+[[nodiscard]] auto perf_gate_socket_path() -> std::string {
+  return unique_temp_path("perf_gate.sock");
+}
+
+[[nodiscard]] auto env_or(const char* name, std::string fallback)
+    -> std::string {
+  const auto* value = std::getenv(name);
+  return value != nullptr ? std::string{value} : std::move(fallback);
+}
+
+// Reads lines of `<workload> <msgs_per_second> <p99_us>`, and the
+// `throughput_tolerance` and `latency_tolerance` settings. `#` starts a
+// comment.
+[[nodiscard]] auto read_perf_baseline(const std::string& path)
+    -> std::optional<perf_baseline> {
+  auto file = std::ifstream{path};
+
+  if (!file) {
+    return std::nullopt;
+  }
+
+  auto baseline = perf_baseline{};
+
+  for (auto line = std::string{}; std::getline(file, line);) {
+    line = line.substr(0, line.find('#'));
+
+    auto fields = std::istringstream{line};
+    auto key = std::string{};
+
+    if (!(fields >> key)) {
+      continue;
+    }
+
+    if (key == "throughput_tolerance") {
+      fields >> baseline.throughput_tolerance;
+    } else if (key == "latency_tolerance") {
+      fields >> baseline.latency_tolerance;
+    } else {
+      auto result = perf_result{};
+      fields >> result.msgs_per_second >> result.p99_us;
+
+      BOOST_REQUIRE_MESSAGE(fields, "Malformed baseline line: " << line);
+
+      baseline.results.emplace(std::move(key), result);
+    }
+  }
+
+  return baseline;
+}
+
+auto write_perf_baseline(const std::string& path,
+                         const perf_baseline& baseline) -> void {
+  auto file = std::ofstream{path};
+
+  file << "# Perf gate baseline: <workload> <msgs_per_second> <p99_us>\n"
+       << "# Regenerate on the reference machine with\n"
+       << "# MORI_ECHO_PERF_UPDATE_BASELINE=1 ctest -L perf\n"
+       << "throughput_tolerance " << baseline.throughput_tolerance << '\n'
+       << "latency_tolerance " << baseline.latency_tolerance << '\n';
+
+  for (const auto& [name, result] : baseline.results) {
+    file << name << ' ' << static_cast<std::uint64_t>(result.msgs_per_second)
+         << ' ' << static_cast<std::uint64_t>(result.p99_us) << '\n';
+  }
+}
+
+template <typename AsyncStream>
+[[nodiscard]] auto perf_gate_client(basic_client_channel<AsyncStream> channel,
+                                    const perf_workload& workload,
+                                    std::vector<std::chrono::nanoseconds>&
+                                        latencies)
+    -> boost::asio::awaitable<void> {
+  co_await send_message<messages::login_request>{}(
+      channel, 0, perf_gate_username, perf_gate_password);
+
+  const auto login_response =
+      co_await receive_message<messages::login_response>(
+          channel, co_await receive_response_header(channel));
+
+  BOOST_REQUIRE(login_response.status_code == mori_status::login_status::OK);
+
+  const auto payload = crypto::encrypt(
+      {
+          .username_sum = crypto::calculate_checksum(perf_gate_username),
+          .password_sum = crypto::calculate_checksum(perf_gate_password),
+          .sequence = 1,
+      },
+      std::vector<std::byte>(workload.payload_size, std::byte{'P'}));
+
+  for (auto i = std::size_t{0}; i < workload.round_trips; ++i) {
+    const auto sent = std::chrono::steady_clock::now();
+
+    co_await send_message<messages::echo_request>{}(channel, 1, payload);
+
+    const auto echo_response =
+        co_await receive_message<messages::echo_response>(
+            channel, co_await receive_response_header(channel));
+
+    latencies.push_back(std::chrono::steady_clock::now() - sent);
+
+    BOOST_REQUIRE(echo_response.message_size == workload.payload_size);
+  }
+}
+
+[[nodiscard]] auto perf_gate_connect(boost::asio::io_context& io_context,
+                                     std::uint16_t port,
+                                     const perf_workload& workload,
+                                     std::vector<std::chrono::nanoseconds>&
+                                         latencies)
+    -> boost::asio::awaitable<void> {
+  if (workload.transport == perf_transport::TCP) {
+    auto socket = boost::asio::ip::tcp::socket{io_context};
+
+    co_await socket.async_connect(
+        {boost::asio::ip::address_v4::loopback(), port},
+        boost::asio::use_awaitable);
+
+    socket.set_option(boost::asio::ip::tcp::no_delay{true});
+
+    co_await perf_gate_client(client_channel{std::move(socket)}, workload,
+                              latencies);
+  } else {
+    auto socket = boost::asio::local::stream_protocol::socket{io_context};
+
+    co_await socket.async_connect({perf_gate_socket_path()},
+                                  boost::asio::use_awaitable);
+
+    co_await perf_gate_client(local_client_channel{std::move(socket)},
+                              workload, latencies);
+  }
+}
+
+// Runs the clients of `workload` on this thread, against a server running
+// on a thread of its own.
+[[nodiscard]] auto run_perf_workload(const perf_workload& workload)
+    -> perf_result {
+  auto server_context = boost::asio::io_context{1};
+
+  const auto endpoint = mori_echo::spawn_server(
+      server_context.get_executor(),
+      {
+          .port = 0,
+          .local_socket_path = perf_gate_socket_path(),
+          .enable_decryption = true,
+          .authenticator =
+              mori_echo::auth::allow_all_client_authenticator::create(),
+      });
+
+  // Let the local socket listener bind before any client connects. Only the
+  // TCP one is bound by the time spawn_server() returns.
+  server_context.poll();
+
+  auto server_work = boost::asio::make_work_guard(server_context);
+  auto server_thread = std::thread{[&] { server_context.run(); }};
+
+  auto client_context = boost::asio::io_context{1};
+
+  auto latencies = std::vector<std::chrono::nanoseconds>{};
+  latencies.reserve(workload.clients * workload.round_trips);
+
+  for (auto i = std::size_t{0}; i < workload.clients; ++i) {
+    boost::asio::co_spawn(
+        client_context,
+        perf_gate_connect(client_context, endpoint.port(), workload,
+                          latencies),
+        [](std::exception_ptr error) {
+          if (error) {
+            std::rethrow_exception(error);
+          }
+        });
+  }
+
+  const auto start = std::chrono::steady_clock::now();
+
+  client_context.run();
+
+  const auto elapsed = std::chrono::steady_clock::now() - start;
+
+  server_context.stop();
+  server_thread.join();
+
+  std::sort(latencies.begin(), latencies.end());
+
+  const auto p99 = latencies[static_cast<std::size_t>(
+      0.99 * static_cast<double>(latencies.size() - 1))];
+
+  return {
+      .msgs_per_second = static_cast<double>(latencies.size()) /
+                         std::chrono::duration<double>(elapsed).count(),
+      .p99_us = std::chrono::duration<double, std::micro>(p99).count(),
+  };
+}
+
+[[nodiscard]] auto run_perf_workload_median(const perf_workload& workload)
+    -> perf_result {
+  auto runs = std::vector<perf_result>{};
+
+  for (auto i = std::size_t{0}; i < perf_gate_repetitions; ++i) {
+    runs.push_back(run_perf_workload(workload));
+  }
+
+  const auto median = [&](double perf_result::*metric) {
+    auto values = std::vector<double>{};
+
+    for (const auto& run : runs) {
+      values.push_back(run.*metric);
+    }
+
+    std::nth_element(values.begin(), values.begin() + values.size() / 2,
+                     values.end());
+
+    return values[values.size() / 2];
+  };
+
+  return {
+      .msgs_per_second = median(&perf_result::msgs_per_second),
+      .p99_us = median(&perf_result::p99_us),
+  };
+}
+
+// One JSON object per line, for dashboards and CI annotations.
+[[nodiscard]] auto format_perf_result(std::string_view name,
+                                      const perf_result& result,
+                                      const perf_result* baseline,
+                                      std::string_view status)
+    -> std::string {
+  auto line = fmt::format(
+      R"({{"workload":"{}","msgs_per_second":{:.0f},"p99_us":{:.1f})", name,
+      result.msgs_per_second, result.p99_us);
+
+  if (baseline != nullptr) {
+    line += fmt::format(
+        R"(,"baseline_msgs_per_second":{:.0f},"baseline_p99_us":{:.1f})",
+        baseline->msgs_per_second, baseline->p99_us);
+  }
+
+  return line + fmt::format(R"(,"status":"{}"}})", status);
+}
+
+BOOST_AUTO_TEST_SUITE(perf_gate)
+
+BOOST_AUTO_TEST_CASE(workloads_within_baseline) {
+  spdlog::set_level(spdlog::level::warn);
+
+  const auto baseline_path =
+      env_or("MORI_ECHO_PERF_BASELINE", "perf_baseline.txt");
+  const auto results_path =
+      env_or("MORI_ECHO_PERF_RESULTS", "perf_gate_results.jsonl");
+
+  const auto is_update = std::getenv("MORI_ECHO_PERF_UPDATE_BASELINE");
+
+  const auto baseline =
+      read_perf_baseline(baseline_path).value_or(perf_baseline{});
+
+  auto measured = perf_baseline{
+      .throughput_tolerance = baseline.throughput_tolerance,
+      .latency_tolerance = baseline.latency_tolerance,
+  };
+
+  auto results = std::ofstream{results_path};
+
+  for (const auto& workload : perf_workloads) {
+    const auto result = run_perf_workload_median(workload);
+
+    measured.results.emplace(std::string{workload.name}, result);
+
+    const auto found = baseline.results.find(workload.name);
+    const auto* expected =
+        found != baseline.results.end() ? &found->second : nullptr;
+
+    auto status = std::string_view{"no_baseline"};
+
+    if (expected != nullptr) {
+      const auto is_slower =
+          result.msgs_per_second <
+          expected->msgs_per_second * (1.0 - baseline.throughput_tolerance);
+
+      const auto is_laggier =
+          result.p99_us > expected->p99_us * (1.0 + baseline.latency_tolerance);
+
+      status = is_slower || is_laggier ? "regressed" : "ok";
+
+      if (is_update == nullptr) {
+        BOOST_CHECK_MESSAGE(!is_slower, workload.name << " throughput "
+                                                      << result.msgs_per_second
+                                                      << " msgs/s regressed");
+        BOOST_CHECK_MESSAGE(!is_laggier, workload.name << " p99 "
+                                                       << result.p99_us
+                                                       << "us regressed");
+      }
+    }
+
+    const auto line = format_perf_result(workload.name, result, expected,
+                                         status);
+
+    std::cout << line << std::endl;
+    results << line << '\n';
+  }
+
+  if (is_update != nullptr) {
+    write_perf_baseline(baseline_path, measured);
+  }
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+} // namespace mori_echo::benchmark
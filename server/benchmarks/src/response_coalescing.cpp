@@ -0,0 +1,184 @@
+#include <array>
+#include <boost/asio/co_spawn.hpp>
+#include <boost/asio/detached.hpp>
+#include <boost/asio/io_context.hpp>
+#include <boost/asio/ip/tcp.hpp>
+#include <boost/asio/use_awaitable.hpp>
+#include <boost/test/unit_test.hpp>
+#include <chrono>
+#include <spdlog/spdlog.h>
+#include <sys/resource.h>
+#include <thread>
+#include <vector>
+
+#include "client_authenticator/allow_all_client_authenticator.hpp"
+#include "client_channel/client_channel.hpp"
+#include "client_channel/response_batch.hpp"
+#include "echo_server/echo_server.hpp"
+#include "message_receiver/test_message_receiver.hpp"
+#include "message_sender/test_message_sender.hpp"
+#include "message_types/echo_response.hpp"
+#include "message_types/login_response.hpp"
+
+namespace mori_echo::benchmark {
+
+inline constexpr auto coalescing_bench_echoes = std::size_t{100000};
+
+// Bytes of requests the client writes at once.
+inline constexpr auto coalescing_bench_write_size = std::size_t{16} * 1024;
+
+inline constexpr auto coalescing_bench_payload_sizes =
+    std::array{std::size_t{32}, std::size_t{256}, std::size_t{2048}};
+
+// Writes requests back to back, several frames per write, never waiting for
+// a response.
+[[nodiscard]] auto send_pipelined_requests(
+    client_channel& channel, const std::vector<std::byte>& payload,
+    std::size_t count) -> boost::asio::awaitable<void> {
+  auto requests = std::vector<std::byte>{};
+
+  for (auto i = std::size_t{0}; i < count; ++i) {
+    const auto request =
+        encode_echo_request(static_cast<std::uint8_t>(i), payload);
+    requests.insert(requests.end(), request.begin(), request.end());
+
+    if (requests.size() >= coalescing_bench_write_size || i + 1 == count) {
+      co_await channel.send(requests);
+      requests.clear();
+    }
+  }
+}
+
+[[nodiscard]] auto pipeline_echoes(boost::asio::io_context& io_context,
+                                   std::uint16_t port,
+                                   const std::vector<std::byte>& payload,
+                                   std::size_t count)
+    -> boost::asio::awaitable<void> {
+  auto socket = boost::asio::ip::tcp::socket{io_context};
+
+  co_await socket.async_connect(
+      {boost::asio::ip::address_v4::loopback(), port},
+      boost::asio::use_awaitable);
+
+  auto channel = client_channel{std::move(socket)};
+
+  co_await send_message<messages::login_request>{}(channel, 0, "benchuser",
+                                                   "benchpass");
+
+  const auto login_response =
+      co_await receive_message<messages::login_response>(
+          channel, co_await receive_response_header(channel));
+
+  BOOST_REQUIRE(login_response.status_code == mori_status::login_status::OK);
+
+  boost::asio::co_spawn(io_context,
+                        send_pipelined_requests(channel, payload, count),
+                        boost::asio::detached);
+
+  for (auto i = std::size_t{0}; i < count; ++i) {
+    const auto echo_response =
+        co_await receive_message<messages::echo_response>(
+            channel, co_await receive_response_header(channel));
+
+    BOOST_REQUIRE(echo_response.message_size == payload.size());
+  }
+}
+
+struct pipelined_results {
+  double echoes_per_second = {};
+
+  // CPU time of the server's thread per echo, user and system.
+  double server_cpu_us = {};
+};
+
+// With decryption off, so that sending dominates.
+[[nodiscard]] auto measure_pipelined_echoes(
+    bool enable_coalescing, std::size_t payload_size,
+    std::shared_ptr<coalescing_counters> counters) -> pipelined_results {
+  auto server_context = boost::asio::io_context{1};
+
+  const auto endpoint = mori_echo::spawn_server(
+      server_context.get_executor(),
+      {
+          .port = 0,
+          .enable_decryption = false,
+          .enable_coalescing = enable_coalescing,
+          .coalescing = {.counters = std::move(counters)},
+          .authenticator =
+              mori_echo::auth::allow_all_client_authenticator::create(),
+      });
+
+  auto server_work = boost::asio::make_work_guard(server_context);
+  auto server_cpu = std::chrono::microseconds{};
+  auto server_thread = std::thread{[&] {
+    server_context.run();
+
+    auto usage = rusage{};
+    ::getrusage(RUSAGE_THREAD, &usage);
+
+    server_cpu =
+        std::chrono::seconds{usage.ru_utime.tv_sec + usage.ru_stime.tv_sec} +
+        std::chrono::microseconds{usage.ru_utime.tv_usec +
+                                  usage.ru_stime.tv_usec};
+  }};
+
+  const auto payload = std::vector<std::byte>(payload_size, std::byte{'C'});
+
+  auto client_context = boost::asio::io_context{1};
+
+  const auto start = std::chrono::steady_clock::now();
+
+  boost::asio::co_spawn(
+      client_context,
+      pipeline_echoes(client_context, endpoint.port(), payload,
+                      coalescing_bench_echoes),
+      [](std::exception_ptr error) {
+        if (error) {
+          std::rethrow_exception(error);
+        }
+      });
+
+  client_context.run();
+
+  const auto elapsed = std::chrono::duration<double>(
+                           std::chrono::steady_clock::now() - start)
+                           .count();
+
+  server_context.stop();
+  server_thread.join();
+
+  const auto echoes = static_cast<double>(coalescing_bench_echoes);
+
+  return {
+      .echoes_per_second = echoes / elapsed,
+      .server_cpu_us = static_cast<double>(server_cpu.count()) / echoes,
+  };
+}
+
+BOOST_AUTO_TEST_SUITE(response_coalescing)
+
+BOOST_AUTO_TEST_CASE(separate_vs_coalesced_sends) {
+  for (const auto payload_size : coalescing_bench_payload_sizes) {
+    const auto counters = coalescing_counters::create();
+
+    spdlog::set_level(spdlog::level::warn);
+
+    const auto separate =
+        measure_pipelined_echoes(false, payload_size, nullptr);
+    const auto coalesced =
+        measure_pipelined_echoes(true, payload_size, counters);
+
+    spdlog::set_level(spdlog::level::info);
+
+    spdlog::info("{} byte payloads: {:.0f} echoes/s at {:.2f}us of server "
+                 "CPU each sent separately, {:.0f} echoes/s at {:.2f}us "
+                 "coalesced, {:.1f} responses per send call",
+                 payload_size, separate.echoes_per_second,
+                 separate.server_cpu_us, coalesced.echoes_per_second,
+                 coalesced.server_cpu_us, counters->responses_per_call());
+  }
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+} // namespace mori_echo::benchmark
@@ -0,0 +1,237 @@
+#include <algorithm>
+#include <boost/asio/co_spawn.hpp>
+#include <boost/asio/io_context.hpp>
+#include <boost/asio/local/stream_protocol.hpp>
+#include <boost/asio/use_awaitable.hpp>
+#include <boost/test/unit_test.hpp>
+#include <chrono>
+#include <spdlog/spdlog.h>
+#include <thread>
+#include <vector>
+
+#include "client_authenticator/allow_all_client_authenticator.hpp"
+#include "client_channel/client_channel.hpp"
+#include "client_crypto/test_client_crypto.hpp"
+#include "echo_server/echo_server.hpp"
+#include "message_receiver/test_message_receiver.hpp"
+#include "message_sender/test_message_sender.hpp"
+#include "message_types/echo_response.hpp"
+#include "message_types/login_response.hpp"
+#include "shm_client/test_shm_client.hpp"
+#include "test_endpoints/test_endpoints.hpp"
+
+namespace mori_echo::benchmark {
+
+inline constexpr auto shm_bench_username = std::string_view{"benchuser"};
+inline constexpr auto shm_bench_password = std::string_view{"benchpass"};
+
+inline constexpr auto shm_payload_size = std::size_t{32};
+inline constexpr auto shm_round_trips = std::size_t{20000};
+
+// Ring polls on both sides before sleeping, when spinning.
+inline constexpr auto shm_spin_count = std::size_t{100000};
+
+[[nodiscard]] auto shm_bench_socket_path() -> std::string {
+  return unique_temp_path("bench_uds.sock");
+}
+
+[[nodiscard]] auto shm_bench_control_path() -> std::string {
+  return unique_temp_path("bench_shm.sock");
+}
+
+[[nodiscard]] auto shm_bench_payload() -> std::vector<std::byte> {
+  return crypto::encrypt(
+      {
+          .username_sum = crypto::calculate_checksum(shm_bench_username),
+          .password_sum = crypto::calculate_checksum(shm_bench_password),
+          .sequence = 1,
+      },
+      std::vector<std::byte>(shm_payload_size, std::byte{'M'}));
+}
+
+[[nodiscard]] auto uds_round_trips(boost::asio::io_context& io_context)
+    -> boost::asio::awaitable<std::vector<std::chrono::nanoseconds>> {
+  auto socket = boost::asio::local::stream_protocol::socket{io_context};
+
+  co_await socket.async_connect({shm_bench_socket_path()},
+                                boost::asio::use_awaitable);
+
+  auto channel = local_client_channel{std::move(socket)};
+
+  co_await send_message<messages::login_request>{}(
+      channel, 0, shm_bench_username, shm_bench_password);
+
+  const auto login_response =
+      co_await receive_message<messages::login_response>(
+          channel, co_await receive_response_header(channel));
+
+  BOOST_REQUIRE(login_response.status_code == mori_status::login_status::OK);
+
+  const auto payload = shm_bench_payload();
+
+  auto latencies = std::vector<std::chrono::nanoseconds>{};
+  latencies.reserve(shm_round_trips);
+
+  for (auto i = std::size_t{0}; i < shm_round_trips; ++i) {
+    const auto sent = std::chrono::steady_clock::now();
+
+    co_await send_message<messages::echo_request>{}(channel, 1, payload);
+
+    const auto echo_response =
+        co_await receive_message<messages::echo_response>(
+            channel, co_await receive_response_header(channel));
+
+    latencies.push_back(std::chrono::steady_clock::now() - sent);
+
+    BOOST_REQUIRE(echo_response.message_size == shm_payload_size);
+  }
+
+  co_return latencies;
+}
+
+[[nodiscard]] auto shm_round_trips_with(boost::asio::io_context& io_context,
+                                        std::size_t spin_count)
+    -> boost::asio::awaitable<std::vector<std::chrono::nanoseconds>> {
+  auto client = co_await shm_client::connect(io_context.get_executor(),
+                                             shm_bench_control_path());
+
+  client.send(encode_login_request(0, shm_bench_username, shm_bench_password));
+
+  auto login_reply = co_await client.receive();
+  auto login_data = std::span{login_reply};
+
+  const auto login_response = decode_message<messages::login_response>(
+      login_data, decode_header(login_data));
+
+  BOOST_REQUIRE(login_response.status_code == mori_status::login_status::OK);
+
+  const auto request = encode_echo_request(1, shm_bench_payload());
+
+  auto latencies = std::vector<std::chrono::nanoseconds>{};
+  latencies.reserve(shm_round_trips);
+
+  for (auto i = std::size_t{0}; i < shm_round_trips; ++i) {
+    const auto sent = std::chrono::steady_clock::now();
+
+    client.send(request);
+
+    const auto reply = co_await client.receive(spin_count);
+
+    latencies.push_back(std::chrono::steady_clock::now() - sent);
+
+    BOOST_REQUIRE(reply.size() == request.size());
+  }
+
+  co_return latencies;
+}
+
+template <typename RoundTrips>
+[[nodiscard]] auto run_round_trips(RoundTrips round_trips)
+    -> std::vector<std::chrono::nanoseconds> {
+  auto io_context = boost::asio::io_context{1};
+
+  auto latencies = std::vector<std::chrono::nanoseconds>{};
+
+  boost::asio::co_spawn(
+      io_context,
+      [&]() -> boost::asio::awaitable<void> {
+        latencies = co_await round_trips(io_context);
+      },
+      [](std::exception_ptr error) {
+        if (error) {
+          std::rethrow_exception(error);
+        }
+      });
+
+  io_context.run();
+
+  return latencies;
+}
+
+auto report_round_trips(std::string_view name,
+                        std::vector<std::chrono::nanoseconds> latencies)
+    -> void {
+  std::sort(latencies.begin(), latencies.end());
+
+  const auto percentile = [&](double fraction) {
+    const auto index = static_cast<std::size_t>(
+        fraction * static_cast<double>(latencies.size() - 1));
+
+    return std::chrono::duration<double, std::micro>(latencies[index]).count();
+  };
+
+  spdlog::info("{} latency: p50 {:.2f}us p99 {:.2f}us", name, percentile(0.50),
+               percentile(0.99));
+}
+
+// Runs the server on its own thread, spinning on idle rings `spin_count`
+// times, and measures `round_trips` against it.
+template <typename RoundTrips>
+[[nodiscard]] auto measure_against_server(std::size_t spin_count,
+                                          RoundTrips round_trips)
+    -> std::vector<std::chrono::nanoseconds> {
+  auto server_context = boost::asio::io_context{1};
+
+  mori_echo::spawn_server(
+      server_context.get_executor(),
+      {
+          .port = 0,
+          .local_socket_path = shm_bench_socket_path(),
+          .shm_control_path = shm_bench_control_path(),
+          .shm_spin_count = spin_count,
+          .enable_decryption = true,
+          .authenticator =
+              mori_echo::auth::allow_all_client_authenticator::create(),
+      });
+
+  // Let the local socket and shared-memory listeners bind before any client
+  // connects. Only the TCP one is bound by the time spawn_server() returns.
+  server_context.poll();
+
+  auto server_work = boost::asio::make_work_guard(server_context);
+  auto server_thread = std::thread{[&] { server_context.run(); }};
+
+  auto latencies = run_round_trips(std::move(round_trips));
+
+  server_context.stop();
+  server_thread.join();
+
+  return latencies;
+}
+
+BOOST_AUTO_TEST_SUITE(shm_transport)
+
+BOOST_AUTO_TEST_CASE(local_socket_vs_shm) {
+  spdlog::set_level(spdlog::level::warn);
+
+  const auto uds = measure_against_server(0, uds_round_trips);
+
+  const auto shm_sleeping = measure_against_server(
+      0, [](auto& io_context) { return shm_round_trips_with(io_context, 0); });
+
+  spdlog::set_level(spdlog::level::info);
+
+  report_round_trips("unix socket", uds);
+  report_round_trips("shm (eventfd wake-ups)", shm_sleeping);
+
+  // Spinning needs a core for each side, or both just burn their time slices.
+  if (std::thread::hardware_concurrency() < 2) {
+    spdlog::info("shm (spinning) skipped: fewer than two cores");
+    return;
+  }
+
+  spdlog::set_level(spdlog::level::warn);
+
+  const auto shm_spinning =
+      measure_against_server(shm_spin_count, [](auto& io_context) {
+        return shm_round_trips_with(io_context, shm_spin_count);
+      });
+
+  spdlog::set_level(spdlog::level::info);
+
+  report_round_trips("shm (spinning)", shm_spinning);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+} // namespace mori_echo::benchmark
@@ -0,0 +1,173 @@
+#include <array>
+#include <boost/asio/co_spawn.hpp>
+#include <boost/asio/detached.hpp>
+#include <boost/asio/io_context.hpp>
+#include <boost/asio/ip/tcp.hpp>
+#include <boost/asio/use_awaitable.hpp>
+#include <boost/test/unit_test.hpp>
+#include <chrono>
+#include <ctime>
+#include <spdlog/spdlog.h>
+#include <thread>
+#include <vector>
+
+#include "client_authenticator/allow_all_client_authenticator.hpp"
+#include "client_channel/client_channel.hpp"
+#include "echo_server/echo_server.hpp"
+#include "message_receiver/test_message_receiver.hpp"
+#include "message_sender/test_message_sender.hpp"
+#include "message_types/echo_response.hpp"
+#include "message_types/login_response.hpp"
+
+namespace mori_echo::benchmark {
+
+// Echoed per run, whatever the payload size.
+inline constexpr auto splice_bench_total_bytes = std::size_t{256} * 1024 * 1024;
+
+inline constexpr auto splice_bench_payload_sizes =
+    std::array{std::size_t{64} * 1024, std::size_t{1024} * 1024,
+               std::size_t{8} * 1024 * 1024};
+
+struct passthrough_results {
+  std::chrono::steady_clock::duration elapsed = {};
+
+  // CPU time of the server's thread.
+  std::chrono::nanoseconds server_cpu = {};
+};
+
+[[nodiscard]] auto thread_cpu_time() -> std::chrono::nanoseconds {
+  auto now = timespec{};
+  ::clock_gettime(CLOCK_THREAD_CPUTIME_ID, &now);
+
+  return std::chrono::seconds{now.tv_sec} +
+         std::chrono::nanoseconds{now.tv_nsec};
+}
+
+[[nodiscard]] auto send_passthrough_requests(
+    client_channel& channel, const std::vector<std::byte>& payload,
+    std::size_t count) -> boost::asio::awaitable<void> {
+  for (auto i = std::size_t{0}; i < count; ++i) {
+    co_await send_message<messages::echo_request>{}(channel, 1, payload);
+  }
+}
+
+// Streams `count` echoes of `payload`, reading them back while they are sent.
+[[nodiscard]] auto stream_passthrough_echoes(
+    boost::asio::io_context& io_context, std::uint16_t port,
+    const std::vector<std::byte>& payload, std::size_t count)
+    -> boost::asio::awaitable<void> {
+  auto socket = boost::asio::ip::tcp::socket{io_context};
+
+  co_await socket.async_connect(
+      {boost::asio::ip::address_v4::loopback(), port},
+      boost::asio::use_awaitable);
+
+  auto channel = client_channel{std::move(socket)};
+
+  co_await send_message<messages::login_request>{}(channel, 0, "benchuser",
+                                                   "benchpass");
+
+  const auto login_response =
+      co_await receive_message<messages::login_response>(
+          channel, co_await receive_response_header(channel));
+
+  BOOST_REQUIRE(login_response.status_code == mori_status::login_status::OK);
+
+  boost::asio::co_spawn(io_context,
+                        send_passthrough_requests(channel, payload, count),
+                        boost::asio::detached);
+
+  for (auto i = std::size_t{0}; i < count; ++i) {
+    const auto echo_response =
+        co_await receive_message<messages::echo_response>(
+            channel, co_await receive_response_header(channel));
+
+    BOOST_REQUIRE(echo_response.message_size == payload.size());
+  }
+}
+
+[[nodiscard]] auto measure_passthrough(bool enable_splice,
+                                       std::size_t payload_size)
+    -> passthrough_results {
+  auto server_context = boost::asio::io_context{1};
+
+  const auto endpoint = mori_echo::spawn_server(
+      server_context.get_executor(),
+      {
+          .port = 0,
+          .enable_decryption = false,
+          .enable_splice = enable_splice,
+          .max_message_size = 16 * 1024 * 1024,
+          .authenticator =
+              mori_echo::auth::allow_all_client_authenticator::create(),
+      });
+
+  auto results = passthrough_results{};
+
+  auto server_work = boost::asio::make_work_guard(server_context);
+  auto server_thread = std::thread{[&] {
+    const auto cpu_start = thread_cpu_time();
+    server_context.run();
+    results.server_cpu = thread_cpu_time() - cpu_start;
+  }};
+
+  const auto payload = std::vector<std::byte>(payload_size, std::byte{'S'});
+  const auto count = splice_bench_total_bytes / payload_size;
+
+  auto client_context = boost::asio::io_context{1};
+
+  const auto start = std::chrono::steady_clock::now();
+
+  boost::asio::co_spawn(client_context,
+                        stream_passthrough_echoes(client_context,
+                                                  endpoint.port(), payload,
+                                                  count),
+                        [](std::exception_ptr error) {
+                          if (error) {
+                            std::rethrow_exception(error);
+                          }
+                        });
+
+  client_context.run();
+
+  results.elapsed = std::chrono::steady_clock::now() - start;
+
+  server_context.stop();
+  server_thread.join();
+
+  return results;
+}
+
+auto report_passthrough(std::string_view name, std::size_t payload_size,
+                        const passthrough_results& results) -> void {
+  const auto seconds = std::chrono::duration<double>(results.elapsed).count();
+  const auto cpu_seconds =
+      std::chrono::duration<double>(results.server_cpu).count();
+
+  const auto mebibytes =
+      static_cast<double>(splice_bench_total_bytes) / (1024.0 * 1024.0);
+
+  spdlog::info("{} {} KiB payloads: {:.1f} MiB/s, server CPU {:.2f}ms/MiB",
+               name, payload_size / 1024, mebibytes / seconds,
+               cpu_seconds * 1000.0 / mebibytes);
+}
+
+BOOST_AUTO_TEST_SUITE(splice_passthrough)
+
+BOOST_AUTO_TEST_CASE(copy_vs_splice) {
+  for (const auto payload_size : splice_bench_payload_sizes) {
+    spdlog::set_level(spdlog::level::warn);
+
+    const auto copied = measure_passthrough(false, payload_size);
+    const auto spliced = measure_passthrough(true, payload_size);
+
+    spdlog::set_level(spdlog::level::info);
+
+    report_passthrough("copied", payload_size, copied);
+    report_passthrough("spliced", payload_size, spliced);
+  }
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+} // namespace mori_echo::benchmark
@@ -0,0 +1,229 @@
+#include <boost/asio/co_spawn.hpp>
+#include <boost/asio/io_context.hpp>
+#include <boost/asio/ip/tcp.hpp>
+#include <boost/asio/ip/udp.hpp>
+#include <boost/asio/steady_timer.hpp>
+#include <boost/asio/use_awaitable.hpp>
+#include <boost/test/unit_test.hpp>
+#include <chrono>
+#include <spdlog/spdlog.h>
+#include <thread>
+
+#include "client_authenticator/allow_all_client_authenticator.hpp"
+#include "client_channel/client_channel.hpp"
+#include "client_crypto/test_client_crypto.hpp"
+#include "echo_server/echo_server.hpp"
+#include "message_receiver/test_message_receiver.hpp"
+#include "message_sender/test_message_sender.hpp"
+#include "message_types/echo_response.hpp"
+#include "message_types/login_response.hpp"
+#include "test_endpoints/test_endpoints.hpp"
+
+namespace mori_echo::benchmark {
+
+inline constexpr auto username = std::string_view{"benchuser"};
+inline constexpr auto password = std::string_view{"benchpass"};
+
+inline constexpr auto payload_size = std::size_t{32};
+inline constexpr auto concurrent_clients = std::size_t{16};
+
+[[nodiscard]] auto encrypted_payload(std::uint8_t sequence)
+    -> std::vector<std::byte> {
+  return crypto::encrypt(
+      {
+          .username_sum = crypto::calculate_checksum(username),
+          .password_sum = crypto::calculate_checksum(password),
+          .sequence = sequence,
+      },
+      std::vector<std::byte>(payload_size, std::byte{'M'}));
+}
+
+// A probe over TCP pays for the handshake and the login round trip before its
+// single echo.
+[[nodiscard]] auto tcp_probe(boost::asio::io_context& io_context,
+                             std::uint16_t port,
+                             const std::vector<std::byte>& payload)
+    -> boost::asio::awaitable<void> {
+  auto socket = boost::asio::ip::tcp::socket{io_context};
+
+  co_await socket.async_connect(
+      {boost::asio::ip::address_v4::loopback(), port},
+      boost::asio::use_awaitable);
+
+  socket.set_option(boost::asio::ip::tcp::no_delay{true});
+
+  auto channel = client_channel{std::move(socket)};
+
+  co_await send_message<messages::login_request>{}(channel, 0, username,
+                                                    password);
+
+  const auto login_response =
+      co_await receive_message<messages::login_response>(
+          channel, co_await receive_response_header(channel));
+
+  BOOST_REQUIRE(login_response.status_code == mori_status::login_status::OK);
+
+  co_await send_message<messages::echo_request>{}(channel, 1, payload);
+
+  const auto echo_response =
+      co_await receive_message<messages::echo_response>(
+          channel, co_await receive_response_header(channel));
+
+  BOOST_REQUIRE(echo_response.message_size == payload.size());
+}
+
+struct probe_results {
+  std::size_t completed = {};
+  std::size_t lost = {};
+  std::chrono::steady_clock::duration elapsed = {};
+};
+
+[[nodiscard]] auto run_tcp_probes(std::uint16_t port, std::size_t count)
+    -> probe_results {
+  auto io_context = boost::asio::io_context{1};
+
+  const auto payload = encrypted_payload(1);
+
+  auto results = probe_results{};
+  auto started = std::size_t{0};
+
+  for (auto i = std::size_t{0}; i < concurrent_clients; ++i) {
+    boost::asio::co_spawn(
+        io_context,
+        [&]() -> boost::asio::awaitable<void> {
+          while (started < count) {
+            ++started;
+            co_await tcp_probe(io_context, port, payload);
+            ++results.completed;
+          }
+        },
+        [](std::exception_ptr error) {
+          if (error) {
+            std::rethrow_exception(error);
+          }
+        });
+  }
+
+  const auto start = std::chrono::steady_clock::now();
+  io_context.run();
+  results.elapsed = std::chrono::steady_clock::now() - start;
+
+  return results;
+}
+
+[[nodiscard]] auto run_udp_probes(std::uint16_t port, std::size_t count)
+    -> probe_results {
+  auto io_context = boost::asio::io_context{1};
+
+  const auto probe =
+      encode_echo_probe(0, username, password, 1, encrypted_payload(1));
+
+  auto results = probe_results{};
+  auto sent = std::size_t{0};
+
+  for (auto i = std::size_t{0}; i < concurrent_clients; ++i) {
+    boost::asio::co_spawn(
+        io_context,
+        [&]() -> boost::asio::awaitable<void> {
+          auto socket = boost::asio::ip::udp::socket{
+              io_context, boost::asio::ip::udp::v4()};
+
+          socket.connect({boost::asio::ip::address_v4::loopback(), port});
+
+          auto timeout = boost::asio::steady_timer{io_context};
+          auto reply = std::vector<std::byte>(65536);
+
+          while (sent < count) {
+            ++sent;
+
+            co_await socket.async_send(boost::asio::buffer(probe),
+                                       boost::asio::use_awaitable);
+
+            // Datagrams may be dropped under load; do not wait forever.
+            timeout.expires_after(std::chrono::seconds{1});
+            timeout.async_wait([&](boost::system::error_code error) {
+              if (!error) {
+                socket.cancel();
+              }
+            });
+
+            try {
+              co_await socket.async_receive(boost::asio::buffer(reply),
+                                            boost::asio::use_awaitable);
+              ++results.completed;
+            } catch (const boost::system::system_error&) {
+              ++results.lost;
+            }
+
+            timeout.cancel();
+          }
+        },
+        [](std::exception_ptr error) {
+          if (error) {
+            std::rethrow_exception(error);
+          }
+        });
+  }
+
+  const auto start = std::chrono::steady_clock::now();
+  io_context.run();
+  results.elapsed = std::chrono::steady_clock::now() - start;
+
+  return results;
+}
+
+auto report(std::string_view name, const probe_results& results) -> double {
+  const auto seconds =
+      std::chrono::duration<double>(results.elapsed).count();
+
+  const auto rate = static_cast<double>(results.completed) / seconds;
+
+  spdlog::info("{}: {} probes ({} lost) in {:.3f}s = {:.0f} probes/s", name,
+               results.completed, results.lost, seconds, rate);
+
+  return rate;
+}
+
+BOOST_AUTO_TEST_SUITE(udp_probe)
+
+BOOST_AUTO_TEST_CASE(udp_vs_tcp_probe_rate) {
+  spdlog::set_level(spdlog::level::warn);
+
+  auto server_context = boost::asio::io_context{1};
+
+  const auto udp_port = free_udp_port();
+
+  const auto endpoint = mori_echo::spawn_server(
+      server_context.get_executor(),
+      {
+          .port = 0,
+          .udp_port = udp_port,
+          .enable_decryption = true,
+          .authenticator =
+              mori_echo::auth::allow_all_client_authenticator::create(),
+      });
+
+  // Let the UDP listener bind before any client sends. Only the TCP one is
+  // bound by the time spawn_server() returns.
+  server_context.poll();
+
+  auto server_work = boost::asio::make_work_guard(server_context);
+  auto server_thread = std::thread{[&] { server_context.run(); }};
+
+  const auto tcp = run_tcp_probes(endpoint.port(), 5000);
+  const auto udp = run_udp_probes(udp_port, 50000);
+
+  spdlog::set_level(spdlog::level::info);
+
+  const auto tcp_rate = report("tcp (connect + login + echo)", tcp);
+  const auto udp_rate = report("udp (single datagram)", udp);
+
+  spdlog::info("udp/tcp probe rate: {:.1f}x", udp_rate / tcp_rate);
+
+  server_context.stop();
+  server_thread.join();
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+} // namespace mori_echo::benchmark
@@ -0,0 +1,184 @@
+#include <array>
+#include <boost/asio/co_spawn.hpp>
+#include <boost/asio/detached.hpp>
+#include <boost/asio/io_context.hpp>
+#include <boost/asio/ip/tcp.hpp>
+#include <boost/asio/use_awaitable.hpp>
+#include <boost/test/unit_test.hpp>
+#include <chrono>
+#include <spdlog/spdlog.h>
+#include <sys/resource.h>
+#include <thread>
+#include <vector>
+
+#include "client_authenticator/allow_all_client_authenticator.hpp"
+#include "client_channel/client_channel.hpp"
+#include "client_channel/zerocopy_sender.hpp"
+#include "echo_server/echo_server.hpp"
+#include "message_receiver/test_message_receiver.hpp"
+#include "message_sender/test_message_sender.hpp"
+#include "message_types/echo_response.hpp"
+#include "message_types/login_response.hpp"
+
+namespace mori_echo::benchmark {
+
+// Echoed per run, whatever the payload size.
+inline constexpr auto zerocopy_bench_total_bytes =
+    std::size_t{128} * 1024 * 1024;
+
+inline constexpr auto zerocopy_bench_payload_sizes =
+    std::array{std::size_t{4} * 1024, std::size_t{16} * 1024,
+               std::size_t{32} * 1024, std::size_t{60000}};
+
+struct zerocopy_results {
+  std::chrono::steady_clock::duration elapsed = {};
+
+  // CPU time of the server's thread, user and system.
+  std::chrono::microseconds server_cpu = {};
+};
+
+[[nodiscard]] auto send_zerocopy_requests(client_channel& channel,
+                                          const std::vector<std::byte>& payload,
+                                          std::size_t count)
+    -> boost::asio::awaitable<void> {
+  for (auto i = std::size_t{0}; i < count; ++i) {
+    co_await send_message<messages::echo_request>{}(channel, 1, payload);
+  }
+}
+
+// Streams `count` echoes of `payload`, reading them back while they are sent.
+[[nodiscard]] auto stream_zerocopy_echoes(boost::asio::io_context& io_context,
+                                          std::uint16_t port,
+                                          const std::vector<std::byte>& payload,
+                                          std::size_t count)
+    -> boost::asio::awaitable<void> {
+  auto socket = boost::asio::ip::tcp::socket{io_context};
+
+  co_await socket.async_connect(
+      {boost::asio::ip::address_v4::loopback(), port},
+      boost::asio::use_awaitable);
+
+  auto channel = client_channel{std::move(socket)};
+
+  co_await send_message<messages::login_request>{}(channel, 0, "benchuser",
+                                                   "benchpass");
+
+  const auto login_response =
+      co_await receive_message<messages::login_response>(
+          channel, co_await receive_response_header(channel));
+
+  BOOST_REQUIRE(login_response.status_code == mori_status::login_status::OK);
+
+  boost::asio::co_spawn(io_context,
+                        send_zerocopy_requests(channel, payload, count),
+                        boost::asio::detached);
+
+  for (auto i = std::size_t{0}; i < count; ++i) {
+    const auto echo_response =
+        co_await receive_message<messages::echo_response>(
+            channel, co_await receive_response_header(channel));
+
+    BOOST_REQUIRE(echo_response.message_size == payload.size());
+  }
+}
+
+// With decryption and splicing off, so that sending dominates.
+[[nodiscard]] auto measure_sends(bool enable_zerocopy, std::size_t payload_size,
+                                 std::shared_ptr<zerocopy_counters> counters)
+    -> zerocopy_results {
+  auto server_context = boost::asio::io_context{1};
+
+  const auto endpoint = mori_echo::spawn_server(
+      server_context.get_executor(),
+      {
+          .port = 0,
+          .enable_decryption = false,
+          .enable_splice = false,
+          .enable_zerocopy = enable_zerocopy,
+          .zerocopy = {.threshold = 1024, .counters = std::move(counters)},
+          .authenticator =
+              mori_echo::auth::allow_all_client_authenticator::create(),
+      });
+
+  auto results = zerocopy_results{};
+
+  auto server_work = boost::asio::make_work_guard(server_context);
+  auto server_thread = std::thread{[&] {
+    server_context.run();
+
+    auto usage = rusage{};
+    ::getrusage(RUSAGE_THREAD, &usage);
+
+    results.server_cpu =
+        std::chrono::seconds{usage.ru_utime.tv_sec + usage.ru_stime.tv_sec} +
+        std::chrono::microseconds{usage.ru_utime.tv_usec +
+                                  usage.ru_stime.tv_usec};
+  }};
+
+  const auto payload = std::vector<std::byte>(payload_size, std::byte{'Z'});
+  const auto count = zerocopy_bench_total_bytes / payload_size;
+
+  auto client_context = boost::asio::io_context{1};
+
+  const auto start = std::chrono::steady_clock::now();
+
+  boost::asio::co_spawn(client_context,
+                        stream_zerocopy_echoes(client_context, endpoint.port(),
+                                               payload, count),
+                        [](std::exception_ptr error) {
+                          if (error) {
+                            std::rethrow_exception(error);
+                          }
+                        });
+
+  client_context.run();
+
+  results.elapsed = std::chrono::steady_clock::now() - start;
+
+  server_context.stop();
+  server_thread.join();
+
+  return results;
+}
+
+auto report_sends(std::string_view name, std::size_t payload_size,
+                  const zerocopy_results& results) -> void {
+  const auto seconds = std::chrono::duration<double>(results.elapsed).count();
+  const auto cpu_seconds =
+      std::chrono::duration<double>(results.server_cpu).count();
+
+  const auto mebibytes =
+      static_cast<double>(zerocopy_bench_total_bytes) / (1024.0 * 1024.0);
+
+  spdlog::info("{} {} byte payloads: {:.1f} MiB/s, server CPU {:.2f}ms/MiB",
+               name, payload_size, mebibytes / seconds,
+               cpu_seconds * 1000.0 / mebibytes);
+}
+
+BOOST_AUTO_TEST_SUITE(zerocopy_sends)
+
+BOOST_AUTO_TEST_CASE(copy_vs_zerocopy) {
+  for (const auto payload_size : zerocopy_bench_payload_sizes) {
+    const auto counters = zerocopy_counters::create();
+
+    spdlog::set_level(spdlog::level::warn);
+
+    const auto copied = measure_sends(false, payload_size, nullptr);
+    const auto zero_copied = measure_sends(true, payload_size, counters);
+
+    spdlog::set_level(spdlog::level::info);
+
+    report_sends("copied", payload_size, copied);
+    report_sends("MSG_ZEROCOPY", payload_size, zero_copied);
+
+    spdlog::info("MSG_ZEROCOPY outcomes: {} zero-copied, {} kernel-copied, "
+                 "{} send-copied",
+                 counters->count(zerocopy_outcome::ZERO_COPIED),
+                 counters->count(zerocopy_outcome::KERNEL_COPIED),
+                 counters->count(zerocopy_outcome::SEND_COPIED));
+  }
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+} // namespace mori_echo::benchmark
@@ -1,22 +1,142 @@
 #pragma once
 
+#include <algorithm>
+#include <boost/asio/any_io_executor.hpp>
 #include <boost/asio/awaitable.hpp>
+#include <boost/asio/error.hpp>
 #include <boost/asio/ip/tcp.hpp>
+#include <boost/asio/local/stream_protocol.hpp>
+#include <boost/asio/read.hpp>
+#include <boost/asio/redirect_error.hpp>
+#include <boost/asio/use_awaitable.hpp>
+#include <boost/asio/write.hpp>
+#include <cassert>
+#include <cerrno>
+#include <fcntl.h>
+#include <memory>
+#include <optional>
+#include <span>
+#include <sys/socket.h>
 #include <vector>
 
+#include "payload_pool.hpp"
+#include "response_batch.hpp"
+#include "splice_pipe.hpp"
+#include "zerocopy_sender.hpp"
+#include "memory_transport/memory_stream.hpp"
+#include "traffic_capture/traffic_capture.hpp"
+
 namespace mori_echo {
 
-class [[nodiscard]] client_channel {
+// Streams over a kernel socket, which splice(), MSG_ZEROCOPY and rebinding
+// work on.
+template <typename AsyncStream>
+concept socket_stream =
+    requires(AsyncStream& stream) { stream.native_handle(); };
+
+template <typename AsyncStream> class [[nodiscard]] basic_client_channel {
 public:
-  client_channel(boost::asio::ip::tcp::socket client_socket)
-      : socket{std::move(client_socket)} {}
+  basic_client_channel(AsyncStream client_stream)
+      : stream{std::move(client_stream)} {}
 
+  // Receives into a buffer of the thread's `payload_pool`.
   [[nodiscard]] auto receive(std::size_t count)
       -> boost::asio::awaitable<std::vector<std::byte>>;
 
-  [[nodiscard]] auto send(const std::vector<std::byte>& data)
+  [[nodiscard]] auto receive(std::span<std::byte> buffer)
+      -> boost::asio::awaitable<void>;
+
+  [[nodiscard]] auto receive_some(std::span<std::byte> buffer)
+      -> boost::asio::awaitable<std::size_t>;
+
+  [[nodiscard]] auto send(std::span<const std::byte> data)
+      -> boost::asio::awaitable<void>;
+
+  // Overloads reporting failures, end of stream included, through `error`
+  // rather than by throwing.
+
+  [[nodiscard]] auto receive(std::size_t count,
+                             boost::system::error_code& error)
+      -> boost::asio::awaitable<std::vector<std::byte>>;
+
+  [[nodiscard]] auto receive(std::span<std::byte> buffer,
+                             boost::system::error_code& error)
+      -> boost::asio::awaitable<void>;
+
+  [[nodiscard]] auto receive_some(std::span<std::byte> buffer,
+                                  boost::system::error_code& error)
+      -> boost::asio::awaitable<std::size_t>;
+
+  [[nodiscard]] auto send(std::span<const std::byte> data,
+                          boost::system::error_code& error)
+      -> boost::asio::awaitable<void>;
+
+  // Waits until data can be read, without reading it. Sends the responses
+  // held first, and gives back the memory they took.
+  [[nodiscard]] auto wait_readable(boost::system::error_code& error)
+      -> boost::asio::awaitable<void>;
+
+  // Sends the next `count` bytes received straight back, moving them through
+  // a pipe with splice() so that they never enter user space. Leaves the
+  // socket non-blocking. Not for channels being captured, which must see
+  // what they receive.
+  [[nodiscard]] auto splice_back(std::size_t count,
+                                 boost::system::error_code& error)
+      -> boost::asio::awaitable<void>
+    requires socket_stream<AsyncStream>;
+
+  // Sends payloads of at least `options.threshold` bytes given to
+  // `send_pinned` with MSG_ZEROCOPY from now on. Returns whether the stream
+  // supports it, which Unix domain sockets and memory streams do not.
+  auto enable_zerocopy(zerocopy_options options) -> bool;
+
+  // Sends `prefix`, and then `payload` with MSG_ZEROCOPY if it is large
+  // enough, keeping it pinned until the kernel is done with it. Otherwise
+  // holds both back while coalescing allows, and returns once they are
+  // queued, before they are sent. Payloads end up in the thread's
+  // `payload_pool` either way.
+  [[nodiscard]] auto send_pinned(std::span<const std::byte> prefix,
+                                 std::vector<std::byte> payload,
+                                 boost::system::error_code& error)
+      -> boost::asio::awaitable<void>;
+
+  // Holds echo responses given to `send_pinned` from now on while the client
+  // has more requests buffered, to send them together. Any other send, and
+  // any read which would wait for the client, sends them first.
+  auto enable_coalescing(coalescing_options options) -> void {
+    batch.emplace(std::move(options));
+  }
+
+  // Sends the responses held, if any.
+  [[nodiscard]] auto flush_responses(boost::system::error_code& error)
       -> boost::asio::awaitable<void>;
 
+  // Moves the connection onto `executor`, e.g. to another worker. No operation
+  // may be pending. The channel reads nothing ahead, so bytes not read yet
+  // move along in the socket.
+  [[nodiscard]] auto rebind(boost::asio::any_io_executor executor) &&
+      -> basic_client_channel
+    requires socket_stream<AsyncStream>;
+
+  // Records everything received from now on to a capture session.
+  auto set_capture(capture::capture_session session) -> void {
+    capture = std::move(session);
+  }
+
+  [[nodiscard]] auto is_capturing() const -> bool {
+    return capture.is_recording();
+  }
+
+  // Bytes received from the client so far, spliced ones included.
+  [[nodiscard]] auto received() const -> std::uint64_t {
+    return received_bytes;
+  }
+
+  // Whether the client already sent more than was received.
+  [[nodiscard]] auto has_buffered_input() -> bool {
+    return buffered_input() > 0;
+  }
+
   template <typename T>
     requires std::is_trivially_copyable_v<T>
   [[nodiscard]] auto receive_as() -> boost::asio::awaitable<T> {
@@ -38,8 +158,513 @@ private:
   [[nodiscard]] auto send_raw(void* buffer, std::size_t size)
       -> boost::asio::awaitable<void>;
 
+  // Sends `data` whole with `flags`.
+  [[nodiscard]] auto send_flagged(std::span<const std::byte> data, int flags,
+                                  boost::system::error_code& error)
+      -> boost::asio::awaitable<void>;
+
+  // Whether a read of `count` bytes could wait on the client while responses
+  // are held, which must be sent before.
+  [[nodiscard]] auto should_flush_before_read(std::size_t count) -> bool {
+    return batch && !batch->is_empty() && buffered_input() < count;
+  }
+
+  [[nodiscard]] auto buffered_input() -> std::size_t {
+    auto error = boost::system::error_code{};
+    const auto available = stream.available(error);
+
+    return error ? 0 : available;
+  }
+
+  // Sends the responses held with a single gathered send where possible,
+  // passing `flags` to each call.
+  [[nodiscard]] auto send_held(int flags, boost::system::error_code& error)
+      -> boost::asio::awaitable<void>;
+
+  // Sends `payload` with MSG_ZEROCOPY, and returns how many send calls took
+  // a notification id. Copies the rest if the kernel runs out of room for
+  // notifications, setting `is_partly_copied`.
+  [[nodiscard]] auto send_zerocopy(std::span<const std::byte> payload,
+                                   bool& is_partly_copied,
+                                   boost::system::error_code& error)
+      -> boost::asio::awaitable<std::uint32_t>
+    requires socket_stream<AsyncStream>;
+
 private:
-  boost::asio::ip::tcp::socket socket;
+  AsyncStream stream;
+
+  capture::capture_session capture;
+
+  std::optional<response_batch> batch;
+
+  std::uint64_t received_bytes = 0;
+
+  // After the stream, so that it is destroyed while the socket is open.
+  std::unique_ptr<zerocopy_sender> zerocopy;
 };
 
+using client_channel = basic_client_channel<boost::asio::ip::tcp::socket>;
+
+using local_client_channel =
+    basic_client_channel<boost::asio::local::stream_protocol::socket>;
+
+using memory_client_channel = basic_client_channel<memory_stream>;
+
+template <typename AsyncStream>
+auto basic_client_channel<AsyncStream>::rebind(
+    boost::asio::any_io_executor executor) && -> basic_client_channel
+  requires socket_stream<AsyncStream>
+{
+  const auto protocol = stream.local_endpoint().protocol();
+
+  auto moved = AsyncStream{std::move(executor)};
+  moved.assign(protocol, stream.release());
+
+  auto channel = basic_client_channel{std::move(moved)};
+  channel.capture = std::move(capture);
+  channel.zerocopy = std::move(zerocopy);
+  channel.batch = std::move(batch);
+  channel.received_bytes = received_bytes;
+
+  return channel;
+}
+
+template <typename AsyncStream>
+auto basic_client_channel<AsyncStream>::receive(std::size_t count)
+    -> boost::asio::awaitable<std::vector<std::byte>> {
+  auto buffer = payload_pool::acquire(count);
+
+  co_await boost::asio::async_read(stream, boost::asio::buffer(buffer),
+                                   boost::asio::use_awaitable);
+
+  received_bytes += buffer.size();
+  capture.record(buffer);
+
+  co_return buffer;
+}
+
+template <typename AsyncStream>
+auto basic_client_channel<AsyncStream>::receive(std::span<std::byte> buffer)
+    -> boost::asio::awaitable<void> {
+  co_await boost::asio::async_read(
+      stream, boost::asio::buffer(buffer.data(), buffer.size()),
+      boost::asio::use_awaitable);
+
+  received_bytes += buffer.size();
+  capture.record(buffer);
+}
+
+template <typename AsyncStream>
+auto basic_client_channel<AsyncStream>::receive_some(
+    std::span<std::byte> buffer) -> boost::asio::awaitable<std::size_t> {
+  const auto received = co_await stream.async_read_some(
+      boost::asio::buffer(buffer.data(), buffer.size()),
+      boost::asio::use_awaitable);
+
+  received_bytes += received;
+  capture.record(buffer.first(received));
+
+  co_return received;
+}
+
+template <typename AsyncStream>
+auto basic_client_channel<AsyncStream>::send(std::span<const std::byte> data)
+    -> boost::asio::awaitable<void> {
+  co_await boost::asio::async_write(
+      stream, boost::asio::buffer(data.data(), data.size()),
+      boost::asio::use_awaitable);
+}
+
+template <typename AsyncStream>
+auto basic_client_channel<AsyncStream>::receive(
+    std::size_t count, boost::system::error_code& error)
+    -> boost::asio::awaitable<std::vector<std::byte>> {
+  if (should_flush_before_read(count)) {
+    co_await send_held(0, error);
+
+    if (error) {
+      co_return std::vector<std::byte>{};
+    }
+  }
+
+  auto buffer = payload_pool::acquire(count);
+
+  co_await boost::asio::async_read(
+      stream, boost::asio::buffer(buffer),
+      boost::asio::redirect_error(boost::asio::use_awaitable, error));
+
+  if (!error) {
+    received_bytes += buffer.size();
+    capture.record(buffer);
+  }
+
+  co_return buffer;
+}
+
+template <typename AsyncStream>
+auto basic_client_channel<AsyncStream>::receive(
+    std::span<std::byte> buffer, boost::system::error_code& error)
+    -> boost::asio::awaitable<void> {
+  if (should_flush_before_read(buffer.size())) {
+    co_await send_held(0, error);
+
+    if (error) {
+      co_return;
+    }
+  }
+
+  co_await boost::asio::async_read(
+      stream, boost::asio::buffer(buffer.data(), buffer.size()),
+      boost::asio::redirect_error(boost::asio::use_awaitable, error));
+
+  if (!error) {
+    received_bytes += buffer.size();
+    capture.record(buffer);
+  }
+}
+
+template <typename AsyncStream>
+auto basic_client_channel<AsyncStream>::receive_some(
+    std::span<std::byte> buffer, boost::system::error_code& error)
+    -> boost::asio::awaitable<std::size_t> {
+  if (should_flush_before_read(1)) {
+    co_await send_held(0, error);
+
+    if (error) {
+      co_return 0;
+    }
+  }
+
+  const auto received = co_await stream.async_read_some(
+      boost::asio::buffer(buffer.data(), buffer.size()),
+      boost::asio::redirect_error(boost::asio::use_awaitable, error));
+
+  received_bytes += received;
+  capture.record(buffer.first(received));
+
+  co_return received;
+}
+
+template <typename AsyncStream>
+auto basic_client_channel<AsyncStream>::send(std::span<const std::byte> data,
+                                             boost::system::error_code& error)
+    -> boost::asio::awaitable<void> {
+  // Held responses go first, with `data` right behind them.
+  if (batch && !batch->is_empty()) {
+    co_await send_held(MSG_MORE, error);
+
+    if (error) {
+      co_return;
+    }
+  }
+
+  co_await boost::asio::async_write(
+      stream, boost::asio::buffer(data.data(), data.size()),
+      boost::asio::redirect_error(boost::asio::use_awaitable, error));
+}
+
+template <typename AsyncStream>
+auto basic_client_channel<AsyncStream>::wait_readable(
+    boost::system::error_code& error) -> boost::asio::awaitable<void> {
+  if (should_flush_before_read(1)) {
+    co_await send_held(0, error);
+
+    if (error) {
+      co_return;
+    }
+  }
+
+  // Parked sessions hold no batch either.
+  if (batch && batch->is_empty()) {
+    batch->release_storage();
+  }
+
+  co_await stream.async_wait(
+      AsyncStream::wait_read,
+      boost::asio::redirect_error(boost::asio::use_awaitable, error));
+}
+
+template <typename AsyncStream>
+auto basic_client_channel<AsyncStream>::splice_back(
+    std::size_t count, boost::system::error_code& error)
+    -> boost::asio::awaitable<void>
+  requires socket_stream<AsyncStream>
+{
+  assert(!is_capturing());
+
+  // splice() only honours the socket's own non-blocking mode.
+  if (!stream.native_non_blocking()) {
+    stream.native_non_blocking(true, error);
+
+    if (error) {
+      co_return;
+    }
+  }
+
+  const auto fd = stream.native_handle();
+  const auto last_error = [] {
+    return boost::system::error_code{errno,
+                                     boost::asio::error::get_system_category()};
+  };
+
+  auto pipe = splice_pipe::acquire();
+
+  for (auto remaining = count; remaining > 0 || pipe.buffered > 0;) {
+    // Whether no more can be spliced in until some is spliced out, or until
+    // the client sends more.
+    auto is_read_blocked =
+        remaining == 0 || pipe.buffered == pipe.capacity();
+
+    if (!is_read_blocked) {
+      const auto spliced =
+          ::splice(fd, nullptr, pipe.write_end(), nullptr,
+                   std::min(remaining, pipe.capacity() - pipe.buffered),
+                   SPLICE_F_MOVE | SPLICE_F_NONBLOCK);
+
+      if (spliced > 0) {
+        remaining -= static_cast<std::size_t>(spliced);
+        pipe.buffered += static_cast<std::size_t>(spliced);
+        received_bytes += static_cast<std::size_t>(spliced);
+      } else if (spliced == 0) {
+        error = boost::asio::error::eof;
+        co_return;
+      } else if (errno == EAGAIN) {
+        is_read_blocked = true;
+      } else if (errno != EINTR) {
+        error = last_error();
+        co_return;
+      }
+    }
+
+    if (pipe.buffered == 0) {
+      if (is_read_blocked) {
+        co_await stream.async_wait(
+            AsyncStream::wait_read,
+            boost::asio::redirect_error(boost::asio::use_awaitable, error));
+
+        if (error) {
+          co_return;
+        }
+      }
+
+      continue;
+    }
+
+    const auto spliced =
+        ::splice(pipe.read_end(), nullptr, fd, nullptr, pipe.buffered,
+                 SPLICE_F_MOVE | SPLICE_F_NONBLOCK |
+                     (remaining > 0 ? SPLICE_F_MORE : 0));
+
+    if (spliced > 0) {
+      pipe.buffered -= static_cast<std::size_t>(spliced);
+    } else if (spliced < 0 && errno == EAGAIN) {
+      if (is_read_blocked) {
+        co_await stream.async_wait(
+            AsyncStream::wait_write,
+            boost::asio::redirect_error(boost::asio::use_awaitable, error));
+
+        if (error) {
+          co_return;
+        }
+      }
+    } else if (spliced < 0 && errno != EINTR) {
+      error = last_error();
+      co_return;
+    }
+  }
+}
+
+template <typename AsyncStream>
+auto basic_client_channel<AsyncStream>::enable_zerocopy(
+    zerocopy_options options) -> bool {
+  if constexpr (socket_stream<AsyncStream>) {
+    zerocopy =
+        zerocopy_sender::create(stream.native_handle(), std::move(options));
+  }
+
+  return zerocopy != nullptr;
+}
+
+template <typename AsyncStream>
+auto basic_client_channel<AsyncStream>::send_pinned(
+    std::span<const std::byte> prefix, std::vector<std::byte> payload,
+    boost::system::error_code& error) -> boost::asio::awaitable<void> {
+  if (zerocopy) {
+    zerocopy->reap();
+  }
+
+  const auto is_pinned = zerocopy && zerocopy->is_eligible(payload.size());
+
+  if (batch && !is_pinned) {
+    batch->add(prefix, std::move(payload));
+
+    if (!batch->should_hold(buffered_input() > 0)) {
+      co_await send_held(0, error);
+    }
+
+    co_return;
+  }
+
+  if (batch && !batch->is_empty()) {
+    co_await send_held(MSG_MORE, error);
+
+    if (error) {
+      payload_pool::release(std::move(payload));
+      co_return;
+    }
+  }
+
+  if (!zerocopy || !zerocopy->is_eligible(payload.size()) ||
+      !zerocopy->try_reserve(payload.size())) {
+    co_await send(prefix, error);
+
+    if (!error) {
+      co_await send(payload, error);
+    }
+
+    payload_pool::release(std::move(payload));
+    co_return;
+  }
+
+  // Only sockets enable zerocopy.
+  if constexpr (socket_stream<AsyncStream>) {
+    // Copied, as it is tiny, and held back until the payload follows it.
+    co_await send_flagged(prefix, MSG_MORE, error);
+
+    auto is_partly_copied = false;
+    auto send_calls = std::uint32_t{0};
+
+    if (!error) {
+      send_calls = co_await send_zerocopy(payload, is_partly_copied, error);
+    }
+
+    zerocopy->pin(std::move(payload), send_calls, is_partly_copied);
+  }
+}
+
+template <typename AsyncStream>
+auto basic_client_channel<AsyncStream>::flush_responses(
+    boost::system::error_code& error) -> boost::asio::awaitable<void> {
+  if (batch && !batch->is_empty()) {
+    co_await send_held(0, error);
+  }
+}
+
+template <typename AsyncStream>
+auto basic_client_channel<AsyncStream>::send_held(
+    int flags, boost::system::error_code& error)
+    -> boost::asio::awaitable<void> {
+  auto buffers = batch->buffers();
+  auto send_calls = std::uint64_t{0};
+
+  while (!buffers.empty()) {
+    auto sent = co_await stream.async_send(
+        buffers, flags,
+        boost::asio::redirect_error(boost::asio::use_awaitable, error));
+
+    ++send_calls;
+
+    if (error) {
+      break;
+    }
+
+    while (!buffers.empty() && buffers.front().size() <= sent) {
+      sent -= buffers.front().size();
+      buffers = buffers.subspan(1);
+    }
+
+    if (!buffers.empty()) {
+      buffers.front() += sent;
+    }
+  }
+
+  batch->clear(send_calls);
+}
+
+template <typename AsyncStream>
+auto basic_client_channel<AsyncStream>::send_flagged(
+    std::span<const std::byte> data, int flags,
+    boost::system::error_code& error) -> boost::asio::awaitable<void> {
+  while (!data.empty()) {
+    const auto sent = co_await stream.async_send(
+        boost::asio::buffer(data.data(), data.size()), flags,
+        boost::asio::redirect_error(boost::asio::use_awaitable, error));
+
+    if (error) {
+      co_return;
+    }
+
+    data = data.subspan(sent);
+  }
+}
+
+template <typename AsyncStream>
+auto basic_client_channel<AsyncStream>::send_zerocopy(
+    std::span<const std::byte> payload, bool& is_partly_copied,
+    boost::system::error_code& error)
+    -> boost::asio::awaitable<std::uint32_t>
+  requires socket_stream<AsyncStream>
+{
+  if (!stream.native_non_blocking()) {
+    stream.native_non_blocking(true, error);
+
+    if (error) {
+      co_return 0;
+    }
+  }
+
+  auto send_calls = std::uint32_t{0};
+
+  while (!payload.empty()) {
+    const auto sent = ::send(stream.native_handle(), payload.data(),
+                             payload.size(), MSG_ZEROCOPY | MSG_NOSIGNAL);
+
+    if (sent > 0) {
+      payload = payload.subspan(static_cast<std::size_t>(sent));
+      ++send_calls;
+    } else if (errno == EAGAIN) {
+      co_await stream.async_wait(
+          AsyncStream::wait_write,
+          boost::asio::redirect_error(boost::asio::use_awaitable, error));
+
+      if (error) {
+        co_return send_calls;
+      }
+    } else if (errno == ENOBUFS) {
+      is_partly_copied = true;
+
+      co_await send(payload, error);
+      co_return send_calls;
+    } else if (errno != EINTR) {
+      error = boost::system::error_code{
+          errno, boost::asio::error::get_system_category()};
+      co_return send_calls;
+    }
+  }
+
+  co_return send_calls;
+}
+
+template <typename AsyncStream>
+auto basic_client_channel<AsyncStream>::receive_raw(void* buffer,
+                                                    std::size_t size)
+    -> boost::asio::awaitable<void> {
+  assert(buffer != nullptr);
+
+  co_await boost::asio::async_read(stream, boost::asio::buffer(buffer, size),
+                                   boost::asio::use_awaitable);
+
+  received_bytes += size;
+  capture.record({static_cast<const std::byte*>(buffer), size});
+}
+
+template <typename AsyncStream>
+auto basic_client_channel<AsyncStream>::send_raw(void* buffer, std::size_t size)
+    -> boost::asio::awaitable<void> {
+  assert(buffer != nullptr);
+
+  co_await boost::asio::async_write(stream, boost::asio::buffer(buffer, size),
+                                    boost::asio::use_awaitable);
+}
+
 } // namespace mori_echo
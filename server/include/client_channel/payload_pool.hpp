@@ -0,0 +1,29 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+namespace mori_echo {
+
+// Payload buffers kept by each thread for reuse.
+inline constexpr auto max_pooled_payloads = std::size_t{64};
+
+// Buffers larger than this are freed rather than kept.
+inline constexpr auto max_pooled_payload_size = std::size_t{1024} * 1024;
+
+// Payload buffers of the calling thread, handed back once the kernel is done
+// with them rather than freed.
+class payload_pool {
+public:
+  payload_pool() = delete;
+
+  // A buffer of `size` bytes, reused if the thread has one large enough.
+  [[nodiscard]] static auto acquire(std::size_t size) -> std::vector<std::byte>;
+
+  static auto release(std::vector<std::byte> buffer) -> void;
+
+  // Buffers the calling thread keeps.
+  [[nodiscard]] static auto size() -> std::size_t;
+};
+
+} // namespace mori_echo
@@ -0,0 +1,117 @@
+#pragma once
+
+#include <atomic>
+#include <boost/asio/buffer.hpp>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <span>
+#include <vector>
+
+namespace mori_echo {
+
+class [[nodiscard]] coalescing_counters {
+public:
+  [[nodiscard]] static auto create() -> std::shared_ptr<coalescing_counters>;
+
+  coalescing_counters(const coalescing_counters&) = delete;
+  coalescing_counters& operator=(const coalescing_counters&) = delete;
+
+  // Records `responses` sent by `send_calls` system calls.
+  auto record(std::uint64_t responses, std::uint64_t send_calls) -> void;
+
+  [[nodiscard]] auto responses() const -> std::uint64_t;
+  [[nodiscard]] auto send_calls() const -> std::uint64_t;
+
+  // Zero before any response was sent.
+  [[nodiscard]] auto responses_per_call() const -> double;
+
+private:
+  coalescing_counters() = default;
+
+  std::atomic<std::uint64_t> response_count = 0;
+  std::atomic<std::uint64_t> send_call_count = 0;
+};
+
+struct coalescing_options {
+  // Bytes held back at most, past which they are sent whatever follows.
+  std::size_t max_bytes = 64 * 1024;
+
+  // Time the first response held back may wait for others to join it.
+  std::chrono::microseconds max_delay = std::chrono::microseconds{50};
+
+  // Counts responses and the calls which sent them when set.
+  std::shared_ptr<coalescing_counters> counters = nullptr;
+};
+
+// Payloads up to this size are cheaper to copy than to gather.
+inline constexpr auto max_copied_payload_size = std::size_t{512};
+
+// Memory a drained batch keeps for the next burst. Buffers grown past it by a
+// larger burst are given back once it was sent.
+inline constexpr auto retained_batch_capacity = std::size_t{8 * 1024};
+
+// Responses of a connection held back while its client has more requests
+// waiting to be read, so that they go out together in a single gathered send
+// rather than one or two sends each.
+//
+// Copies each response's prefix, and small payloads along with it, into a
+// shared buffer. Takes larger payloads, which go back to the thread's
+// `payload_pool` once sent.
+class [[nodiscard]] response_batch {
+public:
+  explicit response_batch(coalescing_options options)
+      : options{std::move(options)} {}
+
+  response_batch(response_batch&&) = default;
+  response_batch& operator=(response_batch&&) = default;
+
+  ~response_batch();
+
+  [[nodiscard]] auto is_empty() const -> bool { return responses.empty(); }
+
+  auto add(std::span<const std::byte> prefix, std::vector<std::byte> payload)
+      -> void;
+
+  // Whether to keep holding what was added, given whether the client has
+  // more input buffered. Never holds a response nothing may follow soon.
+  [[nodiscard]] auto should_hold(bool is_input_buffered) const -> bool;
+
+  // Everything held, in order, to be gathered by a single send.
+  [[nodiscard]] auto buffers() -> std::span<boost::asio::const_buffer>;
+
+  // Forgets the responses sent, recording them as sent by `send_calls`.
+  auto clear(std::uint64_t send_calls) -> void;
+
+  // Gives back the memory of the buffers, for a connection going idle. Only
+  // once drained.
+  auto release_storage() -> void;
+
+  // Bytes of memory held by the buffers, whether in use or not.
+  [[nodiscard]] auto capacity() const -> std::size_t;
+
+private:
+  struct held_response {
+    // End of the response's bytes in `copied`.
+    std::size_t copied_end = 0;
+
+    // Follows the copied bytes, unless empty.
+    std::vector<std::byte> payload;
+  };
+
+  auto release_payloads() -> void;
+
+  coalescing_options options;
+
+  std::vector<held_response> responses;
+  std::vector<std::byte> copied;
+  std::size_t held_bytes = 0;
+
+  std::chrono::steady_clock::time_point first_held = {};
+
+  // Kept from one send to the next, to gather without allocating.
+  std::vector<boost::asio::const_buffer> gathered;
+};
+
+} // namespace mori_echo
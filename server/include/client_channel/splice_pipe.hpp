@@ -0,0 +1,45 @@
+#pragma once
+
+#include <cstddef>
+
+namespace mori_echo {
+
+// Size asked of the kernel for new pipes. It may give less, past the
+// per-user limits of `/proc/sys/fs/pipe-*`.
+inline constexpr auto splice_pipe_size = std::size_t{256} * 1024;
+
+// Pipes kept by each thread for reuse. Past these, finished pipes are closed.
+inline constexpr auto max_free_splice_pipes = std::size_t{8};
+
+// A pipe to move bytes between sockets with splice(), so that they never
+// enter user space. Taken from the calling thread's free pipes, and handed
+// back to them once destroyed empty.
+class [[nodiscard]] splice_pipe {
+public:
+  [[nodiscard]] static auto acquire() -> splice_pipe;
+
+  splice_pipe(splice_pipe&& other) noexcept;
+  splice_pipe& operator=(splice_pipe&& other) = delete;
+
+  ~splice_pipe();
+
+  [[nodiscard]] auto read_end() const -> int { return read_fd; }
+  [[nodiscard]] auto write_end() const -> int { return write_fd; }
+
+  [[nodiscard]] auto capacity() const -> std::size_t { return size; }
+
+  // Bytes spliced in and not out yet, kept by the caller. Pipes destroyed with
+  // some left are closed instead of reused.
+  std::size_t buffered = 0;
+
+private:
+  splice_pipe(int read_fd, int write_fd, std::size_t size)
+      : read_fd{read_fd}, write_fd{write_fd}, size{size} {}
+
+  int read_fd = -1;
+  int write_fd = -1;
+
+  std::size_t size = 0;
+};
+
+} // namespace mori_echo
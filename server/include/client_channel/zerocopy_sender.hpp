@@ -0,0 +1,138 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace mori_echo {
+
+// What became of a response eligible for a zero-copy send.
+enum class zerocopy_outcome : std::size_t {
+  // Sent from its buffer, without the kernel copying it.
+  ZERO_COPIED,
+
+  // Sent with MSG_ZEROCOPY, but copied by the kernel anyway, as it does for
+  // loopback and for devices without scatter-gather.
+  KERNEL_COPIED,
+
+  // Sent with a regular copying send, as the connection had too many bytes
+  // pinned already, or the kernel ran out of room for notifications.
+  SEND_COPIED,
+};
+
+inline constexpr auto zerocopy_outcome_count = std::size_t{3};
+
+class [[nodiscard]] zerocopy_counters {
+public:
+  [[nodiscard]] static auto create() -> std::shared_ptr<zerocopy_counters>;
+
+  zerocopy_counters(const zerocopy_counters&) = delete;
+  zerocopy_counters& operator=(const zerocopy_counters&) = delete;
+
+  auto record(zerocopy_outcome outcome) -> void;
+
+  [[nodiscard]] auto count(zerocopy_outcome outcome) const -> std::uint64_t;
+
+  auto record_abandoned(std::size_t bytes) -> void;
+
+  // Bytes of payloads still pinned when their connection closed, past its
+  // drain timeout, and left allocated for the kernel to read.
+  [[nodiscard]] auto abandoned_bytes() const -> std::uint64_t;
+
+private:
+  zerocopy_counters() = default;
+
+  std::array<std::atomic<std::uint64_t>, zerocopy_outcome_count> counts = {};
+  std::atomic<std::uint64_t> abandoned = 0;
+};
+
+struct zerocopy_options {
+  // Payloads smaller than this are cheaper to copy than to pin.
+  std::size_t threshold = 16 * 1024;
+
+  // Bytes a connection may have pinned at once, waiting on the kernel.
+  std::size_t max_pinned = 1024 * 1024;
+
+  // Longest a closing connection blocks its thread waiting on the kernel to
+  // be done with its pinned payloads.
+  std::chrono::milliseconds drain_timeout = std::chrono::milliseconds{50};
+
+  // Counts outcomes when set.
+  std::shared_ptr<zerocopy_counters> counters = nullptr;
+};
+
+// Keeps the payloads a socket sent with MSG_ZEROCOPY until the kernel reports
+// being done with them on the socket's error queue, and then hands them back
+// to the thread's `payload_pool`.
+//
+// Every send call with MSG_ZEROCOPY which queues data takes the next of the
+// socket's 32-bit notification ids, and the kernel completes them in ranges.
+class [[nodiscard]] zerocopy_sender {
+public:
+  // Turns SO_ZEROCOPY on for `fd`. Null if the socket does not support it,
+  // like Unix domain sockets.
+  [[nodiscard]] static auto create(int fd, zerocopy_options options)
+      -> std::unique_ptr<zerocopy_sender>;
+
+  zerocopy_sender(const zerocopy_sender&) = delete;
+  zerocopy_sender& operator=(const zerocopy_sender&) = delete;
+
+  // Waits up to the drain timeout for the kernel to be done with the pinned
+  // payloads, as it goes on sending queued data from them once the socket is
+  // closed. Freed, they could be reused and overwritten before going out.
+  // Those still pinned after that are leaked rather than freed.
+  ~zerocopy_sender();
+
+  [[nodiscard]] auto is_eligible(std::size_t size) const -> bool {
+    return size >= options.threshold;
+  }
+
+  // Hands back the payloads the kernel is done with, without blocking.
+  auto reap() -> void;
+
+  // Whether `size` more bytes may be pinned. Records a `SEND_COPIED` outcome
+  // otherwise, as the caller copies them instead.
+  [[nodiscard]] auto try_reserve(std::size_t size) -> bool;
+
+  // Keeps `payload` pinned until the next `send_calls` notification ids
+  // complete. Also records a `SEND_COPIED` outcome if `is_partly_copied`.
+  auto pin(std::vector<std::byte> payload, std::uint32_t send_calls,
+           bool is_partly_copied) -> void;
+
+private:
+  struct pinned_payload {
+    std::uint32_t first_id = 0;
+    std::uint32_t id_count = 0;
+    std::uint32_t pending_ids = 0;
+
+    bool was_copied = false;
+
+    // Already recorded as `SEND_COPIED`.
+    bool is_recorded = false;
+
+    std::vector<std::byte> payload;
+  };
+
+  zerocopy_sender(int fd, zerocopy_options options)
+      : fd{fd}, options{std::move(options)} {}
+
+  auto complete(std::uint32_t first_id, std::uint32_t last_id, bool was_copied)
+      -> void;
+
+  auto record(zerocopy_outcome outcome) -> void;
+
+  int fd = -1;
+  zerocopy_options options;
+
+  // The id the next send call takes.
+  std::uint32_t next_id = 0;
+
+  std::vector<pinned_payload> pinned;
+  std::size_t pinned_bytes = 0;
+};
+
+} // namespace mori_echo
@@ -0,0 +1,130 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <boost/system/error_code.hpp>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <variant>
+
+namespace mori_echo {
+
+// Why a client connection was dropped.
+enum class drop_reason : std::uint8_t {
+  DISCONNECTED,
+  CONNECTION_ERROR,
+  MALFORMED_FRAME,
+  WRONG_MESSAGE_TYPE,
+  MESSAGE_TOO_LONG,
+  SIZE_MISMATCH,
+  UNEXPECTED_MESSAGE,
+  ALREADY_LOGGED_IN,
+  NOT_LOGGED_IN,
+  LOGIN_FAILED,
+
+  // Shed by a loop running late, see `loop_monitor`.
+  OVERLOADED,
+
+  // Over its rate limits, see `rate_limiter`.
+  RATE_LIMITED,
+
+  SERVER_ERROR,
+};
+
+inline constexpr auto drop_reason_count =
+    static_cast<std::size_t>(drop_reason::SERVER_ERROR) + 1;
+
+[[nodiscard]] auto describe(drop_reason reason) -> std::string_view;
+
+// A client fault returned up the handler path instead of thrown, so that a
+// storm of misbehaving or disconnecting clients does not cost an unwind each.
+struct client_fault {
+  drop_reason reason = drop_reason::SERVER_ERROR;
+
+  // What was wrong, always a string literal.
+  std::string_view detail = {};
+
+  // Set for connection faults.
+  boost::system::error_code error = {};
+
+  // What the authenticator reported, for login failures.
+  std::string cause = {};
+};
+
+[[nodiscard]] auto make_fault(drop_reason reason) -> client_fault;
+
+// Faults of a failed read or write. End of stream is a normal disconnect.
+[[nodiscard]] auto make_fault(const boost::system::error_code& error)
+    -> client_fault;
+
+// The outcome of a step of a client session: either its value or the fault
+// which ends the session.
+template <typename T> class [[nodiscard]] client_result {
+public:
+  client_result(T value) : state{std::move(value)} {}
+  client_result(client_fault fault) : state{std::move(fault)} {}
+
+  [[nodiscard]] explicit operator bool() const noexcept {
+    return state.index() == 0;
+  }
+
+  [[nodiscard]] auto operator*() & -> T& { return value(); }
+  [[nodiscard]] auto operator*() && -> T&& { return std::move(value()); }
+  [[nodiscard]] auto operator->() -> T* { return &value(); }
+
+  [[nodiscard]] auto fault() && -> client_fault {
+    assert(!*this);
+    return std::move(std::get<client_fault>(state));
+  }
+
+private:
+  [[nodiscard]] auto value() -> T& {
+    assert(*this);
+    return std::get<T>(state);
+  }
+
+  std::variant<T, client_fault> state;
+};
+
+template <> class [[nodiscard]] client_result<void> {
+public:
+  client_result() = default;
+  client_result(client_fault fault) : state{std::move(fault)} {}
+
+  [[nodiscard]] explicit operator bool() const noexcept {
+    return !state.has_value();
+  }
+
+  [[nodiscard]] auto fault() && -> client_fault {
+    assert(!*this);
+    return std::move(*state);
+  }
+
+private:
+  std::optional<client_fault> state;
+};
+
+// Dropped clients, counted by reason.
+class [[nodiscard]] drop_counters {
+public:
+  [[nodiscard]] static auto create() -> std::shared_ptr<drop_counters>;
+
+  drop_counters(const drop_counters&) = delete;
+  drop_counters& operator=(const drop_counters&) = delete;
+
+  auto record(drop_reason reason) -> void;
+
+  [[nodiscard]] auto count(drop_reason reason) const -> std::uint64_t;
+
+private:
+  drop_counters() = default;
+
+  std::array<std::atomic<std::uint64_t>, drop_reason_count> counts = {};
+};
+
+} // namespace mori_echo
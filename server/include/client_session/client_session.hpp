@@ -1,18 +1,58 @@
 #pragma once
 
+#include <boost/uuid/random_generator.hpp>
+#include <boost/uuid/uuid.hpp>
 #include <cstdint>
-#include <string>
+#include <spdlog/fmt/fmt.h>
+#include <string_view>
+
+#include "rate_limiter/rate_limiter.hpp"
 
 namespace mori_echo {
 
+// Per-connection state, kept to a small fixed-size record as an idle server
+// holds one for each of its connections.
 struct client_session {
-  std::string uuid;
-  std::string address;
+  boost::uuids::uuid uuid = {};
 
   bool is_logged_in = false;
 
   std::uint8_t username_sum = {};
   std::uint8_t password_sum = {};
+
+  rate_limit_state rate = {};
 };
 
+static_assert(sizeof(client_session) == 48);
+
+[[nodiscard]] inline auto make_client_session() -> client_session {
+  // Seeded once per thread rather than once per connection.
+  thread_local auto generate = boost::uuids::random_generator{};
+
+  return {.uuid = generate()};
+}
+
 } // namespace mori_echo
+
+// Formats session UUIDs in their canonical text form, without allocating.
+template <> struct fmt::formatter<boost::uuids::uuid> {
+  constexpr auto parse(fmt::format_parse_context& ctx) { return ctx.begin(); }
+
+  template <typename FormatContext>
+  auto format(const boost::uuids::uuid& uuid, FormatContext& ctx) const {
+    constexpr auto digits = std::string_view{"0123456789abcdef"};
+
+    auto out = ctx.out();
+
+    for (auto i = std::size_t{0}; i < uuid.size(); ++i) {
+      if (i == 4 || i == 6 || i == 8 || i == 10) {
+        *out++ = '-';
+      }
+
+      *out++ = digits[uuid.data[i] >> 4];
+      *out++ = digits[uuid.data[i] & 0x0F];
+    }
+
+    return out;
+  }
+};
@@ -0,0 +1,92 @@
+#pragma once
+
+#include <atomic>
+#include <boost/asio/awaitable.hpp>
+#include <boost/asio/co_spawn.hpp>
+#include <boost/asio/thread_pool.hpp>
+#include <boost/asio/use_awaitable.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <type_traits>
+
+namespace mori_echo {
+
+struct compute_pool_metrics {
+  std::uint64_t offloaded = {};
+
+  // Jobs run inline by their caller because the queue was full.
+  std::uint64_t ran_inline = {};
+
+  // Jobs queued or running now, and the most there ever were.
+  std::size_t queue_depth = {};
+  std::size_t peak_queue_depth = {};
+};
+
+// Threads running CPU-bound jobs away from the IO threads. At most
+// `max_queue_depth` jobs wait or run at once, beyond which callers run their
+// jobs themselves rather than queueing without bound.
+class [[nodiscard]] compute_pool {
+public:
+  [[nodiscard]] static auto create(std::size_t thread_count,
+                                   std::size_t max_queue_depth)
+      -> std::shared_ptr<compute_pool>;
+
+  compute_pool(const compute_pool&) = delete;
+  compute_pool& operator=(const compute_pool&) = delete;
+
+  ~compute_pool();
+
+  // Runs `job` on the pool, resuming the caller on its own executor once done.
+  // The job must own everything it uses, as its caller may go away meanwhile.
+  template <typename Job>
+  [[nodiscard]] auto run(Job job)
+      -> boost::asio::awaitable<std::invoke_result_t<Job&>>;
+
+  [[nodiscard]] auto metrics() const -> compute_pool_metrics;
+
+private:
+  compute_pool(std::size_t thread_count, std::size_t max_queue_depth)
+      : threads{thread_count}, max_queue_depth{max_queue_depth} {}
+
+  template <typename Job>
+  [[nodiscard]] static auto run_job(Job job)
+      -> boost::asio::awaitable<std::invoke_result_t<Job&>>;
+
+  [[nodiscard]] auto try_enqueue() -> bool;
+  auto dequeue() -> void;
+
+  boost::asio::thread_pool threads;
+  std::size_t max_queue_depth;
+
+  std::atomic<std::uint64_t> offloaded = 0;
+  std::atomic<std::uint64_t> ran_inline = 0;
+  std::atomic<std::size_t> queue_depth = 0;
+  std::atomic<std::size_t> peak_queue_depth = 0;
+};
+
+template <typename Job>
+auto compute_pool::run(Job job)
+    -> boost::asio::awaitable<std::invoke_result_t<Job&>> {
+  if (!try_enqueue()) {
+    ran_inline.fetch_add(1, std::memory_order_relaxed);
+    co_return job();
+  }
+
+  struct dequeue_on_exit {
+    compute_pool& pool;
+    ~dequeue_on_exit() { pool.dequeue(); }
+  } const guard{*this};
+
+  co_return co_await boost::asio::co_spawn(
+      threads.get_executor(), run_job(std::move(job)),
+      boost::asio::use_awaitable);
+}
+
+template <typename Job>
+auto compute_pool::run_job(Job job)
+    -> boost::asio::awaitable<std::invoke_result_t<Job&>> {
+  co_return job();
+}
+
+} // namespace mori_echo
@@ -1,12 +1,15 @@
 #pragma once
 
 #include <boost/asio/any_io_executor.hpp>
+#include <boost/asio/ip/tcp.hpp>
 
 #include "echo_server_config.hpp"
 
 namespace mori_echo {
 
+// Starts the listeners `cfg` asks for on `executor`, and returns the endpoint
+// of the TCP one, bound by then. A port of 0 has the system pick one.
 auto spawn_server(boost::asio::any_io_executor executor, echo_server_config cfg)
-    -> void;
+    -> boost::asio::ip::tcp::endpoint;
 
 } // namespace mori_echo
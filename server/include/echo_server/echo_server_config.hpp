@@ -1,17 +1,169 @@
 #pragma once
 
+#include <atomic>
+#include <chrono>
+#include <cstddef>
 #include <cstdint>
 #include <memory>
+#include <optional>
+#include <string>
 
 #include "client_authenticator/client_authenticator.hpp"
+#include "client_channel/response_batch.hpp"
+#include "client_channel/zerocopy_sender.hpp"
+#include "client_fault/client_fault.hpp"
+#include "compute_pool/compute_pool.hpp"
+#include "latency_tracer/latency_tracer.hpp"
+#include "loop_monitor/loop_monitor.hpp"
+#include "memory_transport/memory_acceptor.hpp"
+#include "rate_limiter/rate_limiter.hpp"
+#include "traffic_capture/traffic_capture.hpp"
+#include "worker_pool/connection_rebalancer.hpp"
+#include "worker_pool/worker_pool.hpp"
 
 namespace mori_echo {
 
+class [[nodiscard]] turn_counters {
+public:
+  [[nodiscard]] static auto create() -> std::shared_ptr<turn_counters>;
+
+  turn_counters(const turn_counters&) = delete;
+  turn_counters& operator=(const turn_counters&) = delete;
+
+  // Records a session yielding its thread after `messages` messages.
+  auto record_yield(std::uint64_t messages) -> void;
+
+  [[nodiscard]] auto yields() const -> std::uint64_t;
+
+  // Most messages a session handled in a turn it yielded after.
+  [[nodiscard]] auto longest_turn() const -> std::uint64_t;
+
+private:
+  turn_counters() = default;
+
+  std::atomic<std::uint64_t> yield_count = 0;
+  std::atomic<std::uint64_t> longest_turn_messages = 0;
+};
+
+// Messages, and bytes received, a session may handle in a row before it
+// yields its thread, whichever runs out first.
+struct turn_budget_options {
+  std::size_t messages = 64;
+  std::size_t bytes = 1024 * 1024;
+
+  // Counts the turns sessions yielded after when set.
+  std::shared_ptr<turn_counters> counters = nullptr;
+};
+
 struct echo_server_config {
+  // 0 for one picked by the system, which `spawn_server` reports.
   std::uint16_t port = {};
+
+  // Also serve self-contained echo probes over UDP on this port.
+  std::optional<std::uint16_t> udp_port = std::nullopt;
+
+  // Also serve the TCP protocol on a Unix domain socket at this path.
+  std::optional<std::string> local_socket_path = std::nullopt;
+
+  // Also serve same-host clients over shared-memory rings, handed out through
+  // a control socket at this path.
+  std::optional<std::string> shm_control_path = std::nullopt;
+
+  // Ring polls of an idle shared-memory session before it sleeps on its
+  // eventfd. Spinning holds the IO thread to save the wake-up latency.
+  std::size_t shm_spin_count = 0;
+
+  // Also serve in-process clients connecting through this acceptor, with no
+  // socket in between. Their sessions are neither spliced nor zero-copied,
+  // nor moved between workers.
+  std::shared_ptr<memory_acceptor> memory = nullptr;
+
   bool enable_decryption = true;
 
+  // Logs echo payloads at debug level when set. Unset leaves the logging out
+  // of the echo handler altogether, whatever the log level.
+  bool enable_payload_logs = true;
+
+  // With decryption off, echo payloads of at least `splice_threshold` bytes
+  // from TCP and Unix socket clients are passed through the kernel with
+  // splice(), rather than read into memory and written back. Smaller ones
+  // are cheaper to copy than to pass through a pipe.
+  bool enable_splice = true;
+  std::size_t splice_threshold = 16 * 1024;
+
+  // Sends echo responses to TCP clients with MSG_ZEROCOPY when set, for
+  // payloads of at least `zerocopy.threshold` bytes. Their buffers stay
+  // pinned until the kernel reports being done with them. Over loopback the
+  // kernel copies them anyway.
+  bool enable_zerocopy = false;
+  zerocopy_options zerocopy = {};
+
+  // Holds echo responses of TCP and Unix socket clients back while their next
+  // requests are already buffered, up to `coalescing.max_bytes` bytes and
+  // `coalescing.max_delay`, and sends them together with a single gathered
+  // send. A response with no request buffered behind it is sent at once.
+  bool enable_coalescing = true;
+  coalescing_options coalescing = {};
+
+  // Largest frame accepted from a client, extended frames included.
+  std::uint32_t max_message_size = std::uint32_t{16} * 1024 * 1024;
+
+  // Echo regular frames as they arrive instead of after the whole payload.
+  // Extended frames are always echoed this way.
+  bool enable_cut_through = false;
+
+  // Largest piece of a streamed payload held in memory by a connection.
+  std::size_t stream_chunk_size = 16 * 1024;
+
+  // Park idle connections on a readiness wait, holding no read buffer or
+  // handler frames until their next request arrives. Costs an extra wake-up
+  // per request, in exchange for less memory per mostly idle connection.
+  bool enable_idle_wait = false;
+
+  // Has a session whose client keeps requests buffered yield its thread to
+  // the other sessions with a post once it used up its `turn_budget`, rather
+  // than handling them all while they wait. Off by default: every read already
+  // completes through the executor's queue, so sessions take turns anyway.
+  bool enable_turn_budget = false;
+  turn_budget_options turn_budget = {};
+
   std::shared_ptr<auth::client_authenticator> authenticator;
+
+  // Aggregates per-stage latencies of echo requests when set. The USDT probes
+  // at each stage are there either way.
+  std::shared_ptr<latency_tracer> tracer = nullptr;
+
+  // Hands TCP and Unix socket clients out to these workers when set, instead
+  // of serving them on the listener's executor.
+  std::shared_ptr<worker_pool> workers = nullptr;
+
+  // Moves clients off busy workers of `workers` onto idle ones when set,
+  // given the same pool.
+  std::shared_ptr<connection_rebalancer> rebalancer = nullptr;
+
+  // Decrypts echo payloads of at least `offload_threshold` bytes on this pool
+  // when set. Smaller payloads are cheaper to decrypt than to hand over.
+  std::shared_ptr<compute_pool> compute = nullptr;
+  std::size_t offload_threshold = 16 * 1024;
+
+  // Counts dropped TCP and Unix socket clients by reason when set.
+  std::shared_ptr<drop_counters> drops = nullptr;
+
+  // Probes the listener's loop and those of the workers when set, and sheds
+  // load from TCP and Unix socket clients while they run late.
+  std::shared_ptr<loop_monitor> monitor = nullptr;
+
+  // Limits the rate of each client's echo requests, messages and bytes, when
+  // set. Clients over their limits are delayed or dropped, as it says.
+  std::shared_ptr<rate_limiter> limiter = nullptr;
+
+  // Echoes taking at least this long, from their header to their response,
+  // are recorded by the flight recorder. Zero records none.
+  std::chrono::nanoseconds slow_echo_threshold = std::chrono::milliseconds{10};
+
+  // Records the inbound traffic of TCP and Unix socket clients when set, to
+  // be replayed later with `capture::replay`.
+  std::shared_ptr<capture::traffic_capture> capture = nullptr;
 };
 
 } // namespace mori_echo
@@ -0,0 +1,139 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <ctime>
+#include <string>
+#include <vector>
+
+namespace mori_echo::flight {
+
+inline constexpr auto dump_magic = std::uint64_t{0x31544C46524F4D};
+
+// Events kept per thread. The oldest are overwritten once a ring is full.
+inline constexpr auto ring_capacity = std::size_t{4096};
+
+// Threads with a ring at once. Rings of finished threads are handed to new
+// ones, and events of threads past this are not recorded.
+inline constexpr auto max_rings = std::size_t{256};
+
+enum class event_kind : std::uint8_t {
+  ACCEPT,
+  LOGIN,
+  LOGIN_REJECTED,
+
+  // With its `drop_reason` as detail.
+  DROP,
+
+  // With the size of the frame as value.
+  OVERSIZE_FRAME,
+
+  // With how long the echo took, in microseconds, as value.
+  SLOW_ECHO,
+
+  // A handler holding its loop past its budget, with how long in
+  // microseconds as value.
+  SLOW_HANDLER,
+
+  // A session moving to another worker, with its index as value.
+  MIGRATION,
+};
+
+struct event_record {
+  // Of the coarse monotonic clock, precise to a few milliseconds. Events of a
+  // thread are in order in its ring regardless.
+  std::uint64_t timestamp_ns = {};
+
+  // First half of the session UUID.
+  std::uint64_t session = {};
+
+  std::uint32_t value = {};
+
+  event_kind kind = event_kind::ACCEPT;
+  std::uint8_t detail = {};
+
+  std::array<std::uint8_t, 2> reserved = {};
+};
+
+static_assert(sizeof(event_record) == 24);
+
+// Events of one thread, only ever written by that thread.
+struct thread_ring {
+  std::atomic<bool> is_claimed = false;
+
+  std::uint32_t thread_id = {};
+
+  // Past the newest event.
+  std::atomic<std::uint64_t> head = 0;
+
+  std::array<event_record, ring_capacity> events = {};
+};
+
+// The ring of the calling thread, claimed on first use. Null past
+// `max_rings` threads.
+[[nodiscard]] auto claim_thread_ring() -> thread_ring*;
+
+// Records an event on the calling thread's ring. Costs a read of the coarse
+// clock, which unlike the steady clock is a plain load from the vDSO page,
+// and a store to memory the thread owns, without locks or atomic
+// read-modify-writes.
+inline auto record(event_kind kind, std::uint64_t session,
+                   std::uint32_t value = 0, std::uint8_t detail = 0) -> void {
+  thread_local auto* const ring = claim_thread_ring();
+
+  if (ring == nullptr) {
+    return;
+  }
+
+  auto now = timespec{};
+  ::clock_gettime(CLOCK_MONOTONIC_COARSE, &now);
+
+  const auto head = ring->head.load(std::memory_order_relaxed);
+
+  ring->events[head % ring_capacity] = {
+      .timestamp_ns = static_cast<std::uint64_t>(now.tv_sec) * 1'000'000'000 +
+                      static_cast<std::uint64_t>(now.tv_nsec),
+      .session = session,
+      .value = value,
+      .kind = kind,
+      .detail = detail,
+  };
+
+  ring->head.store(head + 1, std::memory_order_release);
+}
+
+// Writes the rings of every thread to `path`. Async-signal-safe, so that it
+// can run from a crash handler. Returns whether the dump was written whole.
+auto dump(const char* path) noexcept -> bool;
+
+// Dumps to `path` on SIGSEGV, SIGBUS, SIGFPE, SIGILL and SIGABRT, before
+// letting the signal take its course.
+auto dump_on_crash(const std::string& path) -> void;
+
+struct thread_events {
+  std::uint32_t thread_id = {};
+
+  // Oldest first.
+  std::vector<event_record> events;
+};
+
+struct flight_dump {
+  // Both clocks at the time of the dump, to place events in wall clock time.
+  std::chrono::steady_clock::time_point dumped_steady;
+  std::chrono::system_clock::time_point dumped;
+
+  std::vector<thread_events> threads;
+};
+
+// Reads back a dump written by `dump`.
+[[nodiscard]] auto read_dump(const std::string& path) -> flight_dump;
+
+// One line of text for an event, like
+// `2024-01-01 12:00:00.123456 [1234] DROP 0123456789abcdef: Message too long.`
+[[nodiscard]] auto describe(const flight_dump& dump, std::uint32_t thread_id,
+                            const event_record& event) -> std::string;
+
+} // namespace mori_echo::flight
@@ -0,0 +1,130 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+#if __has_include(<sys/sdt.h>) && !defined(MORI_ECHO_DISABLE_USDT)
+#include <sys/sdt.h>
+
+// USDT probes compile to a single nop, patched by perf or bpftrace only while
+// they are attached, e.g. `bpftrace -e 'usdt:./mori_echo_server:frame_start'`.
+#define MORI_ECHO_PROBE(name, sequence) DTRACE_PROBE1(mori_echo, name, sequence)
+#else
+#define MORI_ECHO_PROBE(name, sequence) static_cast<void>(sequence)
+#endif
+
+namespace mori_echo {
+
+// Points of an echo request, in the order they are reached.
+enum class trace_point : std::size_t {
+  FRAME_START,
+  FRAME_COMPLETE,
+  DECRYPT_DONE,
+  WRITE_ISSUED,
+  WRITE_COMPLETE,
+};
+
+inline constexpr auto trace_point_count = std::size_t{5};
+
+// Spans between consecutive trace points, and the whole request.
+//
+// A streamed echo is read, decrypted and written a chunk at a time, so its
+// READ stage spans the whole stream and the others its last chunk. A spliced
+// echo reaches neither FRAME_COMPLETE nor DECRYPT_DONE, and only has its
+// WRITE stage, from the start of the splice, and its TOTAL. Echoes passed
+// through undecrypted never reach DECRYPT_DONE, and have neither a DECRYPT
+// nor a QUEUE stage. A response held back for coalescing reaches
+// WRITE_COMPLETE once queued in its batch rather than once sent, so its WRITE
+// stage leaves out the wait for the batch.
+enum class trace_stage : std::size_t { READ, DECRYPT, QUEUE, WRITE, TOTAL };
+
+inline constexpr auto trace_stage_count = std::size_t{5};
+
+// Lock-free histogram of durations, with one power-of-two bucket per bit of
+// a nanosecond count.
+class [[nodiscard]] latency_histogram {
+public:
+  static constexpr auto bucket_count = std::size_t{64};
+
+  auto record(std::chrono::nanoseconds duration) -> void;
+
+  [[nodiscard]] auto count() const -> std::uint64_t;
+
+  // Upper bound of the bucket holding the given fraction of the samples.
+  [[nodiscard]] auto percentile(double fraction) const
+      -> std::chrono::nanoseconds;
+
+private:
+  std::array<std::atomic<std::uint64_t>, bucket_count> buckets = {};
+};
+
+// Aggregates per-stage latencies of echo requests across connections, and
+// logs every `sample_interval`-th request as a trace record.
+class [[nodiscard]] latency_tracer {
+public:
+  using clock = std::chrono::steady_clock;
+  using timestamps = std::array<clock::time_point, trace_point_count>;
+
+  [[nodiscard]] static auto create(std::size_t sample_interval = 0)
+      -> std::shared_ptr<latency_tracer>;
+
+  // Records a request. Stages whose trace points were not reached, like the
+  // decryption of a spliced echo, are left out.
+  auto record(std::uint8_t sequence, const timestamps& points) -> void;
+
+  [[nodiscard]] auto histogram(trace_stage stage) const
+      -> const latency_histogram&;
+
+  auto log_summary() const -> void;
+
+private:
+  explicit latency_tracer(std::size_t sample_interval)
+      : sample_interval{sample_interval} {}
+
+  std::size_t sample_interval;
+  std::atomic<std::size_t> recorded = 0;
+
+  std::array<latency_histogram, trace_stage_count> histograms;
+};
+
+// Trace of a single echo request. Fires the USDT probe of each point, and
+// timestamps it when a tracer is set.
+class [[nodiscard]] echo_trace {
+public:
+  echo_trace(latency_tracer* tracer, std::uint8_t sequence)
+      : tracer{tracer}, sequence{sequence} {}
+
+  template <trace_point Point> auto mark() -> void {
+    if constexpr (Point == trace_point::FRAME_START) {
+      MORI_ECHO_PROBE(frame_start, sequence);
+    } else if constexpr (Point == trace_point::FRAME_COMPLETE) {
+      MORI_ECHO_PROBE(frame_complete, sequence);
+    } else if constexpr (Point == trace_point::DECRYPT_DONE) {
+      MORI_ECHO_PROBE(decrypt_done, sequence);
+    } else if constexpr (Point == trace_point::WRITE_ISSUED) {
+      MORI_ECHO_PROBE(write_issued, sequence);
+    } else {
+      MORI_ECHO_PROBE(write_complete, sequence);
+    }
+
+    if (tracer != nullptr) {
+      points[static_cast<std::size_t>(Point)] = latency_tracer::clock::now();
+
+      if constexpr (Point == trace_point::WRITE_COMPLETE) {
+        tracer->record(sequence, points);
+      }
+    }
+  }
+
+private:
+  latency_tracer* tracer;
+  std::uint8_t sequence;
+
+  latency_tracer::timestamps points = {};
+};
+
+} // namespace mori_echo
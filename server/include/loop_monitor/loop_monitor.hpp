@@ -0,0 +1,128 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <boost/asio/any_io_executor.hpp>
+#include <boost/asio/awaitable.hpp>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <mutex>
+
+#include "latency_tracer/latency_tracer.hpp"
+
+namespace mori_echo {
+
+struct loop_monitor_options {
+  // How often each loop is probed.
+  std::chrono::nanoseconds probe_interval = std::chrono::milliseconds{10};
+
+  // A loop starts shedding load once a probe runs this late...
+  std::chrono::nanoseconds shed_lag = std::chrono::milliseconds{50};
+
+  // ...and stops once its probes have stayed below it for this long.
+  std::chrono::nanoseconds shed_hold = std::chrono::milliseconds{500};
+
+  // Session handlers holding their loop longer than this are reported, and
+  // dropped while their loop sheds load.
+  std::chrono::nanoseconds handler_budget = std::chrono::milliseconds{5};
+};
+
+// Ways load is shed, counted by `loop_monitor`.
+enum class shed_action : std::size_t {
+  // A listener stopped accepting for a while.
+  PAUSED_ACCEPTS,
+
+  REJECTED_LOGIN,
+  DROPPED_SESSION,
+};
+
+inline constexpr auto shed_action_count = std::size_t{3};
+
+// Measures how late each watched io_context runs a periodic timer, and how
+// long session handlers hold it. Loops running late shed load until they
+// catch up: listeners pause their accepts, new logins are rejected, and
+// sessions whose handlers run past their budget are dropped.
+//
+// Loops are expected to run on one thread each.
+class [[nodiscard]] loop_monitor
+    : public std::enable_shared_from_this<loop_monitor> {
+public:
+  using clock = std::chrono::steady_clock;
+
+  [[nodiscard]] static auto create(loop_monitor_options options = {})
+      -> std::shared_ptr<loop_monitor>;
+
+  loop_monitor(const loop_monitor&) = delete;
+  loop_monitor& operator=(const loop_monitor&) = delete;
+
+  // Probes the loop of `executor` for as long as it runs, or until stopped.
+  auto watch(boost::asio::any_io_executor executor) -> void;
+
+  // Ends the probes at their next tick.
+  auto stop() -> void;
+
+  // Whether the loop of the calling thread is shedding load.
+  [[nodiscard]] auto is_shedding() const -> bool;
+
+  // Whether any watched loop is shedding load.
+  [[nodiscard]] auto is_any_shedding() const -> bool;
+
+  // Records a handler of a session holding its loop from `started` until now,
+  // and returns for how long it did.
+  auto record_handler(clock::time_point started) -> std::chrono::nanoseconds;
+
+  auto record(shed_action action) -> void;
+
+  [[nodiscard]] auto count(shed_action action) const -> std::uint64_t;
+
+  // How late the probes ran.
+  [[nodiscard]] auto lag() const -> const latency_histogram&;
+
+  // Lag of the latest probe of the worst loop.
+  [[nodiscard]] auto current_lag() const -> std::chrono::nanoseconds;
+
+  // How long session handlers held their loop.
+  [[nodiscard]] auto handlers() const -> const latency_histogram&;
+
+  [[nodiscard]] auto options() const -> const loop_monitor_options&;
+
+  auto log_summary() const -> void;
+
+private:
+  struct loop_state {
+    std::atomic<std::int64_t> lag_ns = 0;
+    std::atomic<bool> is_shedding = false;
+
+    // Only touched by the probe.
+    clock::time_point last_late = {};
+  };
+
+  explicit loop_monitor(loop_monitor_options options)
+      : settings{options} {}
+
+  [[nodiscard]] static auto probe(std::shared_ptr<loop_monitor> monitor,
+                                  loop_state& state)
+      -> boost::asio::awaitable<void>;
+
+  // The monitor probing the loop of this thread, and its state for it.
+  static thread_local const loop_monitor* probed_by;
+  static thread_local loop_state* probed_state;
+
+  loop_monitor_options settings;
+
+  std::atomic<bool> is_stopped = false;
+
+  // Stable addresses, read by the probes and by `is_any_shedding`.
+  std::list<loop_state> loops;
+  mutable std::mutex loops_mutex;
+
+  latency_histogram lag_histogram;
+  latency_histogram handler_histogram;
+
+  std::array<std::atomic<std::uint64_t>, shed_action_count> shed_counts = {};
+};
+
+} // namespace mori_echo
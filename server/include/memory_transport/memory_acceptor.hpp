@@ -0,0 +1,48 @@
+#pragma once
+
+#include <boost/asio/any_io_executor.hpp>
+#include <boost/asio/awaitable.hpp>
+#include <boost/asio/steady_timer.hpp>
+#include <cstddef>
+#include <deque>
+#include <memory>
+#include <mutex>
+
+#include "memory_stream.hpp"
+
+namespace mori_echo {
+
+// Hands in-process clients to a server as memory streams, the way a listening
+// socket hands it remote ones, so that whole sessions run without the kernel.
+// Clients may connect from any thread, before the server accepts or after.
+class [[nodiscard]] memory_acceptor {
+public:
+  [[nodiscard]] static auto
+  create(std::size_t capacity = default_memory_stream_capacity)
+      -> std::shared_ptr<memory_acceptor>;
+
+  memory_acceptor(const memory_acceptor&) = delete;
+  memory_acceptor& operator=(const memory_acceptor&) = delete;
+
+  // The client end of a new stream, run on `executor`.
+  [[nodiscard]] auto connect(boost::asio::any_io_executor executor)
+      -> memory_stream;
+
+  // The server end of the next stream connected, run on `executor`. A single
+  // listener accepts at a time.
+  [[nodiscard]] auto accept(boost::asio::any_io_executor executor)
+      -> boost::asio::awaitable<memory_stream>;
+
+private:
+  explicit memory_acceptor(std::size_t capacity) : capacity{capacity} {}
+
+  std::size_t capacity;
+
+  std::mutex mutex;
+  std::deque<std::shared_ptr<memory_link>> pending;
+
+  // Owned by the waiting listener, which may go away with its executor.
+  std::weak_ptr<boost::asio::steady_timer> listener;
+};
+
+} // namespace mori_echo
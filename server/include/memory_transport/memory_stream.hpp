@@ -0,0 +1,277 @@
+#pragma once
+
+#include <array>
+#include <boost/asio/any_io_executor.hpp>
+#include <boost/asio/buffer.hpp>
+#include <boost/asio/compose.hpp>
+#include <boost/asio/error.hpp>
+#include <boost/asio/post.hpp>
+#include <boost/asio/steady_timer.hpp>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <span>
+#include <utility>
+#include <vector>
+
+namespace mori_echo {
+
+// Bytes a memory stream buffers each way unless told otherwise, about what a
+// loopback socket does.
+inline constexpr auto default_memory_stream_capacity = std::size_t{256} * 1024;
+
+// What the two ends of a memory stream share: a bounded buffer each way, and
+// the wake-up of each end, which the other cancels to retry its operations.
+//
+// Ends may run on different threads. An end's wake-up is only ever touched
+// from its own executor, which must be run by a single thread.
+class memory_link : public std::enable_shared_from_this<memory_link> {
+public:
+  explicit memory_link(std::size_t capacity);
+
+  memory_link(const memory_link&) = delete;
+  memory_link& operator=(const memory_link&) = delete;
+
+  // Sets the wake-up of `end`, 0 or 1, from its executor.
+  auto bind(std::size_t end, boost::asio::steady_timer* wakeup) -> void;
+
+  // Closes `end`, from its executor. The other end reads what was sent
+  // before, then the end of the stream.
+  auto close(std::size_t end) -> void;
+
+  // Null once `end` is closed.
+  [[nodiscard]] auto wakeup(std::size_t end) const
+      -> boost::asio::steady_timer* {
+    return wakeups[end];
+  }
+
+  // Fails with `would_block` while there is nothing to read, or no room to
+  // write, until the other end wakes `end` up.
+
+  [[nodiscard]] auto read_some(std::size_t end, std::span<std::byte> buffer,
+                               boost::system::error_code& error)
+      -> std::size_t;
+
+  [[nodiscard]] auto write_some(std::size_t end,
+                                std::span<const std::byte> data,
+                                boost::system::error_code& error)
+      -> std::size_t;
+
+  // Whether `end` could read, or write, without blocking.
+  auto poll(std::size_t end, bool is_write, boost::system::error_code& error)
+      -> void;
+
+  [[nodiscard]] auto available(std::size_t end) -> std::size_t;
+
+private:
+  // Bytes buffered for one end to read, in a ring.
+  struct direction {
+    std::vector<std::byte> ring;
+    std::size_t head = 0;
+    std::size_t size = 0;
+  };
+
+  [[nodiscard]] auto check_open(std::size_t end,
+                                boost::system::error_code& error) const
+      -> bool;
+
+  // Wakes `end` up if it waits. Called with `mutex` held.
+  auto wake(std::size_t end) -> void;
+
+  std::mutex mutex;
+
+  std::array<direction, 2> inbound;
+  std::array<bool, 2> is_open = {true, true};
+  std::array<bool, 2> is_waiting = {};
+  std::array<boost::asio::steady_timer*, 2> wakeups = {};
+};
+
+// An operation on an end of a memory stream, attempted again each time the
+// other end wakes it up, until it would no longer block.
+template <typename Attempt, bool IsTransfer> class memory_operation {
+public:
+  memory_operation(std::shared_ptr<memory_link> link, std::size_t end,
+                   Attempt attempt)
+      : link{std::move(link)}, end{end}, attempt{std::move(attempt)} {}
+
+  template <typename Self>
+  auto operator()(Self& self, boost::system::error_code = {}) -> void {
+    // Completed like those of sockets, never from within their initiation.
+    if (!std::exchange(is_started, true)) {
+      boost::asio::post(std::move(self));
+      return;
+    }
+
+    auto error = boost::system::error_code{};
+    auto transferred = std::size_t{0};
+
+    if (link) {
+      transferred = attempt(*link, end, error);
+    } else {
+      error = boost::asio::error::bad_descriptor;
+    }
+
+    if (error == boost::asio::error::would_block) {
+      if (auto* wakeup = link->wakeup(end); wakeup != nullptr) {
+        wakeup->async_wait(std::move(self));
+        return;
+      }
+
+      error = boost::asio::error::operation_aborted;
+    }
+
+    if constexpr (IsTransfer) {
+      self.complete(error, transferred);
+    } else {
+      self.complete(error);
+    }
+  }
+
+private:
+  std::shared_ptr<memory_link> link;
+  std::size_t end;
+  Attempt attempt;
+  bool is_started = false;
+};
+
+// An end of an in-memory duplex stream, standing in for a socket wherever a
+// `basic_client_channel` takes one, so that sessions can be served without
+// the kernel. Like a socket, must only be used from its executor.
+class [[nodiscard]] memory_stream {
+public:
+  using executor_type = boost::asio::any_io_executor;
+
+  enum wait_type { wait_read, wait_write, wait_error };
+
+  // Two connected ends, run on their own executors.
+  [[nodiscard]] static auto
+  make_pair(executor_type first, executor_type second,
+            std::size_t capacity = default_memory_stream_capacity)
+      -> std::pair<memory_stream, memory_stream>;
+
+  // End `end`, 0 or 1, of `link`.
+  memory_stream(std::shared_ptr<memory_link> link, std::size_t end,
+                executor_type executor);
+
+  memory_stream(memory_stream&& other) noexcept = default;
+  memory_stream& operator=(memory_stream&& other) = delete;
+
+  ~memory_stream() { close(); }
+
+  [[nodiscard]] auto get_executor() const -> executor_type {
+    return executor;
+  }
+
+  [[nodiscard]] auto is_open() const -> bool { return link != nullptr; }
+
+  // Fails pending operations, and has the other end read the end of the
+  // stream once it read what was sent before.
+  auto close() -> void;
+
+  [[nodiscard]] auto available(boost::system::error_code& error) const
+      -> std::size_t;
+
+  template <typename MutableBufferSequence, typename ReadToken>
+  auto async_read_some(const MutableBufferSequence& buffers,
+                       ReadToken&& token) {
+    auto attempt = [buffers](memory_link& link, std::size_t end,
+                             boost::system::error_code& error) {
+      return transfer(buffers, error, [&](auto buffer) {
+        return link.read_some(end,
+                              {static_cast<std::byte*>(buffer.data()),
+                               buffer.size()},
+                              error);
+      });
+    };
+
+    return start<true, void(boost::system::error_code, std::size_t)>(
+        std::move(attempt), std::forward<ReadToken>(token));
+  }
+
+  template <typename ConstBufferSequence, typename WriteToken>
+  auto async_write_some(const ConstBufferSequence& buffers,
+                        WriteToken&& token) {
+    auto attempt = [buffers](memory_link& link, std::size_t end,
+                             boost::system::error_code& error) {
+      return transfer(buffers, error, [&](auto buffer) {
+        return link.write_some(end,
+                               {static_cast<const std::byte*>(buffer.data()),
+                                buffer.size()},
+                               error);
+      });
+    };
+
+    return start<true, void(boost::system::error_code, std::size_t)>(
+        std::move(attempt), std::forward<WriteToken>(token));
+  }
+
+  // Flags are for the kernel, which plays no part here.
+  template <typename ConstBufferSequence, typename WriteToken>
+  auto async_send(const ConstBufferSequence& buffers, int /*flags*/,
+                  WriteToken&& token) {
+    return async_write_some(buffers, std::forward<WriteToken>(token));
+  }
+
+  // Errors are reported by the operations themselves, so waiting for one
+  // waits for a readable end.
+  template <typename WaitToken>
+  auto async_wait(wait_type wait, WaitToken&& token) {
+    auto attempt = [wait](memory_link& link, std::size_t end,
+                          boost::system::error_code& error) {
+      link.poll(end, wait == wait_write, error);
+      return std::size_t{0};
+    };
+
+    return start<false, void(boost::system::error_code)>(
+        std::move(attempt), std::forward<WaitToken>(token));
+  }
+
+private:
+  // Moves each buffer of `buffers` with `move`, until one is not filled or
+  // emptied whole. Having moved anything at all is a success.
+  template <typename BufferSequence, typename Move>
+  static auto transfer(const BufferSequence& buffers,
+                       boost::system::error_code& error, Move move)
+      -> std::size_t {
+    auto transferred = std::size_t{0};
+
+    for (auto each = boost::asio::buffer_sequence_begin(buffers);
+         each != boost::asio::buffer_sequence_end(buffers); ++each) {
+      const auto buffer = *each;
+
+      if (buffer.size() == 0) {
+        continue;
+      }
+
+      const auto moved = move(buffer);
+      transferred += moved;
+
+      if (moved < buffer.size()) {
+        break;
+      }
+    }
+
+    if (transferred > 0) {
+      error = {};
+    }
+
+    return transferred;
+  }
+
+  template <bool IsTransfer, typename Signature, typename Attempt,
+            typename Token>
+  auto start(Attempt attempt, Token&& token) {
+    return boost::asio::async_compose<Token, Signature>(
+        memory_operation<Attempt, IsTransfer>{link, end, std::move(attempt)},
+        token, executor);
+  }
+
+  std::shared_ptr<memory_link> link;
+  std::size_t end = 0;
+  executor_type executor;
+
+  // Stays put as the stream moves, for the link to point at.
+  std::unique_ptr<boost::asio::steady_timer> wakeup;
+};
+
+} // namespace mori_echo
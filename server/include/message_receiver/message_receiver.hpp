@@ -1,19 +1,72 @@
 #pragma once
 
 #include <boost/asio/awaitable.hpp>
+#include <cstdint>
+#include <span>
 
 #include "client_channel/client_channel.hpp"
+#include "client_fault/client_fault.hpp"
+#include "message_types/echo_request.hpp"
+#include "message_types/login_request.hpp"
 #include "message_types/message_base.hpp"
 #include "message_types/message_header.hpp"
 
 namespace mori_echo {
 
-[[nodiscard]] auto receive_header(client_channel& channel)
-    -> boost::asio::awaitable<messages::message_header>;
+// Channel receivers are instantiated in message_receiver.cpp for the
+// `client_channel`, `local_client_channel` and `memory_client_channel`
+// transports. They return client faults and disconnects rather than throwing
+// them.
 
-template <messages::MoriEchoMessage T>
-[[nodiscard]] auto receive_message(client_channel& channel,
+template <typename AsyncStream>
+[[nodiscard]] auto receive_header(basic_client_channel<AsyncStream>& channel)
+    -> boost::asio::awaitable<client_result<messages::message_header>>;
+
+// Validates an echo request and receives its payload size, leaving the
+// payload itself on the channel to be streamed by the caller.
+template <typename AsyncStream>
+[[nodiscard]] auto receive_echo_size(basic_client_channel<AsyncStream>& channel,
+                                     messages::message_header header,
+                                     std::uint32_t max_message_size)
+    -> boost::asio::awaitable<client_result<std::uint32_t>>;
+
+template <messages::MoriEchoMessage T> struct message_receiver;
+
+template <> struct message_receiver<messages::login_request> {
+  template <typename AsyncStream>
+  auto operator()(basic_client_channel<AsyncStream>& channel,
+                  messages::message_header header)
+      -> boost::asio::awaitable<client_result<messages::login_request>>;
+};
+
+// Receives a regular echo request whole. Extended ones are streamed instead.
+template <> struct message_receiver<messages::echo_request> {
+  template <typename AsyncStream>
+  auto operator()(basic_client_channel<AsyncStream>& channel,
+                  messages::message_header header)
+      -> boost::asio::awaitable<client_result<messages::echo_request>>;
+};
+
+template <messages::MoriEchoMessage T, typename AsyncStream>
+[[nodiscard]] auto receive_message(basic_client_channel<AsyncStream>& channel,
                                    messages::message_header header)
-    -> boost::asio::awaitable<T>;
+    -> decltype(message_receiver<T>{}(channel, std::move(header))) {
+  return message_receiver<T>{}(channel, std::move(header));
+}
+
+// Decodes frames packed back to back in a datagram, consuming each from the
+// front of `data`. Validation is the same as for frames received on a channel.
+[[nodiscard]] auto decode_header(std::span<std::byte>& data)
+    -> messages::message_header;
+
+template <messages::MoriEchoMessage T>
+[[nodiscard]] auto decode_message(std::span<std::byte>& data,
+                                  messages::message_header header) -> T;
+
+// Decodes an echo request, returning a view of its payload inside `data` so
+// that it can be decrypted in place.
+[[nodiscard]] auto decode_echo_payload(std::span<std::byte>& data,
+                                       const messages::message_header& header)
+    -> std::span<std::byte>;
 
 } // namespace mori_echo
@@ -1,8 +1,13 @@
 #pragma once
 
 #include <boost/asio/awaitable.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <span>
 
 #include "client_channel/client_channel.hpp"
+#include "client_fault/client_fault.hpp"
+#include "message_codec/message_codec.hpp"
 #include "message_types/echo_response.hpp"
 #include "message_types/login_response.hpp"
 #include "message_types/message_base.hpp"
@@ -10,18 +15,59 @@
 
 namespace mori_echo {
 
+// Channel senders are instantiated in message_sender.cpp for the
+// `client_channel`, `local_client_channel` and `memory_client_channel`
+// transports. They return write failures rather than throwing them.
+
 template <messages::MoriEchoMessage T> struct send_message;
 
 template <> struct send_message<messages::login_response> {
-  auto operator()(client_channel& channel, std::uint8_t sequence,
-                  mori_status::login_status status_code)
-      -> boost::asio::awaitable<void>;
+  template <typename AsyncStream>
+  auto operator()(basic_client_channel<AsyncStream>& channel,
+                  std::uint8_t sequence, mori_status::login_status status_code)
+      -> boost::asio::awaitable<client_result<void>>;
 };
 
 template <> struct send_message<messages::echo_response> {
-  auto operator()(client_channel& channel, std::uint8_t sequence,
-                  const std::vector<std::byte>& message)
-      -> boost::asio::awaitable<void>;
+  template <typename AsyncStream>
+  auto operator()(basic_client_channel<AsyncStream>& channel,
+                  std::uint8_t sequence, const std::vector<std::byte>& message)
+      -> boost::asio::awaitable<client_result<void>>;
+
+  // Takes the payload, so that the channel may send it without copying, and
+  // hand it back to the thread's `payload_pool` after.
+  template <typename AsyncStream>
+  auto operator()(basic_client_channel<AsyncStream>& channel,
+                  std::uint8_t sequence, std::vector<std::byte>&& message)
+      -> boost::asio::awaitable<client_result<void>>;
 };
 
+// Sends the framing of an echo response, leaving its payload to be streamed
+// by the caller.
+template <typename AsyncStream>
+[[nodiscard]] auto send_echo_header(basic_client_channel<AsyncStream>& channel,
+                                    std::uint8_t sequence,
+                                    std::uint32_t message_size,
+                                    bool is_extended)
+    -> boost::asio::awaitable<client_result<void>>;
+
+// Encoded sizes of the frames written to memory by the encoders below.
+inline constexpr auto login_response_frame_size =
+    frame_prefix_size<messages::login_response>;
+
+inline constexpr auto echo_response_framing_size =
+    frame_prefix_size<messages::echo_response>;
+
+// Encodes a login response into `data`, for transports that build frames in
+// memory instead of writing them to a channel.
+auto encode_login_response(
+    std::span<std::byte, login_response_frame_size> data, std::uint8_t sequence,
+    mori_status::login_status status_code) -> void;
+
+// Encodes everything of an echo response but its payload, which is expected
+// to follow `data` in memory.
+auto encode_echo_header(std::span<std::byte, echo_response_framing_size> data,
+                        std::uint8_t sequence, std::uint16_t message_size)
+    -> void;
+
 } // namespace mori_echo
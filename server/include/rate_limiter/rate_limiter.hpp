@@ -0,0 +1,113 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace mori_echo {
+
+// Rates a client's echo requests may arrive at, each with the burst a client
+// may send at once after staying below its rate. Zero rates are unlimited.
+struct rate_limits {
+  std::uint32_t messages_per_second = 0;
+  std::uint32_t message_burst = 64;
+
+  // Frames count whole, headers included. Under `DISCONNECT`, a burst below
+  // the largest frame accepted drops any client sending such a frame.
+  std::uint64_t bytes_per_second = 0;
+  std::uint64_t byte_burst = std::uint64_t{16} * 1024 * 1024;
+};
+
+// What a client over its limits gets, as configured and as counted.
+enum class rate_limit_action : std::size_t {
+  // Its next read waits until it is back within its limits.
+  DELAY,
+
+  DISCONNECT,
+};
+
+inline constexpr auto rate_limit_action_count = std::size_t{2};
+
+struct rate_limit_options {
+  rate_limits defaults = {};
+
+  // Limits of these users, by name, in place of the defaults.
+  std::unordered_map<std::string, rate_limits> users = {};
+
+  rate_limit_action action = rate_limit_action::DELAY;
+};
+
+// A session's standing against its limits, kept in the session itself and
+// only ever touched by it.
+struct rate_limit_state {
+  using clock = std::chrono::steady_clock;
+
+  // When each of the session's buckets will be full again, or when they were
+  // last, as in the generic cell rate algorithm. A bucket is over its limit
+  // once this lies more than its burst ahead.
+  clock::time_point messages_full = {};
+  clock::time_point bytes_full = {};
+
+  // Index of the session's limits within its `rate_limiter`.
+  std::uint32_t limits = 0;
+};
+
+// Token buckets for the messages and the bytes of each session, refilled at
+// the rates of the session's user. Holds only what every session reads,
+// counting what it did to them with relaxed atomics.
+class [[nodiscard]] rate_limiter {
+public:
+  using clock = rate_limit_state::clock;
+
+  [[nodiscard]] static auto create(rate_limit_options options = {})
+      -> std::shared_ptr<rate_limiter>;
+
+  rate_limiter(const rate_limiter&) = delete;
+  rate_limiter& operator=(const rate_limiter&) = delete;
+
+  // Subjects a session logged in as `username` to that user's limits.
+  auto assign(rate_limit_state& state, std::string_view username) const
+      -> void;
+
+  // Takes a message of `bytes` bytes out of a session's buckets at `now`,
+  // and returns how long the session must wait to be back within its
+  // limits. Zero while within them.
+  [[nodiscard]] auto take(rate_limit_state& state, std::uint64_t bytes,
+                          clock::time_point now) const
+      -> std::chrono::nanoseconds;
+
+  [[nodiscard]] auto action() const -> rate_limit_action {
+    return options.action;
+  }
+
+  // Records `action` taken against a client, which waited for `delay` if at
+  // all.
+  auto record(rate_limit_action action,
+              std::chrono::nanoseconds delay = {}) -> void;
+
+  [[nodiscard]] auto count(rate_limit_action action) const -> std::uint64_t;
+
+  // Time delayed clients waited, all together.
+  [[nodiscard]] auto total_delay() const -> std::chrono::nanoseconds;
+
+private:
+  explicit rate_limiter(rate_limit_options options);
+
+  rate_limit_options options;
+
+  // The defaults first, then those of `options.users`, by index.
+  std::vector<rate_limits> limits;
+  std::unordered_map<std::string, std::uint32_t> user_limits;
+
+  std::array<std::atomic<std::uint64_t>, rate_limit_action_count> counts = {};
+  std::atomic<std::int64_t> delay_ns = 0;
+};
+
+} // namespace mori_echo
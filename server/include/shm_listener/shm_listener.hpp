@@ -0,0 +1,19 @@
+#pragma once
+
+#include <boost/asio/any_io_executor.hpp>
+#include <boost/asio/awaitable.hpp>
+
+#include "echo_server/echo_server_config.hpp"
+
+namespace mori_echo {
+
+// Serves same-host clients over shared-memory rings. A client connects to the
+// control socket and receives, along one byte, a memory file holding a
+// `shm::shm_region` followed by the request and the response eventfds. It then
+// runs the TCP protocol over the rings, one frame per slot, and ends the
+// session by closing the control socket.
+[[nodiscard]] auto shm_listen(boost::asio::any_io_executor executor,
+                              echo_server_config cfg)
+    -> boost::asio::awaitable<void>;
+
+} // namespace mori_echo
@@ -0,0 +1,130 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+namespace mori_echo::shm {
+
+// Holds any regular frame. Extended frames are not carried by the rings.
+inline constexpr auto slot_capacity = std::size_t{65536};
+
+// Frames per ring. A client keeps at most this many requests in flight, so
+// that the server never finds the response ring full.
+inline constexpr auto ring_slots = std::uint32_t{16};
+
+inline constexpr auto cache_line_size = std::size_t{64};
+
+inline constexpr auto region_magic = std::uint32_t{0x4D4F5249};
+
+static_assert((ring_slots & (ring_slots - 1)) == 0,
+              "The ring size must be a power of two.");
+
+static_assert(std::atomic<std::uint32_t>::is_always_lock_free,
+              "Ring indexes are shared between processes.");
+
+struct shm_slot {
+  std::uint32_t size = {};
+
+  alignas(cache_line_size) std::array<std::byte, slot_capacity> data = {};
+};
+
+// Single-producer single-consumer ring of frames. Indexes only ever grow and
+// wrap around the slots. Both sides publish their own index and read the
+// other's with sequential consistency, so that a producer pushing into an
+// empty ring always sees a consumer about to sleep, and signals it.
+class shm_ring {
+public:
+  // Consumer: the oldest frame, or nullptr if the ring is empty.
+  [[nodiscard]] auto front() -> shm_slot* {
+    const auto current = head.load(std::memory_order_relaxed);
+
+    if (current == tail.load()) {
+      return nullptr;
+    }
+
+    return &slots[current % ring_slots];
+  }
+
+  // Consumer: releases the frame returned by front().
+  auto pop() -> void { head.store(head.load(std::memory_order_relaxed) + 1); }
+
+  // Producer: the slot to fill next, or nullptr if the ring is full.
+  [[nodiscard]] auto back() -> shm_slot* {
+    const auto current = tail.load(std::memory_order_relaxed);
+
+    if (current - head.load() >= ring_slots) {
+      return nullptr;
+    }
+
+    return &slots[current % ring_slots];
+  }
+
+  // Producer: publishes the slot returned by back(). Returns whether the ring
+  // was empty, in which case the consumer may be asleep and must be signaled.
+  [[nodiscard]] auto push() -> bool {
+    const auto current = tail.load(std::memory_order_relaxed);
+
+    tail.store(current + 1);
+
+    return head.load() == current;
+  }
+
+private:
+  alignas(cache_line_size) std::atomic<std::uint32_t> head = 0;
+  alignas(cache_line_size) std::atomic<std::uint32_t> tail = 0;
+
+  std::array<shm_slot, ring_slots> slots = {};
+};
+
+// Layout of the memory shared by the server and a client.
+struct shm_region {
+  std::uint32_t magic = region_magic;
+
+  // Set by the server when it ends the session.
+  std::atomic<std::uint32_t> is_closed = 0;
+
+  shm_ring requests;
+  shm_ring responses;
+};
+
+// Owns a file descriptor received or created for a session.
+class [[nodiscard]] unique_fd {
+public:
+  explicit unique_fd(int fd = -1) : fd{fd} {}
+
+  unique_fd(unique_fd&& other) noexcept;
+  auto operator=(unique_fd&& other) noexcept -> unique_fd&;
+
+  ~unique_fd();
+
+  [[nodiscard]] auto get() const -> int { return fd; }
+
+  // Gives up ownership, e.g. to an asio descriptor.
+  [[nodiscard]] auto release() -> int;
+
+private:
+  int fd;
+};
+
+// Maps the `shm_region` held by a memory file into this process.
+class [[nodiscard]] shm_mapping {
+public:
+  explicit shm_mapping(const unique_fd& memory);
+
+  shm_mapping(shm_mapping&& other) noexcept;
+  auto operator=(shm_mapping&& other) noexcept -> shm_mapping&;
+
+  ~shm_mapping();
+
+  [[nodiscard]] auto region() const -> shm_region& { return *address; }
+
+private:
+  shm_region* address;
+};
+
+// Creates a memory file sized and initialized for one `shm_region`.
+[[nodiscard]] auto create_region_file() -> unique_fd;
+
+} // namespace mori_echo::shm
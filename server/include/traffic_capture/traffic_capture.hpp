@@ -0,0 +1,196 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <span>
+#include <string>
+#include <vector>
+
+namespace mori_echo::capture {
+
+inline constexpr auto capture_magic = std::uint64_t{0x32504143524F4D};
+
+// Records start at multiples of this within the ring.
+inline constexpr auto record_alignment = std::size_t{8};
+
+enum class record_kind : std::uint8_t {
+  // Fills the end of the ring where the next record did not fit.
+  PADDING,
+
+  OPEN,
+  DATA,
+  CLOSE,
+};
+
+struct record_header {
+  // Since the capture started.
+  std::uint64_t timestamp_ns = {};
+
+  std::uint32_t session = {};
+
+  // Size of the data as read from the client, and as kept in the capture.
+  // Data longer than the snap length of the capture is truncated.
+  std::uint32_t original_size = {};
+  std::uint32_t captured_size = {};
+
+  record_kind kind = record_kind::PADDING;
+  std::array<std::uint8_t, 3> reserved = {};
+};
+
+static_assert(sizeof(record_header) == 24);
+
+static_assert(std::atomic<std::uint64_t>::is_always_lock_free,
+              "Ring offsets are read back from the file.");
+
+// Start of a capture file, followed by `rings` rings, each a `ring_header`
+// and `capacity` bytes of records.
+struct file_header {
+  std::uint64_t magic = capture_magic;
+  std::uint64_t capacity = {};
+
+  // Wall clock time the capture started at, in nanoseconds since the epoch.
+  std::uint64_t started_ns = {};
+
+  std::uint64_t rings = {};
+
+  std::array<std::byte, 32> reserved = {};
+};
+
+static_assert(sizeof(file_header) == 64);
+
+// Offsets of a ring, which only ever grow and wrap around it. The oldest
+// records are overwritten once it is full. Each ring has a cache line of its
+// own, as each is written by a thread of its own.
+struct ring_header {
+  // Past the newest record, and at the oldest one.
+  std::atomic<std::uint64_t> head = 0;
+  std::atomic<std::uint64_t> tail = 0;
+
+  std::array<std::byte, 48> reserved = {};
+};
+
+static_assert(sizeof(ring_header) == 64);
+
+class traffic_capture;
+
+// Records the inbound traffic of one connection, and its end once destroyed.
+// Keeps its capture alive until then, as sessions may outlive the listener
+// which opened them. A default-constructed session records nothing.
+class [[nodiscard]] capture_session {
+public:
+  capture_session() = default;
+
+  capture_session(capture_session&& other) noexcept;
+  auto operator=(capture_session&& other) noexcept -> capture_session&;
+
+  ~capture_session();
+
+  // Empty reads, like the one ending a stream, are left out.
+  auto record(std::span<const std::byte> data) -> void;
+
+  [[nodiscard]] auto is_recording() const -> bool { return owner != nullptr; }
+
+private:
+  friend class traffic_capture;
+
+  capture_session(std::shared_ptr<traffic_capture> owner, std::uint32_t id)
+      : owner{std::move(owner)}, id{id} {}
+
+  std::shared_ptr<traffic_capture> owner = nullptr;
+  std::uint32_t id = {};
+};
+
+// Writes the inbound traffic of client sessions to rings preallocated in a
+// memory-mapped file, so that recording a frame costs a copy into the page
+// cache. Each ring keeps its newest records once full.
+//
+// The first `rings - 1` threads to record each get a ring of their own, which
+// they write without locking. Threads past them share the last ring, under a
+// mutex. Records of a session moved between threads are spread over the
+// rings, and merged back by their timestamps when read.
+class [[nodiscard]] traffic_capture
+    : public std::enable_shared_from_this<traffic_capture> {
+public:
+  using clock = std::chrono::steady_clock;
+
+  // `capacity` is split evenly between the rings.
+  [[nodiscard]] static auto create(const std::string& path,
+                                   std::size_t capacity,
+                                   std::size_t snap_length = 64 * 1024,
+                                   std::size_t rings = 1)
+      -> std::shared_ptr<traffic_capture>;
+
+  traffic_capture(const traffic_capture&) = delete;
+  auto operator=(const traffic_capture&) -> traffic_capture& = delete;
+
+  ~traffic_capture();
+
+  [[nodiscard]] auto open_session() -> capture_session;
+
+private:
+  friend class capture_session;
+
+  traffic_capture(int fd, file_header* header, std::size_t snap_length);
+
+  auto record(record_kind kind, std::uint32_t session,
+              std::span<const std::byte> data) -> void;
+
+  // Ring the calling thread writes to, claimed on its first record.
+  [[nodiscard]] auto this_thread_ring() -> std::size_t;
+
+  auto write(std::size_t ring, const record_header& record,
+             std::span<const std::byte> data) -> void;
+
+  // Moves the tail of `ring` past the records overlapping it up to `end`.
+  auto evict_until(std::size_t ring, std::uint64_t end) -> void;
+
+  [[nodiscard]] auto offsets(std::size_t ring) const -> ring_header&;
+  [[nodiscard]] auto records(std::size_t ring) const -> std::byte*;
+
+  int fd;
+  file_header* header;
+  std::size_t snap_length;
+
+  // Tells this capture apart from those before it, in the threads' claims.
+  std::uint64_t id;
+
+  clock::time_point started = clock::now();
+
+  std::atomic<std::uint32_t> next_session = 1;
+  std::atomic<std::size_t> next_ring = 0;
+
+  // Guards the last ring, shared by the threads left without one.
+  std::mutex shared_writer;
+};
+
+inline auto capture_session::record(std::span<const std::byte> data) -> void {
+  if (owner != nullptr && !data.empty()) {
+    owner->record(record_kind::DATA, id, data);
+  }
+}
+
+struct captured_record {
+  std::chrono::nanoseconds timestamp = {};
+  std::uint32_t session = {};
+  record_kind kind = record_kind::DATA;
+
+  std::uint32_t original_size = {};
+  std::vector<std::byte> data;
+};
+
+struct capture_log {
+  std::chrono::system_clock::time_point started;
+
+  // Oldest first, without padding.
+  std::vector<captured_record> records;
+};
+
+// Reads back the records left in a capture file.
+[[nodiscard]] auto read_capture(const std::string& path) -> capture_log;
+
+} // namespace mori_echo::capture
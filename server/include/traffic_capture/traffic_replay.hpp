@@ -0,0 +1,34 @@
+#pragma once
+
+#include <boost/asio/ip/tcp.hpp>
+#include <cstddef>
+
+#include "traffic_capture/traffic_capture.hpp"
+
+namespace mori_echo::capture {
+
+struct replay_options {
+  // Speed relative to the capture: 1 keeps the original pace, 2 halves the
+  // gaps between records. 0 sends every record as soon as possible.
+  double speed = 1.0;
+};
+
+struct replay_stats {
+  std::size_t sessions = {};
+
+  // Sessions dropped by the server before their last record was sent.
+  std::size_t failed_sessions = {};
+
+  std::size_t bytes_sent = {};
+  std::size_t bytes_received = {};
+};
+
+// Replays every captured session on a connection of its own, opened, fed and
+// closed at the times recorded, so that as many are open at once as were in
+// the capture. Data truncated by the snap length is padded back to its
+// original size with zeros. Blocks until every session is over.
+[[nodiscard]] auto replay(const capture_log& log,
+                          const boost::asio::ip::tcp::endpoint& server,
+                          const replay_options& options = {}) -> replay_stats;
+
+} // namespace mori_echo::capture
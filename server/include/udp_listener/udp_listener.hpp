@@ -0,0 +1,17 @@
+#pragma once
+
+#include <boost/asio/any_io_executor.hpp>
+#include <boost/asio/awaitable.hpp>
+
+#include "echo_server/echo_server_config.hpp"
+
+namespace mori_echo {
+
+// Serves echo probes over UDP. Each datagram carries a `login_request` frame
+// immediately followed by an `echo_request` frame, and is answered by a single
+// `echo_response` datagram, or a failed `login_response` one.
+[[nodiscard]] auto udp_listen(boost::asio::any_io_executor executor,
+                              echo_server_config cfg)
+    -> boost::asio::awaitable<void>;
+
+} // namespace mori_echo
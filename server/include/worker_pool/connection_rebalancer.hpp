@@ -0,0 +1,106 @@
+#pragma once
+
+#include <atomic>
+#include <boost/asio/any_io_executor.hpp>
+#include <boost/asio/awaitable.hpp>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <vector>
+
+#include "worker_pool.hpp"
+
+namespace mori_echo {
+
+struct rebalancer_options {
+  // How often the load of the workers is compared.
+  std::chrono::nanoseconds interval = std::chrono::seconds{1};
+
+  // Sessions move off the busiest worker once it handles this many times the
+  // messages of the idlest one over an interval...
+  double imbalance_ratio = 1.5;
+
+  // ...and at least this many.
+  std::uint64_t min_messages = 1000;
+
+  // Sessions moved off the busiest worker per interval. Moving few at a time
+  // lets the next interval see their effect before moving more.
+  std::size_t migrations_per_interval = 1;
+};
+
+// Moves sessions off workers busier than the others, since a session stays on
+// the worker which accepted it for its whole life otherwise. Workers count the
+// messages they handle, and sessions of an overloaded worker pick up pending
+// migrations between two messages. The sessions handling the most messages
+// reach that point the most often, so they are the likeliest to move.
+class [[nodiscard]] connection_rebalancer
+    : public std::enable_shared_from_this<connection_rebalancer> {
+public:
+  [[nodiscard]] static auto create(std::shared_ptr<worker_pool> workers,
+                                   rebalancer_options options = {})
+      -> std::shared_ptr<connection_rebalancer>;
+
+  connection_rebalancer(const connection_rebalancer&) = delete;
+  connection_rebalancer& operator=(const connection_rebalancer&) = delete;
+
+  // Compares the load of the workers on `executor`, until stopped.
+  auto start(boost::asio::any_io_executor executor) -> void;
+
+  // Ends the comparisons at their next interval.
+  auto stop() -> void;
+
+  // Counts a message handled on `worker`, from that worker's thread.
+  auto record_message(std::size_t worker) -> void;
+
+  // The worker a session of `worker` should move to, if any, taking one of
+  // the migrations pending on it.
+  [[nodiscard]] auto take_migration(std::size_t worker)
+      -> std::optional<std::size_t>;
+
+  // Sessions moved onto and off `worker` so far.
+  [[nodiscard]] auto migrations_in(std::size_t worker) const -> std::uint64_t;
+  [[nodiscard]] auto migrations_out(std::size_t worker) const
+      -> std::uint64_t;
+
+  // Messages `worker` handled over the latest interval.
+  [[nodiscard]] auto load(std::size_t worker) const -> std::uint64_t;
+
+  [[nodiscard]] auto pool() const -> const std::shared_ptr<worker_pool>&;
+
+private:
+  // Written by the thread of its worker, on a cache line of its own.
+  struct alignas(64) worker_load {
+    std::atomic<std::uint64_t> messages = 0;
+
+    std::atomic<std::uint64_t> migrations_in = 0;
+    std::atomic<std::uint64_t> migrations_out = 0;
+
+    // Set by the comparisons.
+    std::atomic<std::uint64_t> latest_load = 0;
+    std::atomic<std::int64_t> pending_migrations = 0;
+    std::atomic<std::size_t> migration_target = 0;
+  };
+
+  connection_rebalancer(std::shared_ptr<worker_pool> workers,
+                        rebalancer_options options);
+
+  [[nodiscard]] static auto
+  compare_loads(std::shared_ptr<connection_rebalancer> rebalancer)
+      -> boost::asio::awaitable<void>;
+
+  auto rebalance() -> void;
+
+  std::shared_ptr<worker_pool> workers;
+  rebalancer_options options;
+
+  std::vector<worker_load> loads;
+
+  // Message counts at the previous comparison. Only touched by it.
+  std::vector<std::uint64_t> previous_messages;
+
+  std::atomic<bool> is_stopped = false;
+};
+
+} // namespace mori_echo
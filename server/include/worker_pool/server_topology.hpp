@@ -0,0 +1,46 @@
+#pragma once
+
+#include <cstddef>
+#include <filesystem>
+#include <optional>
+#include <string_view>
+#include <vector>
+
+namespace mori_echo {
+
+// CPUs a thread may run on, and the NUMA node its memory should come from.
+struct cpu_placement {
+  std::vector<unsigned> cpus;
+
+  // Unset when the CPUs span nodes, or the node is unknown.
+  std::optional<unsigned> numa_node = std::nullopt;
+};
+
+// Where the acceptor and each worker thread of the server run.
+struct server_topology {
+  // Unpinned when it has no CPUs.
+  cpu_placement acceptor;
+
+  std::vector<cpu_placement> workers;
+
+  // Parses a layout of `;`-separated entries, each a CPU list in the sysfs
+  // format like `0-3,8`: `acceptor=<cpus>` pins the acceptor, and any other
+  // entry adds a worker pinned to those CPUs. For example `acceptor=0;1;2-3`
+  // runs two workers, on CPU 1 and on CPUs 2 and 3.
+  [[nodiscard]] static auto parse(std::string_view layout,
+                                  const std::filesystem::path& sysfs_root =
+                                      "/sys") -> server_topology;
+
+  // Runs a worker on each online CPU, except for the first
+  // `reserved_acceptor_cores` of them, which are left to the acceptor.
+  [[nodiscard]] static auto
+  detect(std::size_t reserved_acceptor_cores = 0,
+         const std::filesystem::path& sysfs_root = "/sys") -> server_topology;
+};
+
+// Parses a CPU list in the sysfs format, like `0-3,8,10-11`. CPUs must be
+// below `CPU_SETSIZE`.
+[[nodiscard]] auto parse_cpu_list(std::string_view list)
+    -> std::vector<unsigned>;
+
+} // namespace mori_echo
@@ -0,0 +1,70 @@
+#pragma once
+
+#include <atomic>
+#include <boost/asio/any_io_executor.hpp>
+#include <boost/asio/executor_work_guard.hpp>
+#include <boost/asio/io_context.hpp>
+#include <cstddef>
+#include <memory>
+#include <optional>
+#include <thread>
+#include <vector>
+
+#include "server_topology.hpp"
+
+namespace mori_echo {
+
+// Pins the calling thread to the CPUs of `placement`, and makes its memory
+// come from the placement's NUMA node when it has one.
+auto apply_placement(const cpu_placement& placement) -> void;
+
+// Worker threads, each running its own io_context on the CPUs of a worker
+// placement. Clients handed to a worker stay on it for their whole session,
+// unless a `connection_rebalancer` moves them.
+class [[nodiscard]] worker_pool {
+public:
+  [[nodiscard]] static auto create(const server_topology& topology)
+      -> std::shared_ptr<worker_pool>;
+
+  worker_pool(const worker_pool&) = delete;
+  worker_pool& operator=(const worker_pool&) = delete;
+
+  ~worker_pool();
+
+  // Executor of the next worker, in turns.
+  [[nodiscard]] auto next_executor() -> boost::asio::any_io_executor;
+
+  [[nodiscard]] auto size() const -> std::size_t;
+
+  // Executor of the worker at `index`, below `size()`.
+  [[nodiscard]] auto executor(std::size_t index)
+      -> boost::asio::any_io_executor;
+
+  // Index of the worker running the calling thread, unless it is not one of
+  // this pool's.
+  [[nodiscard]] auto this_worker() const -> std::optional<std::size_t>;
+
+  // Stops the workers, abandoning their clients, and waits for them.
+  auto stop() -> void;
+
+private:
+  worker_pool() = default;
+
+  struct worker {
+    boost::asio::io_context context{1};
+
+    boost::asio::executor_work_guard<boost::asio::io_context::executor_type>
+        work = boost::asio::make_work_guard(context);
+
+    std::thread thread;
+  };
+
+  // The pool and index of the worker running this thread.
+  static thread_local const worker_pool* current_pool;
+  static thread_local std::size_t current_worker;
+
+  std::vector<std::unique_ptr<worker>> workers;
+  std::atomic<std::size_t> next_worker = 0;
+};
+
+} // namespace mori_echo
@@ -0,0 +1,56 @@
+#include "client_channel/payload_pool.hpp"
+
+namespace mori_echo {
+
+struct pooled_payloads {
+  std::vector<std::vector<std::byte>> buffers;
+
+  // So that handing a buffer back never allocates.
+  pooled_payloads() { buffers.reserve(max_pooled_payloads); }
+};
+
+thread_local auto thread_payloads = pooled_payloads{};
+
+auto payload_pool::acquire(std::size_t size) -> std::vector<std::byte> {
+  auto& buffers = thread_payloads.buffers;
+
+  // The smallest that fits, so that small payloads leave large buffers to
+  // large ones.
+  auto found = buffers.end();
+
+  for (auto each = buffers.begin(); each != buffers.end(); ++each) {
+    if (each->capacity() >= size &&
+        (found == buffers.end() || each->capacity() < found->capacity())) {
+      found = each;
+    }
+  }
+
+  if (found == buffers.end()) {
+    return std::vector<std::byte>(size, std::byte{});
+  }
+
+  auto buffer = std::move(*found);
+  buffers.erase(found);
+
+  buffer.resize(size);
+
+  return buffer;
+}
+
+auto payload_pool::release(std::vector<std::byte> buffer) -> void {
+  auto& buffers = thread_payloads.buffers;
+
+  if (buffer.capacity() == 0 || buffer.capacity() > max_pooled_payload_size ||
+      buffers.size() >= max_pooled_payloads) {
+    return;
+  }
+
+  buffer.clear();
+  buffers.push_back(std::move(buffer));
+}
+
+auto payload_pool::size() -> std::size_t {
+  return thread_payloads.buffers.size();
+}
+
+} // namespace mori_echo
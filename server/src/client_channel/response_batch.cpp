@@ -0,0 +1,123 @@
+#include "client_channel/response_batch.hpp"
+
+#include "client_channel/payload_pool.hpp"
+
+namespace mori_echo {
+
+auto coalescing_counters::create() -> std::shared_ptr<coalescing_counters> {
+  return std::shared_ptr<coalescing_counters>{new coalescing_counters{}};
+}
+
+auto coalescing_counters::record(std::uint64_t responses,
+                                 std::uint64_t send_calls) -> void {
+  response_count.fetch_add(responses, std::memory_order_relaxed);
+  send_call_count.fetch_add(send_calls, std::memory_order_relaxed);
+}
+
+auto coalescing_counters::responses() const -> std::uint64_t {
+  return response_count.load(std::memory_order_relaxed);
+}
+
+auto coalescing_counters::send_calls() const -> std::uint64_t {
+  return send_call_count.load(std::memory_order_relaxed);
+}
+
+auto coalescing_counters::responses_per_call() const -> double {
+  const auto calls = send_calls();
+
+  return calls == 0 ? 0.0
+                    : static_cast<double>(responses()) /
+                          static_cast<double>(calls);
+}
+
+response_batch::~response_batch() { release_payloads(); }
+
+auto response_batch::add(std::span<const std::byte> prefix,
+                         std::vector<std::byte> payload) -> void {
+  if (responses.empty()) {
+    first_held = std::chrono::steady_clock::now();
+  }
+
+  held_bytes += prefix.size() + payload.size();
+
+  copied.insert(copied.end(), prefix.begin(), prefix.end());
+
+  if (payload.size() <= max_copied_payload_size) {
+    copied.insert(copied.end(), payload.begin(), payload.end());
+    payload_pool::release(std::move(payload));
+
+    payload = {};
+  }
+
+  responses.push_back({
+      .copied_end = copied.size(),
+      .payload = std::move(payload),
+  });
+}
+
+auto response_batch::should_hold(bool is_input_buffered) const -> bool {
+  return is_input_buffered && held_bytes < options.max_bytes &&
+         std::chrono::steady_clock::now() - first_held < options.max_delay;
+}
+
+auto response_batch::buffers() -> std::span<boost::asio::const_buffer> {
+  gathered.clear();
+
+  // Copied bytes are contiguous up to the next payload taken.
+  auto copied_start = std::size_t{0};
+
+  for (const auto& each : responses) {
+    if (each.payload.empty()) {
+      continue;
+    }
+
+    gathered.emplace_back(copied.data() + copied_start,
+                          each.copied_end - copied_start);
+    gathered.emplace_back(each.payload.data(), each.payload.size());
+
+    copied_start = each.copied_end;
+  }
+
+  if (copied_start < copied.size()) {
+    gathered.emplace_back(copied.data() + copied_start,
+                          copied.size() - copied_start);
+  }
+
+  return gathered;
+}
+
+auto response_batch::clear(std::uint64_t send_calls) -> void {
+  if (options.counters) {
+    options.counters->record(responses.size(), send_calls);
+  }
+
+  release_payloads();
+
+  responses.clear();
+  copied.clear();
+  held_bytes = 0;
+
+  if (capacity() > retained_batch_capacity) {
+    release_storage();
+  }
+}
+
+auto response_batch::release_storage() -> void {
+  // Assigning `{}` would keep the capacity.
+  responses = std::vector<held_response>{};
+  copied = std::vector<std::byte>{};
+  gathered = std::vector<boost::asio::const_buffer>{};
+}
+
+auto response_batch::capacity() const -> std::size_t {
+  return responses.capacity() * sizeof(held_response) + copied.capacity() +
+         gathered.capacity() * sizeof(boost::asio::const_buffer);
+}
+
+auto response_batch::release_payloads() -> void {
+  for (auto& each : responses) {
+    payload_pool::release(std::move(each.payload));
+  }
+}
+
+} // namespace mori_echo
@@ -0,0 +1,100 @@
+#include "client_channel/splice_pipe.hpp"
+
+#include <boost/system/system_error.hpp>
+#include <cerrno>
+#include <fcntl.h>
+#include <unistd.h>
+#include <vector>
+
+namespace mori_echo {
+
+struct pipe_fds {
+  int read_fd = -1;
+  int write_fd = -1;
+
+  std::size_t size = 0;
+};
+
+auto close_pipe(const pipe_fds& fds) -> void {
+  ::close(fds.read_fd);
+  ::close(fds.write_fd);
+}
+
+// Pipes of a thread, closed when it ends.
+struct free_pipes {
+  std::vector<pipe_fds> pipes;
+
+  // So that handing a pipe back never allocates.
+  free_pipes() { pipes.reserve(max_free_splice_pipes); }
+
+  ~free_pipes() {
+    for (const auto& each : pipes) {
+      close_pipe(each);
+    }
+  }
+};
+
+thread_local auto thread_pipes = free_pipes{};
+
+auto splice_pipe::acquire() -> splice_pipe {
+  auto& pipes = thread_pipes.pipes;
+
+  if (!pipes.empty()) {
+    const auto fds = pipes.back();
+    pipes.pop_back();
+
+    return splice_pipe{fds.read_fd, fds.write_fd, fds.size};
+  }
+
+  int fds[2] = {};
+
+  if (::pipe2(fds, O_CLOEXEC | O_NONBLOCK) != 0) {
+    throw boost::system::system_error{
+        boost::system::error_code{errno, boost::system::system_category()},
+        "pipe2"};
+  }
+
+  // Keeps the kernel's default size if refused.
+  ::fcntl(fds[1], F_SETPIPE_SZ, static_cast<int>(splice_pipe_size));
+
+  const auto size = ::fcntl(fds[1], F_GETPIPE_SZ);
+
+  if (size <= 0) {
+    const auto error = errno;
+
+    close_pipe({.read_fd = fds[0], .write_fd = fds[1]});
+
+    throw boost::system::system_error{
+        boost::system::error_code{error, boost::system::system_category()},
+        "fcntl"};
+  }
+
+  return splice_pipe{fds[0], fds[1], static_cast<std::size_t>(size)};
+}
+
+splice_pipe::splice_pipe(splice_pipe&& other) noexcept
+    : buffered{other.buffered}, read_fd{other.read_fd},
+      write_fd{other.write_fd}, size{other.size} {
+  other.read_fd = -1;
+  other.write_fd = -1;
+}
+
+splice_pipe::~splice_pipe() {
+  if (read_fd < 0) {
+    return;
+  }
+
+  const auto fds =
+      pipe_fds{.read_fd = read_fd, .write_fd = write_fd, .size = size};
+
+  auto& pipes = thread_pipes.pipes;
+
+  if (buffered > 0 || pipes.size() >= max_free_splice_pipes) {
+    close_pipe(fds);
+    return;
+  }
+
+  pipes.push_back(fds);
+}
+
+} // namespace mori_echo
@@ -0,0 +1,216 @@
+#include "client_channel/zerocopy_sender.hpp"
+
+#include <algorithm>
+#include <cerrno>
+#include <linux/errqueue.h>
+#include <mutex>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/socket.h>
+
+#include "client_channel/payload_pool.hpp"
+
+namespace mori_echo {
+
+auto zerocopy_counters::create() -> std::shared_ptr<zerocopy_counters> {
+  return std::shared_ptr<zerocopy_counters>{new zerocopy_counters{}};
+}
+
+auto zerocopy_counters::record(zerocopy_outcome outcome) -> void {
+  counts[static_cast<std::size_t>(outcome)].fetch_add(
+      1, std::memory_order_relaxed);
+}
+
+auto zerocopy_counters::count(zerocopy_outcome outcome) const
+    -> std::uint64_t {
+  return counts[static_cast<std::size_t>(outcome)].load(
+      std::memory_order_relaxed);
+}
+
+auto zerocopy_counters::record_abandoned(std::size_t bytes) -> void {
+  abandoned.fetch_add(bytes, std::memory_order_relaxed);
+}
+
+auto zerocopy_counters::abandoned_bytes() const -> std::uint64_t {
+  return abandoned.load(std::memory_order_relaxed);
+}
+
+// Keeps payloads the kernel may still read allocated for good, out of any
+// pool. Only ever reached by connections closing with data stuck in flight.
+auto abandon(std::vector<std::byte> payload) -> void {
+  static auto lock = std::mutex{};
+  static auto* abandoned = new std::vector<std::vector<std::byte>>{};
+
+  const auto guard = std::scoped_lock{lock};
+  abandoned->push_back(std::move(payload));
+}
+
+auto zerocopy_sender::create(int fd, zerocopy_options options)
+    -> std::unique_ptr<zerocopy_sender> {
+  const auto enable = 1;
+
+  if (::setsockopt(fd, SOL_SOCKET, SO_ZEROCOPY, &enable, sizeof(enable)) !=
+      0) {
+    return nullptr;
+  }
+
+  return std::unique_ptr<zerocopy_sender>{
+      new zerocopy_sender{fd, std::move(options)}};
+}
+
+zerocopy_sender::~zerocopy_sender() {
+  using clock = std::chrono::steady_clock;
+
+  reap();
+
+  const auto deadline = clock::now() + options.drain_timeout;
+
+  while (!pinned.empty()) {
+    const auto left = std::chrono::ceil<std::chrono::milliseconds>(
+        deadline - clock::now());
+
+    if (left.count() <= 0) {
+      break;
+    }
+
+    // Notifications on the error queue are reported as POLLERR.
+    auto descriptor = ::pollfd{.fd = fd, .events = 0, .revents = 0};
+    const auto ready = ::poll(&descriptor, 1, static_cast<int>(left.count()));
+
+    if (ready < 0 && errno != EINTR) {
+      break;
+    }
+
+    const auto pinned_before = pinned.size();
+    reap();
+
+    // Also ready on other errors, and once hung up, with nothing left to
+    // wait on.
+    if (ready > 0 && pinned.size() == pinned_before) {
+      break;
+    }
+  }
+
+  for (auto& each : pinned) {
+    if (options.counters) {
+      options.counters->record_abandoned(each.payload.size());
+    }
+
+    abandon(std::move(each.payload));
+  }
+}
+
+auto zerocopy_sender::reap() -> void {
+  while (!pinned.empty()) {
+    alignas(cmsghdr) char control[CMSG_SPACE(sizeof(sock_extended_err)) +
+                                  CMSG_SPACE(sizeof(sockaddr_in6))] = {};
+
+    auto message = msghdr{};
+    message.msg_control = control;
+    message.msg_controllen = sizeof(control);
+
+    if (::recvmsg(fd, &message, MSG_ERRQUEUE | MSG_DONTWAIT) < 0) {
+      return;
+    }
+
+    for (auto* each = CMSG_FIRSTHDR(&message); each != nullptr;
+         each = CMSG_NXTHDR(&message, each)) {
+      const auto is_error =
+          (each->cmsg_level == SOL_IP && each->cmsg_type == IP_RECVERR) ||
+          (each->cmsg_level == SOL_IPV6 && each->cmsg_type == IPV6_RECVERR);
+
+      if (!is_error) {
+        continue;
+      }
+
+      const auto* error =
+          reinterpret_cast<const sock_extended_err*>(CMSG_DATA(each));
+
+      if (error->ee_errno != 0 || error->ee_origin != SO_EE_ORIGIN_ZEROCOPY) {
+        continue;
+      }
+
+      complete(error->ee_info, error->ee_data,
+               (error->ee_code & SO_EE_CODE_ZEROCOPY_COPIED) != 0);
+    }
+  }
+}
+
+auto zerocopy_sender::complete(std::uint32_t first_id, std::uint32_t last_id,
+                               bool was_copied) -> void {
+  for (auto& each : pinned) {
+    // Relative to the payload's first id, across wrap-arounds.
+    const auto first = std::int64_t{
+        static_cast<std::int32_t>(first_id - each.first_id)};
+    const auto last =
+        std::int64_t{static_cast<std::int32_t>(last_id - each.first_id)};
+
+    const auto overlap = std::min<std::int64_t>(last, each.id_count - 1) -
+                         std::max<std::int64_t>(first, 0) + 1;
+
+    if (overlap > 0) {
+      each.pending_ids -= static_cast<std::uint32_t>(overlap);
+      each.was_copied = each.was_copied || was_copied;
+    }
+  }
+
+  std::erase_if(pinned, [this](pinned_payload& each) {
+    if (each.pending_ids > 0) {
+      return false;
+    }
+
+    if (!each.is_recorded) {
+      record(each.was_copied ? zerocopy_outcome::KERNEL_COPIED
+                             : zerocopy_outcome::ZERO_COPIED);
+    }
+
+    pinned_bytes -= each.payload.size();
+    payload_pool::release(std::move(each.payload));
+
+    return true;
+  });
+}
+
+auto zerocopy_sender::try_reserve(std::size_t size) -> bool {
+  if (pinned_bytes + size <= options.max_pinned) {
+    return true;
+  }
+
+  record(zerocopy_outcome::SEND_COPIED);
+
+  return false;
+}
+
+auto zerocopy_sender::pin(std::vector<std::byte> payload,
+                          std::uint32_t send_calls, bool is_partly_copied)
+    -> void {
+  if (is_partly_copied) {
+    record(zerocopy_outcome::SEND_COPIED);
+  }
+
+  const auto first_id = next_id;
+  next_id += send_calls;
+
+  if (send_calls == 0) {
+    payload_pool::release(std::move(payload));
+    return;
+  }
+
+  pinned_bytes += payload.size();
+
+  pinned.push_back({
+      .first_id = first_id,
+      .id_count = send_calls,
+      .pending_ids = send_calls,
+      .is_recorded = is_partly_copied,
+      .payload = std::move(payload),
+  });
+}
+
+auto zerocopy_sender::record(zerocopy_outcome outcome) -> void {
+  if (options.counters) {
+    options.counters->record(outcome);
+  }
+}
+
+} // namespace mori_echo
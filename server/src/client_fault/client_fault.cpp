@@ -0,0 +1,66 @@
+#include "client_fault/client_fault.hpp"
+
+#include <boost/asio/error.hpp>
+
+namespace mori_echo {
+
+auto describe(drop_reason reason) -> std::string_view {
+  switch (reason) {
+    case drop_reason::DISCONNECTED:
+      return "The client disconnected.";
+    case drop_reason::CONNECTION_ERROR:
+      return "Connection error.";
+    case drop_reason::MALFORMED_FRAME:
+      return "Malformed frame.";
+    case drop_reason::WRONG_MESSAGE_TYPE:
+      return "Wrong message type.";
+    case drop_reason::MESSAGE_TOO_LONG:
+      return "Message too long.";
+    case drop_reason::SIZE_MISMATCH:
+      return "Message size mismatch.";
+    case drop_reason::UNEXPECTED_MESSAGE:
+      return "The client should never send this message.";
+    case drop_reason::ALREADY_LOGGED_IN:
+      return "The client is already logged in.";
+    case drop_reason::NOT_LOGGED_IN:
+      return "The client is not logged in.";
+    case drop_reason::LOGIN_FAILED:
+      return "The client login failed.";
+    case drop_reason::OVERLOADED:
+      return "Server overloaded.";
+    case drop_reason::RATE_LIMITED:
+      return "The client exceeded its rate limits.";
+    case drop_reason::SERVER_ERROR:
+      return "Server error.";
+  }
+
+  return "Unknown reason.";
+}
+
+auto make_fault(drop_reason reason) -> client_fault {
+  return {.reason = reason, .detail = describe(reason)};
+}
+
+auto make_fault(const boost::system::error_code& error) -> client_fault {
+  const auto reason = error == boost::asio::error::eof
+                          ? drop_reason::DISCONNECTED
+                          : drop_reason::CONNECTION_ERROR;
+
+  return {.reason = reason, .detail = describe(reason), .error = error};
+}
+
+auto drop_counters::create() -> std::shared_ptr<drop_counters> {
+  return std::shared_ptr<drop_counters>{new drop_counters{}};
+}
+
+auto drop_counters::record(drop_reason reason) -> void {
+  counts[static_cast<std::size_t>(reason)].fetch_add(1,
+                                                     std::memory_order_relaxed);
+}
+
+auto drop_counters::count(drop_reason reason) const -> std::uint64_t {
+  return counts[static_cast<std::size_t>(reason)].load(
+      std::memory_order_relaxed);
+}
+
+} // namespace mori_echo
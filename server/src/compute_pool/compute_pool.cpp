@@ -0,0 +1,51 @@
+#include "compute_pool/compute_pool.hpp"
+
+#include <algorithm>
+
+namespace mori_echo {
+
+auto compute_pool::create(std::size_t thread_count,
+                          std::size_t max_queue_depth)
+    -> std::shared_ptr<compute_pool> {
+  return std::shared_ptr<compute_pool>{new compute_pool{
+      std::max(thread_count, std::size_t{1}), max_queue_depth}};
+}
+
+compute_pool::~compute_pool() { threads.join(); }
+
+auto compute_pool::metrics() const -> compute_pool_metrics {
+  return {
+      .offloaded = offloaded.load(std::memory_order_relaxed),
+      .ran_inline = ran_inline.load(std::memory_order_relaxed),
+      .queue_depth = queue_depth.load(std::memory_order_relaxed),
+      .peak_queue_depth = peak_queue_depth.load(std::memory_order_relaxed),
+  };
+}
+
+auto compute_pool::try_enqueue() -> bool {
+  auto depth = queue_depth.load(std::memory_order_relaxed);
+
+  do {
+    if (depth >= max_queue_depth) {
+      return false;
+    }
+  } while (!queue_depth.compare_exchange_weak(depth, depth + 1,
+                                              std::memory_order_relaxed));
+
+  offloaded.fetch_add(1, std::memory_order_relaxed);
+
+  auto peak = peak_queue_depth.load(std::memory_order_relaxed);
+
+  while (peak < depth + 1 &&
+         !peak_queue_depth.compare_exchange_weak(peak, depth + 1,
+                                                 std::memory_order_relaxed)) {
+  }
+
+  return true;
+}
+
+auto compute_pool::dequeue() -> void {
+  queue_depth.fetch_sub(1, std::memory_order_relaxed);
+}
+
+} // namespace mori_echo
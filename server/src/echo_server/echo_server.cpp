@@ -2,16 +2,27 @@
 
 #include <boost/asio/co_spawn.hpp>
 #include <boost/asio/ip/tcp.hpp>
-#include <boost/uuid/uuid_generators.hpp>
-#include <boost/uuid/uuid_io.hpp>
+#include <boost/asio/local/stream_protocol.hpp>
+#include <boost/asio/post.hpp>
+#include <boost/asio/redirect_error.hpp>
+#include <boost/asio/steady_timer.hpp>
+#include <boost/endian/conversion.hpp>
+#include <cassert>
+#include <chrono>
 #include <exception>
+#include <limits>
+#include <optional>
 #include <spdlog/fmt/bin_to_hex.h>
 #include <spdlog/spdlog.h>
+#include <unistd.h>
 
 #include "client_channel/client_channel.hpp"
+#include "client_channel/payload_pool.hpp"
 #include "client_crypto/client_crypto.hpp"
+#include "client_fault/client_fault.hpp"
 #include "client_session/client_session.hpp"
-#include "exceptions/client_error.hpp"
+#include "flight_recorder/flight_recorder.hpp"
+#include "latency_tracer/latency_tracer.hpp"
 #include "message_receiver/message_receiver.hpp"
 #include "message_sender/message_sender.hpp"
 #include "message_types/echo_request.hpp"
@@ -19,6 +30,8 @@
 #include "message_types/login_request.hpp"
 #include "message_types/login_response.hpp"
 #include "mori_status/login_status.hpp"
+#include "shm_listener/shm_listener.hpp"
+#include "udp_listener/udp_listener.hpp"
 
 namespace mori_echo {
 
@@ -27,6 +40,18 @@ namespace mori_echo {
   return logger;
 }
 
+// Config of a listener, owned by the listener and each of its sessions
+// together. Sessions may outlive their listener: its accept loop may fail,
+// or it may be destroyed along with its loop while they carry on in the
+// loops of the workers.
+using shared_config = std::shared_ptr<const echo_server_config>;
+
+// Sessions in flight recorder events, by the first half of their UUID, which
+// prints as the first 16 digits of its text form.
+[[nodiscard]] auto flight_id(const client_session& session) -> std::uint64_t {
+  return boost::endian::load_big_u64(session.uuid.data);
+}
+
 auto log_client_error(const std::exception& error,
                       const client_session& session, int level = 0) -> void {
   if (level == 0) {
@@ -44,8 +69,35 @@ auto log_client_error(const std::exception& error,
   }
 }
 
+auto log_client_fault(const client_fault& fault, const client_session& session)
+    -> void {
+  switch (fault.reason) {
+    case drop_reason::DISCONNECTED:
+      logger()->info("Client {} disconnected.", session.uuid);
+      return;
+
+    case drop_reason::CONNECTION_ERROR:
+      logger()->warn("Dropping client {}. Reason: {}", session.uuid,
+                     fault.error.message());
+      return;
+
+    default:
+      logger()->warn("Dropping client {}. Reason: {}", session.uuid,
+                     fault.detail);
+  }
+
+  if (!fault.cause.empty()) {
+    logger()->warn(" Caused by: {}", fault.cause);
+  }
+}
+
 auto log_decrypted_message(const client_session& session,
                            const std::vector<std::byte>& plain) -> void {
+  // Spares every echo the copy below, as debug logs are usually off.
+  if (!logger()->should_log(spdlog::level::debug)) {
+    return;
+  }
+
   auto text = std::vector<char>{};
   text.reserve(plain.size());
 
@@ -62,156 +114,993 @@ auto log_encrypted_message(const client_session& session,
                   spdlog::to_hex(encrypted));
 }
 
-[[nodiscard]] auto handle_authenticated_client(client_channel& channel,
-                                               client_session& session,
-                                               const echo_server_config& cfg)
-    -> boost::asio::awaitable<void> {
-  auto header = co_await receive_header(channel);
+template <typename Decrypt, typename AsyncStream>
+[[nodiscard]] auto
+handle_streamed_echo(basic_client_channel<AsyncStream>& channel,
+                     client_session& session, const echo_server_config& cfg,
+                     messages::message_header header, echo_trace& trace)
+    -> boost::asio::awaitable<client_result<void>> {
+  const auto sequence = header.sequence;
+  const auto is_extended = header.is_extended;
 
-  switch (header.type) {
-    case messages::message_type::ECHO_REQUEST: {
-      const auto echo = co_await receive_message<messages::echo_request>(
-          channel, std::move(header));
+  auto message_size = co_await receive_echo_size(channel, std::move(header),
+                                                 cfg.max_message_size);
 
-      if (cfg.enable_decryption) {
-        const auto plain_message = crypto::decrypt(
-            {
-                .username_sum = session.username_sum,
-                .password_sum = session.password_sum,
-                .sequence = echo.header.sequence,
-            },
-            std::move(echo.cipher_message));
+  if (!message_size) {
+    co_return std::move(message_size).fault();
+  }
 
-        log_decrypted_message(session, plain_message);
+  logger()->debug("Streaming echo of {} bytes from {}", *message_size,
+                  session.uuid);
 
-        co_await send_message<messages::echo_response>{}(
-            channel, echo.header.sequence, plain_message);
-      } else {
-        log_encrypted_message(session, echo.cipher_message);
+  if (auto sent = co_await send_echo_header(channel, sequence, *message_size,
+                                            is_extended);
+      !sent) {
+    co_return sent;
+  }
+
+  auto state = crypto::make_cipher_state({
+      .username_sum = session.username_sum,
+      .password_sum = session.password_sum,
+      .sequence = sequence,
+  });
+
+  auto buffer = payload_pool::acquire(
+      std::min(std::max(cfg.stream_chunk_size, std::size_t{1}),
+               std::size_t{*message_size}));
+
+  auto error = boost::system::error_code{};
 
-        co_await send_message<messages::echo_response>{}(
-            channel, echo.header.sequence, echo.cipher_message);
+  for (auto remaining = std::size_t{*message_size}; remaining > 0;) {
+    const auto received = co_await channel.receive_some(
+        std::span{buffer}.first(std::min(remaining, buffer.size())), error);
+
+    if (error) {
+      break;
+    }
+
+    const auto chunk = std::span{buffer}.first(received);
+
+    // Points past the read are those of the last chunk.
+    const auto is_last = chunk.size() == remaining;
+
+    if (is_last) {
+      trace.mark<trace_point::FRAME_COMPLETE>();
+    }
+
+    if constexpr (Decrypt::is_decrypting) {
+      crypto::decrypt_chunk(state, chunk);
+
+      if (is_last) {
+        trace.mark<trace_point::DECRYPT_DONE>();
       }
-    } break;
+    }
+
+    if (is_last) {
+      trace.mark<trace_point::WRITE_ISSUED>();
+    }
+
+    co_await channel.send(chunk, error);
+
+    if (error) {
+      break;
+    }
+
+    remaining -= chunk.size();
+  }
+
+  payload_pool::release(std::move(buffer));
+
+  if (error) {
+    co_return make_fault(error);
+  }
+
+  trace.mark<trace_point::WRITE_COMPLETE>();
+
+  co_return client_result<void>{};
+}
+
+// Echoes a payload without it entering user space: the response header is
+// written, then the payload is spliced from the socket back into it.
+template <typename AsyncStream>
+[[nodiscard]] auto
+handle_spliced_echo(basic_client_channel<AsyncStream>& channel,
+                    client_session& session, const echo_server_config& cfg,
+                    messages::message_header header, echo_trace& trace)
+    -> boost::asio::awaitable<client_result<void>> {
+  const auto sequence = header.sequence;
+  const auto is_extended = header.is_extended;
+
+  auto message_size = co_await receive_echo_size(channel, std::move(header),
+                                                 cfg.max_message_size);
+
+  if (!message_size) {
+    co_return std::move(message_size).fault();
+  }
+
+  logger()->debug("Splicing echo of {} bytes from {}", *message_size,
+                  session.uuid);
+
+  if (auto sent = co_await send_echo_header(channel, sequence, *message_size,
+                                            is_extended);
+      !sent) {
+    co_return sent;
+  }
+
+  // The payload is written as it is read, with nothing in between.
+  trace.mark<trace_point::WRITE_ISSUED>();
+
+  auto error = boost::system::error_code{};
+  co_await channel.splice_back(*message_size, error);
+
+  if (error) {
+    co_return make_fault(error);
+  }
+
+  trace.mark<trace_point::WRITE_COMPLETE>();
+
+  co_return client_result<void>{};
+}
+
+// Captured channels must see their payloads, so they are never spliced. Nor
+// are payloads to decrypt, which the handler leaves out of this check.
+template <typename AsyncStream>
+[[nodiscard]] auto is_spliced(const basic_client_channel<AsyncStream>& channel,
+                              const echo_server_config& cfg,
+                              const messages::message_header& header)
+    -> bool {
+  return cfg.enable_splice &&
+         header.total_size >= cfg.splice_threshold && !channel.is_capturing();
+}
+
+[[nodiscard]] auto is_offloaded(const echo_server_config& cfg,
+                                std::size_t message_size) -> bool {
+  return cfg.compute && message_size >= cfg.offload_threshold;
+}
+
+// Decrypts large messages on the compute pool, if any, so that the IO thread
+// keeps serving its other clients meanwhile.
+[[nodiscard]] auto decrypt_message(const echo_server_config& cfg,
+                                   crypto::crypto_message_params params,
+                                   std::vector<std::byte> message)
+    -> boost::asio::awaitable<std::vector<std::byte>> {
+  if (!is_offloaded(cfg, message.size())) {
+    co_return crypto::decrypt(params, std::move(message));
+  }
+
+  // Built outside the co_await expression: GCC 12 destroys a closure
+  // temporary there twice once its captures are moved out of the frame.
+  auto job = [params, message = std::move(message)]() mutable {
+    return crypto::decrypt(params, std::move(message));
+  };
+
+  co_return co_await cfg.compute->run(std::move(job));
+}
+
+// Start of a stretch of a session handler holding its loop, between resuming
+// from one operation and suspending on the next.
+[[nodiscard]] auto start_handler(const echo_server_config& cfg)
+    -> loop_monitor::clock::time_point {
+  return cfg.monitor ? loop_monitor::clock::now()
+                     : loop_monitor::clock::time_point{};
+}
+
+// Reports a handler which held its loop past its budget, and sheds its
+// session if the loop is running late.
+[[nodiscard]] auto end_handler(const client_session& session,
+                               const echo_server_config& cfg,
+                               loop_monitor::clock::time_point started)
+    -> std::optional<client_fault> {
+  if (!cfg.monitor) {
+    return std::nullopt;
+  }
+
+  const auto elapsed = cfg.monitor->record_handler(started);
+
+  if (elapsed <= cfg.monitor->options().handler_budget) {
+    return std::nullopt;
+  }
+
+  const auto micros =
+      std::chrono::duration_cast<std::chrono::microseconds>(elapsed).count();
+
+  logger()->warn("Handler of client {} held its loop for {}us.", session.uuid,
+                 micros);
+
+  flight::record(flight::event_kind::SLOW_HANDLER, flight_id(session),
+                 static_cast<std::uint32_t>(std::min<std::int64_t>(
+                     micros, std::numeric_limits<std::uint32_t>::max())));
+
+  if (!cfg.monitor->is_shedding()) {
+    return std::nullopt;
+  }
+
+  cfg.monitor->record(shed_action::DROPPED_SESSION);
+
+  return make_fault(drop_reason::OVERLOADED);
+}
+
+// Records echoes taking longer than the configured threshold, from their
+// header to their response.
+auto record_if_slow(const client_session& session,
+                    const echo_server_config& cfg,
+                    std::chrono::steady_clock::time_point started) -> void {
+  const auto elapsed = std::chrono::steady_clock::now() - started;
+
+  if (cfg.slow_echo_threshold.count() == 0 ||
+      elapsed < cfg.slow_echo_threshold) {
+    return;
+  }
+
+  const auto micros =
+      std::chrono::duration_cast<std::chrono::microseconds>(elapsed).count();
+
+  flight::record(flight::event_kind::SLOW_ECHO, flight_id(session),
+                 static_cast<std::uint32_t>(std::min<std::int64_t>(
+                     micros, std::numeric_limits<std::uint32_t>::max())));
+}
+
+// Takes an echo request of `frame_size` bytes out of the session's rate
+// limits. A session over them is held back until it is within them again, or
+// dropped, depending on the limiter.
+template <typename AsyncStream>
+[[nodiscard]] auto limit_rate(basic_client_channel<AsyncStream>& channel,
+                              client_session& session,
+                              const echo_server_config& cfg,
+                              std::uint32_t frame_size)
+    -> boost::asio::awaitable<client_result<void>> {
+  const auto wait =
+      cfg.limiter->take(session.rate, frame_size, rate_limiter::clock::now());
+
+  if (wait.count() == 0) {
+    co_return client_result<void>{};
+  }
+
+  if (cfg.limiter->action() == rate_limit_action::DISCONNECT) {
+    cfg.limiter->record(rate_limit_action::DISCONNECT);
+
+    co_return make_fault(drop_reason::RATE_LIMITED);
+  }
+
+  cfg.limiter->record(rate_limit_action::DELAY, wait);
+
+  // Responses held back would wait along with the session.
+  auto error = boost::system::error_code{};
+  co_await channel.flush_responses(error);
+
+  if (error) {
+    co_return make_fault(error);
+  }
+
+  const auto executor = co_await boost::asio::this_coro::executor;
+  auto timer = boost::asio::steady_timer{executor, wait};
+
+  co_await timer.async_wait(
+      boost::asio::redirect_error(boost::asio::use_awaitable, error));
+
+  co_return client_result<void>{};
+}
+
+// Stages of the echo handler below, chosen from the config once per listener
+// by `select_echo_pipeline`. Whatever a listener leaves out is compiled out of
+// its handler, rather than checked for on every echo.
+//
+// Splicing and cut-through stay checks on every echo, as they depend on the
+// size of each message as well as on the config. So do rate limiting and the
+// loop monitor's handler budget: each is a pointer test, which does not pay
+// for doubling the handlers compiled for every transport.
+
+// Echoes payloads as the client encrypted them.
+struct passing_through {
+  static constexpr auto is_decrypting = false;
+
+  [[nodiscard]] static auto decrypt(const echo_server_config& /*cfg*/,
+                                    const client_session& /*session*/,
+                                    messages::echo_request& echo)
+      -> std::vector<std::byte> {
+    return std::move(echo.cipher_message);
+  }
+};
+
+// Echoes payloads decrypted, on the compute pool if large enough.
+struct decrypting {
+  static constexpr auto is_decrypting = true;
+
+  [[nodiscard]] static auto decrypt(const echo_server_config& cfg,
+                                    const client_session& session,
+                                    messages::echo_request& echo)
+      -> boost::asio::awaitable<std::vector<std::byte>> {
+    return decrypt_message(cfg,
+                           {
+                               .username_sum = session.username_sum,
+                               .password_sum = session.password_sum,
+                               .sequence = echo.header.sequence,
+                           },
+                           std::move(echo.cipher_message));
+  }
+};
+
+struct payload_logging {
+  template <typename Decrypt>
+  static auto log(const client_session& session,
+                  const std::vector<std::byte>& payload) -> void {
+    if constexpr (Decrypt::is_decrypting) {
+      log_decrypted_message(session, payload);
+    } else {
+      log_encrypted_message(session, payload);
+    }
+  }
+};
+
+struct no_payload_logging {
+  template <typename Decrypt>
+  static auto log(const client_session& /*session*/,
+                  const std::vector<std::byte>& /*payload*/) -> void {}
+};
+
+// Times echoes for the latency tracer and the slow echo records.
+struct echo_timing {
+  [[nodiscard]] static auto trace(const echo_server_config& cfg,
+                                  std::uint8_t sequence) -> echo_trace {
+    return echo_trace{cfg.tracer.get(), sequence};
+  }
+
+  [[nodiscard]] static auto start() -> std::chrono::steady_clock::time_point {
+    return std::chrono::steady_clock::now();
+  }
+
+  static auto record(const client_session& session,
+                     const echo_server_config& cfg,
+                     std::chrono::steady_clock::time_point started) -> void {
+    record_if_slow(session, cfg, started);
+  }
+};
+
+// Leaves echoes untimed, but for the USDT probes at their trace points.
+struct no_echo_timing {
+  [[nodiscard]] static auto trace(const echo_server_config& /*cfg*/,
+                                  std::uint8_t sequence) -> echo_trace {
+    return echo_trace{nullptr, sequence};
+  }
+
+  [[nodiscard]] static auto start() -> std::chrono::steady_clock::time_point {
+    return {};
+  }
+
+  static auto record(const client_session& /*session*/,
+                     const echo_server_config& /*cfg*/,
+                     std::chrono::steady_clock::time_point /*started*/)
+      -> void {}
+};
+
+// The stages of an echo, in the order each echo goes through them.
+template <typename Decrypt, typename Log, typename Metrics>
+struct echo_pipeline {
+  using decrypt = Decrypt;
+  using log = Log;
+  using metrics = Metrics;
+};
+
+template <typename Log, typename Metrics, typename Spawn>
+auto select_decryption(const echo_server_config& cfg, Spawn&& spawn) -> void {
+  if (cfg.enable_decryption) {
+    spawn(echo_pipeline<decrypting, Log, Metrics>{});
+  } else {
+    spawn(echo_pipeline<passing_through, Log, Metrics>{});
+  }
+}
+
+template <typename Log, typename Spawn>
+auto select_echo_timing(const echo_server_config& cfg, Spawn&& spawn) -> void {
+  if (cfg.tracer || cfg.slow_echo_threshold.count() != 0) {
+    select_decryption<Log, echo_timing>(cfg, std::forward<Spawn>(spawn));
+  } else {
+    select_decryption<Log, no_echo_timing>(cfg, std::forward<Spawn>(spawn));
+  }
+}
+
+// Calls `spawn` with the `echo_pipeline` matching `cfg`, for it to spawn a
+// listener whose clients are served by that pipeline.
+template <typename Spawn>
+auto select_echo_pipeline(const echo_server_config& cfg, Spawn&& spawn)
+    -> void {
+  if (cfg.enable_payload_logs) {
+    select_echo_timing<payload_logging>(cfg, std::forward<Spawn>(spawn));
+  } else {
+    select_echo_timing<no_payload_logging>(cfg, std::forward<Spawn>(spawn));
+  }
+}
+
+template <typename Pipeline, typename AsyncStream>
+[[nodiscard]] auto
+handle_authenticated_client(basic_client_channel<AsyncStream>& channel,
+                            client_session& session,
+                            const echo_server_config& cfg)
+    -> boost::asio::awaitable<client_result<void>> {
+  using decrypt = typename Pipeline::decrypt;
+  using log = typename Pipeline::log;
+  using metrics = typename Pipeline::metrics;
+
+  auto header = co_await receive_header(channel);
+
+  if (!header) {
+    co_return std::move(header).fault();
+  }
+
+  auto trace = echo_trace{metrics::trace(cfg, header->sequence)};
+  trace.mark<trace_point::FRAME_START>();
+
+  if (header->total_size > cfg.max_message_size) {
+    flight::record(flight::event_kind::OVERSIZE_FRAME, flight_id(session),
+                   header->total_size);
+
+    co_return make_fault(drop_reason::MESSAGE_TOO_LONG);
+  }
+
+  const auto started = metrics::start();
+
+  switch (header->type) {
+    case messages::message_type::ECHO_REQUEST:
+      break;
 
     case messages::message_type::LOGIN_RESPONSE:
     case messages::message_type::ECHO_RESPONSE:
-      throw exceptions::client_error{
-          "The client should never send this message."};
+      co_return make_fault(drop_reason::UNEXPECTED_MESSAGE);
 
     case messages::message_type::LOGIN_REQUEST:
-      throw exceptions::client_error{"The client is already logged in."};
+      co_return make_fault(drop_reason::ALREADY_LOGGED_IN);
+  }
+
+  if (cfg.limiter) {
+    auto limited =
+        co_await limit_rate(channel, session, cfg, header->total_size);
+
+    if (!limited) {
+      co_return std::move(limited).fault();
+    }
+  }
+
+  // Memory streams have no socket to splice from.
+  if constexpr (socket_stream<AsyncStream> && !decrypt::is_decrypting) {
+    if (is_spliced(channel, cfg, *header)) {
+      auto spliced = co_await handle_spliced_echo(channel, session, cfg,
+                                                  std::move(*header), trace);
+
+      if (spliced) {
+        metrics::record(session, cfg, started);
+      }
+
+      co_return spliced;
+    }
+  }
+
+  if (header->is_extended || cfg.enable_cut_through) {
+    auto streamed = co_await handle_streamed_echo<decrypt>(
+        channel, session, cfg, std::move(*header), trace);
+
+    if (streamed) {
+      metrics::record(session, cfg, started);
+    }
+
+    co_return streamed;
+  }
+
+  auto echo = co_await receive_message<messages::echo_request>(
+      channel, std::move(*header));
+
+  if (!echo) {
+    co_return std::move(echo).fault();
+  }
+
+  trace.mark<trace_point::FRAME_COMPLETE>();
+
+  auto handler_started = start_handler(cfg);
+
+  auto payload = std::vector<std::byte>{};
+
+  if constexpr (decrypt::is_decrypting) {
+    const auto is_decryption_offloaded =
+        is_offloaded(cfg, echo->cipher_message.size());
+
+    payload = co_await decrypt::decrypt(cfg, session, *echo);
+
+    trace.mark<trace_point::DECRYPT_DONE>();
+
+    // Resumed from the compute pool rather than from the read.
+    if (is_decryption_offloaded) {
+      handler_started = start_handler(cfg);
+    }
+  } else {
+    payload = decrypt::decrypt(cfg, session, *echo);
+  }
+
+  log::template log<decrypt>(session, payload);
+
+  if (auto fault = end_handler(session, cfg, handler_started)) {
+    co_return std::move(*fault);
+  }
+
+  trace.mark<trace_point::WRITE_ISSUED>();
+
+  auto sent = co_await send_message<messages::echo_response>{}(
+      channel, echo->header.sequence, std::move(payload));
+
+  // Responses held back for coalescing count as written once queued in the
+  // batch, for the slow echo records as well as for the trace.
+  if (sent) {
+    trace.mark<trace_point::WRITE_COMPLETE>();
+
+    metrics::record(session, cfg, started);
   }
+
+  co_return sent;
 }
 
-[[nodiscard]] auto handle_new_client(client_channel& channel,
+template <typename AsyncStream>
+[[nodiscard]] auto handle_new_client(basic_client_channel<AsyncStream>& channel,
                                      client_session& session,
                                      const echo_server_config& cfg)
-    -> boost::asio::awaitable<void> {
+    -> boost::asio::awaitable<client_result<void>> {
   auto header = co_await receive_header(channel);
 
-  if (header.type != messages::message_type::LOGIN_REQUEST) {
-    throw exceptions::client_error{"The client is not logged in."};
+  if (!header) {
+    co_return std::move(header).fault();
   }
 
-  const auto login = co_await receive_message<messages::login_request>(
-      channel, std::move(header));
+  if (header->type != messages::message_type::LOGIN_REQUEST) {
+    co_return make_fault(drop_reason::NOT_LOGGED_IN);
+  }
 
-  auto authentication_error = std::exception_ptr{};
+  auto login = co_await receive_message<messages::login_request>(
+      channel, std::move(*header));
 
-  try {
-    cfg.authenticator->authenticate(login.username, login.password);
+  if (!login) {
+    co_return std::move(login).fault();
+  }
 
-    session.username_sum = crypto::calculate_checksum(login.username);
-    session.password_sum = crypto::calculate_checksum(login.password);
+  const auto handler_started = start_handler(cfg);
 
-    session.is_logged_in = true;
-  } catch (const std::exception& error) {
-    authentication_error = std::current_exception();
-  }
+  // Authenticators report rejections by throwing, which is rare enough to
+  // leave as is.
+  auto authentication_error = std::optional<std::string>{};
 
-  if (!authentication_error) {
-    co_await send_message<messages::login_response>{}(
-        channel, login.header.sequence, mori_status::login_status::OK);
-  } else {
-    co_await send_message<messages::login_response>{}(
-        channel, login.header.sequence, mori_status::login_status::FAILED);
+  const auto is_shed = cfg.monitor && cfg.monitor->is_shedding();
 
+  if (is_shed) {
+    cfg.monitor->record(shed_action::REJECTED_LOGIN);
+  } else {
     try {
-      std::rethrow_exception(authentication_error);
+      cfg.authenticator->authenticate(login->username, login->password);
+
+      session.username_sum = crypto::calculate_checksum(login->username);
+      session.password_sum = crypto::calculate_checksum(login->password);
+
+      if (cfg.limiter) {
+        cfg.limiter->assign(session.rate, login->username);
+      }
+
+      session.is_logged_in = true;
     } catch (const std::exception& error) {
-      std::throw_with_nested(
-          exceptions::client_error{"The client login failed."});
+      authentication_error = error.what();
     }
   }
+
+  if (auto fault = end_handler(session, cfg, handler_started)) {
+    co_return std::move(*fault);
+  }
+
+  const auto status = session.is_logged_in ? mori_status::login_status::OK
+                                           : mori_status::login_status::FAILED;
+
+  flight::record(session.is_logged_in ? flight::event_kind::LOGIN
+                                      : flight::event_kind::LOGIN_REJECTED,
+                 flight_id(session));
+
+  auto sent = co_await send_message<messages::login_response>{}(
+      channel, login->header.sequence, status);
+
+  if (!sent || session.is_logged_in) {
+    co_return sent;
+  }
+
+  if (is_shed) {
+    co_return make_fault(drop_reason::OVERLOADED);
+  }
+
+  auto fault = make_fault(drop_reason::LOGIN_FAILED);
+  fault.cause = std::move(*authentication_error);
+
+  co_return fault;
 }
 
-[[nodiscard]] auto make_client_session(boost::asio::ip::tcp::endpoint endpoint)
-    -> client_session {
-  return {
-      .uuid = boost::uuids::to_string(boost::uuids::random_generator{}()),
-      .address = endpoint.address().to_string(),
+template <typename Pipeline, typename AsyncStream>
+[[nodiscard]] auto serve_client(basic_client_channel<AsyncStream> channel,
+                                client_session session,
+                                shared_config shared_cfg)
+    -> boost::asio::awaitable<void>;
 
-      .is_logged_in = false,
-  };
+// Moves a session between two of its messages onto the worker `target`,
+// where it carries on in a coroutine of its own.
+template <typename Pipeline, typename AsyncStream>
+auto migrate_client(basic_client_channel<AsyncStream> channel,
+                    const client_session& session, shared_config shared_cfg,
+                    std::size_t target) -> void {
+  const auto& cfg = *shared_cfg;
+
+  logger()->debug("Moving client {} to worker {}", session.uuid, target);
+
+  flight::record(flight::event_kind::MIGRATION, flight_id(session),
+                 static_cast<std::uint32_t>(target));
+
+  auto executor = cfg.rebalancer->pool()->executor(target);
+  auto moved = std::move(channel).rebind(executor);
+
+  boost::asio::post(
+      executor,
+      [channel = std::move(moved), session, shared_cfg = std::move(shared_cfg),
+       executor]() mutable {
+        boost::asio::co_spawn(executor,
+                              serve_client<Pipeline>(std::move(channel),
+                                                     session,
+                                                     std::move(shared_cfg)),
+            [](std::exception_ptr error) {
+              if (error) {
+                std::rethrow_exception(error);
+              }
+            });
+      });
 }
 
-[[nodiscard]] auto handle_client(boost::asio::ip::tcp::socket socket,
-                                 echo_server_config cfg)
+// Serves a client until it is dropped, or moved to another worker.
+template <typename Pipeline, typename AsyncStream>
+auto serve_client(basic_client_channel<AsyncStream> channel,
+                  client_session session, shared_config shared_cfg)
     -> boost::asio::awaitable<void> {
-  auto session = make_client_session(socket.remote_endpoint());
+  const auto& cfg = *shared_cfg;
 
-  logger()->info("New client connected: {}", session.uuid);
+  // Sessions outside the rebalancer's pool stay where they are.
+  const auto worker =
+      cfg.rebalancer ? cfg.rebalancer->pool()->this_worker() : std::nullopt;
+
+  auto status = client_result<void>{};
+
+  const auto executor = co_await boost::asio::this_coro::executor;
 
-  auto channel = client_channel{std::move(socket)};
+  // Where the session's current turn on its thread started.
+  auto turn_messages = std::size_t{0};
+  auto turn_start = channel.received();
 
   try {
-    for (;;) {
+    while (status) {
+      // Memory streams stay on the worker they were accepted on.
+      if constexpr (socket_stream<AsyncStream>) {
+        if (worker) {
+          if (const auto target = cfg.rebalancer->take_migration(*worker)) {
+            migrate_client<Pipeline>(std::move(channel), session,
+                                     std::move(shared_cfg), *target);
+            co_return;
+          }
+        }
+      }
+
+      if (cfg.enable_idle_wait) {
+        // Parked here, an idle client holds no read buffer and no frames of
+        // the handlers below.
+        auto error = boost::system::error_code{};
+        co_await channel.wait_readable(error);
+
+        if (error) {
+          status = make_fault(error);
+          break;
+        }
+      }
+
       if (session.is_logged_in) {
-        co_await handle_authenticated_client(channel, session, cfg);
+        status = co_await handle_authenticated_client<Pipeline>(channel,
+                                                                session, cfg);
       } else {
-        co_await handle_new_client(channel, session, cfg);
+        status = co_await handle_new_client(channel, session, cfg);
       }
-    }
-  } catch (const boost::system::system_error& error) {
-    if (error.code() != boost::asio::error::eof) {
-      log_client_error(error, session);
-    } else {
-      logger()->info("Client {} disconnected.", session.uuid);
+
+      if (worker) {
+        cfg.rebalancer->record_message(*worker);
+      }
+
+      if (!cfg.enable_turn_budget || !status) {
+        continue;
+      }
+
+      ++turn_messages;
+
+      if (turn_messages < cfg.turn_budget.messages &&
+          channel.received() - turn_start < cfg.turn_budget.bytes) {
+        continue;
+      }
+
+      // A client with nothing buffered has the session give its thread up
+      // at the next read anyway.
+      if (channel.has_buffered_input()) {
+        if (cfg.turn_budget.counters) {
+          cfg.turn_budget.counters->record_yield(turn_messages);
+        }
+
+        co_await boost::asio::post(executor, boost::asio::use_awaitable);
+      }
+
+      turn_messages = 0;
+      turn_start = channel.received();
     }
   } catch (const std::exception& error) {
+    if (cfg.drops) {
+      cfg.drops->record(drop_reason::SERVER_ERROR);
+    }
+
+    flight::record(flight::event_kind::DROP, flight_id(session), 0,
+                   static_cast<std::uint8_t>(drop_reason::SERVER_ERROR));
+
     log_client_error(error, session);
+    co_return;
+  }
+
+  // Responses held for requests before the faulty one are still due.
+  auto error = boost::system::error_code{};
+  co_await channel.flush_responses(error);
+
+  const auto fault = std::move(status).fault();
+
+  if (cfg.drops) {
+    cfg.drops->record(fault.reason);
   }
+
+  flight::record(flight::event_kind::DROP, flight_id(session), 0,
+                 static_cast<std::uint8_t>(fault.reason));
+
+  log_client_fault(fault, session);
 }
 
-[[nodiscard]] auto tcp_listen(boost::asio::any_io_executor executor,
-                              echo_server_config cfg)
+template <typename Pipeline, typename AsyncStream>
+[[nodiscard]] auto handle_client(AsyncStream socket, shared_config shared_cfg)
     -> boost::asio::awaitable<void> {
-  auto acceptor = boost::asio::ip::tcp::acceptor{
-      executor, {boost::asio::ip::tcp::v4(), cfg.port}};
+  const auto& cfg = *shared_cfg;
+
+  auto session = make_client_session();
+
+  logger()->info("New client connected: {}", session.uuid);
+
+  flight::record(flight::event_kind::ACCEPT, flight_id(session));
+
+  auto channel = basic_client_channel<AsyncStream>{std::move(socket)};
+
+  if (cfg.capture) {
+    channel.set_capture(cfg.capture->open_session());
+  }
+
+  if (cfg.enable_zerocopy) {
+    channel.enable_zerocopy(cfg.zerocopy);
+  }
+
+  if (cfg.enable_coalescing) {
+    channel.enable_coalescing(cfg.coalescing);
+  }
+
+  co_await serve_client<Pipeline>(std::move(channel), session,
+                                  std::move(shared_cfg));
+}
+
+[[nodiscard]] auto client_executor(boost::asio::any_io_executor executor,
+                                   const echo_server_config& cfg)
+    -> boost::asio::any_io_executor {
+  return cfg.workers ? cfg.workers->next_executor() : executor;
+}
+
+template <typename Pipeline, typename AsyncStream>
+auto spawn_client(AsyncStream socket, shared_config shared_cfg) -> void {
+  auto executor = socket.get_executor();
+
+  // Spawn from the client's own thread, so that its session is allocated
+  // there, on the memory of that worker.
+  boost::asio::post(executor, [socket = std::move(socket),
+                               shared_cfg = std::move(shared_cfg)]() mutable {
+    auto executor = socket.get_executor();
 
-  logger()->info("Listening on port: {}", acceptor.local_endpoint().port());
+    boost::asio::co_spawn(
+        executor,
+        handle_client<Pipeline>(std::move(socket), std::move(shared_cfg)),
+        [](std::exception_ptr error) {
+          if (error) {
+            std::rethrow_exception(error);
+          }
+        });
+  });
+}
+
+// Holds a listener back while a loop sheds load, along with the client it
+// just accepted. Clients after it are left in the backlog meanwhile.
+[[nodiscard]] auto pause_while_shedding(boost::asio::any_io_executor executor,
+                                        const echo_server_config& cfg)
+    -> boost::asio::awaitable<void> {
+  if (!cfg.monitor || !cfg.monitor->is_any_shedding()) {
+    co_return;
+  }
+
+  cfg.monitor->record(shed_action::PAUSED_ACCEPTS);
+
+  auto timer = boost::asio::steady_timer{executor};
+
+  do {
+    timer.expires_after(cfg.monitor->options().probe_interval);
+    co_await timer.async_wait(boost::asio::use_awaitable);
+  } while (cfg.monitor->is_any_shedding());
+}
+
+// Serves its clients through the echo pipeline `Pipeline`, as do the other
+// listeners below.
+template <typename Pipeline>
+[[nodiscard]] auto tcp_listen(Pipeline /*pipeline*/,
+                              boost::asio::ip::tcp::acceptor acceptor,
+                              shared_config shared_cfg)
+    -> boost::asio::awaitable<void> {
+  const auto& cfg = *shared_cfg;
+  const auto executor = acceptor.get_executor();
 
   for (;;) {
-    auto socket = co_await acceptor.async_accept(boost::asio::use_awaitable);
+    auto socket = co_await acceptor.async_accept(
+        client_executor(executor, cfg), boost::asio::use_awaitable);
+
+    co_await pause_while_shedding(executor, cfg);
+
+    spawn_client<Pipeline>(std::move(socket), shared_cfg);
+  }
+}
+
+template <typename Pipeline>
+[[nodiscard]] auto local_listen(Pipeline /*pipeline*/,
+                                boost::asio::any_io_executor executor,
+                                shared_config shared_cfg)
+    -> boost::asio::awaitable<void> {
+  const auto& cfg = *shared_cfg;
+
+  assert(cfg.local_socket_path.has_value());
+
+  // A socket file left behind by a previous run would fail the bind.
+  ::unlink(cfg.local_socket_path->c_str());
+
+  auto acceptor = boost::asio::local::stream_protocol::acceptor{
+      executor, {*cfg.local_socket_path}};
+
+  logger()->info("Listening on local socket: {}",
+                 acceptor.local_endpoint().path());
+
+  for (;;) {
+    auto socket = co_await acceptor.async_accept(
+        client_executor(executor, cfg), boost::asio::use_awaitable);
+
+    co_await pause_while_shedding(executor, cfg);
+
+    spawn_client<Pipeline>(std::move(socket), shared_cfg);
+  }
+}
+
+template <typename Pipeline>
+[[nodiscard]] auto memory_listen(Pipeline /*pipeline*/,
+                                 boost::asio::any_io_executor executor,
+                                 shared_config shared_cfg)
+    -> boost::asio::awaitable<void> {
+  const auto& cfg = *shared_cfg;
+
+  logger()->info("Listening for in-process clients");
+
+  for (;;) {
+    auto stream = co_await cfg.memory->accept(client_executor(executor, cfg));
+
+    co_await pause_while_shedding(executor, cfg);
 
-    boost::asio::co_spawn(executor, handle_client(std::move(socket), cfg),
+    spawn_client<Pipeline>(std::move(stream), shared_cfg);
+  }
+}
+
+auto turn_counters::create() -> std::shared_ptr<turn_counters> {
+  return std::shared_ptr<turn_counters>{new turn_counters{}};
+}
+
+auto turn_counters::record_yield(std::uint64_t messages) -> void {
+  yield_count.fetch_add(1, std::memory_order_relaxed);
+
+  auto longest = longest_turn_messages.load(std::memory_order_relaxed);
+
+  while (longest < messages &&
+         !longest_turn_messages.compare_exchange_weak(
+             longest, messages, std::memory_order_relaxed)) {
+  }
+}
+
+auto turn_counters::yields() const -> std::uint64_t {
+  return yield_count.load(std::memory_order_relaxed);
+}
+
+auto turn_counters::longest_turn() const -> std::uint64_t {
+  return longest_turn_messages.load(std::memory_order_relaxed);
+}
+
+auto spawn_server(boost::asio::any_io_executor executor, echo_server_config cfg)
+    -> boost::asio::ip::tcp::endpoint {
+  if (cfg.rebalancer) {
+    cfg.rebalancer->start(executor);
+  }
+
+  if (cfg.monitor) {
+    cfg.monitor->watch(executor);
+
+    for (auto i = std::size_t{0}; cfg.workers && i < cfg.workers->size(); ++i) {
+      cfg.monitor->watch(cfg.workers->executor(i));
+    }
+  }
+
+  // Shared by the listeners below and their sessions. The UDP and
+  // shared-memory listeners keep copies of their own.
+  const auto shared_cfg = std::make_shared<const echo_server_config>(cfg);
+
+  if (cfg.local_socket_path) {
+    select_echo_pipeline(cfg, [&](auto pipeline) {
+      boost::asio::co_spawn(executor,
+                            local_listen(pipeline, executor, shared_cfg),
+                            [](std::exception_ptr error) {
+                              if (error) {
+                                std::rethrow_exception(error);
+                              }
+                            });
+    });
+  }
+
+  if (cfg.shm_control_path) {
+    boost::asio::co_spawn(executor, shm_listen(executor, cfg),
                           [](std::exception_ptr error) {
                             if (error) {
                               std::rethrow_exception(error);
                             }
                           });
   }
-}
 
-auto spawn_server(boost::asio::any_io_executor executor, echo_server_config cfg)
-    -> void {
-  boost::asio::co_spawn(executor, tcp_listen(executor, std::move(cfg)),
-                        [](std::exception_ptr error) {
-                          if (error) {
-                            std::rethrow_exception(error);
-                          }
-                        });
+  if (cfg.udp_port) {
+    boost::asio::co_spawn(executor, udp_listen(executor, cfg),
+                          [](std::exception_ptr error) {
+                            if (error) {
+                              std::rethrow_exception(error);
+                            }
+                          });
+  }
+
+  if (cfg.memory) {
+    select_echo_pipeline(cfg, [&](auto pipeline) {
+      boost::asio::co_spawn(executor,
+                            memory_listen(pipeline, executor, shared_cfg),
+                            [](std::exception_ptr error) {
+                              if (error) {
+                                std::rethrow_exception(error);
+                              }
+                            });
+    });
+  }
+
+  // Bound before returning, so that its port is known even if ephemeral.
+  auto acceptor = boost::asio::ip::tcp::acceptor{
+      executor, {boost::asio::ip::tcp::v4(), cfg.port}};
+
+  const auto endpoint = acceptor.local_endpoint();
+
+  logger()->info("Listening on port: {}", endpoint.port());
+
+  select_echo_pipeline(cfg, [&](auto pipeline) {
+    boost::asio::co_spawn(
+        executor, tcp_listen(pipeline, std::move(acceptor), shared_cfg),
+        [](std::exception_ptr error) {
+          if (error) {
+            std::rethrow_exception(error);
+          }
+        });
+  });
+
+  return endpoint;
 }
 
 } // namespace mori_echo
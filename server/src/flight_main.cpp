@@ -0,0 +1,47 @@
+#include <algorithm>
+#include <cstdio>
+#include <exception>
+#include <spdlog/spdlog.h>
+#include <string>
+#include <tuple>
+#include <vector>
+
+#include "flight_recorder/flight_recorder.hpp"
+
+// Prints a flight recorder dump as text, oldest event first across threads:
+// `mori_echo_flight <dump>`.
+auto main(int argc, char** argv) -> int {
+  if (argc != 2) {
+    spdlog::error("Usage: {} <dump>", argv[0]);
+    return -1;
+  }
+
+  try {
+    const auto dump = mori_echo::flight::read_dump(argv[1]);
+
+    using thread_event =
+        std::tuple<std::uint32_t, const mori_echo::flight::event_record*>;
+
+    auto events = std::vector<thread_event>{};
+
+    for (const auto& thread : dump.threads) {
+      for (const auto& event : thread.events) {
+        events.emplace_back(thread.thread_id, &event);
+      }
+    }
+
+    std::stable_sort(events.begin(), events.end(),
+                     [](const thread_event& lhs, const thread_event& rhs) {
+                       return std::get<1>(lhs)->timestamp_ns <
+                              std::get<1>(rhs)->timestamp_ns;
+                     });
+
+    for (const auto& [thread_id, event] : events) {
+      std::puts(
+          mori_echo::flight::describe(dump, thread_id, *event).c_str());
+    }
+  } catch (const std::exception& error) {
+    spdlog::error("Fatal error: {}", error.what());
+    return -1;
+  }
+}
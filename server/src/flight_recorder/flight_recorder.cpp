@@ -0,0 +1,309 @@
+#include "flight_recorder/flight_recorder.hpp"
+
+#include <algorithm>
+#include <boost/system/system_error.hpp>
+#include <cerrno>
+#include <csignal>
+#include <cstring>
+#include <ctime>
+#include <fcntl.h>
+#include <fstream>
+#include <iterator>
+#include <spdlog/fmt/fmt.h>
+// After fmt.h, which sets up where fmt comes from.
+#include <spdlog/fmt/chrono.h>
+#include <unistd.h>
+
+#include "client_fault/client_fault.hpp"
+#include "exceptions/server_error.hpp"
+
+namespace mori_echo::flight {
+
+struct dump_header {
+  std::uint64_t magic = dump_magic;
+
+  std::uint32_t record_size = sizeof(event_record);
+  std::uint32_t ring_capacity = flight::ring_capacity;
+
+  std::uint64_t dumped_steady_ns = {};
+  std::uint64_t dumped_ns = {};
+
+  std::uint64_t ring_count = {};
+};
+
+// Precedes the events of each ring, which are dumped as they lie in memory.
+struct ring_header {
+  std::uint32_t thread_id = {};
+  std::uint32_t reserved = {};
+
+  std::uint64_t head = {};
+};
+
+// Allocated on first claim and never freed, so that a dump can walk them at
+// any time, from a signal handler included.
+std::array<std::atomic<thread_ring*>, max_rings> rings = {};
+
+// Where the crash handler dumps to. Written once, before it is installed.
+std::array<char, 4096> crash_dump_path = {};
+
+// Hands the ring of a finishing thread back to the next thread to claim one.
+struct ring_release {
+  thread_ring* ring = nullptr;
+
+  ~ring_release() {
+    if (ring != nullptr) {
+      ring->is_claimed.store(false, std::memory_order_release);
+    }
+  }
+};
+
+auto claim_thread_ring() -> thread_ring* {
+  thread_local auto release = ring_release{};
+
+  for (auto& slot : rings) {
+    auto* ring = slot.load(std::memory_order_acquire);
+
+    if (ring == nullptr) {
+      auto* fresh = new thread_ring{};
+      fresh->is_claimed.store(true, std::memory_order_relaxed);
+
+      if (!slot.compare_exchange_strong(ring, fresh,
+                                        std::memory_order_acq_rel)) {
+        delete fresh;
+        continue;
+      }
+
+      ring = fresh;
+    } else if (ring->is_claimed.exchange(true, std::memory_order_acquire)) {
+      continue;
+    }
+
+    ring->thread_id = static_cast<std::uint32_t>(::gettid());
+    release.ring = ring;
+
+    return ring;
+  }
+
+  return nullptr;
+}
+
+[[nodiscard]] auto clock_ns(clockid_t clock) noexcept -> std::uint64_t {
+  auto now = timespec{};
+  ::clock_gettime(clock, &now);
+
+  return static_cast<std::uint64_t>(now.tv_sec) * 1'000'000'000 +
+         static_cast<std::uint64_t>(now.tv_nsec);
+}
+
+[[nodiscard]] auto write_all(int fd, const void* data,
+                             std::size_t size) noexcept -> bool {
+  const auto* bytes = static_cast<const char*>(data);
+
+  while (size > 0) {
+    const auto written = ::write(fd, bytes, size);
+
+    if (written < 0 && errno == EINTR) {
+      continue;
+    }
+
+    if (written <= 0) {
+      return false;
+    }
+
+    bytes += written;
+    size -= static_cast<std::size_t>(written);
+  }
+
+  return true;
+}
+
+auto dump(const char* path) noexcept -> bool {
+  const auto fd = ::open(path, O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+
+  if (fd < 0) {
+    return false;
+  }
+
+  auto header = dump_header{
+      .dumped_steady_ns = clock_ns(CLOCK_MONOTONIC),
+      .dumped_ns = clock_ns(CLOCK_REALTIME),
+  };
+
+  for (const auto& slot : rings) {
+    if (slot.load(std::memory_order_acquire) != nullptr) {
+      ++header.ring_count;
+    }
+  }
+
+  auto is_complete = write_all(fd, &header, sizeof(header));
+
+  // Rings claimed after the count above are left out. Events recorded while
+  // dumping may tear, which the reader cannot tell.
+  for (auto i = std::size_t{0}; is_complete && i < header.ring_count; ++i) {
+    const auto* ring = rings[i].load(std::memory_order_acquire);
+
+    const auto ring_info = ring_header{
+        .thread_id = ring->thread_id,
+        .head = ring->head.load(std::memory_order_acquire),
+    };
+
+    is_complete = write_all(fd, &ring_info, sizeof(ring_info)) &&
+                  write_all(fd, ring->events.data(), sizeof(ring->events));
+  }
+
+  return ::close(fd) == 0 && is_complete;
+}
+
+extern "C" auto dump_and_reraise(int signal) -> void {
+  dump(crash_dump_path.data());
+
+  // The handler was reset on entry, so this ends the process as the signal
+  // would have.
+  ::raise(signal);
+}
+
+auto dump_on_crash(const std::string& path) -> void {
+  if (path.size() >= crash_dump_path.size()) {
+    throw exceptions::server_error{"Flight recorder dump path too long."};
+  }
+
+  std::copy(path.begin(), path.end(), crash_dump_path.begin());
+  crash_dump_path[path.size()] = '\0';
+
+  struct sigaction action = {};
+  action.sa_handler = dump_and_reraise;
+  action.sa_flags = SA_RESETHAND | SA_NODEFER;
+  sigemptyset(&action.sa_mask);
+
+  for (const auto signal : {SIGSEGV, SIGBUS, SIGFPE, SIGILL, SIGABRT}) {
+    if (::sigaction(signal, &action, nullptr) != 0) {
+      throw boost::system::system_error{
+          boost::system::error_code{errno, boost::system::system_category()},
+          "sigaction"};
+    }
+  }
+}
+
+template <typename T>
+auto read_exactly(std::ifstream& file, T& value) -> void {
+  if (!file.read(reinterpret_cast<char*>(&value), sizeof(value))) {
+    throw exceptions::server_error{"Truncated flight recorder dump."};
+  }
+}
+
+auto read_dump(const std::string& path) -> flight_dump {
+  auto file = std::ifstream{path, std::ios::binary};
+
+  if (!file) {
+    throw exceptions::server_error{"Cannot open flight recorder dump."};
+  }
+
+  auto header = dump_header{};
+  read_exactly(file, header);
+
+  if (header.magic != dump_magic ||
+      header.record_size != sizeof(event_record) ||
+      header.ring_capacity != ring_capacity) {
+    throw exceptions::server_error{"Not a flight recorder dump."};
+  }
+
+  auto result = flight_dump{
+      .dumped_steady = std::chrono::steady_clock::time_point{
+          std::chrono::nanoseconds{header.dumped_steady_ns}},
+      .dumped = std::chrono::system_clock::time_point{
+          std::chrono::duration_cast<std::chrono::system_clock::duration>(
+              std::chrono::nanoseconds{header.dumped_ns})},
+      .threads = {},
+  };
+
+  auto events = std::array<event_record, ring_capacity>{};
+
+  for (auto i = std::uint64_t{0}; i < header.ring_count; ++i) {
+    auto ring_info = ring_header{};
+    read_exactly(file, ring_info);
+    read_exactly(file, events);
+
+    auto& thread = result.threads.emplace_back();
+    thread.thread_id = ring_info.thread_id;
+
+    const auto count = std::min<std::uint64_t>(ring_info.head, ring_capacity);
+    const auto oldest = (ring_info.head - count) % ring_capacity;
+
+    thread.events.reserve(count);
+
+    for (auto j = std::uint64_t{0}; j < count; ++j) {
+      thread.events.push_back(events[(oldest + j) % ring_capacity]);
+    }
+  }
+
+  return result;
+}
+
+[[nodiscard]] auto kind_name(event_kind kind) -> std::string_view {
+  switch (kind) {
+    case event_kind::ACCEPT:
+      return "ACCEPT";
+    case event_kind::LOGIN:
+      return "LOGIN";
+    case event_kind::LOGIN_REJECTED:
+      return "LOGIN_REJECTED";
+    case event_kind::DROP:
+      return "DROP";
+    case event_kind::OVERSIZE_FRAME:
+      return "OVERSIZE_FRAME";
+    case event_kind::SLOW_ECHO:
+      return "SLOW_ECHO";
+    case event_kind::SLOW_HANDLER:
+      return "SLOW_HANDLER";
+    case event_kind::MIGRATION:
+      return "MIGRATION";
+  }
+
+  return "UNKNOWN";
+}
+
+auto describe(const flight_dump& dump, std::uint32_t thread_id,
+              const event_record& event) -> std::string {
+  const auto age = dump.dumped_steady.time_since_epoch() -
+                   std::chrono::nanoseconds{event.timestamp_ns};
+
+  const auto time =
+      dump.dumped -
+      std::chrono::duration_cast<std::chrono::system_clock::duration>(age);
+
+  const auto seconds = std::chrono::floor<std::chrono::seconds>(time);
+  const auto micros =
+      std::chrono::duration_cast<std::chrono::microseconds>(time - seconds);
+
+  auto line = fmt::format("{:%F %T}.{:06} [{}] {} {:016x}", seconds,
+                          micros.count(), thread_id, kind_name(event.kind),
+                          event.session);
+
+  switch (event.kind) {
+    case event_kind::DROP:
+      fmt::format_to(
+          std::back_inserter(line), ": {}",
+          mori_echo::describe(static_cast<drop_reason>(event.detail)));
+      break;
+
+    case event_kind::OVERSIZE_FRAME:
+      fmt::format_to(std::back_inserter(line), ": {} bytes", event.value);
+      break;
+
+    case event_kind::SLOW_ECHO:
+    case event_kind::SLOW_HANDLER:
+      fmt::format_to(std::back_inserter(line), ": {} us", event.value);
+      break;
+
+    case event_kind::MIGRATION:
+      fmt::format_to(std::back_inserter(line), ": to worker {}", event.value);
+      break;
+
+    default:
+      break;
+  }
+
+  return line;
+}
+
+} // namespace mori_echo::flight
@@ -0,0 +1,161 @@
+#include "latency_tracer/latency_tracer.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <cassert>
+#include <spdlog/spdlog.h>
+
+namespace mori_echo::tracing {
+
+[[nodiscard]] inline auto logger() -> std::shared_ptr<spdlog::logger> {
+  static auto logger = spdlog::default_logger()->clone("latency_tracer");
+  return logger;
+}
+
+[[nodiscard]] auto stage_name(trace_stage stage) -> const char* {
+  switch (stage) {
+    case trace_stage::READ:
+      return "read";
+    case trace_stage::DECRYPT:
+      return "decrypt";
+    case trace_stage::QUEUE:
+      return "queue";
+    case trace_stage::WRITE:
+      return "write";
+    case trace_stage::TOTAL:
+      return "total";
+  }
+
+  return "unknown";
+}
+
+[[nodiscard]] auto to_micros(std::chrono::nanoseconds duration) -> double {
+  return std::chrono::duration<double, std::micro>(duration).count();
+}
+
+} // namespace mori_echo::tracing
+
+namespace mori_echo {
+
+auto latency_histogram::record(std::chrono::nanoseconds duration) -> void {
+  const auto nanoseconds =
+      static_cast<std::uint64_t>(std::max(duration.count(), std::int64_t{0}));
+
+  // Bucket N holds durations below 2^N nanoseconds.
+  const auto bucket = std::min(std::size_t{std::bit_width(nanoseconds)},
+                               bucket_count - 1);
+
+  buckets[bucket].fetch_add(1, std::memory_order_relaxed);
+}
+
+auto latency_histogram::count() const -> std::uint64_t {
+  auto total = std::uint64_t{0};
+
+  for (const auto& bucket : buckets) {
+    total += bucket.load(std::memory_order_relaxed);
+  }
+
+  return total;
+}
+
+auto latency_histogram::percentile(double fraction) const
+    -> std::chrono::nanoseconds {
+  assert(fraction >= 0 && fraction <= 1);
+
+  const auto total = count();
+
+  if (total == 0) {
+    return {};
+  }
+
+  const auto rank = static_cast<std::uint64_t>(
+      fraction * static_cast<double>(total - 1)) + 1;
+
+  auto seen = std::uint64_t{0};
+
+  for (auto bucket = std::size_t{0}; bucket < bucket_count; ++bucket) {
+    seen += buckets[bucket].load(std::memory_order_relaxed);
+
+    if (seen >= rank) {
+      return std::chrono::nanoseconds{
+          static_cast<std::int64_t>(std::uint64_t{1} << bucket)};
+    }
+  }
+
+  return std::chrono::nanoseconds::max();
+}
+
+auto latency_tracer::create(std::size_t sample_interval)
+    -> std::shared_ptr<latency_tracer> {
+  return std::shared_ptr<latency_tracer>{new latency_tracer{sample_interval}};
+}
+
+auto latency_tracer::record(std::uint8_t sequence, const timestamps& points)
+    -> void {
+  const auto at = [&](trace_point point) {
+    return points[static_cast<std::size_t>(point)];
+  };
+
+  auto durations = std::array<std::chrono::nanoseconds, trace_stage_count>{};
+  auto is_reached = std::array<bool, trace_stage_count>{};
+
+  // Stage N spans trace points N and N + 1.
+  for (auto stage = std::size_t{0}; stage + 1 < trace_stage_count; ++stage) {
+    const auto from = points[stage];
+    const auto to = points[stage + 1];
+
+    is_reached[stage] =
+        from != clock::time_point{} && to != clock::time_point{};
+    durations[stage] = to - from;
+  }
+
+  const auto total = static_cast<std::size_t>(trace_stage::TOTAL);
+
+  is_reached[total] = true;
+  durations[total] =
+      at(trace_point::WRITE_COMPLETE) - at(trace_point::FRAME_START);
+
+  for (auto stage = std::size_t{0}; stage < trace_stage_count; ++stage) {
+    if (is_reached[stage]) {
+      histograms[stage].record(durations[stage]);
+    }
+  }
+
+  const auto index = recorded.fetch_add(1, std::memory_order_relaxed);
+
+  if (sample_interval == 0 || index % sample_interval != 0) {
+    return;
+  }
+
+  const auto stage_micros = [&](trace_stage stage) {
+    const auto each = static_cast<std::size_t>(stage);
+    return is_reached[each] ? tracing::to_micros(durations[each]) : 0.0;
+  };
+
+  tracing::logger()->info(
+      "Echo {}: read {:.2f}us decrypt {:.2f}us queue {:.2f}us write {:.2f}us "
+      "total {:.2f}us",
+      sequence, stage_micros(trace_stage::READ),
+      stage_micros(trace_stage::DECRYPT), stage_micros(trace_stage::QUEUE),
+      stage_micros(trace_stage::WRITE), stage_micros(trace_stage::TOTAL));
+}
+
+auto latency_tracer::histogram(trace_stage stage) const
+    -> const latency_histogram& {
+  return histograms[static_cast<std::size_t>(stage)];
+}
+
+auto latency_tracer::log_summary() const -> void {
+  for (auto stage = std::size_t{0}; stage < trace_stage_count; ++stage) {
+    const auto& each = histograms[stage];
+
+    tracing::logger()->info(
+        "{}: {} samples, p50 < {:.2f}us, p99 < {:.2f}us, p99.9 < {:.2f}us",
+        tracing::stage_name(static_cast<trace_stage>(stage)), each.count(),
+        tracing::to_micros(each.percentile(0.50)),
+        tracing::to_micros(each.percentile(0.99)),
+        tracing::to_micros(each.percentile(0.999)));
+  }
+}
+
+} // namespace mori_echo
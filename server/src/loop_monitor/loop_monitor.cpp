@@ -0,0 +1,178 @@
+#include "loop_monitor/loop_monitor.hpp"
+
+#include <algorithm>
+#include <boost/asio/co_spawn.hpp>
+#include <boost/asio/redirect_error.hpp>
+#include <boost/asio/steady_timer.hpp>
+#include <boost/asio/use_awaitable.hpp>
+#include <spdlog/spdlog.h>
+
+namespace mori_echo::monitoring {
+
+[[nodiscard]] inline auto logger() -> std::shared_ptr<spdlog::logger> {
+  static auto logger = spdlog::default_logger()->clone("loop_monitor");
+  return logger;
+}
+
+[[nodiscard]] auto to_millis(std::chrono::nanoseconds duration) -> double {
+  return std::chrono::duration<double, std::milli>(duration).count();
+}
+
+} // namespace mori_echo::monitoring
+
+namespace mori_echo {
+
+thread_local const loop_monitor* loop_monitor::probed_by = nullptr;
+thread_local loop_monitor::loop_state* loop_monitor::probed_state = nullptr;
+
+auto loop_monitor::create(loop_monitor_options options)
+    -> std::shared_ptr<loop_monitor> {
+  return std::shared_ptr<loop_monitor>{new loop_monitor{options}};
+}
+
+auto loop_monitor::watch(boost::asio::any_io_executor executor) -> void {
+  auto* state = [this] {
+    const auto lock = std::scoped_lock{loops_mutex};
+    return &loops.emplace_back();
+  }();
+
+  boost::asio::co_spawn(executor, probe(shared_from_this(), *state),
+                        [](std::exception_ptr error) {
+                          if (error) {
+                            std::rethrow_exception(error);
+                          }
+                        });
+}
+
+auto loop_monitor::probe(std::shared_ptr<loop_monitor> monitor,
+                         loop_state& state) -> boost::asio::awaitable<void> {
+  // Destroyed with the frame, should the loop end first.
+  struct unregister {
+    ~unregister() {
+      probed_by = nullptr;
+      probed_state = nullptr;
+    }
+  };
+
+  const auto on_exit = unregister{};
+
+  const auto& options = monitor->settings;
+
+  auto timer =
+      boost::asio::steady_timer{co_await boost::asio::this_coro::executor};
+  auto error = boost::system::error_code{};
+
+  for (auto due = clock::now() + options.probe_interval;
+       !monitor->is_stopped.load(std::memory_order_relaxed);) {
+    timer.expires_at(due);
+
+    co_await timer.async_wait(
+        boost::asio::redirect_error(boost::asio::use_awaitable, error));
+
+    if (error) {
+      co_return;
+    }
+
+    // Set on every tick, as the probe may have been spawned from another
+    // thread, e.g. by polling the loop before running it.
+    probed_by = monitor.get();
+    probed_state = &state;
+
+    const auto now = clock::now();
+    const auto lag = std::chrono::nanoseconds{now - due};
+
+    monitor->lag_histogram.record(lag);
+    state.lag_ns.store(lag.count(), std::memory_order_relaxed);
+
+    if (lag >= options.shed_lag) {
+      if (!state.is_shedding.exchange(true, std::memory_order_relaxed)) {
+        monitoring::logger()->warn(
+            "Loop running {:.1f}ms late, shedding load.",
+            monitoring::to_millis(lag));
+      }
+
+      state.last_late = now;
+    } else if (state.is_shedding.load(std::memory_order_relaxed) &&
+               now - state.last_late >= options.shed_hold) {
+      state.is_shedding.store(false, std::memory_order_relaxed);
+
+      monitoring::logger()->info("Loop caught up, no longer shedding load.");
+    }
+
+    due = now + options.probe_interval;
+  }
+}
+
+auto loop_monitor::stop() -> void {
+  is_stopped.store(true, std::memory_order_relaxed);
+}
+
+auto loop_monitor::is_shedding() const -> bool {
+  return probed_by == this &&
+         probed_state->is_shedding.load(std::memory_order_relaxed);
+}
+
+auto loop_monitor::is_any_shedding() const -> bool {
+  const auto lock = std::scoped_lock{loops_mutex};
+
+  return std::any_of(loops.begin(), loops.end(), [](const loop_state& each) {
+    return each.is_shedding.load(std::memory_order_relaxed);
+  });
+}
+
+auto loop_monitor::record_handler(clock::time_point started)
+    -> std::chrono::nanoseconds {
+  const auto elapsed = std::chrono::nanoseconds{clock::now() - started};
+
+  handler_histogram.record(elapsed);
+
+  return elapsed;
+}
+
+auto loop_monitor::record(shed_action action) -> void {
+  shed_counts[static_cast<std::size_t>(action)].fetch_add(
+      1, std::memory_order_relaxed);
+}
+
+auto loop_monitor::count(shed_action action) const -> std::uint64_t {
+  return shed_counts[static_cast<std::size_t>(action)].load(
+      std::memory_order_relaxed);
+}
+
+auto loop_monitor::lag() const -> const latency_histogram& {
+  return lag_histogram;
+}
+
+auto loop_monitor::current_lag() const -> std::chrono::nanoseconds {
+  const auto lock = std::scoped_lock{loops_mutex};
+
+  auto worst = std::int64_t{0};
+
+  for (const auto& each : loops) {
+    worst = std::max(worst, each.lag_ns.load(std::memory_order_relaxed));
+  }
+
+  return std::chrono::nanoseconds{worst};
+}
+
+auto loop_monitor::handlers() const -> const latency_histogram& {
+  return handler_histogram;
+}
+
+auto loop_monitor::options() const -> const loop_monitor_options& {
+  return settings;
+}
+
+auto loop_monitor::log_summary() const -> void {
+  monitoring::logger()->info(
+      "Loop lag p50 {:.2f}ms p99 {:.2f}ms max {:.2f}ms, handlers p99 {:.2f}ms. "
+      "Shed: {} accept pauses, {} logins, {} sessions.",
+      monitoring::to_millis(lag_histogram.percentile(0.5)),
+      monitoring::to_millis(lag_histogram.percentile(0.99)),
+      monitoring::to_millis(lag_histogram.percentile(1.0)),
+      monitoring::to_millis(handler_histogram.percentile(0.99)),
+      count(shed_action::PAUSED_ACCEPTS), count(shed_action::REJECTED_LOGIN),
+      count(shed_action::DROPPED_SESSION));
+}
+
+} // namespace mori_echo
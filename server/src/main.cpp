@@ -1,10 +1,17 @@
 #include <boost/asio/io_context.hpp>
 #include <boost/asio/signal_set.hpp>
+#include <cstdlib>
 #include <exception>
 #include <spdlog/spdlog.h>
+#include <string>
 
 #include "client_authenticator/allow_all_client_authenticator.hpp"
 #include "echo_server/echo_server.hpp"
+#include "flight_recorder/flight_recorder.hpp"
+#include "loop_monitor/loop_monitor.hpp"
+#include "traffic_capture/traffic_capture.hpp"
+#include "worker_pool/server_topology.hpp"
+#include "worker_pool/worker_pool.hpp"
 
 auto log_fatal_error(const std::exception& error, int level = 0) -> void {
   if (level == 0) {
@@ -21,17 +28,73 @@ auto log_fatal_error(const std::exception& error, int level = 0) -> void {
   }
 }
 
+// Dumps the flight recorder on SIGUSR2, for as long as the server runs.
+auto dump_on_signal(boost::asio::signal_set& signals, const std::string& path)
+    -> void {
+  signals.async_wait([&signals, &path](auto error, auto) {
+    if (error) {
+      return;
+    }
+
+    if (mori_echo::flight::dump(path.c_str())) {
+      spdlog::info("Flight recorder dumped to {}", path);
+    } else {
+      spdlog::error("Failed to dump the flight recorder to {}", path);
+    }
+
+    dump_on_signal(signals, path);
+  });
+}
+
 auto main() -> int {
   spdlog::set_level(spdlog::level::debug);
 
   spdlog::info("MoriEcho TCP Echo Server started.");
 
+  // Where the flight recorder is dumped, for `mori_echo_flight`.
+  const auto* flight_path = std::getenv("MORI_ECHO_FLIGHT_DUMP");
+
+  const auto flight_dump_path =
+      std::string{flight_path != nullptr ? flight_path : "mori_echo.flight"};
+
   try {
+    mori_echo::flight::dump_on_crash(flight_dump_path);
+
+    // Thread layout, like `acceptor=0;1;2;3`. Detected from sysfs if unset.
+    const auto* layout = std::getenv("MORI_ECHO_TOPOLOGY");
+
+    const auto topology = layout != nullptr
+                              ? mori_echo::server_topology::parse(layout)
+                              : mori_echo::server_topology::detect();
+
+    const auto workers = mori_echo::worker_pool::create(topology);
+
+    // After spawning the workers, which would inherit it otherwise.
+    mori_echo::apply_placement(topology.acceptor);
+
+    // Capture file for the inbound traffic, for `mori_echo_replay`.
+    const auto* capture_path = std::getenv("MORI_ECHO_CAPTURE");
+
+    constexpr auto capture_capacity = std::size_t{256} * 1024 * 1024;
+
+    // A ring for each worker, and one shared by any other thread.
+    const auto capture =
+        capture_path != nullptr
+            ? mori_echo::capture::traffic_capture::create(
+                  capture_path, capture_capacity, 64 * 1024,
+                  workers->size() + 1)
+            : nullptr;
+
+    const auto monitor = mori_echo::loop_monitor::create();
+
     auto io_context = boost::asio::io_context{1};
 
     auto signals = boost::asio::signal_set{io_context, SIGINT, SIGTERM};
     signals.async_wait([&](auto, auto) { io_context.stop(); });
 
+    auto dump_signals = boost::asio::signal_set{io_context, SIGUSR2};
+    dump_on_signal(dump_signals, flight_dump_path);
+
     constexpr auto tcp_port = std::uint16_t{31216};
 
     mori_echo::spawn_server(
@@ -41,11 +104,21 @@ auto main() -> int {
             .enable_decryption = true,
             .authenticator =
                 mori_echo::auth::allow_all_client_authenticator::create(),
+            .workers = workers,
+            .monitor = monitor,
+            .capture = capture,
         });
 
     io_context.run();
+
+    monitor->stop();
+    workers->stop();
+
+    monitor->log_summary();
   } catch (const std::exception& error) {
     log_fatal_error(error);
+
+    mori_echo::flight::dump(flight_dump_path.c_str());
     return -1;
   }
 
@@ -0,0 +1,64 @@
+#include "memory_transport/memory_acceptor.hpp"
+
+#include <boost/asio/post.hpp>
+#include <boost/asio/redirect_error.hpp>
+#include <boost/asio/use_awaitable.hpp>
+#include <utility>
+
+namespace mori_echo {
+
+auto memory_acceptor::create(std::size_t capacity)
+    -> std::shared_ptr<memory_acceptor> {
+  return std::shared_ptr<memory_acceptor>{new memory_acceptor{capacity}};
+}
+
+auto memory_acceptor::connect(boost::asio::any_io_executor executor)
+    -> memory_stream {
+  auto link = std::make_shared<memory_link>(capacity);
+  auto client = memory_stream{link, 0, std::move(executor)};
+
+  const auto lock = std::scoped_lock{mutex};
+
+  pending.push_back(std::move(link));
+
+  // The listener's timer is only touched from its own executor.
+  if (auto waiting = listener.lock()) {
+    boost::asio::post(waiting->get_executor(),
+                      [waiting = std::weak_ptr{waiting}] {
+                        if (auto timer = waiting.lock()) {
+                          timer->cancel();
+                        }
+                      });
+  }
+
+  return client;
+}
+
+auto memory_acceptor::accept(boost::asio::any_io_executor executor)
+    -> boost::asio::awaitable<memory_stream> {
+  auto wakeup = std::make_shared<boost::asio::steady_timer>(
+      executor, boost::asio::steady_timer::time_point::max());
+
+  for (;;) {
+    {
+      const auto lock = std::scoped_lock{mutex};
+
+      if (!pending.empty()) {
+        auto link = std::move(pending.front());
+        pending.pop_front();
+
+        listener.reset();
+
+        co_return memory_stream{std::move(link), 1, std::move(executor)};
+      }
+
+      listener = wakeup;
+    }
+
+    auto error = boost::system::error_code{};
+    co_await wakeup->async_wait(
+        boost::asio::redirect_error(boost::asio::use_awaitable, error));
+  }
+}
+
+} // namespace mori_echo
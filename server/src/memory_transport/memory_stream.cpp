@@ -0,0 +1,207 @@
+#include "memory_transport/memory_stream.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+namespace mori_echo {
+
+memory_link::memory_link(std::size_t capacity) {
+  for (auto& each : inbound) {
+    each.ring.resize(capacity);
+  }
+}
+
+auto memory_link::bind(std::size_t end, boost::asio::steady_timer* wakeup)
+    -> void {
+  const auto lock = std::scoped_lock{mutex};
+
+  wakeups[end] = wakeup;
+}
+
+auto memory_link::close(std::size_t end) -> void {
+  const auto lock = std::scoped_lock{mutex};
+
+  if (!is_open[end]) {
+    return;
+  }
+
+  is_open[end] = false;
+
+  if (auto* own = std::exchange(wakeups[end], nullptr); own != nullptr) {
+    own->cancel();
+  }
+
+  wake(1 - end);
+}
+
+auto memory_link::check_open(std::size_t end,
+                             boost::system::error_code& error) const -> bool {
+  if (!is_open[end]) {
+    error = boost::asio::error::operation_aborted;
+    return false;
+  }
+
+  return true;
+}
+
+auto memory_link::read_some(std::size_t end, std::span<std::byte> buffer,
+                            boost::system::error_code& error)
+    -> std::size_t {
+  const auto lock = std::scoped_lock{mutex};
+
+  if (!check_open(end, error)) {
+    return 0;
+  }
+
+  auto& from = inbound[end];
+
+  if (from.size == 0) {
+    if (!is_open[1 - end]) {
+      error = boost::asio::error::eof;
+    } else {
+      error = boost::asio::error::would_block;
+      is_waiting[end] = true;
+    }
+
+    return 0;
+  }
+
+  const auto count = std::min(buffer.size(), from.size);
+  const auto capacity = from.ring.size();
+
+  // Up to where the ring wraps around, then from its start.
+  const auto first = std::min(count, capacity - from.head);
+  std::memcpy(buffer.data(), from.ring.data() + from.head, first);
+  std::memcpy(buffer.data() + first, from.ring.data(), count - first);
+
+  from.head = (from.head + count) % capacity;
+  from.size -= count;
+
+  error = {};
+  wake(1 - end);
+
+  return count;
+}
+
+auto memory_link::write_some(std::size_t end, std::span<const std::byte> data,
+                             boost::system::error_code& error)
+    -> std::size_t {
+  const auto lock = std::scoped_lock{mutex};
+
+  if (!check_open(end, error)) {
+    return 0;
+  }
+
+  if (!is_open[1 - end]) {
+    error = boost::asio::error::broken_pipe;
+    return 0;
+  }
+
+  auto& to = inbound[1 - end];
+  const auto capacity = to.ring.size();
+
+  if (to.size == capacity) {
+    error = boost::asio::error::would_block;
+    is_waiting[end] = true;
+
+    return 0;
+  }
+
+  const auto count = std::min(data.size(), capacity - to.size);
+  const auto tail = (to.head + to.size) % capacity;
+
+  const auto first = std::min(count, capacity - tail);
+  std::memcpy(to.ring.data() + tail, data.data(), first);
+  std::memcpy(to.ring.data(), data.data() + first, count - first);
+
+  to.size += count;
+
+  error = {};
+  wake(1 - end);
+
+  return count;
+}
+
+auto memory_link::poll(std::size_t end, bool is_write,
+                       boost::system::error_code& error) -> void {
+  const auto lock = std::scoped_lock{mutex};
+
+  if (!check_open(end, error)) {
+    return;
+  }
+
+  // Like a socket, an end whose peer closed is ready, for the operation
+  // itself to fail.
+  const auto is_ready =
+      !is_open[1 - end] ||
+      (is_write ? inbound[1 - end].size < inbound[1 - end].ring.size()
+                : inbound[end].size > 0);
+
+  if (is_ready) {
+    error = {};
+    return;
+  }
+
+  error = boost::asio::error::would_block;
+  is_waiting[end] = true;
+}
+
+auto memory_link::available(std::size_t end) -> std::size_t {
+  const auto lock = std::scoped_lock{mutex};
+
+  return inbound[end].size;
+}
+
+auto memory_link::wake(std::size_t end) -> void {
+  if (!std::exchange(is_waiting[end], false) || wakeups[end] == nullptr) {
+    return;
+  }
+
+  // The wake-up belongs to the other end's executor, where it is cancelled.
+  boost::asio::post(wakeups[end]->get_executor(),
+                    [link = shared_from_this(), end] {
+                      const auto lock = std::scoped_lock{link->mutex};
+
+                      if (auto* wakeup = link->wakeups[end];
+                          wakeup != nullptr) {
+                        wakeup->cancel();
+                      }
+                    });
+}
+
+auto memory_stream::make_pair(executor_type first, executor_type second,
+                              std::size_t capacity)
+    -> std::pair<memory_stream, memory_stream> {
+  auto link = std::make_shared<memory_link>(capacity);
+
+  return {memory_stream{link, 0, std::move(first)},
+          memory_stream{link, 1, std::move(second)}};
+}
+
+memory_stream::memory_stream(std::shared_ptr<memory_link> link,
+                             std::size_t end, executor_type executor)
+    : link{std::move(link)}, end{end}, executor{std::move(executor)},
+      wakeup{std::make_unique<boost::asio::steady_timer>(
+          this->executor, boost::asio::steady_timer::time_point::max())} {
+  this->link->bind(end, wakeup.get());
+}
+
+auto memory_stream::close() -> void {
+  if (auto closed = std::exchange(link, nullptr)) {
+    closed->close(end);
+  }
+}
+
+auto memory_stream::available(boost::system::error_code& error) const
+    -> std::size_t {
+  if (!link) {
+    error = boost::asio::error::bad_descriptor;
+    return 0;
+  }
+
+  error = {};
+
+  return link->available(end);
+}
+
+} // namespace mori_echo
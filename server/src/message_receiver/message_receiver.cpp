@@ -1,10 +1,14 @@
 #include "message_receiver/message_receiver.hpp"
 
-#include <boost/endian/conversion.hpp>
+#include <array>
+#include <cassert>
 #include <cstdint>
-#include <limits>
+#include <optional>
+#include <cstring>
+#include <string>
 
 #include "exceptions/client_error.hpp"
+#include "message_codec/message_codec.hpp"
 #include "message_types/echo_request.hpp"
 #include "message_types/login_request.hpp"
 #include "message_types/message_header.hpp"
@@ -12,145 +16,255 @@
 
 namespace mori_echo {
 
-static_assert(config::byte_order == config::endian_mode::LITTLE_ENDIAN_MODE ||
-                  config::byte_order == config::endian_mode::BIG_ENDIAN_MODE,
-              "Invalid byte order configuration.");
+[[nodiscard]] auto check_header(std::uint8_t type, std::uint32_t total_size,
+                                bool is_extended)
+    -> std::optional<client_fault> {
+  if (const auto error = check_frame(type, total_size, is_extended);
+      error != frame_error::NONE) {
+    return client_fault{
+        .reason = drop_reason::MALFORMED_FRAME,
+        .detail = describe(error),
+    };
+  }
 
-inline constexpr auto header_size =
-    sizeof(std::uint16_t) + sizeof(std::uint8_t) + sizeof(std::uint8_t);
+  return std::nullopt;
+}
 
-[[nodiscard]] auto receive_header(client_channel& channel)
-    -> boost::asio::awaitable<messages::message_header> {
-  constexpr auto min_message_size = header_size + 1;
+[[nodiscard]] auto check_type(const messages::message_header& header,
+                              messages::message_type expected_type)
+    -> std::optional<client_fault> {
+  if (header.type != expected_type) {
+    return make_fault(drop_reason::WRONG_MESSAGE_TYPE);
+  }
 
-  constexpr auto max_message_size = std::min(
-      std::size_t{
-          std::numeric_limits<decltype(std::declval<messages::message_header>()
-                                           .total_size)>::max()},
-      header_size + sizeof(std::uint16_t) +
-          std::numeric_limits<std::uint16_t>::max());
+  return std::nullopt;
+}
 
-  auto total_size = co_await channel.receive_as<std::uint16_t>();
+// Datagram decoders throw their faults instead, as each datagram is handled
+// on its own rather than ending a session.
 
-  if constexpr (config::byte_order == config::endian_mode::LITTLE_ENDIAN_MODE) {
-    boost::endian::little_to_native_inplace(total_size);
-  } else {
-    boost::endian::big_to_native_inplace(total_size);
+auto validate_frame(std::uint8_t type, std::uint32_t total_size,
+                    bool is_extended) -> messages::message_type {
+  if (const auto fault = check_header(type, total_size, is_extended)) {
+    throw exceptions::client_error{std::string{fault->detail}};
   }
 
-  if (total_size < min_message_size) {
-    throw exceptions::client_error{"Message too short."};
-  } else if (total_size > max_message_size) {
-    throw exceptions::client_error{"Message too long."};
+  return static_cast<messages::message_type>(type);
+}
+
+auto validate_type(const messages::message_header& header,
+                   messages::message_type expected_type) -> void {
+  if (const auto fault = check_type(header, expected_type)) {
+    throw exceptions::client_error{std::string{fault->detail}};
   }
+}
 
-  const auto type = co_await channel.receive_as<std::uint8_t>();
+template <std::size_t Size>
+[[nodiscard]] auto make_credential(std::span<std::byte, Size> data)
+    -> std::string {
+  static_assert(Size > 0);
 
-  auto actual_type = messages::message_type{};
+  // For ASCIIZ of size X, the max length is X - 1. Force null-terminator.
+  data[Size - 1] = std::byte{'\0'};
 
-  switch (type) {
-    case static_cast<std::uint8_t>(messages::message_type::LOGIN_REQUEST):
-    case static_cast<std::uint8_t>(messages::message_type::LOGIN_RESPONSE):
-    case static_cast<std::uint8_t>(messages::message_type::ECHO_REQUEST):
-    case static_cast<std::uint8_t>(messages::message_type::ECHO_RESPONSE):
-      actual_type = static_cast<messages::message_type>(type);
-      break;
+  return std::string{reinterpret_cast<const char*>(data.data())};
+}
 
-    default:
-      throw exceptions::client_error{"Invalid message type."};
+template <std::size_t Count>
+[[nodiscard]] auto take(std::span<std::byte>& data)
+    -> std::span<std::byte, Count> {
+  if (data.size() < Count) {
+    throw exceptions::client_error{"Datagram truncated."};
   }
 
-  const auto sequence = co_await channel.receive_as<std::uint8_t>();
+  const auto taken = data.first<Count>();
+
+  data = data.subspan(Count);
+
+  return taken;
+}
+
+[[nodiscard]] auto take(std::span<std::byte>& data, std::size_t count)
+    -> std::span<std::byte> {
+  if (data.size() < count) {
+    throw exceptions::client_error{"Datagram truncated."};
+  }
+
+  const auto taken = data.first(count);
+
+  data = data.subspan(count);
+
+  return taken;
+}
+
+template <typename AsyncStream>
+auto receive_header(basic_client_channel<AsyncStream>& channel)
+    -> boost::asio::awaitable<client_result<messages::message_header>> {
+  auto error = boost::system::error_code{};
+
+  auto header_data = std::array<std::byte, messages::header_size>{};
+  co_await channel.receive(header_data, error);
+
+  if (error) {
+    co_return make_fault(error);
+  }
+
+  const auto header = decode_layout<messages::header_layout>(
+      std::span<const std::byte, messages::header_size>{header_data},
+      header_fields);
+
+  if (header.total_size != messages::extended_frame_marker) {
+    if (auto fault = check_header(header.type, header.total_size, false)) {
+      co_return std::move(*fault);
+    }
+
+    co_return messages::message_header{
+        .total_size = header.total_size,
+        .type = static_cast<messages::message_type>(header.type),
+        .sequence = header.sequence,
+    };
+  }
+
+  auto size_data =
+      std::array<std::byte, sizeof(messages::extended_size_layout)>{};
+  co_await channel.receive(size_data, error);
+
+  if (error) {
+    co_return make_fault(error);
+  }
+
+  const auto extended_size = decode_layout<messages::extended_size_layout>(
+      std::span<const std::byte, sizeof(size_data)>{size_data},
+      extended_size_fields);
+
+  if (auto fault =
+          check_header(header.type, extended_size.total_size, true)) {
+    co_return std::move(*fault);
+  }
 
   co_return messages::message_header{
-      .total_size = total_size,
-      .type = actual_type,
-      .sequence = sequence,
+      .total_size = extended_size.total_size,
+      .type = static_cast<messages::message_type>(header.type),
+      .sequence = header.sequence,
+      .is_extended = true,
   };
 }
 
-template <>
-auto receive_message<messages::login_request>(client_channel& channel,
-                                              messages::message_header header)
-    -> boost::asio::awaitable<messages::login_request> {
-  constexpr auto min_message_size =
-      header_size + config::username_size + config::password_size;
-
-  constexpr auto max_message_size = min_message_size;
+template <typename AsyncStream>
+auto receive_echo_size(basic_client_channel<AsyncStream>& channel,
+                       messages::message_header header,
+                       std::uint32_t max_message_size)
+    -> boost::asio::awaitable<client_result<std::uint32_t>> {
+  using schema = messages::message_schema<messages::echo_request>;
 
-  if (header.type != messages::message_type::LOGIN_REQUEST) {
-    throw exceptions::client_error{"Wrong message type."};
+  if (auto fault = check_type(header, messages::message_type::ECHO_REQUEST)) {
+    co_return std::move(*fault);
   }
 
-  if (header.total_size < min_message_size) {
-    throw exceptions::client_error{"Message too short."};
-  } else if (header.total_size > max_message_size) {
-    throw exceptions::client_error{"Message too long."};
+  if (header.total_size > max_message_size) {
+    co_return make_fault(drop_reason::MESSAGE_TOO_LONG);
   }
 
-  auto username = co_await channel.receive(config::username_size);
-  auto password = co_await channel.receive(config::password_size);
+  auto error = boost::system::error_code{};
+  auto message_size = std::uint32_t{};
 
-  assert(username.size() == config::username_size);
-  assert(password.size() == config::password_size);
+  if (header.is_extended) {
+    auto layout_data = std::array<std::byte, sizeof(schema::extended_layout)>{};
+    co_await channel.receive(layout_data, error);
 
-  static_assert(config::username_size > 0);
-  static_assert(config::password_size > 0);
+    message_size =
+        decode_extended_fixed_part<messages::echo_request>(layout_data)
+            .*schema::extended_payload_size;
+  } else {
+    auto layout_data = std::array<std::byte, sizeof(schema::layout)>{};
+    co_await channel.receive(layout_data, error);
 
-  // For ASCIIZ of size X, the max length is X - 1. Force null-terminator.
-  username[config::username_size - 1] = std::byte{'\0'};
-  password[config::password_size - 1] = std::byte{'\0'};
+    message_size = decode_fixed_part<messages::echo_request>(layout_data)
+                       .*schema::payload_size;
+  }
 
-  auto message = messages::login_request{};
+  if (error) {
+    co_return make_fault(error);
+  }
 
-  message.header = std::move(header);
+  if (!sizes_payload<messages::echo_request>(header, message_size)) {
+    co_return make_fault(drop_reason::SIZE_MISMATCH);
+  }
 
-  message.username =
-      std::string{reinterpret_cast<const char*>(username.data())};
+  co_return message_size;
+}
 
-  message.password =
-      std::string{reinterpret_cast<const char*>(password.data())};
+[[nodiscard]] auto
+make_login_request(messages::message_header header,
+                   messages::message_schema<messages::login_request>::layout
+                       layout) -> messages::login_request {
+  auto message = messages::login_request{};
 
-  co_return message;
+  message.header = std::move(header);
+  message.username = make_credential(std::span{layout.username});
+  message.password = make_credential(std::span{layout.password});
+
+  return message;
 }
 
-template <>
-auto receive_message<messages::echo_request>(client_channel& channel,
-                                             messages::message_header header)
-    -> boost::asio::awaitable<messages::echo_request> {
-  constexpr auto min_message_size = header_size + sizeof(std::uint16_t);
+template <typename AsyncStream>
+auto message_receiver<messages::login_request>::operator()(
+    basic_client_channel<AsyncStream>& channel, messages::message_header header)
+    -> boost::asio::awaitable<client_result<messages::login_request>> {
+  if (auto fault = check_type(header, messages::message_type::LOGIN_REQUEST)) {
+    co_return std::move(*fault);
+  }
+
+  auto error = boost::system::error_code{};
 
-  constexpr auto max_message_size = std::min(
-      std::size_t{
-          std::numeric_limits<decltype(std::declval<messages::message_header>()
-                                           .total_size)>::max()},
-      min_message_size + std::numeric_limits<std::uint16_t>::max());
+  auto layout_data =
+      std::array<std::byte, messages::layout_size<messages::login_request>>{};
+  co_await channel.receive(layout_data, error);
 
-  if (header.type != messages::message_type::ECHO_REQUEST) {
-    throw exceptions::client_error{"Wrong message type."};
+  if (error) {
+    co_return make_fault(error);
   }
 
-  if (header.total_size < min_message_size) {
-    throw exceptions::client_error{"Message too short."};
-  } else if (header.total_size > max_message_size) {
-    throw exceptions::client_error{"Message too long."};
+  co_return make_login_request(
+      std::move(header),
+      decode_fixed_part<messages::login_request>(layout_data));
+}
+
+template <typename AsyncStream>
+auto message_receiver<messages::echo_request>::operator()(
+    basic_client_channel<AsyncStream>& channel, messages::message_header header)
+    -> boost::asio::awaitable<client_result<messages::echo_request>> {
+  using schema = messages::message_schema<messages::echo_request>;
+
+  if (auto fault = check_type(header, messages::message_type::ECHO_REQUEST)) {
+    co_return std::move(*fault);
   }
 
-  auto message_size = co_await channel.receive_as<std::uint16_t>();
+  // Extended frames are streamed by the caller instead.
+  assert(!header.is_extended);
 
-  if constexpr (config::byte_order == config::endian_mode::LITTLE_ENDIAN_MODE) {
-    boost::endian::little_to_native_inplace(message_size);
-  } else {
-    boost::endian::big_to_native_inplace(message_size);
+  auto error = boost::system::error_code{};
+
+  auto layout_data = std::array<std::byte, sizeof(schema::layout)>{};
+  co_await channel.receive(layout_data, error);
+
+  if (error) {
+    co_return make_fault(error);
   }
 
-  const auto final_message_size = min_message_size + message_size;
+  const auto message_size =
+      decode_fixed_part<messages::echo_request>(layout_data)
+          .*schema::payload_size;
 
-  if (header.total_size != final_message_size) {
-    throw exceptions::client_error{"Message size mismatch."};
+  if (!sizes_payload<messages::echo_request>(header, message_size)) {
+    co_return make_fault(drop_reason::SIZE_MISMATCH);
   }
 
-  auto cipher_message = co_await channel.receive(message_size);
+  auto cipher_message = co_await channel.receive(message_size, error);
+
+  if (error) {
+    co_return make_fault(error);
+  }
 
   assert(cipher_message.size() == message_size);
 
@@ -163,4 +277,95 @@ auto receive_message<messages::echo_request>(client_channel& channel,
   co_return message;
 }
 
+template auto receive_header(client_channel& channel)
+    -> boost::asio::awaitable<client_result<messages::message_header>>;
+
+template auto receive_header(local_client_channel& channel)
+    -> boost::asio::awaitable<client_result<messages::message_header>>;
+
+template auto receive_header(memory_client_channel& channel)
+    -> boost::asio::awaitable<client_result<messages::message_header>>;
+
+template auto receive_echo_size(client_channel& channel,
+                                messages::message_header header,
+                                std::uint32_t max_message_size)
+    -> boost::asio::awaitable<client_result<std::uint32_t>>;
+
+template auto receive_echo_size(local_client_channel& channel,
+                                messages::message_header header,
+                                std::uint32_t max_message_size)
+    -> boost::asio::awaitable<client_result<std::uint32_t>>;
+
+template auto receive_echo_size(memory_client_channel& channel,
+                                messages::message_header header,
+                                std::uint32_t max_message_size)
+    -> boost::asio::awaitable<client_result<std::uint32_t>>;
+
+template auto message_receiver<messages::login_request>::operator()(
+    client_channel& channel, messages::message_header header)
+    -> boost::asio::awaitable<client_result<messages::login_request>>;
+
+template auto message_receiver<messages::login_request>::operator()(
+    local_client_channel& channel, messages::message_header header)
+    -> boost::asio::awaitable<client_result<messages::login_request>>;
+
+template auto message_receiver<messages::login_request>::operator()(
+    memory_client_channel& channel, messages::message_header header)
+    -> boost::asio::awaitable<client_result<messages::login_request>>;
+
+template auto message_receiver<messages::echo_request>::operator()(
+    client_channel& channel, messages::message_header header)
+    -> boost::asio::awaitable<client_result<messages::echo_request>>;
+
+template auto message_receiver<messages::echo_request>::operator()(
+    local_client_channel& channel, messages::message_header header)
+    -> boost::asio::awaitable<client_result<messages::echo_request>>;
+
+template auto message_receiver<messages::echo_request>::operator()(
+    memory_client_channel& channel, messages::message_header header)
+    -> boost::asio::awaitable<client_result<messages::echo_request>>;
+
+auto decode_header(std::span<std::byte>& data) -> messages::message_header {
+  const auto header = decode_layout<messages::header_layout>(
+      take<messages::header_size>(data), header_fields);
+
+  // Extended frames never fit in a datagram.
+  return {
+      .total_size = header.total_size,
+      .type = validate_frame(header.type, header.total_size, false),
+      .sequence = header.sequence,
+  };
+}
+
+template <>
+auto decode_message<messages::login_request>(std::span<std::byte>& data,
+                                             messages::message_header header)
+    -> messages::login_request {
+  validate_type(header, messages::message_type::LOGIN_REQUEST);
+
+  return make_login_request(
+      std::move(header),
+      decode_fixed_part<messages::login_request>(
+          take<messages::layout_size<messages::login_request>>(data)));
+}
+
+auto decode_echo_payload(std::span<std::byte>& data,
+                         const messages::message_header& header)
+    -> std::span<std::byte> {
+  using schema = messages::message_schema<messages::echo_request>;
+
+  validate_type(header, messages::message_type::ECHO_REQUEST);
+
+  const auto message_size =
+      decode_fixed_part<messages::echo_request>(
+          take<sizeof(schema::layout)>(data))
+          .*schema::payload_size;
+
+  if (!sizes_payload<messages::echo_request>(header, message_size)) {
+    throw exceptions::client_error{"Message size mismatch."};
+  }
+
+  return take(data, message_size);
+}
+
 } // namespace mori_echo
@@ -1,94 +1,196 @@
 #include "message_sender/message_sender.hpp"
 
-#include <boost/endian/conversion.hpp>
+#include <algorithm>
 #include <cstdint>
 
 #include "exceptions/server_error.hpp"
+#include "message_codec/message_codec.hpp"
 #include "message_types/echo_response.hpp"
 #include "message_types/login_response.hpp"
-#include "mori_echo/server_config.hpp"
 #include "mori_status/login_status.hpp"
 
 namespace mori_echo {
 
-static_assert(config::byte_order == config::endian_mode::LITTLE_ENDIAN_MODE ||
-                  config::byte_order == config::endian_mode::BIG_ENDIAN_MODE,
-              "Invalid byte order configuration.");
-
-inline constexpr auto header_size =
-    sizeof(std::uint16_t) + sizeof(std::uint8_t) + sizeof(std::uint8_t);
+template <typename AsyncStream>
+auto send_message<messages::login_response>::operator()(
+    basic_client_channel<AsyncStream>& channel, std::uint8_t sequence,
+    mori_status::login_status status_code)
+    -> boost::asio::awaitable<client_result<void>> {
+  const auto frame = make_login_response_frame(sequence, status_code);
 
-[[nodiscard]] auto
-send_header(client_channel& channel, std::uint16_t total_size,
-            messages::message_type type, std::uint8_t sequence)
-    -> boost::asio::awaitable<void> {
-  co_await channel.send_as(total_size);
+  auto error = boost::system::error_code{};
+  co_await channel.send(frame, error);
 
-  co_await channel.send_as(
-      static_cast<std::underlying_type_t<decltype(type)>>(type));
+  if (error) {
+    co_return make_fault(error);
+  }
 
-  co_await channel.send_as(sequence);
+  co_return client_result<void>{};
 }
 
-auto send_message<messages::login_response>::operator()(
-    client_channel& channel, std::uint8_t sequence,
-    mori_status::login_status status_code) -> boost::asio::awaitable<void> {
-  auto total_size = std::uint16_t{header_size + sizeof(status_code)};
-
-  if constexpr (config::byte_order == config::endian_mode::LITTLE_ENDIAN_MODE) {
-    boost::endian::native_to_little_inplace(total_size);
-  } else {
-    boost::endian::native_to_big_inplace(total_size);
+template <typename AsyncStream>
+auto send_message<messages::echo_response>::operator()(
+    basic_client_channel<AsyncStream>& channel, std::uint8_t sequence,
+    const std::vector<std::byte>& message)
+    -> boost::asio::awaitable<client_result<void>> {
+  if (message.size() > max_payload_size<messages::echo_response>) {
+    throw exceptions::server_error{"Message too long."};
   }
 
-  co_await send_header(channel, total_size,
-                       messages::message_type::LOGIN_RESPONSE, sequence);
+  const auto prefix = encode_frame_prefix<messages::echo_response>(
+      sequence, {.message_size = static_cast<std::uint16_t>(message.size())},
+      message.size());
 
-  auto login_status_code =
-      static_cast<std::underlying_type_t<decltype(status_code)>>(status_code);
+  auto error = boost::system::error_code{};
+  co_await channel.send(prefix, error);
 
-  if constexpr (config::byte_order == config::endian_mode::LITTLE_ENDIAN_MODE) {
-    boost::endian::native_to_little_inplace(login_status_code);
-  } else {
-    boost::endian::native_to_big_inplace(login_status_code);
+  if (!error) {
+    co_await channel.send(message, error);
   }
 
-  co_await channel.send_as(login_status_code);
+  if (error) {
+    co_return make_fault(error);
+  }
+
+  co_return client_result<void>{};
 }
 
+template <typename AsyncStream>
 auto send_message<messages::echo_response>::operator()(
-    client_channel& channel, std::uint8_t sequence,
-    const std::vector<std::byte>& message) -> boost::asio::awaitable<void> {
-  constexpr auto max_message_size = std::numeric_limits<std::uint16_t>::max() -
-                                    sizeof(std::uint16_t) - header_size;
-
-  if (message.size() > max_message_size) {
+    basic_client_channel<AsyncStream>& channel, std::uint8_t sequence,
+    std::vector<std::byte>&& message)
+    -> boost::asio::awaitable<client_result<void>> {
+  if (message.size() > max_payload_size<messages::echo_response>) {
     throw exceptions::server_error{"Message too long."};
   }
 
-  auto total_size = static_cast<std::uint16_t>(
-      header_size + sizeof(std::uint16_t) + message.size());
+  const auto prefix = encode_frame_prefix<messages::echo_response>(
+      sequence, {.message_size = static_cast<std::uint16_t>(message.size())},
+      message.size());
 
-  if constexpr (config::byte_order == config::endian_mode::LITTLE_ENDIAN_MODE) {
-    boost::endian::native_to_little_inplace(total_size);
-  } else {
-    boost::endian::native_to_big_inplace(total_size);
+  auto error = boost::system::error_code{};
+  co_await channel.send_pinned(prefix, std::move(message), error);
+
+  if (error) {
+    co_return make_fault(error);
   }
 
-  co_await send_header(channel, total_size,
-                       messages::message_type::ECHO_RESPONSE, sequence);
+  co_return client_result<void>{};
+}
+
+template <typename AsyncStream>
+auto send_echo_header(basic_client_channel<AsyncStream>& channel,
+                      std::uint8_t sequence, std::uint32_t message_size,
+                      bool is_extended)
+    -> boost::asio::awaitable<client_result<void>> {
+  auto error = boost::system::error_code{};
 
-  auto message_size = static_cast<std::uint16_t>(message.size());
+  if (!is_extended) {
+    if (message_size > max_payload_size<messages::echo_response>) {
+      throw exceptions::server_error{"Message too long."};
+    }
 
-  if constexpr (config::byte_order == config::endian_mode::LITTLE_ENDIAN_MODE) {
-    boost::endian::native_to_little_inplace(message_size);
+    const auto prefix = encode_frame_prefix<messages::echo_response>(
+        sequence, {.message_size = static_cast<std::uint16_t>(message_size)},
+        message_size);
+
+    co_await channel.send(prefix, error);
   } else {
-    boost::endian::native_to_big_inplace(message_size);
+    if (message_size > max_extended_payload_size<messages::echo_response>) {
+      throw exceptions::server_error{"Message too long."};
+    }
+
+    const auto prefix = encode_extended_frame_prefix<messages::echo_response>(
+        sequence, {.message_size = message_size}, message_size);
+
+    co_await channel.send(prefix, error);
+  }
+
+  if (error) {
+    co_return make_fault(error);
+  }
+
+  co_return client_result<void>{};
+}
+
+template auto send_message<messages::login_response>::operator()(
+    client_channel& channel, std::uint8_t sequence,
+    mori_status::login_status status_code)
+    -> boost::asio::awaitable<client_result<void>>;
+
+template auto send_message<messages::login_response>::operator()(
+    local_client_channel& channel, std::uint8_t sequence,
+    mori_status::login_status status_code)
+    -> boost::asio::awaitable<client_result<void>>;
+
+template auto send_message<messages::login_response>::operator()(
+    memory_client_channel& channel, std::uint8_t sequence,
+    mori_status::login_status status_code)
+    -> boost::asio::awaitable<client_result<void>>;
+
+template auto send_message<messages::echo_response>::operator()(
+    client_channel& channel, std::uint8_t sequence,
+    const std::vector<std::byte>& message)
+    -> boost::asio::awaitable<client_result<void>>;
+
+template auto send_message<messages::echo_response>::operator()(
+    local_client_channel& channel, std::uint8_t sequence,
+    const std::vector<std::byte>& message)
+    -> boost::asio::awaitable<client_result<void>>;
+
+template auto send_message<messages::echo_response>::operator()(
+    memory_client_channel& channel, std::uint8_t sequence,
+    const std::vector<std::byte>& message)
+    -> boost::asio::awaitable<client_result<void>>;
+
+template auto send_message<messages::echo_response>::operator()(
+    client_channel& channel, std::uint8_t sequence,
+    std::vector<std::byte>&& message)
+    -> boost::asio::awaitable<client_result<void>>;
+
+template auto send_message<messages::echo_response>::operator()(
+    local_client_channel& channel, std::uint8_t sequence,
+    std::vector<std::byte>&& message)
+    -> boost::asio::awaitable<client_result<void>>;
+
+template auto send_message<messages::echo_response>::operator()(
+    memory_client_channel& channel, std::uint8_t sequence,
+    std::vector<std::byte>&& message)
+    -> boost::asio::awaitable<client_result<void>>;
+
+template auto send_echo_header(client_channel& channel, std::uint8_t sequence,
+                               std::uint32_t message_size, bool is_extended)
+    -> boost::asio::awaitable<client_result<void>>;
+
+template auto send_echo_header(local_client_channel& channel,
+                               std::uint8_t sequence,
+                               std::uint32_t message_size, bool is_extended)
+    -> boost::asio::awaitable<client_result<void>>;
+
+template auto send_echo_header(memory_client_channel& channel,
+                               std::uint8_t sequence,
+                               std::uint32_t message_size, bool is_extended)
+    -> boost::asio::awaitable<client_result<void>>;
+
+auto encode_login_response(
+    std::span<std::byte, login_response_frame_size> data, std::uint8_t sequence,
+    mori_status::login_status status_code) -> void {
+  const auto frame = make_login_response_frame(sequence, status_code);
+
+  std::copy(frame.begin(), frame.end(), data.begin());
+}
+
+auto encode_echo_header(std::span<std::byte, echo_response_framing_size> data,
+                        std::uint8_t sequence, std::uint16_t message_size)
+    -> void {
+  if (message_size > max_payload_size<messages::echo_response>) {
+    throw exceptions::server_error{"Message too long."};
   }
 
-  co_await channel.send_as(message_size);
+  const auto framing = encode_frame_prefix<messages::echo_response>(
+      sequence, {.message_size = message_size}, message_size);
 
-  co_await channel.send(message);
+  std::copy(framing.begin(), framing.end(), data.begin());
 }
 
 } // namespace mori_echo
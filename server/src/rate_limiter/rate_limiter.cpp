@@ -0,0 +1,94 @@
+#include "rate_limiter/rate_limiter.hpp"
+
+#include <algorithm>
+#include <utility>
+
+namespace mori_echo {
+
+// Time a bucket refilling `rate` tokens per second takes to refill `tokens`.
+[[nodiscard]] auto refill_time(std::uint64_t tokens, std::uint64_t rate)
+    -> std::chrono::nanoseconds {
+  constexpr auto nanoseconds_per_second = std::uint64_t{1'000'000'000};
+
+  // Split so that large frames at low rates do not overflow.
+  const auto whole_seconds = tokens / rate;
+  const auto rest = tokens % rate * nanoseconds_per_second / rate;
+
+  return std::chrono::seconds{whole_seconds} +
+         std::chrono::nanoseconds{rest};
+}
+
+// Takes `tokens` out of the bucket full again at `full`, and returns how long
+// until it is back within its burst.
+[[nodiscard]] auto take_tokens(rate_limiter::clock::time_point& full,
+                               std::uint64_t tokens, std::uint64_t rate,
+                               std::uint64_t burst,
+                               rate_limiter::clock::time_point now)
+    -> std::chrono::nanoseconds {
+  if (rate == 0) {
+    return {};
+  }
+
+  full = std::max(full, now) + refill_time(tokens, rate);
+
+  const auto ahead = full - now - refill_time(burst, rate);
+
+  return std::max(std::chrono::nanoseconds{ahead}, std::chrono::nanoseconds{});
+}
+
+auto rate_limiter::create(rate_limit_options options)
+    -> std::shared_ptr<rate_limiter> {
+  return std::shared_ptr<rate_limiter>{new rate_limiter{std::move(options)}};
+}
+
+rate_limiter::rate_limiter(rate_limit_options options)
+    : options{std::move(options)} {
+  limits.push_back(this->options.defaults);
+
+  for (const auto& [username, user] : this->options.users) {
+    user_limits.emplace(username, static_cast<std::uint32_t>(limits.size()));
+    limits.push_back(user);
+  }
+}
+
+auto rate_limiter::assign(rate_limit_state& state,
+                          std::string_view username) const -> void {
+  const auto user = user_limits.find(std::string{username});
+
+  state.limits = user == user_limits.end() ? 0 : user->second;
+}
+
+auto rate_limiter::take(rate_limit_state& state, std::uint64_t bytes,
+                        clock::time_point now) const
+    -> std::chrono::nanoseconds {
+  const auto& session = limits[state.limits];
+
+  const auto message_wait =
+      take_tokens(state.messages_full, 1, session.messages_per_second,
+                  session.message_burst, now);
+
+  const auto byte_wait = take_tokens(state.bytes_full, bytes,
+                                     session.bytes_per_second,
+                                     session.byte_burst, now);
+
+  return std::max(message_wait, byte_wait);
+}
+
+auto rate_limiter::record(rate_limit_action action,
+                          std::chrono::nanoseconds delay) -> void {
+  counts[static_cast<std::size_t>(action)].fetch_add(1,
+                                                     std::memory_order_relaxed);
+
+  delay_ns.fetch_add(delay.count(), std::memory_order_relaxed);
+}
+
+auto rate_limiter::count(rate_limit_action action) const -> std::uint64_t {
+  return counts[static_cast<std::size_t>(action)].load(
+      std::memory_order_relaxed);
+}
+
+auto rate_limiter::total_delay() const -> std::chrono::nanoseconds {
+  return std::chrono::nanoseconds{delay_ns.load(std::memory_order_relaxed)};
+}
+
+} // namespace mori_echo
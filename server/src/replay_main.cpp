@@ -0,0 +1,42 @@
+#include <boost/asio/ip/address.hpp>
+#include <cstdlib>
+#include <exception>
+#include <spdlog/spdlog.h>
+#include <string>
+
+#include "traffic_capture/traffic_replay.hpp"
+
+// Replays a capture recorded by a server started with MORI_ECHO_CAPTURE:
+// `mori_echo_replay <capture> <address> <port> [speed]`.
+auto main(int argc, char** argv) -> int {
+  if (argc < 4 || argc > 5) {
+    spdlog::error("Usage: {} <capture> <address> <port> [speed]", argv[0]);
+    return -1;
+  }
+
+  try {
+    const auto server = boost::asio::ip::tcp::endpoint{
+        boost::asio::ip::make_address(argv[2]),
+        static_cast<std::uint16_t>(std::stoul(argv[3]))};
+
+    const auto options = mori_echo::capture::replay_options{
+        .speed = argc == 5 ? std::stod(argv[4]) : 1.0,
+    };
+
+    const auto log = mori_echo::capture::read_capture(argv[1]);
+
+    spdlog::info("Replaying {} records to {}:{} at {}x speed.",
+                 log.records.size(), server.address().to_string(),
+                 server.port(), options.speed);
+
+    const auto stats = mori_echo::capture::replay(log, server, options);
+
+    spdlog::info("Replayed {} sessions, {} failed. Sent {} bytes, received {} "
+                 "bytes.",
+                 stats.sessions, stats.failed_sessions, stats.bytes_sent,
+                 stats.bytes_received);
+  } catch (const std::exception& error) {
+    spdlog::error("Fatal error: {}", error.what());
+    return -1;
+  }
+}
@@ -0,0 +1,412 @@
+#include "shm_listener/shm_listener.hpp"
+
+#include <algorithm>
+#include <array>
+#include <boost/asio/co_spawn.hpp>
+#include <boost/asio/local/stream_protocol.hpp>
+#include <boost/asio/posix/stream_descriptor.hpp>
+#include <boost/asio/post.hpp>
+#include <boost/asio/use_awaitable.hpp>
+#include <cassert>
+#include <cerrno>
+#include <cstring>
+#include <exception>
+#include <memory>
+#include <span>
+#include <spdlog/spdlog.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <vector>
+
+#include "client_crypto/client_crypto.hpp"
+#include "client_session/client_session.hpp"
+#include "exceptions/client_error.hpp"
+#include "message_receiver/message_receiver.hpp"
+#include "message_sender/message_sender.hpp"
+#include "message_types/login_request.hpp"
+#include "mori_status/login_status.hpp"
+#include "shm_listener/shm_ring.hpp"
+
+namespace mori_echo::shm {
+
+[[nodiscard]] inline auto logger() -> std::shared_ptr<spdlog::logger> {
+  static auto logger = spdlog::default_logger()->clone("shm_listener");
+  return logger;
+}
+
+// What a session shares with its client, and the control socket whose closing
+// ends it.
+struct shm_session {
+  boost::asio::local::stream_protocol::socket control;
+
+  unique_fd memory;
+  shm_mapping mapping;
+
+  // Signaled by the client when the request ring goes non-empty.
+  boost::asio::posix::stream_descriptor request_signal;
+
+  // Signaled by the server when the response ring goes non-empty.
+  boost::asio::posix::stream_descriptor response_signal;
+
+  bool is_control_closed = false;
+};
+
+[[nodiscard]] auto make_eventfd(boost::asio::any_io_executor executor)
+    -> boost::asio::posix::stream_descriptor {
+  const auto fd = ::eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+
+  if (fd < 0) {
+    throw boost::system::system_error{
+        boost::system::error_code{errno, boost::system::system_category()},
+        "eventfd"};
+  }
+
+  return {executor, fd};
+}
+
+[[nodiscard]] auto
+make_shm_session(boost::asio::local::stream_protocol::socket control)
+    -> std::shared_ptr<shm_session> {
+  auto executor = control.get_executor();
+
+  auto memory = create_region_file();
+  auto mapping = shm_mapping{memory};
+
+  return std::make_shared<shm_session>(
+      std::move(control), std::move(memory), std::move(mapping),
+      make_eventfd(executor), make_eventfd(executor));
+}
+
+auto signal(boost::asio::posix::stream_descriptor& eventfd) -> void {
+  const auto value = std::uint64_t{1};
+
+  // Only fails if the counter would overflow, which leaves it readable anyway.
+  [[maybe_unused]] const auto written =
+      ::write(eventfd.native_handle(), &value, sizeof(value));
+}
+
+auto clear_signal(boost::asio::posix::stream_descriptor& eventfd) -> void {
+  auto value = std::uint64_t{};
+
+  [[maybe_unused]] const auto read =
+      ::read(eventfd.native_handle(), &value, sizeof(value));
+}
+
+// Hands the memory file and both eventfds to the client.
+[[nodiscard]] auto send_handshake(shm_session& session)
+    -> boost::asio::awaitable<void> {
+  const auto fds = std::array{
+      session.memory.get(),
+      session.request_signal.native_handle(),
+      session.response_signal.native_handle(),
+  };
+
+  auto payload = std::byte{1};
+  auto payload_data = ::iovec{.iov_base = &payload, .iov_len = sizeof(payload)};
+
+  alignas(::cmsghdr) auto control_data =
+      std::array<char, CMSG_SPACE(sizeof(fds))>{};
+
+  auto message = ::msghdr{};
+  message.msg_iov = &payload_data;
+  message.msg_iovlen = 1;
+  message.msg_control = control_data.data();
+  message.msg_controllen = control_data.size();
+
+  auto* rights = CMSG_FIRSTHDR(&message);
+  rights->cmsg_level = SOL_SOCKET;
+  rights->cmsg_type = SCM_RIGHTS;
+  rights->cmsg_len = CMSG_LEN(sizeof(fds));
+
+  std::memcpy(CMSG_DATA(rights), fds.data(), sizeof(fds));
+
+  for (;;) {
+    if (::sendmsg(session.control.native_handle(), &message,
+                  MSG_DONTWAIT | MSG_NOSIGNAL) >= 0) {
+      co_return;
+    }
+
+    if (errno == EAGAIN || errno == EWOULDBLOCK) {
+      co_await session.control.async_wait(
+          boost::asio::local::stream_protocol::socket::wait_write,
+          boost::asio::use_awaitable);
+    } else if (errno != EINTR) {
+      throw boost::system::system_error{
+          boost::system::error_code{errno, boost::system::system_category()},
+          "sendmsg"};
+    }
+  }
+}
+
+// Handles one frame of the request ring, writing its reply to the back of
+// `responses`. Returns whether the client must be signaled.
+[[nodiscard]] auto handle_frame(std::span<std::byte> frame,
+                                shm_ring& responses,
+                                client_session& session,
+                                const echo_server_config& cfg) -> bool {
+  auto data = frame;
+
+  const auto header = decode_header(data);
+
+  auto* reply = responses.back();
+
+  if (reply == nullptr) {
+    throw exceptions::client_error{"Too many requests in flight."};
+  }
+
+  if (!session.is_logged_in) {
+    if (header.type != messages::message_type::LOGIN_REQUEST) {
+      throw exceptions::client_error{"The client is not logged in."};
+    }
+
+    // The client can still write to its slot, so the credentials are copied
+    // out before being read as strings.
+    auto login_data = std::vector<std::byte>(data.begin(), data.end());
+    auto login_frame = std::span{login_data};
+
+    const auto login =
+        decode_message<messages::login_request>(login_frame, header);
+
+    if (!login_frame.empty()) {
+      throw exceptions::client_error{
+          "Unexpected data after the login request."};
+    }
+
+    auto authentication_error = std::exception_ptr{};
+
+    try {
+      cfg.authenticator->authenticate(login.username, login.password);
+
+      session.username_sum = crypto::calculate_checksum(login.username);
+      session.password_sum = crypto::calculate_checksum(login.password);
+
+      session.is_logged_in = true;
+    } catch (const std::exception& error) {
+      authentication_error = std::current_exception();
+    }
+
+    encode_login_response(
+        std::span{reply->data}.first<login_response_frame_size>(),
+        header.sequence,
+        authentication_error ? mori_status::login_status::FAILED
+                             : mori_status::login_status::OK);
+
+    reply->size = login_response_frame_size;
+
+    const auto wake_client = responses.push();
+
+    if (authentication_error) {
+      try {
+        std::rethrow_exception(authentication_error);
+      } catch (const std::exception& error) {
+        std::throw_with_nested(
+            exceptions::client_error{"The client login failed."});
+      }
+    }
+
+    return wake_client;
+  }
+
+  switch (header.type) {
+    case messages::message_type::ECHO_REQUEST:
+      break;
+
+    case messages::message_type::LOGIN_RESPONSE:
+    case messages::message_type::ECHO_RESPONSE:
+      throw exceptions::client_error{
+          "The client should never send this message."};
+
+    case messages::message_type::LOGIN_REQUEST:
+      throw exceptions::client_error{"The client is already logged in."};
+  }
+
+  const auto payload = decode_echo_payload(data, header);
+
+  if (!data.empty()) {
+    throw exceptions::client_error{"Unexpected data after the echo request."};
+  }
+
+  // Decrypted once copied to the reply slot, so that the server never reads
+  // back what the client may have rewritten in the meantime.
+  const auto reply_payload = std::span{reply->data}.subspan(
+      echo_response_framing_size, payload.size());
+
+  std::copy(payload.begin(), payload.end(), reply_payload.begin());
+
+  if (cfg.enable_decryption) {
+    auto state = crypto::make_cipher_state({
+        .username_sum = session.username_sum,
+        .password_sum = session.password_sum,
+        .sequence = header.sequence,
+    });
+
+    crypto::decrypt_chunk(state, reply_payload);
+  }
+
+  encode_echo_header(
+      std::span{reply->data}.first<echo_response_framing_size>(),
+      header.sequence, static_cast<std::uint16_t>(payload.size()));
+
+  reply->size =
+      static_cast<std::uint32_t>(echo_response_framing_size + payload.size());
+
+  return responses.push();
+}
+
+// Handles the frames waiting in the request ring, at most a ring's worth so
+// that a busy client cannot hold the IO thread. Returns how many were handled.
+[[nodiscard]] auto drain_requests(shm_session& session, client_session& client,
+                                  const echo_server_config& cfg)
+    -> std::size_t {
+  auto& region = session.mapping.region();
+
+  auto handled = std::size_t{0};
+  auto wake_client = false;
+
+  for (; handled < ring_slots; ++handled) {
+    auto* request = region.requests.front();
+
+    if (request == nullptr) {
+      break;
+    }
+
+    // The size is written by the client, so it is bounded by the slot.
+    const auto size = std::min(std::size_t{request->size}, slot_capacity);
+
+    wake_client = handle_frame(std::span{request->data}.first(size),
+                               region.responses, client, cfg) ||
+                  wake_client;
+
+    region.requests.pop();
+  }
+
+  if (wake_client) {
+    signal(session.response_signal);
+  }
+
+  return handled;
+}
+
+[[nodiscard]] auto serve_requests(std::shared_ptr<shm_session> session,
+                                  client_session& client,
+                                  const echo_server_config& cfg)
+    -> boost::asio::awaitable<void> {
+  auto idle_polls = std::size_t{0};
+
+  while (!session->is_control_closed) {
+    if (drain_requests(*session, client, cfg) > 0) {
+      idle_polls = 0;
+
+      // Lets the other clients run between batches.
+      co_await boost::asio::post(session->control.get_executor(),
+                                 boost::asio::use_awaitable);
+    } else if (idle_polls < cfg.shm_spin_count) {
+      ++idle_polls;
+    } else {
+      idle_polls = 0;
+
+      co_await session->request_signal.async_wait(
+          boost::asio::posix::stream_descriptor::wait_read,
+          boost::asio::use_awaitable);
+
+      clear_signal(session->request_signal);
+    }
+  }
+}
+
+// Waits for the control socket to close, then wakes the session so that it
+// ends.
+[[nodiscard]] auto watch_control(std::shared_ptr<shm_session> session)
+    -> boost::asio::awaitable<void> {
+  auto ignored = std::byte{};
+
+  try {
+    for (;;) {
+      co_await session->control.async_read_some(
+          boost::asio::buffer(&ignored, sizeof(ignored)),
+          boost::asio::use_awaitable);
+    }
+  } catch (const boost::system::system_error&) {
+  }
+
+  session->is_control_closed = true;
+  session->request_signal.cancel();
+}
+
+[[nodiscard]] auto
+handle_shm_client(boost::asio::local::stream_protocol::socket control,
+                  echo_server_config cfg) -> boost::asio::awaitable<void> {
+  auto client = make_client_session();
+
+  logger()->info("New client connected: {}", client.uuid);
+
+  auto session = std::shared_ptr<shm_session>{};
+
+  try {
+    session = make_shm_session(std::move(control));
+
+    co_await send_handshake(*session);
+
+    boost::asio::co_spawn(session->control.get_executor(),
+                          watch_control(session),
+                          [](std::exception_ptr error) {
+                            if (error) {
+                              std::rethrow_exception(error);
+                            }
+                          });
+
+    co_await serve_requests(session, client, cfg);
+
+    logger()->info("Client {} disconnected.", client.uuid);
+  } catch (const boost::system::system_error& error) {
+    if (session && session->is_control_closed) {
+      logger()->info("Client {} disconnected.", client.uuid);
+    } else {
+      logger()->warn("Dropping client {}. Reason: {}", client.uuid,
+                     error.what());
+    }
+  } catch (const std::exception& error) {
+    logger()->warn("Dropping client {}. Reason: {}", client.uuid, error.what());
+  }
+
+  if (session) {
+    session->mapping.region().is_closed.store(1);
+    signal(session->response_signal);
+
+    auto ignored = boost::system::error_code{};
+    session->control.close(ignored);
+  }
+}
+
+} // namespace mori_echo::shm
+
+namespace mori_echo {
+
+auto shm_listen(boost::asio::any_io_executor executor, echo_server_config cfg)
+    -> boost::asio::awaitable<void> {
+  assert(cfg.shm_control_path.has_value());
+
+  // A socket file left behind by a previous run would fail the bind.
+  ::unlink(cfg.shm_control_path->c_str());
+
+  auto acceptor = boost::asio::local::stream_protocol::acceptor{
+      executor, {*cfg.shm_control_path}};
+
+  shm::logger()->info("Listening for shared-memory clients on: {}",
+                 acceptor.local_endpoint().path());
+
+  for (;;) {
+    auto control = co_await acceptor.async_accept(boost::asio::use_awaitable);
+
+    boost::asio::co_spawn(executor,
+                          shm::handle_shm_client(std::move(control), cfg),
+                          [](std::exception_ptr error) {
+                            if (error) {
+                              std::rethrow_exception(error);
+                            }
+                          });
+  }
+}
+
+} // namespace mori_echo
@@ -0,0 +1,118 @@
+#include "shm_listener/shm_ring.hpp"
+
+#include <boost/system/system_error.hpp>
+#include <cerrno>
+#include <new>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <utility>
+
+#include "exceptions/server_error.hpp"
+
+namespace mori_echo::shm {
+
+[[noreturn]] auto throw_last_error(const char* what) -> void {
+  throw boost::system::system_error{
+      boost::system::error_code{errno, boost::system::system_category()},
+      what};
+}
+
+unique_fd::unique_fd(unique_fd&& other) noexcept
+    : fd{std::exchange(other.fd, -1)} {}
+
+auto unique_fd::operator=(unique_fd&& other) noexcept -> unique_fd& {
+  if (this != &other) {
+    if (fd >= 0) {
+      ::close(fd);
+    }
+
+    fd = std::exchange(other.fd, -1);
+  }
+
+  return *this;
+}
+
+unique_fd::~unique_fd() {
+  if (fd >= 0) {
+    ::close(fd);
+  }
+}
+
+auto unique_fd::release() -> int { return std::exchange(fd, -1); }
+
+shm_mapping::shm_mapping(const unique_fd& memory) {
+  struct stat status = {};
+
+  if (::fstat(memory.get(), &status) < 0) {
+    throw_last_error("fstat");
+  }
+
+  // The file comes from the other side of the session.
+  if (static_cast<std::size_t>(status.st_size) != sizeof(shm_region)) {
+    throw exceptions::server_error{"Shared memory region size mismatch."};
+  }
+
+  auto* mapped = ::mmap(nullptr, sizeof(shm_region), PROT_READ | PROT_WRITE,
+                        MAP_SHARED, memory.get(), 0);
+
+  if (mapped == MAP_FAILED) {
+    throw_last_error("mmap");
+  }
+
+  address = static_cast<shm_region*>(mapped);
+
+  if (address->magic != region_magic) {
+    ::munmap(mapped, sizeof(shm_region));
+
+    throw exceptions::server_error{"Invalid shared memory region."};
+  }
+}
+
+shm_mapping::shm_mapping(shm_mapping&& other) noexcept
+    : address{std::exchange(other.address, nullptr)} {}
+
+auto shm_mapping::operator=(shm_mapping&& other) noexcept -> shm_mapping& {
+  if (this != &other) {
+    if (address != nullptr) {
+      ::munmap(address, sizeof(shm_region));
+    }
+
+    address = std::exchange(other.address, nullptr);
+  }
+
+  return *this;
+}
+
+shm_mapping::~shm_mapping() {
+  if (address != nullptr) {
+    ::munmap(address, sizeof(shm_region));
+  }
+}
+
+auto create_region_file() -> unique_fd {
+  auto memory = unique_fd{::memfd_create("mori_echo_shm", MFD_CLOEXEC)};
+
+  if (memory.get() < 0) {
+    throw_last_error("memfd_create");
+  }
+
+  if (::ftruncate(memory.get(), sizeof(shm_region)) < 0) {
+    throw_last_error("ftruncate");
+  }
+
+  auto* mapped = ::mmap(nullptr, sizeof(shm_region), PROT_READ | PROT_WRITE,
+                        MAP_SHARED, memory.get(), 0);
+
+  if (mapped == MAP_FAILED) {
+    throw_last_error("mmap");
+  }
+
+  new (mapped) shm_region{};
+
+  ::munmap(mapped, sizeof(shm_region));
+
+  return memory;
+}
+
+} // namespace mori_echo::shm
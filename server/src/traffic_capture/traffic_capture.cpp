@@ -0,0 +1,374 @@
+#include "traffic_capture/traffic_capture.hpp"
+
+#include <algorithm>
+#include <boost/system/system_error.hpp>
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <new>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <utility>
+
+#include "exceptions/server_error.hpp"
+
+namespace mori_echo::capture {
+
+[[noreturn]] auto throw_last_error(const char* what) -> void {
+  throw boost::system::system_error{
+      boost::system::error_code{errno, boost::system::system_category()},
+      what};
+}
+
+[[nodiscard]] constexpr auto align_record(std::size_t size) -> std::size_t {
+  return (size + record_alignment - 1) / record_alignment * record_alignment;
+}
+
+// Rings start on cache lines of their own.
+inline constexpr auto ring_alignment = sizeof(ring_header);
+
+[[nodiscard]] constexpr auto ring_size(std::size_t capacity) -> std::size_t {
+  return sizeof(ring_header) + capacity;
+}
+
+// Captures created so far, numbering them for `this_thread_ring`.
+std::atomic<std::uint64_t> captures_created = 0;
+
+// Bytes taken in the ring by the record at `offset`, padding included.
+[[nodiscard]] auto record_span(const std::byte* ring, std::size_t capacity,
+                               std::uint64_t offset) -> std::size_t {
+  const auto position = offset % capacity;
+  const auto room = capacity - position;
+
+  // Too short for a header: skipped as is by the writer.
+  if (room < sizeof(record_header)) {
+    return room;
+  }
+
+  auto header = record_header{};
+  std::memcpy(&header, ring + position, sizeof(header));
+
+  return align_record(sizeof(record_header) + header.captured_size);
+}
+
+capture_session::capture_session(capture_session&& other) noexcept
+    : owner{std::exchange(other.owner, nullptr)}, id{other.id} {}
+
+auto capture_session::operator=(capture_session&& other) noexcept
+    -> capture_session& {
+  if (this != &other) {
+    if (owner != nullptr) {
+      owner->record(record_kind::CLOSE, id, {});
+    }
+
+    owner = std::exchange(other.owner, nullptr);
+    id = other.id;
+  }
+
+  return *this;
+}
+
+capture_session::~capture_session() {
+  if (owner != nullptr) {
+    owner->record(record_kind::CLOSE, id, {});
+  }
+}
+
+auto traffic_capture::create(const std::string& path, std::size_t capacity,
+                             std::size_t snap_length, std::size_t rings)
+    -> std::shared_ptr<traffic_capture> {
+  rings = std::max(rings, std::size_t{1});
+  capacity = capacity / rings / ring_alignment * ring_alignment;
+
+  // A record never wraps, so padding and the record after it must both fit.
+  if (2 * align_record(sizeof(record_header) + snap_length) > capacity) {
+    throw exceptions::server_error{
+        "Capture ring too small for its snap length."};
+  }
+
+  const auto fd = ::open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC,
+                         0644);
+
+  if (fd < 0) {
+    throw_last_error("open");
+  }
+
+  const auto file_size = sizeof(file_header) + rings * ring_size(capacity);
+
+  // Reserves the blocks upfront, so that a full disk fails here rather than
+  // with a SIGBUS on some later record.
+  if (const auto error = ::posix_fallocate(fd, 0, file_size); error != 0) {
+    ::close(fd);
+
+    errno = error;
+    throw_last_error("posix_fallocate");
+  }
+
+  auto* mapped =
+      ::mmap(nullptr, file_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+
+  if (mapped == MAP_FAILED) {
+    const auto error = errno;
+    ::close(fd);
+
+    errno = error;
+    throw_last_error("mmap");
+  }
+
+  auto* header = new (mapped) file_header{};
+  header->capacity = capacity;
+  header->rings = rings;
+
+  for (auto i = std::size_t{0}; i < rings; ++i) {
+    new (static_cast<std::byte*>(mapped) + sizeof(file_header) +
+         i * ring_size(capacity)) ring_header{};
+  }
+
+  header->started_ns = static_cast<std::uint64_t>(
+      std::chrono::duration_cast<std::chrono::nanoseconds>(
+          std::chrono::system_clock::now().time_since_epoch())
+          .count());
+
+  return std::shared_ptr<traffic_capture>{
+      new traffic_capture{fd, header, snap_length}};
+}
+
+traffic_capture::traffic_capture(int fd, file_header* header,
+                                 std::size_t snap_length)
+    : fd{fd}, header{header}, snap_length{snap_length},
+      id{captures_created.fetch_add(1, std::memory_order_relaxed) + 1} {}
+
+traffic_capture::~traffic_capture() {
+  ::munmap(header,
+           sizeof(file_header) + header->rings * ring_size(header->capacity));
+  ::close(fd);
+}
+
+auto traffic_capture::open_session() -> capture_session {
+  const auto session = next_session.fetch_add(1, std::memory_order_relaxed);
+
+  record(record_kind::OPEN, session, {});
+
+  return {shared_from_this(), session};
+}
+
+auto traffic_capture::offsets(std::size_t ring) const -> ring_header& {
+  return *reinterpret_cast<ring_header*>(reinterpret_cast<std::byte*>(header) +
+                                         sizeof(file_header) +
+                                         ring * ring_size(header->capacity));
+}
+
+auto traffic_capture::records(std::size_t ring) const -> std::byte* {
+  return reinterpret_cast<std::byte*>(&offsets(ring)) + sizeof(ring_header);
+}
+
+auto traffic_capture::this_thread_ring() -> std::size_t {
+  struct ring_claim {
+    std::uint64_t capture = 0;
+    std::size_t ring = 0;
+  };
+
+  // A single claim per thread, as a server records to a single capture.
+  // Threads recording to several in turns claim again on every switch, and
+  // end up sharing the last ring.
+  thread_local auto claim = ring_claim{};
+
+  if (claim.capture != id) {
+    claim = {
+        .capture = id,
+        .ring = std::min<std::size_t>(
+            next_ring.fetch_add(1, std::memory_order_relaxed),
+            header->rings - 1),
+    };
+  }
+
+  return claim.ring;
+}
+
+auto traffic_capture::evict_until(std::size_t ring, std::uint64_t end)
+    -> void {
+  auto& ring_offsets = offsets(ring);
+
+  const auto head = ring_offsets.head.load(std::memory_order_relaxed);
+  auto tail = ring_offsets.tail.load(std::memory_order_relaxed);
+
+  while (end - tail > header->capacity && tail < head) {
+    tail += record_span(records(ring), header->capacity, tail);
+  }
+
+  ring_offsets.tail.store(std::min(tail, head), std::memory_order_release);
+}
+
+auto traffic_capture::record(record_kind kind, std::uint32_t session,
+                             std::span<const std::byte> data) -> void {
+  const auto captured = std::min(data.size(), snap_length);
+
+  const auto record = record_header{
+      .timestamp_ns = static_cast<std::uint64_t>(
+          std::chrono::duration_cast<std::chrono::nanoseconds>(clock::now() -
+                                                               started)
+              .count()),
+      .session = session,
+      .original_size = static_cast<std::uint32_t>(data.size()),
+      .captured_size = static_cast<std::uint32_t>(captured),
+      .kind = kind,
+  };
+
+  const auto ring = this_thread_ring();
+
+  if (ring + 1 < header->rings) {
+    write(ring, record, data.first(captured));
+  } else {
+    const auto lock = std::scoped_lock{shared_writer};
+    write(ring, record, data.first(captured));
+  }
+}
+
+auto traffic_capture::write(std::size_t ring, const record_header& record,
+                            std::span<const std::byte> data) -> void {
+  const auto capacity = header->capacity;
+  const auto size = align_record(sizeof(record_header) + data.size());
+
+  auto& ring_offsets = offsets(ring);
+  auto* ring_records = records(ring);
+
+  auto position = ring_offsets.head.load(std::memory_order_relaxed);
+
+  // Records never wrap: the rest of the ring is padded instead.
+  if (const auto room = capacity - position % capacity; room < size) {
+    evict_until(ring, position + room + size);
+
+    if (room >= sizeof(record_header)) {
+      const auto padding = record_header{
+          .timestamp_ns = record.timestamp_ns,
+          .captured_size =
+              static_cast<std::uint32_t>(room - sizeof(record_header)),
+      };
+
+      std::memcpy(ring_records + position % capacity, &padding,
+                  sizeof(padding));
+    }
+
+    position += room;
+  } else {
+    evict_until(ring, position + size);
+  }
+
+  auto* destination = ring_records + position % capacity;
+
+  std::memcpy(destination, &record, sizeof(record));
+  std::memcpy(destination + sizeof(record), data.data(), data.size());
+
+  ring_offsets.head.store(position + size, std::memory_order_release);
+}
+
+// Appends the records left in a ring to `records`, oldest first.
+auto read_ring(const ring_header& offsets, const std::byte* ring,
+               std::size_t capacity, std::vector<captured_record>& records)
+    -> void {
+  const auto head = offsets.head.load(std::memory_order_acquire);
+
+  for (auto offset = offsets.tail.load(std::memory_order_acquire);
+       offset < head; offset += record_span(ring, capacity, offset)) {
+    const auto position = offset % capacity;
+
+    if (capacity - position < sizeof(record_header)) {
+      continue;
+    }
+
+    auto record = record_header{};
+    std::memcpy(&record, ring + position, sizeof(record));
+
+    if (record.kind == record_kind::PADDING) {
+      continue;
+    }
+
+    const auto* data = ring + position + sizeof(record);
+
+    records.push_back({
+        .timestamp = std::chrono::nanoseconds{record.timestamp_ns},
+        .session = record.session,
+        .kind = record.kind,
+        .original_size = record.original_size,
+        .data = {data, data + record.captured_size},
+    });
+  }
+}
+
+auto read_capture(const std::string& path) -> capture_log {
+  const auto fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+
+  if (fd < 0) {
+    throw_last_error("open");
+  }
+
+  struct stat status = {};
+
+  if (::fstat(fd, &status) < 0) {
+    const auto error = errno;
+    ::close(fd);
+
+    errno = error;
+    throw_last_error("fstat");
+  }
+
+  const auto file_size = static_cast<std::size_t>(status.st_size);
+
+  if (file_size < sizeof(file_header)) {
+    ::close(fd);
+
+    throw exceptions::server_error{"Truncated capture file."};
+  }
+
+  auto* mapped = ::mmap(nullptr, file_size, PROT_READ, MAP_SHARED, fd, 0);
+
+  if (mapped == MAP_FAILED) {
+    const auto error = errno;
+    ::close(fd);
+
+    errno = error;
+    throw_last_error("mmap");
+  }
+
+  ::close(fd);
+
+  const auto& header = *static_cast<const file_header*>(mapped);
+
+  if (header.magic != capture_magic ||
+      sizeof(file_header) + header.rings * ring_size(header.capacity) !=
+          file_size) {
+    ::munmap(mapped, file_size);
+
+    throw exceptions::server_error{"Invalid capture file."};
+  }
+
+  auto log = capture_log{
+      .started = std::chrono::system_clock::time_point{
+          std::chrono::duration_cast<std::chrono::system_clock::duration>(
+              std::chrono::nanoseconds{header.started_ns})},
+      .records = {},
+  };
+
+  for (auto i = std::size_t{0}; i < header.rings; ++i) {
+    const auto* ring = static_cast<const std::byte*>(mapped) +
+                       sizeof(file_header) + i * ring_size(header.capacity);
+
+    read_ring(*reinterpret_cast<const ring_header*>(ring),
+              ring + sizeof(ring_header), header.capacity, log.records);
+  }
+
+  // Rings are each in order already, so sessions moved between threads keep
+  // their records in order.
+  std::stable_sort(log.records.begin(), log.records.end(),
+                   [](const captured_record& left,
+                      const captured_record& right) {
+                     return left.timestamp < right.timestamp;
+                   });
+
+  ::munmap(mapped, file_size);
+
+  return log;
+}
+
+} // namespace mori_echo::capture
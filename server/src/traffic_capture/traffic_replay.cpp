@@ -0,0 +1,173 @@
+#include "traffic_capture/traffic_replay.hpp"
+
+#include <array>
+#include <boost/asio/co_spawn.hpp>
+#include <boost/asio/io_context.hpp>
+#include <boost/asio/redirect_error.hpp>
+#include <boost/asio/steady_timer.hpp>
+#include <boost/asio/use_awaitable.hpp>
+#include <boost/asio/write.hpp>
+#include <chrono>
+#include <exception>
+#include <map>
+#include <memory>
+#include <vector>
+
+namespace mori_echo::capture {
+
+using replay_clock = std::chrono::steady_clock;
+
+// When a record is due, given when the replay started and the timestamp of
+// the first record of the capture.
+struct replay_schedule {
+  replay_clock::time_point started;
+  std::chrono::nanoseconds first;
+  double speed;
+
+  [[nodiscard]] auto due(const captured_record& record) const
+      -> replay_clock::time_point {
+    if (speed <= 0) {
+      return started;
+    }
+
+    return started +
+           std::chrono::duration_cast<replay_clock::duration>(
+               std::chrono::duration<double, std::nano>(
+                   static_cast<double>((record.timestamp - first).count()) /
+                   speed));
+  }
+};
+
+[[nodiscard]] auto wait_until(boost::asio::steady_timer& timer,
+                              replay_clock::time_point due)
+    -> boost::asio::awaitable<void> {
+  if (due <= replay_clock::now()) {
+    co_return;
+  }
+
+  timer.expires_at(due);
+
+  auto error = boost::system::error_code{};
+  co_await timer.async_wait(
+      boost::asio::redirect_error(boost::asio::use_awaitable, error));
+}
+
+// Reads and discards the responses of a session until the server closes it.
+[[nodiscard]] auto
+drain_responses(std::shared_ptr<boost::asio::ip::tcp::socket> socket,
+                replay_stats& stats) -> boost::asio::awaitable<void> {
+  auto buffer = std::array<std::byte, 16 * 1024>{};
+  auto error = boost::system::error_code{};
+
+  while (!error) {
+    stats.bytes_received += co_await socket->async_read_some(
+        boost::asio::buffer(buffer),
+        boost::asio::redirect_error(boost::asio::use_awaitable, error));
+  }
+}
+
+[[nodiscard]] auto replay_session(std::vector<const captured_record*> records,
+                                  boost::asio::ip::tcp::endpoint server,
+                                  replay_schedule schedule, replay_stats& stats)
+    -> boost::asio::awaitable<void> {
+  auto executor = co_await boost::asio::this_coro::executor;
+
+  auto timer = boost::asio::steady_timer{executor};
+
+  // Shared with the reader, which outlives this writer until the server
+  // closes its end.
+  auto socket = std::make_shared<boost::asio::ip::tcp::socket>(executor);
+
+  auto error = boost::system::error_code{};
+
+  // From the first record left of the session, in case the capture lost its
+  // opening to the ring.
+  co_await wait_until(timer, schedule.due(*records.front()));
+
+  co_await socket->async_connect(
+      server, boost::asio::redirect_error(boost::asio::use_awaitable, error));
+
+  if (error) {
+    ++stats.failed_sessions;
+    co_return;
+  }
+
+  boost::asio::co_spawn(executor, drain_responses(socket, stats),
+                        [](std::exception_ptr error) {
+                          if (error) {
+                            std::rethrow_exception(error);
+                          }
+                        });
+
+  auto payload = std::vector<std::byte>{};
+
+  for (const auto* record : records) {
+    co_await wait_until(timer, schedule.due(*record));
+
+    if (record->kind == record_kind::CLOSE) {
+      break;
+    }
+
+    if (record->kind != record_kind::DATA) {
+      continue;
+    }
+
+    payload.assign(record->data.begin(), record->data.end());
+    payload.resize(record->original_size);
+
+    co_await boost::asio::async_write(
+        *socket, boost::asio::buffer(payload),
+        boost::asio::redirect_error(boost::asio::use_awaitable, error));
+
+    if (error) {
+      ++stats.failed_sessions;
+      co_return;
+    }
+
+    stats.bytes_sent += payload.size();
+  }
+
+  // The server sees the client leave, and closes its end for the reader.
+  socket->shutdown(boost::asio::ip::tcp::socket::shutdown_send, error);
+}
+
+auto replay(const capture_log& log,
+            const boost::asio::ip::tcp::endpoint& server,
+            const replay_options& options) -> replay_stats {
+  auto sessions =
+      std::map<std::uint32_t, std::vector<const captured_record*>>{};
+
+  for (const auto& record : log.records) {
+    sessions[record.session].push_back(&record);
+  }
+
+  auto stats = replay_stats{.sessions = sessions.size()};
+
+  if (sessions.empty()) {
+    return stats;
+  }
+
+  auto io_context = boost::asio::io_context{1};
+
+  const auto schedule = replay_schedule{
+      .started = replay_clock::now(),
+      .first = log.records.front().timestamp,
+      .speed = options.speed,
+  };
+
+  for (auto& [id, records] : sessions) {
+    boost::asio::co_spawn(
+        io_context, replay_session(std::move(records), server, schedule, stats),
+        [](std::exception_ptr error) {
+          if (error) {
+            std::rethrow_exception(error);
+          }
+        });
+  }
+
+  io_context.run();
+
+  return stats;
+}
+
+} // namespace mori_echo::capture
@@ -0,0 +1,226 @@
+#include "udp_listener/udp_listener.hpp"
+
+#include <array>
+#include <boost/asio/ip/udp.hpp>
+#include <boost/asio/use_awaitable.hpp>
+#include <cassert>
+#include <cerrno>
+#include <cstring>
+#include <memory>
+#include <span>
+#include <spdlog/spdlog.h>
+#include <sys/socket.h>
+#include <vector>
+
+#include "client_crypto/client_crypto.hpp"
+#include "exceptions/client_error.hpp"
+#include "message_receiver/message_receiver.hpp"
+#include "message_sender/message_sender.hpp"
+#include "message_types/login_request.hpp"
+#include "mori_status/login_status.hpp"
+
+namespace mori_echo::udp {
+
+[[nodiscard]] inline auto logger() -> std::shared_ptr<spdlog::logger> {
+  static auto logger = spdlog::default_logger()->clone("udp_listener");
+  return logger;
+}
+
+// Datagrams received and replied to per recvmmsg/sendmmsg call.
+inline constexpr auto udp_batch_size = std::size_t{32};
+
+inline constexpr auto max_datagram_size = std::size_t{65535};
+
+// Receive and reply headers for one batch. Replies point back into the
+// receive buffers, since an echo response fits where its request was.
+struct datagram_batch {
+  std::vector<std::byte> buffers =
+      std::vector<std::byte>(udp_batch_size * max_datagram_size);
+
+  std::array<::mmsghdr, udp_batch_size> received = {};
+  std::array<::iovec, udp_batch_size> received_data = {};
+  std::array<::sockaddr_storage, udp_batch_size> addresses = {};
+
+  std::array<::mmsghdr, udp_batch_size> replies = {};
+  std::array<::iovec, udp_batch_size> reply_data = {};
+
+  auto prepare_receive() -> void {
+    for (auto i = std::size_t{0}; i < udp_batch_size; ++i) {
+      received_data[i] = {
+          .iov_base = buffers.data() + i * max_datagram_size,
+          .iov_len = max_datagram_size,
+      };
+
+      received[i] = {};
+      received[i].msg_hdr.msg_name = &addresses[i];
+      received[i].msg_hdr.msg_namelen = sizeof(addresses[i]);
+      received[i].msg_hdr.msg_iov = &received_data[i];
+      received[i].msg_hdr.msg_iovlen = 1;
+    }
+  }
+
+  auto datagram(std::size_t index) -> std::span<std::byte> {
+    return {buffers.data() + index * max_datagram_size, received[index].msg_len};
+  }
+
+  auto add_reply(std::size_t count, std::size_t index,
+                 std::span<std::byte> reply) -> void {
+    reply_data[count] = {.iov_base = reply.data(), .iov_len = reply.size()};
+
+    replies[count] = {};
+    replies[count].msg_hdr.msg_name = &addresses[index];
+    replies[count].msg_hdr.msg_namelen = received[index].msg_hdr.msg_namelen;
+    replies[count].msg_hdr.msg_iov = &reply_data[count];
+    replies[count].msg_hdr.msg_iovlen = 1;
+  }
+};
+
+// Handles one probe in place, returning the reply to send, which is a view
+// into `datagram`.
+[[nodiscard]] auto handle_datagram(std::span<std::byte> datagram,
+                                   const echo_server_config& cfg)
+    -> std::span<std::byte> {
+  auto data = datagram;
+
+  const auto login_header = decode_header(data);
+  const auto login =
+      decode_message<messages::login_request>(data, login_header);
+
+  const auto echo_header = decode_header(data);
+  const auto payload = decode_echo_payload(data, echo_header);
+
+  if (!data.empty()) {
+    throw exceptions::client_error{"Unexpected data after the echo request."};
+  }
+
+  try {
+    cfg.authenticator->authenticate(login.username, login.password);
+  } catch (const std::exception& error) {
+    logger()->debug("Rejecting probe of user {}: {}", login.username,
+                    error.what());
+
+    const auto reply = datagram.first<login_response_frame_size>();
+
+    encode_login_response(reply, login.header.sequence,
+                          mori_status::login_status::FAILED);
+
+    return reply;
+  }
+
+  if (cfg.enable_decryption) {
+    auto state = crypto::make_cipher_state({
+        .username_sum = crypto::calculate_checksum(login.username),
+        .password_sum = crypto::calculate_checksum(login.password),
+        .sequence = echo_header.sequence,
+    });
+
+    crypto::decrypt_chunk(state, payload);
+  }
+
+  // The echo request framing is as long as the echo response one, so the
+  // response is written over it, right before the payload.
+  const auto reply_offset = static_cast<std::size_t>(
+      payload.data() - datagram.data() - echo_response_framing_size);
+
+  encode_echo_header(
+      datagram.subspan(reply_offset).first<echo_response_framing_size>(),
+      echo_header.sequence, static_cast<std::uint16_t>(payload.size()));
+
+  return datagram.subspan(reply_offset,
+                          echo_response_framing_size + payload.size());
+}
+
+[[nodiscard]] auto send_replies(boost::asio::ip::udp::socket& socket,
+                                std::span<::mmsghdr> replies)
+    -> boost::asio::awaitable<void> {
+  while (!replies.empty()) {
+    const auto sent = ::sendmmsg(socket.native_handle(), replies.data(),
+                                 static_cast<unsigned int>(replies.size()),
+                                 MSG_DONTWAIT);
+
+    if (sent >= 0) {
+      replies = replies.subspan(static_cast<std::size_t>(sent));
+    } else if (errno == EAGAIN || errno == EWOULDBLOCK) {
+      co_await socket.async_wait(boost::asio::ip::udp::socket::wait_write,
+                                 boost::asio::use_awaitable);
+    } else if (errno != EINTR) {
+      // Replies are best effort: a client gone away must not stop the
+      // listener.
+      logger()->debug("Dropping {} replies: {}", replies.size(),
+                      std::strerror(errno));
+
+      replies = replies.subspan(1);
+    }
+  }
+}
+
+} // namespace mori_echo::udp
+
+namespace mori_echo {
+
+auto udp_listen(boost::asio::any_io_executor executor, echo_server_config cfg)
+    -> boost::asio::awaitable<void> {
+  assert(cfg.udp_port.has_value());
+
+  auto socket = boost::asio::ip::udp::socket{
+      executor, {boost::asio::ip::udp::v4(), *cfg.udp_port}};
+
+  socket.non_blocking(true);
+
+  udp::logger()->info("Listening on UDP port: {}",
+                      socket.local_endpoint().port());
+
+  auto batch = std::make_unique<udp::datagram_batch>();
+
+  for (;;) {
+    co_await socket.async_wait(boost::asio::ip::udp::socket::wait_read,
+                               boost::asio::use_awaitable);
+
+    for (;;) {
+      batch->prepare_receive();
+
+      const auto received =
+          ::recvmmsg(socket.native_handle(), batch->received.data(),
+                     udp::udp_batch_size, MSG_DONTWAIT, nullptr);
+
+      if (received < 0) {
+        if (errno == EAGAIN || errno == EWOULDBLOCK) {
+          break;
+        } else if (errno == EINTR) {
+          continue;
+        }
+
+        throw boost::system::system_error{
+            boost::system::error_code{errno, boost::system::system_category()},
+            "recvmmsg"};
+      }
+
+      auto replies = std::size_t{0};
+
+      for (auto i = std::size_t{0}; i < static_cast<std::size_t>(received);
+           ++i) {
+        if ((batch->received[i].msg_hdr.msg_flags & MSG_TRUNC) != 0) {
+          udp::logger()->debug("Dropping truncated datagram.");
+          continue;
+        }
+
+        try {
+          batch->add_reply(replies, i,
+                           udp::handle_datagram(batch->datagram(i), cfg));
+          ++replies;
+        } catch (const exceptions::client_error& error) {
+          udp::logger()->debug("Dropping datagram. Reason: {}", error.what());
+        }
+      }
+
+      co_await udp::send_replies(socket,
+                                 std::span{batch->replies}.first(replies));
+
+      if (static_cast<std::size_t>(received) < udp::udp_batch_size) {
+        break;
+      }
+    }
+  }
+}
+
+} // namespace mori_echo
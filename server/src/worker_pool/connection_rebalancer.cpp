@@ -0,0 +1,161 @@
+#include "worker_pool/connection_rebalancer.hpp"
+
+#include <algorithm>
+#include <boost/asio/co_spawn.hpp>
+#include <boost/asio/redirect_error.hpp>
+#include <boost/asio/steady_timer.hpp>
+#include <boost/asio/use_awaitable.hpp>
+#include <spdlog/spdlog.h>
+
+#include "exceptions/server_error.hpp"
+
+namespace mori_echo::rebalancing {
+
+[[nodiscard]] inline auto logger() -> std::shared_ptr<spdlog::logger> {
+  static auto logger = spdlog::default_logger()->clone("rebalancer");
+  return logger;
+}
+
+} // namespace mori_echo::rebalancing
+
+namespace mori_echo {
+
+auto connection_rebalancer::create(std::shared_ptr<worker_pool> workers,
+                                   rebalancer_options options)
+    -> std::shared_ptr<connection_rebalancer> {
+  if (!workers || workers->size() == 0) {
+    throw exceptions::server_error{"Nothing to rebalance without workers."};
+  }
+
+  return std::shared_ptr<connection_rebalancer>{
+      new connection_rebalancer{std::move(workers), options}};
+}
+
+connection_rebalancer::connection_rebalancer(
+    std::shared_ptr<worker_pool> workers, rebalancer_options options)
+    : workers{std::move(workers)}, options{options},
+      loads(this->workers->size()),
+      previous_messages(this->workers->size(), 0) {}
+
+auto connection_rebalancer::start(boost::asio::any_io_executor executor)
+    -> void {
+  boost::asio::co_spawn(executor, compare_loads(shared_from_this()),
+                        [](std::exception_ptr error) {
+                          if (error) {
+                            std::rethrow_exception(error);
+                          }
+                        });
+}
+
+auto connection_rebalancer::stop() -> void {
+  is_stopped.store(true, std::memory_order_relaxed);
+}
+
+auto connection_rebalancer::compare_loads(
+    std::shared_ptr<connection_rebalancer> rebalancer)
+    -> boost::asio::awaitable<void> {
+  auto timer =
+      boost::asio::steady_timer{co_await boost::asio::this_coro::executor};
+  auto error = boost::system::error_code{};
+
+  while (!rebalancer->is_stopped.load(std::memory_order_relaxed)) {
+    timer.expires_after(rebalancer->options.interval);
+
+    co_await timer.async_wait(
+        boost::asio::redirect_error(boost::asio::use_awaitable, error));
+
+    if (error) {
+      co_return;
+    }
+
+    rebalancer->rebalance();
+  }
+}
+
+auto connection_rebalancer::rebalance() -> void {
+  for (auto i = std::size_t{0}; i < loads.size(); ++i) {
+    const auto messages = loads[i].messages.load(std::memory_order_relaxed);
+
+    loads[i].latest_load.store(messages - previous_messages[i],
+                               std::memory_order_relaxed);
+    previous_messages[i] = messages;
+
+    // Migrations not taken over the interval are dropped, as they were
+    // decided on stale loads.
+    loads[i].pending_migrations.store(0, std::memory_order_relaxed);
+  }
+
+  const auto [idlest, busiest] = std::minmax_element(
+      loads.begin(), loads.end(), [](const auto& lhs, const auto& rhs) {
+        return lhs.latest_load.load(std::memory_order_relaxed) <
+               rhs.latest_load.load(std::memory_order_relaxed);
+      });
+
+  const auto busiest_load =
+      busiest->latest_load.load(std::memory_order_relaxed);
+  const auto idlest_load = idlest->latest_load.load(std::memory_order_relaxed);
+
+  if (busiest_load < options.min_messages ||
+      static_cast<double>(busiest_load) <
+          options.imbalance_ratio * static_cast<double>(idlest_load)) {
+    return;
+  }
+
+  const auto target = static_cast<std::size_t>(idlest - loads.begin());
+
+  rebalancing::logger()->info(
+      "Worker {} handled {} messages, worker {} handled {}. Moving {} "
+      "sessions.",
+      busiest - loads.begin(), busiest_load, target, idlest_load,
+      options.migrations_per_interval);
+
+  busiest->migration_target.store(target, std::memory_order_relaxed);
+  busiest->pending_migrations.store(
+      static_cast<std::int64_t>(options.migrations_per_interval),
+      std::memory_order_release);
+}
+
+auto connection_rebalancer::record_message(std::size_t worker) -> void {
+  // Only ever written by the worker's own thread.
+  auto& messages = loads[worker].messages;
+  messages.store(messages.load(std::memory_order_relaxed) + 1,
+                 std::memory_order_relaxed);
+}
+
+auto connection_rebalancer::take_migration(std::size_t worker)
+    -> std::optional<std::size_t> {
+  auto& load = loads[worker];
+
+  if (load.pending_migrations.load(std::memory_order_acquire) <= 0 ||
+      load.pending_migrations.fetch_sub(1, std::memory_order_acquire) <= 0) {
+    return std::nullopt;
+  }
+
+  const auto target = load.migration_target.load(std::memory_order_relaxed);
+
+  load.migrations_out.fetch_add(1, std::memory_order_relaxed);
+  loads[target].migrations_in.fetch_add(1, std::memory_order_relaxed);
+
+  return target;
+}
+
+auto connection_rebalancer::migrations_in(std::size_t worker) const
+    -> std::uint64_t {
+  return loads.at(worker).migrations_in.load(std::memory_order_relaxed);
+}
+
+auto connection_rebalancer::migrations_out(std::size_t worker) const
+    -> std::uint64_t {
+  return loads.at(worker).migrations_out.load(std::memory_order_relaxed);
+}
+
+auto connection_rebalancer::load(std::size_t worker) const -> std::uint64_t {
+  return loads.at(worker).latest_load.load(std::memory_order_relaxed);
+}
+
+auto connection_rebalancer::pool() const
+    -> const std::shared_ptr<worker_pool>& {
+  return workers;
+}
+
+} // namespace mori_echo
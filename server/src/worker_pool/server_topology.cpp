@@ -0,0 +1,220 @@
+#include "worker_pool/server_topology.hpp"
+
+#include <algorithm>
+#include <charconv>
+#include <fstream>
+#include <map>
+#include <sched.h>
+#include <string>
+
+#include "exceptions/server_error.hpp"
+
+namespace mori_echo {
+
+[[nodiscard]] auto trim(std::string_view text) -> std::string_view {
+  constexpr auto whitespace = std::string_view{" \t\n"};
+
+  const auto begin = text.find_first_not_of(whitespace);
+
+  if (begin == std::string_view::npos) {
+    return {};
+  }
+
+  return text.substr(begin, text.find_last_not_of(whitespace) - begin + 1);
+}
+
+[[nodiscard]] auto parse_cpu(std::string_view text) -> unsigned {
+  auto cpu = unsigned{};
+
+  const auto [end, error] =
+      std::from_chars(text.data(), text.data() + text.size(), cpu);
+
+  if (error != std::errc{} || end != text.data() + text.size()) {
+    throw exceptions::server_error{"Invalid CPU number: " + std::string{text}};
+  }
+
+  // Past what a thread can be pinned to, and what ranges are bounded by.
+  if (cpu >= CPU_SETSIZE) {
+    throw exceptions::server_error{"CPU number out of range: " +
+                                   std::string{text}};
+  }
+
+  return cpu;
+}
+
+auto parse_cpu_list(std::string_view list) -> std::vector<unsigned> {
+  auto cpus = std::vector<unsigned>{};
+
+  list = trim(list);
+
+  while (!list.empty()) {
+    const auto comma = list.find(',');
+    const auto range = trim(list.substr(0, comma));
+
+    list = comma == std::string_view::npos ? std::string_view{}
+                                           : list.substr(comma + 1);
+
+    const auto dash = range.find('-');
+
+    const auto first = parse_cpu(trim(range.substr(0, dash)));
+    const auto last = dash == std::string_view::npos
+                          ? first
+                          : parse_cpu(trim(range.substr(dash + 1)));
+
+    if (last < first) {
+      throw exceptions::server_error{"Invalid CPU range: " +
+                                     std::string{range}};
+    }
+
+    for (auto cpu = first; cpu <= last; ++cpu) {
+      cpus.push_back(cpu);
+    }
+  }
+
+  std::sort(cpus.begin(), cpus.end());
+  cpus.erase(std::unique(cpus.begin(), cpus.end()), cpus.end());
+
+  return cpus;
+}
+
+[[nodiscard]] auto read_cpu_list(const std::filesystem::path& path)
+    -> std::optional<std::vector<unsigned>> {
+  auto file = std::ifstream{path};
+
+  if (!file) {
+    return std::nullopt;
+  }
+
+  auto list = std::string{};
+  std::getline(file, list);
+
+  return parse_cpu_list(list);
+}
+
+// Maps each CPU to its NUMA node, as listed in sysfs. Empty on kernels
+// without NUMA support.
+[[nodiscard]] auto read_cpu_nodes(const std::filesystem::path& sysfs_root)
+    -> std::map<unsigned, unsigned> {
+  auto nodes = std::map<unsigned, unsigned>{};
+
+  const auto node_root = sysfs_root / "devices/system/node";
+
+  auto error = std::error_code{};
+
+  for (const auto& entry :
+       std::filesystem::directory_iterator{node_root, error}) {
+    const auto name = entry.path().filename().string();
+
+    if (!name.starts_with("node") ||
+        name.find_first_not_of("0123456789", 4) != std::string::npos ||
+        name.size() == 4) {
+      continue;
+    }
+
+    const auto node = parse_cpu(std::string_view{name}.substr(4));
+
+    const auto cpus = read_cpu_list(entry.path() / "cpulist")
+                          .value_or(std::vector<unsigned>{});
+
+    for (const auto cpu : cpus) {
+      nodes[cpu] = node;
+    }
+  }
+
+  return nodes;
+}
+
+[[nodiscard]] auto place(std::vector<unsigned> cpus,
+                         const std::map<unsigned, unsigned>& cpu_nodes)
+    -> cpu_placement {
+  auto placement = cpu_placement{.cpus = std::move(cpus)};
+
+  for (const auto cpu : placement.cpus) {
+    const auto node = cpu_nodes.find(cpu);
+
+    if (node == cpu_nodes.end() ||
+        (placement.numa_node && *placement.numa_node != node->second)) {
+      placement.numa_node = std::nullopt;
+      break;
+    }
+
+    placement.numa_node = node->second;
+  }
+
+  return placement;
+}
+
+auto server_topology::parse(std::string_view layout,
+                            const std::filesystem::path& sysfs_root)
+    -> server_topology {
+  constexpr auto acceptor_prefix = std::string_view{"acceptor="};
+
+  const auto cpu_nodes = read_cpu_nodes(sysfs_root);
+
+  auto topology = server_topology{};
+
+  while (!layout.empty()) {
+    const auto separator = layout.find(';');
+    const auto entry = trim(layout.substr(0, separator));
+
+    layout = separator == std::string_view::npos ? std::string_view{}
+                                                 : layout.substr(separator + 1);
+
+    if (entry.empty()) {
+      continue;
+    }
+
+    if (entry.starts_with(acceptor_prefix)) {
+      topology.acceptor =
+          place(parse_cpu_list(entry.substr(acceptor_prefix.size())),
+                cpu_nodes);
+      continue;
+    }
+
+    auto cpus = parse_cpu_list(entry);
+
+    if (cpus.empty()) {
+      throw exceptions::server_error{"Worker without CPUs in layout."};
+    }
+
+    topology.workers.push_back(place(std::move(cpus), cpu_nodes));
+  }
+
+  if (topology.workers.empty()) {
+    throw exceptions::server_error{"No workers in layout."};
+  }
+
+  return topology;
+}
+
+auto server_topology::detect(std::size_t reserved_acceptor_cores,
+                             const std::filesystem::path& sysfs_root)
+    -> server_topology {
+  const auto cpu_nodes = read_cpu_nodes(sysfs_root);
+
+  auto online = read_cpu_list(sysfs_root / "devices/system/cpu/online")
+                    .value_or(std::vector<unsigned>{0});
+
+  if (online.empty()) {
+    online.push_back(0);
+  }
+
+  // Never leave the workers without a CPU.
+  const auto reserved = static_cast<std::ptrdiff_t>(
+      std::min(reserved_acceptor_cores, online.size() - 1));
+
+  auto topology = server_topology{};
+
+  if (reserved > 0) {
+    topology.acceptor =
+        place({online.begin(), online.begin() + reserved}, cpu_nodes);
+  }
+
+  for (auto cpu = online.begin() + reserved; cpu != online.end(); ++cpu) {
+    topology.workers.push_back(place({*cpu}, cpu_nodes));
+  }
+
+  return topology;
+}
+
+} // namespace mori_echo
@@ -0,0 +1,160 @@
+#include "worker_pool/worker_pool.hpp"
+
+#include <array>
+#include <boost/system/system_error.hpp>
+#include <cerrno>
+#include <climits>
+#include <linux/mempolicy.h>
+#include <pthread.h>
+#include <sched.h>
+#include <spdlog/spdlog.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include "exceptions/server_error.hpp"
+
+namespace mori_echo::workers {
+
+[[nodiscard]] inline auto logger() -> std::shared_ptr<spdlog::logger> {
+  static auto logger = spdlog::default_logger()->clone("worker_pool");
+  return logger;
+}
+
+auto pin_thread(pthread_t thread, const std::vector<unsigned>& cpus) -> void {
+  if (cpus.empty()) {
+    return;
+  }
+
+  auto cpu_set = ::cpu_set_t{};
+  CPU_ZERO(&cpu_set);
+
+  for (const auto cpu : cpus) {
+    if (cpu >= CPU_SETSIZE) {
+      throw exceptions::server_error{"CPU number out of range."};
+    }
+
+    CPU_SET(cpu, &cpu_set);
+  }
+
+  if (const auto error =
+          ::pthread_setaffinity_np(thread, sizeof(cpu_set), &cpu_set);
+      error != 0) {
+    throw boost::system::system_error{
+        boost::system::error_code{error, boost::system::system_category()},
+        "pthread_setaffinity_np"};
+  }
+}
+
+// Pages are placed on first touch, so pinned threads mostly get local memory
+// already. Preferring the node also covers memory that the allocator hands
+// back to this thread after another one first touched it.
+auto prefer_numa_node(unsigned node) -> void {
+  constexpr auto bits_per_word = sizeof(unsigned long) * CHAR_BIT;
+
+  auto node_mask = std::array<unsigned long, 16>{};
+
+  if (node >= node_mask.size() * bits_per_word) {
+    throw exceptions::server_error{"NUMA node out of range."};
+  }
+
+  node_mask[node / bits_per_word] = 1UL << (node % bits_per_word);
+
+  if (::syscall(SYS_set_mempolicy, MPOL_PREFERRED, node_mask.data(),
+                node_mask.size() * bits_per_word) != 0) {
+    throw boost::system::system_error{
+        boost::system::error_code{errno, boost::system::system_category()},
+        "set_mempolicy"};
+  }
+}
+
+} // namespace mori_echo::workers
+
+namespace mori_echo {
+
+auto apply_placement(const cpu_placement& placement) -> void {
+  workers::pin_thread(::pthread_self(), placement.cpus);
+
+  if (placement.numa_node) {
+    workers::prefer_numa_node(*placement.numa_node);
+  }
+}
+
+thread_local const worker_pool* worker_pool::current_pool = nullptr;
+thread_local std::size_t worker_pool::current_worker = 0;
+
+auto worker_pool::create(const server_topology& topology)
+    -> std::shared_ptr<worker_pool> {
+  auto pool = std::shared_ptr<worker_pool>{new worker_pool{}};
+
+  for (const auto& placement : topology.workers) {
+    auto& each = *pool->workers.emplace_back(std::make_unique<worker>());
+
+    each.thread = std::thread{[&context = each.context,
+                               numa_node = placement.numa_node,
+                               owner = pool.get(),
+                               index = pool->workers.size() - 1] {
+      current_pool = owner;
+      current_worker = index;
+
+      try {
+        if (numa_node) {
+          workers::prefer_numa_node(*numa_node);
+        }
+      } catch (const std::exception& error) {
+        workers::logger()->warn("Worker memory stays unbound. Reason: {}",
+                                error.what());
+      }
+
+      context.run();
+    }};
+
+    workers::pin_thread(each.thread.native_handle(), placement.cpus);
+
+    workers::logger()->info("Worker {} runs on CPUs {}, NUMA node {}",
+                            pool->workers.size() - 1,
+                            fmt::join(placement.cpus, ","),
+                            placement.numa_node.has_value()
+                                ? std::to_string(*placement.numa_node)
+                                : std::string{"any"});
+  }
+
+  return pool;
+}
+
+worker_pool::~worker_pool() { stop(); }
+
+auto worker_pool::next_executor() -> boost::asio::any_io_executor {
+  const auto index =
+      next_worker.fetch_add(1, std::memory_order_relaxed) % workers.size();
+
+  return workers[index]->context.get_executor();
+}
+
+auto worker_pool::size() const -> std::size_t { return workers.size(); }
+
+auto worker_pool::executor(std::size_t index) -> boost::asio::any_io_executor {
+  return workers.at(index)->context.get_executor();
+}
+
+auto worker_pool::this_worker() const -> std::optional<std::size_t> {
+  if (current_pool != this) {
+    return std::nullopt;
+  }
+
+  return current_worker;
+}
+
+auto worker_pool::stop() -> void {
+  for (auto& each : workers) {
+    each->work.reset();
+    each->context.stop();
+  }
+
+  for (auto& each : workers) {
+    if (each->thread.joinable()) {
+      each->thread.join();
+    }
+  }
+}
+
+} // namespace mori_echo
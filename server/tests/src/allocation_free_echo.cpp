@@ -0,0 +1,278 @@
+#include <atomic>
+#include <boost/asio/io_context.hpp>
+#include <boost/test/unit_test.hpp>
+#include <cstdlib>
+#include <new>
+#include <spdlog/spdlog.h>
+#include <thread>
+#include <vector>
+
+#include "client_authenticator/test_client_authenticator.hpp"
+#include "echo_client/blocking_echo_client.hpp"
+#include "echo_server/echo_server.hpp"
+
+namespace mori_echo::test {
+
+// Allocations made by counted threads while counting is on.
+std::atomic<bool> is_counting_allocations = false;
+std::atomic<std::uint64_t> counted_allocations = 0;
+
+thread_local bool is_counted_thread = false;
+
+auto count_allocation() -> void {
+  if (is_counted_thread &&
+      is_counting_allocations.load(std::memory_order_relaxed)) {
+    counted_allocations.fetch_add(1, std::memory_order_relaxed);
+  }
+}
+
+[[nodiscard]] auto counted_malloc(std::size_t size) -> void* {
+  count_allocation();
+
+  return std::malloc(size == 0 ? 1 : size);
+}
+
+[[nodiscard]] auto counted_aligned_alloc(std::size_t size,
+                                         std::align_val_t align) -> void* {
+  count_allocation();
+
+  const auto alignment = static_cast<std::size_t>(align);
+
+  return std::aligned_alloc(alignment,
+                            (size + alignment - 1) / alignment * alignment);
+}
+
+} // namespace mori_echo::test
+
+// Replaced for this suite's own test binary, counting only for threads
+// marked as counted.
+
+auto operator new(std::size_t size) -> void* {
+  if (auto* memory = mori_echo::test::counted_malloc(size)) {
+    return memory;
+  }
+
+  throw std::bad_alloc{};
+}
+
+auto operator new[](std::size_t size) -> void* { return operator new(size); }
+
+auto operator new(std::size_t size, const std::nothrow_t&) noexcept -> void* {
+  return mori_echo::test::counted_malloc(size);
+}
+
+auto operator new[](std::size_t size, const std::nothrow_t&) noexcept
+    -> void* {
+  return mori_echo::test::counted_malloc(size);
+}
+
+auto operator new(std::size_t size, std::align_val_t align) -> void* {
+  if (auto* memory = mori_echo::test::counted_aligned_alloc(size, align)) {
+    return memory;
+  }
+
+  throw std::bad_alloc{};
+}
+
+auto operator new[](std::size_t size, std::align_val_t align) -> void* {
+  return operator new(size, align);
+}
+
+auto operator delete(void* memory) noexcept -> void { std::free(memory); }
+
+auto operator delete[](void* memory) noexcept -> void { std::free(memory); }
+
+auto operator delete(void* memory, std::size_t) noexcept -> void {
+  std::free(memory);
+}
+
+auto operator delete[](void* memory, std::size_t) noexcept -> void {
+  std::free(memory);
+}
+
+auto operator delete(void* memory, std::align_val_t) noexcept -> void {
+  std::free(memory);
+}
+
+auto operator delete[](void* memory, std::align_val_t) noexcept -> void {
+  std::free(memory);
+}
+
+auto operator delete(void* memory, std::size_t, std::align_val_t) noexcept
+    -> void {
+  std::free(memory);
+}
+
+auto operator delete[](void* memory, std::size_t, std::align_val_t) noexcept
+    -> void {
+  std::free(memory);
+}
+
+namespace mori_echo::test {
+
+inline constexpr auto warm_up_echoes = std::size_t{256};
+inline constexpr auto counted_echoes = std::size_t{1024};
+
+// Serves on a thread of its own, whose allocations are counted, until
+// destroyed.
+class counted_server {
+public:
+  explicit counted_server(bool enable_decryption) {
+    const auto bound = mori_echo::spawn_server(
+        context.get_executor(),
+        {
+            .enable_decryption = enable_decryption,
+            .authenticator =
+                mori_echo::auth::test_client_authenticator::create(),
+        });
+
+    endpoint = {boost::asio::ip::address_v4::loopback(), bound.port()};
+
+    context.poll();
+
+    thread = std::thread{[this] {
+      is_counted_thread = true;
+      context.run();
+    }};
+  }
+
+  ~counted_server() {
+    context.stop();
+    thread.join();
+  }
+
+  // Where clients reach the server, over loopback.
+  boost::asio::ip::tcp::endpoint endpoint;
+
+private:
+  boost::asio::io_context context{1};
+
+  boost::asio::executor_work_guard<boost::asio::io_context::executor_type>
+      work = boost::asio::make_work_guard(context);
+
+  std::thread thread;
+};
+
+// Alternately below and above the size up to which responses are copied into
+// a batch.
+[[nodiscard]] auto make_steady_payload(std::size_t i)
+    -> std::vector<std::byte> {
+  return std::vector<std::byte>(i % 2 == 0 ? 100 : 3000,
+                                static_cast<std::byte>(i));
+}
+
+// Encrypting its payloads for servers which decrypt them, so that either
+// echoes them back as sent.
+[[nodiscard]] auto connect_counted_client(const counted_server& server,
+                                          bool encrypt)
+    -> client::blocking_echo_client {
+  return client::blocking_echo_client{
+      server.endpoint,
+      {.username = "testuser", .password = "testpass"},
+      {.connections = 1, .connection = {.encrypt = encrypt}}};
+}
+
+// Counts the server's allocations while `echo` runs.
+template <typename Echo>
+auto count_server_allocations(Echo echo) -> std::uint64_t {
+  counted_allocations = 0;
+  is_counting_allocations = true;
+
+  echo();
+
+  is_counting_allocations = false;
+
+  return counted_allocations;
+}
+
+auto echo_one_at_a_time(client::blocking_echo_client& client, std::size_t count)
+    -> void {
+  for (auto i = std::size_t{0}; i < count; ++i) {
+    const auto payload = make_steady_payload(i);
+    BOOST_REQUIRE(client.echo(payload) == payload);
+  }
+}
+
+// Pipelines `depth` echoes at a time.
+auto echo_pipelined(client::blocking_echo_client& client, std::size_t count,
+                    std::size_t depth) -> void {
+  for (auto i = std::size_t{0}; i < count; i += depth) {
+    auto payloads = std::vector<std::vector<std::byte>>{};
+
+    for (auto j = i; j < i + depth; ++j) {
+      payloads.push_back(make_steady_payload(j));
+    }
+
+    BOOST_REQUIRE(client.echo_all(payloads) == payloads);
+  }
+}
+
+// Past the largest regular frame, so that the server streams them through a
+// buffer of `stream_chunk_size` bytes.
+auto echo_extended(client::blocking_echo_client& client, std::size_t count)
+    -> void {
+  const auto payload = std::vector<std::byte>(70 * 1024, std::byte{'X'});
+
+  for (auto i = std::size_t{0}; i < count; ++i) {
+    BOOST_REQUIRE(client.echo(payload) == payload);
+  }
+}
+
+BOOST_AUTO_TEST_SUITE(allocation_free_echo)
+
+BOOST_AUTO_TEST_CASE(decrypted_echoes) {
+  spdlog::set_level(spdlog::level::info);
+
+  const auto server = counted_server{true};
+  auto client = connect_counted_client(server, true);
+
+  echo_one_at_a_time(client, warm_up_echoes);
+
+  BOOST_CHECK_EQUAL(count_server_allocations(
+                        [&] { echo_one_at_a_time(client, counted_echoes); }),
+                    0);
+}
+
+BOOST_AUTO_TEST_CASE(passed_through_echoes) {
+  spdlog::set_level(spdlog::level::info);
+
+  const auto server = counted_server{false};
+  auto client = connect_counted_client(server, false);
+
+  echo_one_at_a_time(client, warm_up_echoes);
+
+  BOOST_CHECK_EQUAL(count_server_allocations(
+                        [&] { echo_one_at_a_time(client, counted_echoes); }),
+                    0);
+}
+
+BOOST_AUTO_TEST_CASE(pipelined_echoes) {
+  spdlog::set_level(spdlog::level::info);
+
+  const auto server = counted_server{true};
+  auto client = connect_counted_client(server, true);
+
+  // Deeper than counted, so that response batches have grown to hold as many
+  // responses as they will.
+  echo_pipelined(client, counted_echoes, 64);
+
+  BOOST_CHECK_EQUAL(count_server_allocations(
+                        [&] { echo_pipelined(client, counted_echoes, 16); }),
+                    0);
+}
+
+BOOST_AUTO_TEST_CASE(extended_echoes) {
+  spdlog::set_level(spdlog::level::info);
+
+  const auto server = counted_server{true};
+  auto client = connect_counted_client(server, true);
+
+  echo_extended(client, 16);
+
+  BOOST_CHECK_EQUAL(
+      count_server_allocations([&] { echo_extended(client, 64); }), 0);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+} // namespace mori_echo::test
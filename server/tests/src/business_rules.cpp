@@ -1,6 +1,7 @@
 #include <boost/asio/co_spawn.hpp>
 #include <boost/asio/io_context.hpp>
 #include <boost/asio/ip/tcp.hpp>
+#include <boost/endian/conversion.hpp>
 #include <boost/test/framework.hpp>
 #include <boost/test/unit_test.hpp>
 #include <spdlog/fmt/bin_to_hex.h>
@@ -11,18 +12,17 @@
 #include "client_channel/client_channel.hpp"
 #include "client_crypto/test_client_crypto.hpp"
 #include "echo_server/echo_server.hpp"
-#include "message_receiver/message_receiver.hpp"
+#include "message_receiver/test_message_receiver.hpp"
 #include "message_sender/test_message_sender.hpp"
 #include "message_types/echo_request.hpp"
 #include "message_types/echo_response.hpp"
 #include "message_types/login_request.hpp"
 #include "message_types/login_response.hpp"
+#include "mori_echo/server_config.hpp"
 #include "mori_status/login_status.hpp"
 
 namespace mori_echo::test {
 
-inline constexpr auto test_tcp_port = std::uint16_t{31217};
-
 BOOST_AUTO_TEST_SUITE(business_rules)
 
 BOOST_AUTO_TEST_CASE(login_and_echo_decryption_enabled_success) {
@@ -34,10 +34,9 @@ BOOST_AUTO_TEST_CASE(login_and_echo_decryption_enabled_success) {
 
   auto io_context = boost::asio::io_context{1};
 
-  mori_echo::spawn_server(
+  const auto endpoint = mori_echo::spawn_server(
       io_context.get_executor(),
       {
-          .port = test_tcp_port,
           .enable_decryption = true,
           .authenticator =
               mori_echo::auth::allow_all_client_authenticator::create(),
@@ -52,7 +51,7 @@ BOOST_AUTO_TEST_CASE(login_and_echo_decryption_enabled_success) {
         auto socket = boost::asio::ip::tcp::socket{io_context};
 
         co_await socket.async_connect(
-            {boost::asio::ip::address::from_string("127.0.0.1"), test_tcp_port},
+            {boost::asio::ip::address_v4::loopback(), endpoint.port()},
             boost::asio::use_awaitable);
 
         auto channel = client_channel{std::move(socket)};
@@ -61,7 +60,7 @@ BOOST_AUTO_TEST_CASE(login_and_echo_decryption_enabled_success) {
         co_await send_message<messages::login_request>{}(
             channel, login_request_sequence, username, password);
 
-        auto login_response_header = co_await receive_header(channel);
+        auto login_response_header = co_await receive_response_header(channel);
         BOOST_CHECK(login_response_header.type ==
                     messages::message_type::LOGIN_RESPONSE);
         BOOST_CHECK(login_response_header.sequence == login_request_sequence);
@@ -104,7 +103,7 @@ BOOST_AUTO_TEST_CASE(login_and_echo_decryption_enabled_success) {
         co_await send_message<messages::echo_request>{}(
             channel, echo_request_sequence, echo_message_encrypted);
 
-        auto echo_response_header = co_await receive_header(channel);
+        auto echo_response_header = co_await receive_response_header(channel);
         BOOST_CHECK(echo_response_header.type ==
                     messages::message_type::ECHO_RESPONSE);
         BOOST_CHECK(echo_response_header.sequence == echo_request_sequence);
@@ -140,10 +139,9 @@ BOOST_AUTO_TEST_CASE(login_and_echo_decryption_disabled_success) {
 
   auto io_context = boost::asio::io_context{1};
 
-  mori_echo::spawn_server(
+  const auto endpoint = mori_echo::spawn_server(
       io_context.get_executor(),
       {
-          .port = test_tcp_port,
           .enable_decryption = false,
           .authenticator =
               mori_echo::auth::allow_all_client_authenticator::create(),
@@ -158,7 +156,7 @@ BOOST_AUTO_TEST_CASE(login_and_echo_decryption_disabled_success) {
         auto socket = boost::asio::ip::tcp::socket{io_context};
 
         co_await socket.async_connect(
-            {boost::asio::ip::address::from_string("127.0.0.1"), test_tcp_port},
+            {boost::asio::ip::address_v4::loopback(), endpoint.port()},
             boost::asio::use_awaitable);
 
         auto channel = client_channel{std::move(socket)};
@@ -167,7 +165,7 @@ BOOST_AUTO_TEST_CASE(login_and_echo_decryption_disabled_success) {
         co_await send_message<messages::login_request>{}(
             channel, login_request_sequence, username, password);
 
-        auto login_response_header = co_await receive_header(channel);
+        auto login_response_header = co_await receive_response_header(channel);
         BOOST_CHECK(login_response_header.type ==
                     messages::message_type::LOGIN_RESPONSE);
         BOOST_CHECK(login_response_header.sequence == login_request_sequence);
@@ -210,7 +208,7 @@ BOOST_AUTO_TEST_CASE(login_and_echo_decryption_disabled_success) {
         co_await send_message<messages::echo_request>{}(
             channel, echo_request_sequence, echo_message_encrypted);
 
-        auto echo_response_header = co_await receive_header(channel);
+        auto echo_response_header = co_await receive_response_header(channel);
         BOOST_CHECK(echo_response_header.type ==
                     messages::message_type::ECHO_RESPONSE);
         BOOST_CHECK(echo_response_header.sequence == echo_request_sequence);
@@ -241,10 +239,9 @@ BOOST_AUTO_TEST_CASE(login_with_password) {
 
   auto io_context = boost::asio::io_context{1};
 
-  mori_echo::spawn_server(
+  const auto endpoint = mori_echo::spawn_server(
       io_context.get_executor(),
       {
-          .port = test_tcp_port,
           .authenticator = mori_echo::auth::test_client_authenticator::create(),
       });
 
@@ -257,7 +254,7 @@ BOOST_AUTO_TEST_CASE(login_with_password) {
         auto socket = boost::asio::ip::tcp::socket{io_context};
 
         co_await socket.async_connect(
-            {boost::asio::ip::address::from_string("127.0.0.1"), test_tcp_port},
+            {boost::asio::ip::address_v4::loopback(), endpoint.port()},
             boost::asio::use_awaitable);
 
         auto channel = client_channel{std::move(socket)};
@@ -266,7 +263,7 @@ BOOST_AUTO_TEST_CASE(login_with_password) {
         co_await send_message<messages::login_request>{}(
             channel, login_request_sequence, username, password);
 
-        auto login_response_header = co_await receive_header(channel);
+        auto login_response_header = co_await receive_response_header(channel);
         BOOST_CHECK(login_response_header.type ==
                     messages::message_type::LOGIN_RESPONSE);
         BOOST_CHECK(login_response_header.sequence == login_request_sequence);
@@ -305,10 +302,9 @@ BOOST_AUTO_TEST_CASE(login_failure) {
 
   auto io_context = boost::asio::io_context{1};
 
-  mori_echo::spawn_server(
+  const auto endpoint = mori_echo::spawn_server(
       io_context.get_executor(),
       {
-          .port = test_tcp_port,
           .authenticator = mori_echo::auth::test_client_authenticator::create(),
       });
 
@@ -321,7 +317,7 @@ BOOST_AUTO_TEST_CASE(login_failure) {
         auto socket = boost::asio::ip::tcp::socket{io_context};
 
         co_await socket.async_connect(
-            {boost::asio::ip::address::from_string("127.0.0.1"), test_tcp_port},
+            {boost::asio::ip::address_v4::loopback(), endpoint.port()},
             boost::asio::use_awaitable);
 
         auto channel = client_channel{std::move(socket)};
@@ -330,7 +326,7 @@ BOOST_AUTO_TEST_CASE(login_failure) {
         co_await send_message<messages::login_request>{}(
             channel, login_request_sequence, username, password);
 
-        auto login_response_header = co_await receive_header(channel);
+        auto login_response_header = co_await receive_response_header(channel);
         BOOST_CHECK(login_response_header.type ==
                     messages::message_type::LOGIN_RESPONSE);
         BOOST_CHECK(login_response_header.sequence == login_request_sequence);
@@ -399,10 +395,9 @@ BOOST_AUTO_TEST_CASE(echo_failure_without_login) {
 
   auto io_context = boost::asio::io_context{1};
 
-  mori_echo::spawn_server(
+  const auto endpoint = mori_echo::spawn_server(
       io_context.get_executor(),
       {
-          .port = test_tcp_port,
           .authenticator =
               mori_echo::auth::allow_all_client_authenticator::create(),
       });
@@ -416,7 +411,7 @@ BOOST_AUTO_TEST_CASE(echo_failure_without_login) {
         auto socket = boost::asio::ip::tcp::socket{io_context};
 
         co_await socket.async_connect(
-            {boost::asio::ip::address::from_string("127.0.0.1"), test_tcp_port},
+            {boost::asio::ip::address_v4::loopback(), endpoint.port()},
             boost::asio::use_awaitable);
 
         auto channel = client_channel{std::move(socket)};
@@ -442,10 +437,18 @@ BOOST_AUTO_TEST_CASE(echo_failure_without_login) {
         logger->debug("Requesting echo for encrypted message: {:X}",
                       spdlog::to_hex(echo_message_encrypted));
 
+        // The whole request may be written before the server drops the
+        // client, so await the drop on the receiving side too.
+        const auto request_echo = [&]() -> boost::asio::awaitable<void> {
+          co_await send_message<messages::echo_request>{}(
+              channel, echo_request_sequence, echo_message_encrypted);
+
+          [[maybe_unused]] const auto header =
+              co_await receive_response_header(channel);
+        };
+
         BOOST_CHECK_EXCEPTION(
-            co_await send_message<messages::echo_request>{}(
-                channel, echo_request_sequence, echo_message_encrypted),
-            boost::system::system_error,
+            co_await request_echo(), boost::system::system_error,
             [](const boost::system::system_error& error) {
               return error.code() == boost::asio::error::connection_reset ||
                      error.code() == boost::asio::error::broken_pipe;
@@ -471,10 +474,9 @@ BOOST_AUTO_TEST_CASE(long_message_success) {
 
   auto io_context = boost::asio::io_context{1};
 
-  mori_echo::spawn_server(
+  const auto endpoint = mori_echo::spawn_server(
       io_context.get_executor(),
       {
-          .port = test_tcp_port,
           .enable_decryption = true,
           .authenticator =
               mori_echo::auth::allow_all_client_authenticator::create(),
@@ -489,7 +491,7 @@ BOOST_AUTO_TEST_CASE(long_message_success) {
         auto socket = boost::asio::ip::tcp::socket{io_context};
 
         co_await socket.async_connect(
-            {boost::asio::ip::address::from_string("127.0.0.1"), test_tcp_port},
+            {boost::asio::ip::address_v4::loopback(), endpoint.port()},
             boost::asio::use_awaitable);
 
         auto channel = client_channel{std::move(socket)};
@@ -498,7 +500,7 @@ BOOST_AUTO_TEST_CASE(long_message_success) {
         co_await send_message<messages::login_request>{}(
             channel, login_request_sequence, username, password);
 
-        auto login_response_header = co_await receive_header(channel);
+        auto login_response_header = co_await receive_response_header(channel);
         BOOST_CHECK(login_response_header.type ==
                     messages::message_type::LOGIN_RESPONSE);
         BOOST_CHECK(login_response_header.sequence == login_request_sequence);
@@ -541,7 +543,7 @@ BOOST_AUTO_TEST_CASE(long_message_success) {
         co_await send_message<messages::echo_request>{}(
             channel, echo_request_sequence, echo_message_encrypted);
 
-        auto echo_response_header = co_await receive_header(channel);
+        auto echo_response_header = co_await receive_response_header(channel);
         BOOST_CHECK(echo_response_header.type ==
                     messages::message_type::ECHO_RESPONSE);
         BOOST_CHECK(echo_response_header.sequence == echo_request_sequence);
@@ -577,10 +579,9 @@ BOOST_AUTO_TEST_CASE(short_message_success) {
 
   auto io_context = boost::asio::io_context{1};
 
-  mori_echo::spawn_server(
+  const auto endpoint = mori_echo::spawn_server(
       io_context.get_executor(),
       {
-          .port = test_tcp_port,
           .enable_decryption = true,
           .authenticator =
               mori_echo::auth::allow_all_client_authenticator::create(),
@@ -595,7 +596,7 @@ BOOST_AUTO_TEST_CASE(short_message_success) {
         auto socket = boost::asio::ip::tcp::socket{io_context};
 
         co_await socket.async_connect(
-            {boost::asio::ip::address::from_string("127.0.0.1"), test_tcp_port},
+            {boost::asio::ip::address_v4::loopback(), endpoint.port()},
             boost::asio::use_awaitable);
 
         auto channel = client_channel{std::move(socket)};
@@ -604,7 +605,7 @@ BOOST_AUTO_TEST_CASE(short_message_success) {
         co_await send_message<messages::login_request>{}(
             channel, login_request_sequence, username, password);
 
-        auto login_response_header = co_await receive_header(channel);
+        auto login_response_header = co_await receive_response_header(channel);
         BOOST_CHECK(login_response_header.type ==
                     messages::message_type::LOGIN_RESPONSE);
         BOOST_CHECK(login_response_header.sequence == login_request_sequence);
@@ -647,7 +648,7 @@ BOOST_AUTO_TEST_CASE(short_message_success) {
         co_await send_message<messages::echo_request>{}(
             channel, echo_request_sequence, echo_message_encrypted);
 
-        auto echo_response_header = co_await receive_header(channel);
+        auto echo_response_header = co_await receive_response_header(channel);
         BOOST_CHECK(echo_response_header.type ==
                     messages::message_type::ECHO_RESPONSE);
         BOOST_CHECK(echo_response_header.sequence == echo_request_sequence);
@@ -683,10 +684,9 @@ BOOST_AUTO_TEST_CASE(empty_message_success) {
 
   auto io_context = boost::asio::io_context{1};
 
-  mori_echo::spawn_server(
+  const auto endpoint = mori_echo::spawn_server(
       io_context.get_executor(),
       {
-          .port = test_tcp_port,
           .enable_decryption = true,
           .authenticator =
               mori_echo::auth::allow_all_client_authenticator::create(),
@@ -701,7 +701,7 @@ BOOST_AUTO_TEST_CASE(empty_message_success) {
         auto socket = boost::asio::ip::tcp::socket{io_context};
 
         co_await socket.async_connect(
-            {boost::asio::ip::address::from_string("127.0.0.1"), test_tcp_port},
+            {boost::asio::ip::address_v4::loopback(), endpoint.port()},
             boost::asio::use_awaitable);
 
         auto channel = client_channel{std::move(socket)};
@@ -710,7 +710,7 @@ BOOST_AUTO_TEST_CASE(empty_message_success) {
         co_await send_message<messages::login_request>{}(
             channel, login_request_sequence, username, password);
 
-        auto login_response_header = co_await receive_header(channel);
+        auto login_response_header = co_await receive_response_header(channel);
         BOOST_CHECK(login_response_header.type ==
                     messages::message_type::LOGIN_RESPONSE);
         BOOST_CHECK(login_response_header.sequence == login_request_sequence);
@@ -753,7 +753,7 @@ BOOST_AUTO_TEST_CASE(empty_message_success) {
         co_await send_message<messages::echo_request>{}(
             channel, echo_request_sequence, echo_message_encrypted);
 
-        auto echo_response_header = co_await receive_header(channel);
+        auto echo_response_header = co_await receive_response_header(channel);
         BOOST_CHECK(echo_response_header.type ==
                     messages::message_type::ECHO_RESPONSE);
         BOOST_CHECK(echo_response_header.sequence == echo_request_sequence);
@@ -780,6 +780,311 @@ BOOST_AUTO_TEST_CASE(empty_message_success) {
   io_context.run();
 }
 
+BOOST_AUTO_TEST_CASE(extended_message_success) {
+  spdlog::set_level(spdlog::level::debug);
+
+  auto logger = spdlog::default_logger()->clone(fmt::format(
+      "test:{}",
+      boost::unit_test::framework::current_test_case().p_name->c_str()));
+
+  auto io_context = boost::asio::io_context{1};
+
+  const auto endpoint = mori_echo::spawn_server(
+      io_context.get_executor(),
+      {
+          .enable_decryption = true,
+          .authenticator =
+              mori_echo::auth::allow_all_client_authenticator::create(),
+      });
+
+  boost::asio::co_spawn(
+      io_context.get_executor(),
+      [&]() -> boost::asio::awaitable<void> {
+        const auto username = std::string{"testuser"};
+        const auto password = std::string{"testpass"};
+
+        auto socket = boost::asio::ip::tcp::socket{io_context};
+
+        co_await socket.async_connect(
+            {boost::asio::ip::address_v4::loopback(), endpoint.port()},
+            boost::asio::use_awaitable);
+
+        auto channel = client_channel{std::move(socket)};
+
+        constexpr auto login_request_sequence = 0;
+        co_await send_message<messages::login_request>{}(
+            channel, login_request_sequence, username, password);
+
+        auto login_response_header = co_await receive_response_header(channel);
+        BOOST_CHECK(login_response_header.type ==
+                    messages::message_type::LOGIN_RESPONSE);
+
+        const auto login_response =
+            co_await receive_message<messages::login_response>(
+                channel, std::move(login_response_header));
+
+        BOOST_CHECK(login_response.status_code ==
+                    mori_status::login_status::OK);
+
+        auto echo_message_data = std::vector<std::byte>(300000);
+
+        for (auto i = std::size_t{0}; i < echo_message_data.size(); ++i) {
+          echo_message_data[i] = static_cast<std::byte>('A' + i % 26);
+        }
+
+        constexpr auto echo_request_sequence = 1;
+
+        const auto echo_message_encrypted = crypto::encrypt(
+            {
+                .username_sum = crypto::calculate_checksum(username),
+                .password_sum = crypto::calculate_checksum(password),
+                .sequence = echo_request_sequence,
+            },
+            echo_message_data);
+
+        logger->debug("Requesting echo for an encrypted message of {} bytes",
+                      echo_message_encrypted.size());
+
+        co_await send_message<messages::echo_request>{}(
+            channel, echo_request_sequence, echo_message_encrypted);
+
+        auto echo_response_header = co_await receive_response_header(channel);
+        BOOST_CHECK(echo_response_header.type ==
+                    messages::message_type::ECHO_RESPONSE);
+        BOOST_CHECK(echo_response_header.sequence == echo_request_sequence);
+        BOOST_CHECK(echo_response_header.is_extended);
+
+        const auto echo_response =
+            co_await receive_message<messages::echo_response>(
+                channel, std::move(echo_response_header));
+        BOOST_CHECK(echo_response.message_size == echo_message_data.size());
+        BOOST_CHECK(echo_response.plain_message == echo_message_data);
+
+        io_context.stop();
+      },
+      [](std::exception_ptr error) {
+        if (error) {
+          std::rethrow_exception(error);
+        }
+      });
+
+  io_context.run();
+}
+
+BOOST_AUTO_TEST_CASE(extended_message_over_limit_failure) {
+  spdlog::set_level(spdlog::level::debug);
+
+  auto logger = spdlog::default_logger()->clone(fmt::format(
+      "test:{}",
+      boost::unit_test::framework::current_test_case().p_name->c_str()));
+
+  auto io_context = boost::asio::io_context{1};
+
+  const auto endpoint = mori_echo::spawn_server(
+      io_context.get_executor(),
+      {
+          .enable_decryption = true,
+          .max_message_size = 100000,
+          .authenticator =
+              mori_echo::auth::allow_all_client_authenticator::create(),
+      });
+
+  boost::asio::co_spawn(
+      io_context.get_executor(),
+      [&]() -> boost::asio::awaitable<void> {
+        const auto username = std::string{"testuser"};
+        const auto password = std::string{"testpass"};
+
+        auto socket = boost::asio::ip::tcp::socket{io_context};
+
+        co_await socket.async_connect(
+            {boost::asio::ip::address_v4::loopback(), endpoint.port()},
+            boost::asio::use_awaitable);
+
+        auto channel = client_channel{std::move(socket)};
+
+        constexpr auto login_request_sequence = 0;
+        co_await send_message<messages::login_request>{}(
+            channel, login_request_sequence, username, password);
+
+        auto login_response_header = co_await receive_response_header(channel);
+
+        const auto login_response =
+            co_await receive_message<messages::login_response>(
+                channel, std::move(login_response_header));
+
+        BOOST_CHECK(login_response.status_code ==
+                    mori_status::login_status::OK);
+
+        const auto echo_message_data = std::vector<std::byte>(200000);
+
+        constexpr auto echo_request_sequence = 1;
+
+        auto error = boost::system::error_code{};
+
+        try {
+          co_await send_message<messages::echo_request>{}(
+              channel, echo_request_sequence, echo_message_data);
+
+          co_await receive_response_header(channel);
+        } catch (const boost::system::system_error& dropped) {
+          error = dropped.code();
+        }
+
+        logger->debug("Connection dropped with: {}", error.message());
+
+        BOOST_CHECK(error == boost::asio::error::eof ||
+                    error == boost::asio::error::connection_reset ||
+                    error == boost::asio::error::broken_pipe);
+
+        io_context.stop();
+      },
+      [](std::exception_ptr error) {
+        if (error) {
+          std::rethrow_exception(error);
+        }
+      });
+
+  io_context.run();
+}
+
+BOOST_AUTO_TEST_CASE(cut_through_echo_success) {
+  spdlog::set_level(spdlog::level::debug);
+
+  auto logger = spdlog::default_logger()->clone(fmt::format(
+      "test:{}",
+      boost::unit_test::framework::current_test_case().p_name->c_str()));
+
+  auto io_context = boost::asio::io_context{1};
+
+  const auto endpoint = mori_echo::spawn_server(
+      io_context.get_executor(),
+      {
+          .enable_decryption = true,
+          .enable_cut_through = true,
+          .stream_chunk_size = 1024,
+          .authenticator =
+              mori_echo::auth::allow_all_client_authenticator::create(),
+      });
+
+  boost::asio::co_spawn(
+      io_context.get_executor(),
+      [&]() -> boost::asio::awaitable<void> {
+        const auto username = std::string{"testuser"};
+        const auto password = std::string{"testpass"};
+
+        auto socket = boost::asio::ip::tcp::socket{io_context};
+
+        co_await socket.async_connect(
+            {boost::asio::ip::address_v4::loopback(), endpoint.port()},
+            boost::asio::use_awaitable);
+
+        auto channel = client_channel{std::move(socket)};
+
+        constexpr auto login_request_sequence = 0;
+        co_await send_message<messages::login_request>{}(
+            channel, login_request_sequence, username, password);
+
+        auto login_response_header = co_await receive_response_header(channel);
+
+        const auto login_response =
+            co_await receive_message<messages::login_response>(
+                channel, std::move(login_response_header));
+
+        BOOST_CHECK(login_response.status_code ==
+                    mori_status::login_status::OK);
+
+        auto echo_message_data = std::vector<std::byte>(60000);
+
+        for (auto i = std::size_t{0}; i < echo_message_data.size(); ++i) {
+          echo_message_data[i] = static_cast<std::byte>('a' + i % 26);
+        }
+
+        constexpr auto echo_request_sequence = 1;
+
+        const auto echo_message_encrypted = crypto::encrypt(
+            {
+                .username_sum = crypto::calculate_checksum(username),
+                .password_sum = crypto::calculate_checksum(password),
+                .sequence = echo_request_sequence,
+            },
+            echo_message_data);
+
+        // Hand-written framing, so that only half of the payload is sent
+        // before the response is expected to start.
+        constexpr auto header_size = std::size_t{4};
+
+        auto total_size = static_cast<std::uint16_t>(
+            header_size + sizeof(std::uint16_t) + echo_message_data.size());
+        auto message_size =
+            static_cast<std::uint16_t>(echo_message_data.size());
+
+        if constexpr (config::byte_order ==
+                      config::endian_mode::LITTLE_ENDIAN_MODE) {
+          boost::endian::native_to_little_inplace(total_size);
+          boost::endian::native_to_little_inplace(message_size);
+        } else {
+          boost::endian::native_to_big_inplace(total_size);
+          boost::endian::native_to_big_inplace(message_size);
+        }
+
+        co_await channel.send_as(total_size);
+        co_await channel.send_as(messages::message_type::ECHO_REQUEST);
+        co_await channel.send_as(std::uint8_t{echo_request_sequence});
+        co_await channel.send_as(message_size);
+
+        const auto half = echo_message_encrypted.size() / 2;
+
+        co_await channel.send(std::span{echo_message_encrypted}.first(half));
+
+        const auto echo_response_header =
+            co_await receive_response_header(channel);
+        BOOST_CHECK(echo_response_header.type ==
+                    messages::message_type::ECHO_RESPONSE);
+        BOOST_CHECK(echo_response_header.sequence == echo_request_sequence);
+        BOOST_CHECK(echo_response_header.total_size ==
+                    header_size + sizeof(std::uint16_t) +
+                        echo_message_data.size());
+
+        auto response_message_size =
+            co_await channel.receive_as<std::uint16_t>();
+
+        if constexpr (config::byte_order ==
+                      config::endian_mode::LITTLE_ENDIAN_MODE) {
+          boost::endian::little_to_native_inplace(response_message_size);
+        } else {
+          boost::endian::big_to_native_inplace(response_message_size);
+        }
+
+        BOOST_CHECK(response_message_size == echo_message_data.size());
+
+        const auto first_half = co_await channel.receive(half);
+
+        logger->debug("Received {} bytes before the request was complete",
+                      first_half.size());
+
+        co_await channel.send(std::span{echo_message_encrypted}.subspan(half));
+
+        const auto second_half =
+            co_await channel.receive(echo_message_encrypted.size() - half);
+
+        auto plain_message = first_half;
+        plain_message.insert(plain_message.end(), second_half.begin(),
+                             second_half.end());
+
+        BOOST_CHECK(plain_message == echo_message_data);
+
+        io_context.stop();
+      },
+      [](std::exception_ptr error) {
+        if (error) {
+          std::rethrow_exception(error);
+        }
+      });
+
+  io_context.run();
+}
+
 BOOST_AUTO_TEST_SUITE_END()
 
 } // namespace mori_echo::test
@@ -10,7 +10,4 @@ auto calculate_next_key(std::uint32_t key) -> std::uint32_t;
 
 auto calculate_cipher_key(std::uint8_t key) -> std::uint8_t;
 
-auto encrypt(crypto_message_params args, std::vector<std::byte> message)
-    -> std::vector<std::byte>;
-
 } // namespace mori_echo::crypto
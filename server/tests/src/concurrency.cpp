@@ -14,7 +14,7 @@
 #include "client_channel/client_channel.hpp"
 #include "client_crypto/test_client_crypto.hpp"
 #include "echo_server/echo_server.hpp"
-#include "message_receiver/message_receiver.hpp"
+#include "message_receiver/test_message_receiver.hpp"
 #include "message_sender/test_message_sender.hpp"
 #include "message_types/echo_request.hpp"
 #include "message_types/echo_response.hpp"
@@ -24,8 +24,6 @@
 
 namespace mori_echo::test {
 
-inline constexpr auto test_tcp_port = std::uint16_t{31217};
-
 BOOST_AUTO_TEST_SUITE(concurrency)
 
 BOOST_AUTO_TEST_CASE(concurrent_clients) {
@@ -39,10 +37,9 @@ BOOST_AUTO_TEST_CASE(concurrent_clients) {
 
   auto io_context = boost::asio::io_context{1};
 
-  mori_echo::spawn_server(
+  const auto endpoint = mori_echo::spawn_server(
       io_context.get_executor(),
       {
-          .port = test_tcp_port,
           .enable_decryption = true,
           .authenticator =
               mori_echo::auth::allow_all_client_authenticator::create(),
@@ -59,7 +56,7 @@ BOOST_AUTO_TEST_CASE(concurrent_clients) {
     auto socket = boost::asio::ip::tcp::socket{io_context};
 
     co_await socket.async_connect(
-        {boost::asio::ip::address::from_string("127.0.0.1"), test_tcp_port},
+        {boost::asio::ip::address_v4::loopback(), endpoint.port()},
         boost::asio::use_awaitable);
 
     auto channel = client_channel{std::move(socket)};
@@ -70,7 +67,7 @@ BOOST_AUTO_TEST_CASE(concurrent_clients) {
     co_await send_message<messages::login_request>{}(
         channel, login_request_sequence, username, password);
 
-    auto login_response_header = co_await receive_header(channel);
+    auto login_response_header = co_await receive_response_header(channel);
     BOOST_CHECK(login_response_header.type ==
                 messages::message_type::LOGIN_RESPONSE);
     BOOST_CHECK(login_response_header.sequence == login_request_sequence);
@@ -113,7 +110,7 @@ BOOST_AUTO_TEST_CASE(concurrent_clients) {
     co_await send_message<messages::echo_request>{}(
         channel, echo_request_sequence, echo_message_encrypted);
 
-    auto echo_response_header = co_await receive_header(channel);
+    auto echo_response_header = co_await receive_response_header(channel);
     BOOST_CHECK(echo_response_header.type ==
                 messages::message_type::ECHO_RESPONSE);
     BOOST_CHECK(echo_response_header.sequence == echo_request_sequence);
@@ -0,0 +1,169 @@
+#include <algorithm>
+#include <boost/asio/io_context.hpp>
+#include <boost/test/unit_test.hpp>
+#include <chrono>
+#include <spdlog/spdlog.h>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "client_authenticator/test_client_authenticator.hpp"
+#include "echo_client/blocking_echo_client.hpp"
+#include "echo_server/echo_server.hpp"
+#include "worker_pool/connection_rebalancer.hpp"
+#include "worker_pool/server_topology.hpp"
+#include "worker_pool/worker_pool.hpp"
+
+namespace mori_echo::test {
+
+[[nodiscard]] auto make_batch(std::size_t batch, std::size_t size)
+    -> std::vector<std::vector<std::byte>> {
+  auto messages = std::vector<std::vector<std::byte>>{};
+
+  for (auto i = std::size_t{0}; i < size; ++i) {
+    const auto text =
+        "Batch " + std::to_string(batch) + " #" + std::to_string(i);
+
+    auto& message = messages.emplace_back(text.size());
+    std::transform(text.begin(), text.end(), message.begin(),
+                   [](char each) { return static_cast<std::byte>(each); });
+  }
+
+  return messages;
+}
+
+// Serves with a pool of two workers on a thread of its own until destroyed.
+class rebalanced_server {
+public:
+  explicit rebalanced_server(rebalancer_options options) {
+    // Two workers sharing the first online CPU, which always exists.
+    const auto first_cpu = server_topology::detect().workers.front().cpus;
+
+    auto topology = server_topology{};
+    topology.workers.push_back({.cpus = first_cpu});
+    topology.workers.push_back({.cpus = first_cpu});
+
+    workers = worker_pool::create(topology);
+    rebalancer = connection_rebalancer::create(workers, options);
+
+    const auto bound = mori_echo::spawn_server(
+        context.get_executor(),
+        {
+            .enable_decryption = true,
+            .authenticator =
+                mori_echo::auth::test_client_authenticator::create(),
+            .workers = workers,
+            .rebalancer = rebalancer,
+        });
+
+    endpoint = {boost::asio::ip::address_v4::loopback(), bound.port()};
+
+    context.poll();
+
+    thread = std::thread{[this] { context.run(); }};
+  }
+
+  ~rebalanced_server() {
+    rebalancer->stop();
+    context.stop();
+    thread.join();
+    workers->stop();
+  }
+
+  std::shared_ptr<worker_pool> workers;
+  std::shared_ptr<connection_rebalancer> rebalancer;
+
+  // Where clients reach the server, over loopback.
+  boost::asio::ip::tcp::endpoint endpoint;
+
+private:
+  boost::asio::io_context context{1};
+
+  boost::asio::executor_work_guard<boost::asio::io_context::executor_type>
+      work = boost::asio::make_work_guard(context);
+
+  std::thread thread;
+};
+
+BOOST_AUTO_TEST_SUITE(connection_rebalancing)
+
+BOOST_AUTO_TEST_CASE(moves_busy_sessions_to_idle_workers) {
+  spdlog::set_level(spdlog::level::info);
+
+  constexpr auto batch_size = std::size_t{16};
+
+  const auto server = rebalanced_server{{
+      .interval = std::chrono::milliseconds{50},
+      .min_messages = 20,
+  }};
+
+  const auto endpoint = server.endpoint;
+  const auto credentials = client::client_credentials{
+      .username = "testuser", .password = "testpass"};
+
+  // Workers take clients in turns, so the busy client lands on the first
+  // worker and the idle one on the second.
+  auto busy = client::blocking_echo_client{endpoint, credentials,
+                                           {.connections = 1}};
+  auto idle = client::blocking_echo_client{endpoint, credentials,
+                                           {.connections = 1}};
+
+  const auto deadline =
+      std::chrono::steady_clock::now() + std::chrono::seconds{10};
+
+  auto batch = std::size_t{0};
+
+  // Pipelined, so that sessions also move with requests left unread.
+  while (server.rebalancer->migrations_out(0) == 0 &&
+         std::chrono::steady_clock::now() < deadline) {
+    const auto messages = make_batch(batch++, batch_size);
+    BOOST_REQUIRE(busy.echo_all(messages) == messages);
+  }
+
+  BOOST_CHECK(server.rebalancer->migrations_out(0) > 0);
+  BOOST_CHECK(server.rebalancer->migrations_in(1) > 0);
+
+  // Moved sessions carry on where they were.
+  for (auto i = 0; i < 10; ++i) {
+    const auto messages = make_batch(batch++, batch_size);
+    BOOST_CHECK(busy.echo_all(messages) == messages);
+  }
+
+  const auto messages = make_batch(batch++, 1);
+  BOOST_CHECK(idle.echo_all(messages) == messages);
+}
+
+BOOST_AUTO_TEST_CASE(leaves_balanced_sessions_in_place) {
+  spdlog::set_level(spdlog::level::info);
+
+  // Intervals long enough for both workers to get their share of the CPU,
+  // even while other tests hold it.
+  const auto server = rebalanced_server{{
+      .interval = std::chrono::milliseconds{250},
+      .min_messages = 20,
+  }};
+
+  const auto endpoint = server.endpoint;
+  const auto credentials = client::client_credentials{
+      .username = "testuser", .password = "testpass"};
+
+  // One connection on each worker, echoing alike.
+  auto client = client::blocking_echo_client{endpoint, credentials,
+                                             {.connections = 2}};
+
+  const auto deadline =
+      std::chrono::steady_clock::now() + std::chrono::milliseconds{1000};
+
+  for (auto batch = std::size_t{0};
+       std::chrono::steady_clock::now() < deadline; ++batch) {
+    const auto messages = make_batch(batch, 64);
+    BOOST_REQUIRE(client.echo_all(messages) == messages);
+  }
+
+  BOOST_CHECK(server.rebalancer->migrations_out(0) == 0);
+  BOOST_CHECK(server.rebalancer->migrations_out(1) == 0);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+} // namespace mori_echo::test
@@ -0,0 +1,153 @@
+#include <boost/asio/co_spawn.hpp>
+#include <boost/asio/io_context.hpp>
+#include <boost/asio/ip/tcp.hpp>
+#include <boost/test/unit_test.hpp>
+#include <spdlog/spdlog.h>
+#include <thread>
+
+#include "client_authenticator/allow_all_client_authenticator.hpp"
+#include "client_channel/client_channel.hpp"
+#include "client_crypto/test_client_crypto.hpp"
+#include "compute_pool/compute_pool.hpp"
+#include "echo_server/echo_server.hpp"
+#include "message_receiver/test_message_receiver.hpp"
+#include "message_sender/test_message_sender.hpp"
+#include "message_types/echo_request.hpp"
+#include "message_types/echo_response.hpp"
+#include "message_types/login_request.hpp"
+#include "message_types/login_response.hpp"
+#include "mori_status/login_status.hpp"
+
+namespace mori_echo::test {
+
+BOOST_AUTO_TEST_SUITE(decrypt_offload)
+
+BOOST_AUTO_TEST_CASE(jobs_run_on_pool_until_full) {
+  auto io_context = boost::asio::io_context{1};
+
+  const auto pool = compute_pool::create(1, 1);
+  const auto full_pool = compute_pool::create(1, 0);
+
+  const auto caller = std::this_thread::get_id();
+
+  boost::asio::co_spawn(
+      io_context.get_executor(),
+      [&]() -> boost::asio::awaitable<void> {
+        const auto on_pool = co_await pool->run(
+            [] { return std::this_thread::get_id(); });
+
+        BOOST_CHECK(on_pool != caller);
+        BOOST_CHECK(std::this_thread::get_id() == caller);
+
+        const auto on_caller = co_await full_pool->run(
+            [] { return std::this_thread::get_id(); });
+
+        BOOST_CHECK(on_caller == caller);
+      },
+      [](std::exception_ptr error) {
+        if (error) {
+          std::rethrow_exception(error);
+        }
+      });
+
+  io_context.run();
+
+  const auto metrics = pool->metrics();
+
+  BOOST_CHECK(metrics.offloaded == 1);
+  BOOST_CHECK(metrics.ran_inline == 0);
+  BOOST_CHECK(metrics.queue_depth == 0);
+  BOOST_CHECK(metrics.peak_queue_depth == 1);
+
+  BOOST_CHECK(full_pool->metrics().offloaded == 0);
+  BOOST_CHECK(full_pool->metrics().ran_inline == 1);
+}
+
+BOOST_AUTO_TEST_CASE(large_payloads_offloaded) {
+  spdlog::set_level(spdlog::level::info);
+
+  constexpr auto offload_threshold = std::size_t{1024};
+
+  const auto pool = compute_pool::create(1, 4);
+
+  auto io_context = boost::asio::io_context{1};
+
+  const auto endpoint = mori_echo::spawn_server(
+      io_context.get_executor(),
+      {
+          .enable_decryption = true,
+          .authenticator =
+              mori_echo::auth::allow_all_client_authenticator::create(),
+          .compute = pool,
+          .offload_threshold = offload_threshold,
+      });
+
+  boost::asio::co_spawn(
+      io_context.get_executor(),
+      [&]() -> boost::asio::awaitable<void> {
+        const auto username = std::string{"testuser"};
+        const auto password = std::string{"testpass"};
+
+        auto socket = boost::asio::ip::tcp::socket{io_context};
+
+        co_await socket.async_connect(
+            {boost::asio::ip::address_v4::loopback(), endpoint.port()},
+            boost::asio::use_awaitable);
+
+        auto channel = client_channel{std::move(socket)};
+
+        co_await send_message<messages::login_request>{}(channel, 0, username,
+                                                         password);
+
+        const auto login_response =
+            co_await receive_message<messages::login_response>(
+                channel, co_await receive_response_header(channel));
+
+        BOOST_REQUIRE(login_response.status_code ==
+                      mori_status::login_status::OK);
+
+        auto sequence = std::uint8_t{1};
+
+        for (const auto size : {std::size_t{32}, offload_threshold * 4}) {
+          const auto echo_message = std::vector<std::byte>(size, std::byte{'L'});
+
+          co_await send_message<messages::echo_request>{}(
+              channel, sequence,
+              crypto::encrypt(
+                  {
+                      .username_sum = crypto::calculate_checksum(username),
+                      .password_sum = crypto::calculate_checksum(password),
+                      .sequence = sequence,
+                  },
+                  echo_message));
+
+          const auto echo_response =
+              co_await receive_message<messages::echo_response>(
+                  channel, co_await receive_response_header(channel));
+
+          BOOST_CHECK(echo_response.header.sequence == sequence);
+          BOOST_CHECK(echo_response.plain_message == echo_message);
+
+          ++sequence;
+        }
+
+        io_context.stop();
+      },
+      [](std::exception_ptr error) {
+        if (error) {
+          std::rethrow_exception(error);
+        }
+      });
+
+  io_context.run();
+
+  const auto metrics = pool->metrics();
+
+  BOOST_CHECK(metrics.offloaded == 1);
+  BOOST_CHECK(metrics.ran_inline == 0);
+  BOOST_CHECK(metrics.queue_depth == 0);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+} // namespace mori_echo::test
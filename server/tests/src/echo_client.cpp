@@ -0,0 +1,268 @@
+#include <algorithm>
+#include <boost/asio/co_spawn.hpp>
+#include <boost/asio/io_context.hpp>
+#include <boost/test/unit_test.hpp>
+#include <memory>
+#include <optional>
+#include <spdlog/spdlog.h>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "client_authenticator/test_client_authenticator.hpp"
+#include "echo_client/blocking_echo_client.hpp"
+#include "echo_client/echo_client_pool.hpp"
+#include "echo_client/echo_connection.hpp"
+#include "echo_server/echo_server.hpp"
+#include "exceptions/client_error.hpp"
+
+namespace mori_echo::test {
+
+[[nodiscard]] auto test_credentials() -> client::client_credentials {
+  return {.username = "testuser", .password = "testpass"};
+}
+
+[[nodiscard]] auto make_test_message(std::size_t index)
+    -> std::vector<std::byte> {
+  const auto text = "Echo #" + std::to_string(index);
+
+  auto message = std::vector<std::byte>(text.size());
+  std::transform(text.begin(), text.end(), message.begin(),
+                 [](char each) { return static_cast<std::byte>(each); });
+
+  return message;
+}
+
+[[nodiscard]] auto check_echo(client::echo_connection& connection,
+                              std::size_t index, std::size_t max_in_flight)
+    -> boost::asio::awaitable<void> {
+  const auto echo = co_await connection.echo(make_test_message(index));
+
+  BOOST_CHECK(echo == make_test_message(index));
+  BOOST_CHECK(connection.in_flight() <= max_in_flight);
+}
+
+// Serves on a thread of its own until destroyed, on `port` unless 0.
+class test_server {
+public:
+  explicit test_server(std::uint16_t port = 0) {
+    const auto bound = mori_echo::spawn_server(
+        context.get_executor(),
+        {
+            .port = port,
+            .enable_decryption = true,
+            .authenticator =
+                mori_echo::auth::test_client_authenticator::create(),
+        });
+
+    endpoint = {boost::asio::ip::address_v4::loopback(), bound.port()};
+
+    context.poll();
+
+    thread = std::thread{[this] { context.run(); }};
+  }
+
+  ~test_server() {
+    context.stop();
+    thread.join();
+  }
+
+  // Where clients reach the server, over loopback.
+  boost::asio::ip::tcp::endpoint endpoint;
+
+private:
+  boost::asio::io_context context{1};
+
+  boost::asio::executor_work_guard<boost::asio::io_context::executor_type>
+      work = boost::asio::make_work_guard(context);
+
+  std::thread thread;
+};
+
+BOOST_AUTO_TEST_SUITE(echo_client)
+
+BOOST_AUTO_TEST_CASE(pipelines_concurrent_echoes) {
+  spdlog::set_level(spdlog::level::info);
+
+  constexpr auto echo_count = std::size_t{100};
+  constexpr auto max_in_flight = std::size_t{8};
+
+  const auto server = test_server{};
+
+  auto io_context = boost::asio::io_context{1};
+
+  auto connection = std::shared_ptr<client::echo_connection>{};
+  auto completed = std::size_t{0};
+
+  boost::asio::co_spawn(
+      io_context,
+      [&]() -> boost::asio::awaitable<void> {
+        connection = co_await client::echo_connection::connect(
+            io_context.get_executor(), server.endpoint,
+            test_credentials(), {.max_in_flight = max_in_flight});
+
+        for (auto i = std::size_t{0}; i < echo_count; ++i) {
+          boost::asio::co_spawn(
+              io_context, check_echo(*connection, i, max_in_flight),
+              [&](std::exception_ptr error) {
+                if (error) {
+                  std::rethrow_exception(error);
+                }
+
+                if (++completed == echo_count) {
+                  connection->close();
+                }
+              });
+        }
+      },
+      [](std::exception_ptr error) {
+        if (error) {
+          std::rethrow_exception(error);
+        }
+      });
+
+  io_context.run();
+
+  BOOST_CHECK(completed == echo_count);
+}
+
+BOOST_AUTO_TEST_CASE(dropped_connections_close) {
+  const auto server = test_server{};
+
+  auto io_context = boost::asio::io_context{1};
+
+  auto dropped = std::weak_ptr<client::echo_connection>{};
+
+  boost::asio::co_spawn(
+      io_context,
+      [&]() -> boost::asio::awaitable<void> {
+        const auto connection = co_await client::echo_connection::connect(
+            io_context.get_executor(), server.endpoint, test_credentials());
+
+        co_await check_echo(*connection, 0, 1);
+
+        dropped = connection;
+      },
+      [](std::exception_ptr error) {
+        if (error) {
+          std::rethrow_exception(error);
+        }
+      });
+
+  // Only returns once nothing reads from the connection any more.
+  io_context.run();
+
+  BOOST_CHECK(dropped.expired());
+}
+
+BOOST_AUTO_TEST_CASE(rejects_wrong_credentials) {
+  const auto server = test_server{};
+
+  BOOST_CHECK_THROW(client::blocking_echo_client(server.endpoint,
+                                                 {
+                                                     .username = "testuser",
+                                                     .password = "wrongpass",
+                                                 }),
+                    exceptions::client_error);
+}
+
+BOOST_AUTO_TEST_CASE(blocking_client_echoes) {
+  constexpr auto echo_count = std::size_t{50};
+
+  const auto server = test_server{};
+
+  auto client = client::blocking_echo_client{server.endpoint,
+                                             test_credentials(),
+                                             {.connections = 2}};
+
+  BOOST_CHECK(client.echo(make_test_message(0)) == make_test_message(0));
+
+  auto messages = std::vector<std::vector<std::byte>>{};
+
+  for (auto i = std::size_t{0}; i < echo_count; ++i) {
+    messages.push_back(make_test_message(i));
+  }
+
+  BOOST_CHECK(client.echo_all(messages) == messages);
+}
+
+BOOST_AUTO_TEST_CASE(pool_replaces_failed_connections) {
+  auto server = std::optional<test_server>{std::in_place};
+
+  const auto endpoint = server->endpoint;
+
+  auto client = client::blocking_echo_client{endpoint, test_credentials(),
+                                             {.connections = 1}};
+
+  BOOST_CHECK(client.echo(make_test_message(0)) == make_test_message(0));
+
+  // Back on the same port, for the client to reconnect to.
+  server.reset();
+  server.emplace(endpoint.port());
+
+  // The echo finding the connection broken fails, and the next one goes
+  // through a new connection.
+  auto echo = std::vector<std::byte>{};
+
+  try {
+    echo = client.echo(make_test_message(1));
+  } catch (const std::exception&) {
+    echo = client.echo(make_test_message(1));
+  }
+
+  BOOST_CHECK(echo == make_test_message(1));
+}
+
+BOOST_AUTO_TEST_CASE(echoes_wait_for_replacements) {
+  constexpr auto echo_count = std::size_t{4};
+
+  const auto server = test_server{};
+
+  auto io_context = boost::asio::io_context{1};
+
+  auto completed = std::size_t{0};
+
+  boost::asio::co_spawn(
+      io_context,
+      [&]() -> boost::asio::awaitable<void> {
+        const auto pool = co_await client::echo_client_pool::connect(
+            io_context.get_executor(), server.endpoint, test_credentials(),
+            {.connections = 1});
+
+        // The first echo replaces the closed connection, and the others
+        // wait for it rather than fail.
+        pool->close();
+
+        for (auto i = std::size_t{0}; i < echo_count; ++i) {
+          boost::asio::co_spawn(
+              io_context,
+              [&, pool, i]() -> boost::asio::awaitable<void> {
+                const auto echo = co_await pool->echo(make_test_message(i));
+
+                BOOST_CHECK(echo == make_test_message(i));
+              },
+              [&, pool](std::exception_ptr error) {
+                if (error) {
+                  std::rethrow_exception(error);
+                }
+
+                if (++completed == echo_count) {
+                  pool->close();
+                }
+              });
+        }
+      },
+      [](std::exception_ptr error) {
+        if (error) {
+          std::rethrow_exception(error);
+        }
+      });
+
+  io_context.run();
+
+  BOOST_CHECK(completed == echo_count);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+} // namespace mori_echo::test
@@ -0,0 +1,113 @@
+#include <boost/asio/co_spawn.hpp>
+#include <boost/asio/io_context.hpp>
+#include <boost/test/unit_test.hpp>
+#include <chrono>
+#include <spdlog/spdlog.h>
+
+#include "client_authenticator/allow_all_client_authenticator.hpp"
+#include "client_channel/client_channel.hpp"
+#include "client_crypto/test_client_crypto.hpp"
+#include "echo_server/echo_server.hpp"
+#include "memory_transport/memory_acceptor.hpp"
+#include "message_receiver/test_message_receiver.hpp"
+#include "message_sender/test_message_sender.hpp"
+#include "message_types/echo_request.hpp"
+#include "message_types/echo_response.hpp"
+#include "test_session/test_session.hpp"
+
+namespace mori_echo::test {
+
+using namespace std::chrono_literals;
+
+struct pipeline_case {
+  bool enable_decryption;
+  bool enable_payload_logs;
+  std::chrono::nanoseconds slow_echo_threshold;
+  bool enable_cut_through;
+};
+
+// Echoes a payload through the pipeline `echo_case` has the server pick,
+// checking it comes back decrypted if and only if the server decrypts.
+auto echo_through_pipeline(const pipeline_case& echo_case) -> void {
+  auto io_context = boost::asio::io_context{1};
+  const auto acceptor = memory_acceptor::create();
+
+  mori_echo::spawn_server(
+      io_context.get_executor(),
+      {
+          .memory = acceptor,
+          .enable_decryption = echo_case.enable_decryption,
+          .enable_payload_logs = echo_case.enable_payload_logs,
+          .enable_cut_through = echo_case.enable_cut_through,
+          .authenticator =
+              mori_echo::auth::allow_all_client_authenticator::create(),
+          .slow_echo_threshold = echo_case.slow_echo_threshold,
+      });
+
+  boost::asio::co_spawn(
+      io_context.get_executor(),
+      [&]() -> boost::asio::awaitable<void> {
+        auto channel = memory_client_channel{
+            acceptor->connect(io_context.get_executor())};
+
+        co_await log_in(channel);
+
+        const auto plain = std::vector<std::byte>(300, std::byte{'P'});
+
+        constexpr auto sequence = 1;
+
+        const auto encrypted = crypto::encrypt(
+            {
+                .username_sum = crypto::calculate_checksum("testuser"),
+                .password_sum = crypto::calculate_checksum("testpass"),
+                .sequence = sequence,
+            },
+            plain);
+
+        co_await send_message<messages::echo_request>{}(channel, sequence,
+                                                        encrypted);
+
+        const auto echo = co_await receive_message<messages::echo_response>(
+            channel, co_await receive_response_header(channel));
+
+        BOOST_CHECK(echo.plain_message ==
+                    (echo_case.enable_decryption ? plain : encrypted));
+
+        io_context.stop();
+      },
+      [](std::exception_ptr error) {
+        if (error) {
+          std::rethrow_exception(error);
+        }
+      });
+
+  io_context.run();
+}
+
+BOOST_AUTO_TEST_SUITE(echo_pipeline)
+
+BOOST_AUTO_TEST_CASE(every_pipeline_echoes) {
+  // Payload logs only run at debug level.
+  spdlog::set_level(spdlog::level::debug);
+
+  for (const auto enable_decryption : {false, true}) {
+    for (const auto enable_payload_logs : {false, true}) {
+      for (const auto slow_echo_threshold : {0ns, 1ns}) {
+        for (const auto enable_cut_through : {false, true}) {
+          echo_through_pipeline({
+              .enable_decryption = enable_decryption,
+              .enable_payload_logs = enable_payload_logs,
+              .slow_echo_threshold = slow_echo_threshold,
+              .enable_cut_through = enable_cut_through,
+          });
+        }
+      }
+    }
+  }
+
+  spdlog::set_level(spdlog::level::info);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+} // namespace mori_echo::test
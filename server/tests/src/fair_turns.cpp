@@ -0,0 +1,116 @@
+#include <boost/asio/co_spawn.hpp>
+#include <boost/asio/io_context.hpp>
+#include <boost/test/unit_test.hpp>
+#include <spdlog/spdlog.h>
+#include <vector>
+
+#include "client_authenticator/allow_all_client_authenticator.hpp"
+#include "client_channel/client_channel.hpp"
+#include "echo_server/echo_server.hpp"
+#include "memory_transport/memory_acceptor.hpp"
+#include "message_receiver/test_message_receiver.hpp"
+#include "message_sender/test_message_sender.hpp"
+#include "message_types/echo_request.hpp"
+#include "message_types/echo_response.hpp"
+#include "test_session/test_session.hpp"
+
+namespace mori_echo::test {
+
+inline constexpr auto pipelined_requests = 100;
+
+// Has a single client send `pipelined_requests` echo requests of
+// `payload_size` bytes at once, so that they stay buffered while the server
+// handles them, and reads their echoes back.
+auto flood_with_turns(bool enable_turn_budget, turn_budget_options budget,
+                      std::size_t payload_size) -> void {
+  auto io_context = boost::asio::io_context{1};
+  const auto acceptor = memory_acceptor::create();
+
+  mori_echo::spawn_server(
+      io_context.get_executor(),
+      {
+          .memory = acceptor,
+          .enable_decryption = false,
+          .enable_turn_budget = enable_turn_budget,
+          .turn_budget = std::move(budget),
+          .authenticator =
+              mori_echo::auth::allow_all_client_authenticator::create(),
+      });
+
+  boost::asio::co_spawn(
+      io_context.get_executor(),
+      [&]() -> boost::asio::awaitable<void> {
+        auto channel = memory_client_channel{
+            acceptor->connect(io_context.get_executor())};
+
+        co_await log_in(channel);
+
+        const auto payload = std::vector<std::byte>(payload_size);
+        auto requests = std::vector<std::byte>{};
+
+        for (auto i = 0; i < pipelined_requests; ++i) {
+          const auto request =
+              encode_echo_request(static_cast<std::uint8_t>(i), payload);
+          requests.insert(requests.end(), request.begin(), request.end());
+        }
+
+        co_await channel.send(requests);
+
+        for (auto i = 0; i < pipelined_requests; ++i) {
+          const auto echo = co_await receive_message<messages::echo_response>(
+              channel, co_await receive_response_header(channel));
+
+          BOOST_CHECK(echo.plain_message == payload);
+        }
+
+        io_context.stop();
+      },
+      [](std::exception_ptr error) {
+        if (error) {
+          std::rethrow_exception(error);
+        }
+      });
+
+  io_context.run();
+}
+
+BOOST_AUTO_TEST_SUITE(fair_turns)
+
+BOOST_AUTO_TEST_CASE(sessions_yield_once_out_of_messages) {
+  spdlog::set_level(spdlog::level::info);
+
+  const auto counters = turn_counters::create();
+
+  flood_with_turns(true, {.messages = 8, .counters = counters}, 32);
+
+  // Every full turn but the last has more requests buffered behind it.
+  BOOST_CHECK(counters->yields() >= pipelined_requests / 8 - 1);
+  BOOST_CHECK(counters->longest_turn() == 8);
+}
+
+BOOST_AUTO_TEST_CASE(sessions_yield_once_out_of_bytes) {
+  spdlog::set_level(spdlog::level::info);
+
+  const auto counters = turn_counters::create();
+
+  // Each request takes a little over 1KiB, so that five use up the bytes.
+  flood_with_turns(
+      true, {.messages = 64, .bytes = 4 * 1024, .counters = counters}, 1024);
+
+  BOOST_CHECK(counters->yields() >= pipelined_requests / 5 - 1);
+  BOOST_CHECK(counters->longest_turn() <= 5);
+}
+
+BOOST_AUTO_TEST_CASE(unbudgeted_sessions_never_yield) {
+  spdlog::set_level(spdlog::level::info);
+
+  const auto counters = turn_counters::create();
+
+  flood_with_turns(false, {.messages = 8, .counters = counters}, 32);
+
+  BOOST_CHECK(counters->yields() == 0);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+} // namespace mori_echo::test
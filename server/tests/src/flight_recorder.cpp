@@ -0,0 +1,166 @@
+#include <algorithm>
+#include <array>
+#include <arpa/inet.h>
+#include <boost/asio/io_context.hpp>
+#include <boost/test/unit_test.hpp>
+#include <netinet/in.h>
+#include <spdlog/spdlog.h>
+#include <sys/socket.h>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+#include "client_authenticator/allow_all_client_authenticator.hpp"
+#include "client_fault/client_fault.hpp"
+#include "echo_server/echo_server.hpp"
+#include "flight_recorder/flight_recorder.hpp"
+#include "message_sender/test_message_sender.hpp"
+#include "test_endpoints/test_endpoints.hpp"
+
+namespace mori_echo::test {
+
+[[nodiscard]] auto test_flight_dump_path() -> std::string {
+  return unique_temp_path("test.flight");
+}
+
+[[nodiscard]] auto dumped_events_of(const flight::flight_dump& dump,
+                                    std::uint32_t thread_id)
+    -> std::vector<flight::event_record> {
+  for (const auto& thread : dump.threads) {
+    if (thread.thread_id == thread_id) {
+      return thread.events;
+    }
+  }
+
+  return {};
+}
+
+// Sends `requests` over a blocking TCP connection to `port`, and reads until
+// the server drops it.
+auto send_until_dropped(std::uint16_t port,
+                        const std::vector<std::byte>& requests) -> void {
+  const auto client = ::socket(AF_INET, SOCK_STREAM, 0);
+  BOOST_REQUIRE(client >= 0);
+
+  auto address = sockaddr_in{};
+  address.sin_family = AF_INET;
+  address.sin_port = htons(port);
+  address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+
+  BOOST_REQUIRE(::connect(client, reinterpret_cast<sockaddr*>(&address),
+                          sizeof(address)) == 0);
+
+  BOOST_REQUIRE(::write(client, requests.data(), requests.size()) ==
+                static_cast<ssize_t>(requests.size()));
+
+  auto buffer = std::array<std::byte, 4096>{};
+
+  while (::read(client, buffer.data(), buffer.size()) > 0) {
+  }
+
+  ::close(client);
+}
+
+BOOST_AUTO_TEST_SUITE(flight_recorder)
+
+BOOST_AUTO_TEST_CASE(ring_keeps_newest_events) {
+  constexpr auto event_count = flight::ring_capacity + 100;
+
+  auto thread_id = std::uint32_t{};
+
+  // On a thread of its own, for a ring of its own.
+  std::thread{[&] {
+    thread_id = static_cast<std::uint32_t>(::gettid());
+
+    for (auto i = std::uint32_t{0}; i < event_count; ++i) {
+      flight::record(flight::event_kind::SLOW_ECHO, 42, i);
+    }
+  }}.join();
+
+  BOOST_REQUIRE(flight::dump(test_flight_dump_path().c_str()));
+
+  const auto events = dumped_events_of(
+      flight::read_dump(test_flight_dump_path()), thread_id);
+
+  BOOST_REQUIRE(events.size() == flight::ring_capacity);
+
+  for (auto i = std::size_t{0}; i < events.size(); ++i) {
+    BOOST_CHECK(events[i].kind == flight::event_kind::SLOW_ECHO);
+    BOOST_CHECK(events[i].session == 42);
+    BOOST_CHECK(events[i].value == event_count - flight::ring_capacity + i);
+  }
+
+  BOOST_CHECK(std::is_sorted(events.begin(), events.end(),
+                             [](const auto& lhs, const auto& rhs) {
+                               return lhs.timestamp_ns < rhs.timestamp_ns;
+                             }));
+}
+
+BOOST_AUTO_TEST_CASE(records_dropped_clients) {
+  spdlog::set_level(spdlog::level::info);
+
+  constexpr auto max_message_size = std::uint32_t{64};
+
+  auto requests = encode_login_request(0, "testuser", "testpass");
+  const auto echo =
+      encode_echo_request(1, std::vector<std::byte>(100, std::byte{0x5A}));
+
+  requests.insert(requests.end(), echo.begin(), echo.end());
+
+  auto server_context = boost::asio::io_context{1};
+
+  const auto endpoint = mori_echo::spawn_server(
+      server_context.get_executor(),
+      {
+          .max_message_size = max_message_size,
+          .authenticator =
+              mori_echo::auth::allow_all_client_authenticator::create(),
+      });
+
+  server_context.poll();
+
+  auto server_thread_id = std::uint32_t{};
+
+  auto server_work = boost::asio::make_work_guard(server_context);
+  auto server_thread = std::thread{[&] {
+    server_thread_id = static_cast<std::uint32_t>(::gettid());
+    server_context.run();
+  }};
+
+  send_until_dropped(endpoint.port(), requests);
+
+  server_context.stop();
+  server_thread.join();
+
+  BOOST_REQUIRE(flight::dump(test_flight_dump_path().c_str()));
+
+  const auto dump = flight::read_dump(test_flight_dump_path());
+  const auto events = dumped_events_of(dump, server_thread_id);
+
+  // The newest events of the server's thread are those of this client.
+  BOOST_REQUIRE(events.size() >= 4);
+
+  const auto client_events = std::vector<flight::event_record>(
+      events.end() - 4, events.end());
+
+  BOOST_CHECK(client_events[0].kind == flight::event_kind::ACCEPT);
+  BOOST_CHECK(client_events[1].kind == flight::event_kind::LOGIN);
+  BOOST_CHECK(client_events[2].kind == flight::event_kind::OVERSIZE_FRAME);
+  BOOST_CHECK(client_events[2].value == echo.size());
+  BOOST_CHECK(client_events[3].kind == flight::event_kind::DROP);
+  BOOST_CHECK(client_events[3].detail ==
+              static_cast<std::uint8_t>(drop_reason::MESSAGE_TOO_LONG));
+
+  for (const auto& event : client_events) {
+    BOOST_CHECK(event.session == client_events[0].session);
+  }
+
+  const auto line = flight::describe(dump, server_thread_id, client_events[3]);
+
+  BOOST_TEST_MESSAGE(line);
+  BOOST_CHECK(line.ends_with(describe(drop_reason::MESSAGE_TOO_LONG)));
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+} // namespace mori_echo::test
@@ -0,0 +1,195 @@
+#include <algorithm>
+#include <array>
+#include <boost/asio/io_context.hpp>
+#include <boost/test/unit_test.hpp>
+#include <cstdio>
+#include <spdlog/spdlog.h>
+#include <sys/resource.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <sys/wait.h>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+#include "client_authenticator/allow_all_client_authenticator.hpp"
+#include "echo_server/echo_server.hpp"
+#include "message_sender/message_sender.hpp"
+#include "message_sender/test_message_sender.hpp"
+#include "test_endpoints/test_endpoints.hpp"
+
+namespace mori_echo::test {
+
+inline constexpr auto target_idle_connections = std::size_t{100'000};
+
+// Descriptors kept free for everything but the connections.
+inline constexpr auto reserved_descriptors = std::size_t{256};
+
+[[nodiscard]] auto idle_socket_path() -> std::string {
+  return unique_temp_path("idle.sock");
+}
+
+[[nodiscard]] auto resident_bytes() -> std::size_t {
+  auto* statm = std::fopen("/proc/self/statm", "r");
+  BOOST_REQUIRE(statm != nullptr);
+
+  auto total_pages = std::size_t{};
+  auto resident_pages = std::size_t{};
+
+  const auto read =
+      std::fscanf(statm, "%zu %zu", &total_pages, &resident_pages);
+  std::fclose(statm);
+
+  BOOST_REQUIRE(read == 2);
+
+  return resident_pages * static_cast<std::size_t>(::sysconf(_SC_PAGESIZE));
+}
+
+// Both ends of every connection live in this process, so each takes two
+// descriptors. Falls short of the target where the hard limit is lower.
+[[nodiscard]] auto idle_connection_count() -> std::size_t {
+  auto limit = rlimit{};
+  ::getrlimit(RLIMIT_NOFILE, &limit);
+
+  limit.rlim_cur = limit.rlim_max;
+  ::setrlimit(RLIMIT_NOFILE, &limit);
+
+  const auto available = static_cast<std::size_t>(limit.rlim_cur);
+
+  return std::min(target_idle_connections,
+                  (available - std::min(available, reserved_descriptors)) / 2);
+}
+
+// Connects `count` clients which log in and then stay idle, and returns how
+// much the resident set grew per connection.
+[[nodiscard]] auto idle_rss_per_connection(bool enable_idle_wait,
+                                           std::size_t count) -> std::size_t {
+  const auto socket_path = idle_socket_path();
+
+  auto server_context = boost::asio::io_context{1};
+
+  mori_echo::spawn_server(
+      server_context.get_executor(),
+      {
+          .local_socket_path = socket_path,
+          .enable_idle_wait = enable_idle_wait,
+          .authenticator =
+              mori_echo::auth::allow_all_client_authenticator::create(),
+      });
+
+  server_context.poll();
+
+  auto server_work = boost::asio::make_work_guard(server_context);
+  auto server_thread = std::thread{[&] { server_context.run(); }};
+
+  const auto login = encode_login_request(0, "testuser", "testpass");
+
+  auto address = sockaddr_un{};
+  address.sun_family = AF_UNIX;
+  socket_path.copy(address.sun_path, sizeof(address.sun_path) - 1);
+
+  auto clients = std::vector<int>{};
+  clients.reserve(count);
+
+  const auto baseline = resident_bytes();
+
+  for (auto i = std::size_t{0}; i < count; ++i) {
+    const auto client = ::socket(AF_UNIX, SOCK_STREAM, 0);
+    BOOST_REQUIRE(client >= 0);
+
+    clients.push_back(client);
+
+    BOOST_REQUIRE(::connect(client, reinterpret_cast<sockaddr*>(&address),
+                            sizeof(address)) == 0);
+
+    BOOST_REQUIRE(::write(client, login.data(), login.size()) ==
+                  static_cast<ssize_t>(login.size()));
+
+    // Once answered, the session is back to waiting for its next request.
+    auto response = std::array<std::byte, login_response_frame_size>{};
+    BOOST_REQUIRE(::recv(client, response.data(), response.size(),
+                         MSG_WAITALL) == static_cast<ssize_t>(response.size()));
+  }
+
+  const auto grown = resident_bytes() - baseline;
+
+  for (const auto client : clients) {
+    ::close(client);
+  }
+
+  server_context.stop();
+  server_thread.join();
+
+  // Run in a child, which leaves without removing temporary paths on exit.
+  ::unlink(socket_path.c_str());
+
+  return grown / count;
+}
+
+// Measures in a child process, so that each run starts from a fresh heap
+// rather than from memory freed by the previous one.
+[[nodiscard]] auto measure_in_child(bool enable_idle_wait, std::size_t count)
+    -> std::size_t {
+  auto result = std::array<int, 2>{};
+  BOOST_REQUIRE(::pipe(result.data()) == 0);
+
+  const auto child = ::fork();
+  BOOST_REQUIRE(child >= 0);
+
+  if (child == 0) {
+    ::close(result[0]);
+
+    auto per_connection = std::size_t{};
+
+    try {
+      per_connection = idle_rss_per_connection(enable_idle_wait, count);
+    } catch (...) {
+      ::_exit(1);
+    }
+
+    const auto written =
+        ::write(result[1], &per_connection, sizeof(per_connection));
+
+    ::_exit(written == sizeof(per_connection) ? 0 : 1);
+  }
+
+  ::close(result[1]);
+
+  auto per_connection = std::size_t{};
+  const auto received =
+      ::read(result[0], &per_connection, sizeof(per_connection));
+  ::close(result[0]);
+
+  auto status = 0;
+  ::waitpid(child, &status, 0);
+
+  BOOST_REQUIRE(received == sizeof(per_connection));
+  BOOST_REQUIRE(WIFEXITED(status) && WEXITSTATUS(status) == 0);
+
+  return per_connection;
+}
+
+BOOST_AUTO_TEST_SUITE(idle_connections)
+
+BOOST_AUTO_TEST_CASE(idle_wait_shrinks_connections) {
+  // A log line per connection would dominate the run.
+  spdlog::set_level(spdlog::level::warn);
+
+  const auto count = idle_connection_count();
+  BOOST_REQUIRE(count > 0);
+
+  const auto waiting_in_read = measure_in_child(false, count);
+  const auto waiting_readable = measure_in_child(true, count);
+
+  spdlog::set_level(spdlog::level::info);
+
+  spdlog::info("RSS per idle connection at {} connections: {} bytes waiting "
+               "in a read, {} bytes with enable_idle_wait",
+               count, waiting_in_read, waiting_readable);
+
+  BOOST_CHECK(waiting_readable < waiting_in_read);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+} // namespace mori_echo::test
@@ -0,0 +1,213 @@
+#include <boost/asio/co_spawn.hpp>
+#include <boost/asio/io_context.hpp>
+#include <boost/asio/ip/tcp.hpp>
+#include <boost/test/unit_test.hpp>
+#include <chrono>
+#include <spdlog/spdlog.h>
+
+#include "client_authenticator/allow_all_client_authenticator.hpp"
+#include "client_channel/client_channel.hpp"
+#include "client_crypto/test_client_crypto.hpp"
+#include "echo_server/echo_server.hpp"
+#include "latency_tracer/latency_tracer.hpp"
+#include "memory_transport/memory_acceptor.hpp"
+#include "message_receiver/test_message_receiver.hpp"
+#include "message_sender/test_message_sender.hpp"
+#include "message_types/echo_request.hpp"
+#include "message_types/echo_response.hpp"
+#include "message_types/login_request.hpp"
+#include "message_types/login_response.hpp"
+#include "mori_status/login_status.hpp"
+
+namespace mori_echo::test {
+
+BOOST_AUTO_TEST_SUITE(latency_tracing)
+
+BOOST_AUTO_TEST_CASE(histogram_percentiles) {
+  auto histogram = latency_histogram{};
+
+  BOOST_CHECK(histogram.percentile(0.5) == std::chrono::nanoseconds{0});
+
+  for (auto i = 0; i < 99; ++i) {
+    histogram.record(std::chrono::nanoseconds{100});
+  }
+
+  histogram.record(std::chrono::milliseconds{1});
+
+  BOOST_CHECK(histogram.count() == 100);
+
+  // 100ns falls in [64ns, 128ns), and 1ms in [2^19ns, 2^20ns).
+  BOOST_CHECK(histogram.percentile(0.5) == std::chrono::nanoseconds{128});
+  BOOST_CHECK(histogram.percentile(0.98) == std::chrono::nanoseconds{128});
+  BOOST_CHECK(histogram.percentile(1.0) ==
+              std::chrono::nanoseconds{std::int64_t{1} << 20});
+}
+
+BOOST_AUTO_TEST_CASE(echo_stages_recorded) {
+  spdlog::set_level(spdlog::level::debug);
+
+  constexpr auto echo_count = 8;
+
+  const auto tracer = latency_tracer::create(1);
+
+  auto io_context = boost::asio::io_context{1};
+
+  const auto endpoint = mori_echo::spawn_server(
+      io_context.get_executor(),
+      {
+          .enable_decryption = true,
+          .authenticator =
+              mori_echo::auth::allow_all_client_authenticator::create(),
+          .tracer = tracer,
+      });
+
+  boost::asio::co_spawn(
+      io_context.get_executor(),
+      [&]() -> boost::asio::awaitable<void> {
+        const auto username = std::string{"testuser"};
+        const auto password = std::string{"testpass"};
+
+        auto socket = boost::asio::ip::tcp::socket{io_context};
+
+        co_await socket.async_connect(
+            {boost::asio::ip::address_v4::loopback(), endpoint.port()},
+            boost::asio::use_awaitable);
+
+        auto channel = client_channel{std::move(socket)};
+
+        co_await send_message<messages::login_request>{}(channel, 0, username,
+                                                         password);
+
+        const auto login_response =
+            co_await receive_message<messages::login_response>(
+                channel, co_await receive_response_header(channel));
+
+        BOOST_REQUIRE(login_response.status_code ==
+                      mori_status::login_status::OK);
+
+        for (auto sequence = 1; sequence <= echo_count; ++sequence) {
+          const auto echo_message = std::vector<std::byte>(64, std::byte{'M'});
+
+          const auto echo_message_encrypted = crypto::encrypt(
+              {
+                  .username_sum = crypto::calculate_checksum(username),
+                  .password_sum = crypto::calculate_checksum(password),
+                  .sequence = static_cast<std::uint8_t>(sequence),
+              },
+              echo_message);
+
+          co_await send_message<messages::echo_request>{}(
+              channel, static_cast<std::uint8_t>(sequence),
+              echo_message_encrypted);
+
+          const auto echo_response =
+              co_await receive_message<messages::echo_response>(
+                  channel, co_await receive_response_header(channel));
+
+          BOOST_CHECK(echo_response.plain_message == echo_message);
+        }
+
+        io_context.stop();
+      },
+      [](std::exception_ptr error) {
+        if (error) {
+          std::rethrow_exception(error);
+        }
+      });
+
+  io_context.run();
+
+  for (const auto stage :
+       {trace_stage::READ, trace_stage::DECRYPT, trace_stage::QUEUE,
+        trace_stage::WRITE, trace_stage::TOTAL}) {
+    BOOST_CHECK(tracer->histogram(stage).count() == echo_count);
+  }
+
+  BOOST_CHECK(tracer->histogram(trace_stage::TOTAL).percentile(0.5) >=
+              tracer->histogram(trace_stage::DECRYPT).percentile(0.5));
+
+  tracer->log_summary();
+}
+
+BOOST_AUTO_TEST_CASE(streamed_echo_stages_recorded) {
+  spdlog::set_level(spdlog::level::info);
+
+  constexpr auto echo_count = 4;
+
+  const auto tracer = latency_tracer::create();
+  const auto acceptor = memory_acceptor::create();
+
+  auto io_context = boost::asio::io_context{1};
+
+  // Streamed in chunks of 1KiB.
+  mori_echo::spawn_server(
+      io_context.get_executor(),
+      {
+          .memory = acceptor,
+          .enable_decryption = true,
+          .enable_cut_through = true,
+          .stream_chunk_size = 1024,
+          .authenticator =
+              mori_echo::auth::allow_all_client_authenticator::create(),
+          .tracer = tracer,
+      });
+
+  boost::asio::co_spawn(
+      io_context.get_executor(),
+      [&]() -> boost::asio::awaitable<void> {
+        auto channel = memory_client_channel{
+            acceptor->connect(io_context.get_executor())};
+
+        co_await send_message<messages::login_request>{}(
+            channel, 0, "testuser", "testpass");
+
+        const auto login_response =
+            co_await receive_message<messages::login_response>(
+                channel, co_await receive_response_header(channel));
+
+        BOOST_REQUIRE(login_response.status_code ==
+                      mori_status::login_status::OK);
+
+        for (auto sequence = 1; sequence <= echo_count; ++sequence) {
+          const auto echo_message =
+              std::vector<std::byte>(4000, std::byte{'S'});
+
+          const auto echo_message_encrypted = crypto::encrypt(
+              {
+                  .username_sum = crypto::calculate_checksum("testuser"),
+                  .password_sum = crypto::calculate_checksum("testpass"),
+                  .sequence = static_cast<std::uint8_t>(sequence),
+              },
+              echo_message);
+
+          co_await send_message<messages::echo_request>{}(
+              channel, static_cast<std::uint8_t>(sequence),
+              echo_message_encrypted);
+
+          const auto echo_response =
+              co_await receive_message<messages::echo_response>(
+                  channel, co_await receive_response_header(channel));
+
+          BOOST_CHECK(echo_response.plain_message == echo_message);
+        }
+
+        io_context.stop();
+      },
+      [](std::exception_ptr error) {
+        if (error) {
+          std::rethrow_exception(error);
+        }
+      });
+
+  io_context.run();
+
+  for (const auto stage :
+       {trace_stage::READ, trace_stage::DECRYPT, trace_stage::QUEUE,
+        trace_stage::WRITE, trace_stage::TOTAL}) {
+    BOOST_CHECK(tracer->histogram(stage).count() == echo_count);
+  }
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+} // namespace mori_echo::test
@@ -0,0 +1,115 @@
+#include <boost/asio/co_spawn.hpp>
+#include <boost/asio/io_context.hpp>
+#include <boost/asio/local/stream_protocol.hpp>
+#include <boost/test/framework.hpp>
+#include <boost/test/unit_test.hpp>
+#include <spdlog/spdlog.h>
+
+#include "client_authenticator/allow_all_client_authenticator.hpp"
+#include "client_channel/client_channel.hpp"
+#include "client_crypto/test_client_crypto.hpp"
+#include "echo_server/echo_server.hpp"
+#include "message_receiver/test_message_receiver.hpp"
+#include "message_sender/test_message_sender.hpp"
+#include "message_types/echo_request.hpp"
+#include "message_types/echo_response.hpp"
+#include "message_types/login_request.hpp"
+#include "message_types/login_response.hpp"
+#include "mori_status/login_status.hpp"
+#include "test_endpoints/test_endpoints.hpp"
+
+namespace mori_echo::test {
+
+[[nodiscard]] auto test_socket_path() -> std::string {
+  return unique_temp_path("test.sock");
+}
+
+BOOST_AUTO_TEST_SUITE(local_listener)
+
+BOOST_AUTO_TEST_CASE(login_and_echo_success) {
+  spdlog::set_level(spdlog::level::debug);
+
+  auto io_context = boost::asio::io_context{1};
+
+  mori_echo::spawn_server(
+      io_context.get_executor(),
+      {
+          .local_socket_path = test_socket_path(),
+          .enable_decryption = true,
+          .authenticator =
+              mori_echo::auth::allow_all_client_authenticator::create(),
+      });
+
+  boost::asio::co_spawn(
+      io_context.get_executor(),
+      [&]() -> boost::asio::awaitable<void> {
+        const auto username = std::string{"testuser"};
+        const auto password = std::string{"testpass"};
+
+        auto socket = boost::asio::local::stream_protocol::socket{io_context};
+
+        co_await socket.async_connect({test_socket_path()},
+                                      boost::asio::use_awaitable);
+
+        auto channel = local_client_channel{std::move(socket)};
+
+        constexpr auto login_request_sequence = 0;
+        co_await send_message<messages::login_request>{}(
+            channel, login_request_sequence, username, password);
+
+        auto login_response_header = co_await receive_response_header(channel);
+        BOOST_CHECK(login_response_header.type ==
+                    messages::message_type::LOGIN_RESPONSE);
+        BOOST_CHECK(login_response_header.sequence == login_request_sequence);
+
+        const auto login_response =
+            co_await receive_message<messages::login_response>(
+                channel, std::move(login_response_header));
+        BOOST_CHECK(login_response.status_code ==
+                    mori_status::login_status::OK);
+
+        const auto echo_message = std::string{"This is a MoriEcho unit test."};
+
+        auto echo_message_data = std::vector<std::byte>{echo_message.size()};
+
+        std::transform(echo_message.begin(), echo_message.end(),
+                       echo_message_data.begin(),
+                       [](char each) { return static_cast<std::byte>(each); });
+
+        constexpr auto echo_request_sequence = 1;
+
+        const auto echo_message_encrypted = crypto::encrypt(
+            {
+                .username_sum = crypto::calculate_checksum(username),
+                .password_sum = crypto::calculate_checksum(password),
+                .sequence = echo_request_sequence,
+            },
+            echo_message_data);
+
+        co_await send_message<messages::echo_request>{}(
+            channel, echo_request_sequence, echo_message_encrypted);
+
+        auto echo_response_header = co_await receive_response_header(channel);
+        BOOST_CHECK(echo_response_header.type ==
+                    messages::message_type::ECHO_RESPONSE);
+        BOOST_CHECK(echo_response_header.sequence == echo_request_sequence);
+
+        const auto echo_response =
+            co_await receive_message<messages::echo_response>(
+                channel, std::move(echo_response_header));
+        BOOST_CHECK(echo_response.plain_message == echo_message_data);
+
+        io_context.stop();
+      },
+      [](std::exception_ptr error) {
+        if (error) {
+          std::rethrow_exception(error);
+        }
+      });
+
+  io_context.run();
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+} // namespace mori_echo::test
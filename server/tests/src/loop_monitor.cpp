@@ -0,0 +1,237 @@
+#include <array>
+#include <arpa/inet.h>
+#include <boost/asio/co_spawn.hpp>
+#include <boost/asio/io_context.hpp>
+#include <boost/asio/post.hpp>
+#include <boost/asio/steady_timer.hpp>
+#include <boost/asio/use_awaitable.hpp>
+#include <boost/test/unit_test.hpp>
+#include <chrono>
+#include <memory>
+#include <netinet/in.h>
+#include <spdlog/spdlog.h>
+#include <string_view>
+#include <sys/socket.h>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+#include "client_authenticator/allow_all_client_authenticator.hpp"
+#include "echo_server/echo_server.hpp"
+#include "loop_monitor/loop_monitor.hpp"
+#include "message_sender/test_message_sender.hpp"
+
+namespace mori_echo::test {
+
+// Blocking TCP connection to the test server listening on `port`.
+[[nodiscard]] auto connect_to_monitored_server(std::uint16_t port) -> int {
+  const auto client = ::socket(AF_INET, SOCK_STREAM, 0);
+  BOOST_REQUIRE(client >= 0);
+
+  auto address = sockaddr_in{};
+  address.sin_family = AF_INET;
+  address.sin_port = htons(port);
+  address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+
+  BOOST_REQUIRE(::connect(client, reinterpret_cast<sockaddr*>(&address),
+                          sizeof(address)) == 0);
+
+  return client;
+}
+
+// Logs in over `client`, and returns whether the server accepted the login.
+[[nodiscard]] auto log_in_to_monitored_server(int client) -> bool {
+  const auto login = encode_login_request(0, "testuser", "testpass");
+
+  BOOST_REQUIRE(::write(client, login.data(), login.size()) ==
+                static_cast<ssize_t>(login.size()));
+
+  // Header, then a 16-bit status which is zero for FAILED in either byte
+  // order.
+  auto response = std::array<std::uint8_t, 6>{};
+  auto received = std::size_t{0};
+
+  while (received < response.size()) {
+    const auto count = ::read(client, response.data() + received,
+                              response.size() - received);
+    BOOST_REQUIRE(count > 0);
+
+    received += static_cast<std::size_t>(count);
+  }
+
+  return response[4] != 0 || response[5] != 0;
+}
+
+// Holds the loop of `context` for `duration`, as an overloaded loop would.
+auto block_loop(boost::asio::io_context& context,
+                std::chrono::milliseconds duration) -> void {
+  boost::asio::post(context,
+                    [duration] { std::this_thread::sleep_for(duration); });
+}
+
+// Holds its loop for a while on every login, as a blocking lookup would.
+class slow_authenticator final : public auth::client_authenticator {
+public:
+  auto authenticate(std::string_view, std::string_view) -> void override {
+    std::this_thread::sleep_for(std::chrono::milliseconds{20});
+  }
+};
+
+// Serves with a loop monitor on a thread of its own until destroyed.
+class monitored_server {
+public:
+  explicit monitored_server(
+      std::shared_ptr<loop_monitor> monitor,
+      std::shared_ptr<auth::client_authenticator> authenticator =
+          auth::allow_all_client_authenticator::create()) {
+    const auto endpoint = mori_echo::spawn_server(
+        context.get_executor(),
+        {
+            .authenticator = std::move(authenticator),
+            .monitor = std::move(monitor),
+        });
+
+    port = endpoint.port();
+
+    context.poll();
+
+    thread = std::thread{[this] { context.run(); }};
+  }
+
+  ~monitored_server() {
+    context.stop();
+    thread.join();
+  }
+
+  boost::asio::io_context context{1};
+
+  std::uint16_t port = 0;
+
+private:
+  boost::asio::executor_work_guard<boost::asio::io_context::executor_type>
+      work = boost::asio::make_work_guard(context);
+
+  std::thread thread;
+};
+
+[[nodiscard]] auto sample_shedding(std::shared_ptr<loop_monitor> monitor,
+                                   std::vector<bool>& samples)
+    -> boost::asio::awaitable<void> {
+  auto timer =
+      boost::asio::steady_timer{co_await boost::asio::this_coro::executor};
+
+  // Before, right after and well after the loop is held.
+  for (const auto delay : {10, 80, 400}) {
+    timer.expires_after(std::chrono::milliseconds{delay});
+    co_await timer.async_wait(boost::asio::use_awaitable);
+
+    samples.push_back(monitor->is_shedding());
+  }
+
+  monitor->stop();
+}
+
+BOOST_AUTO_TEST_SUITE(loop_monitor)
+
+BOOST_AUTO_TEST_CASE(measures_lag_and_sheds_until_caught_up) {
+  const auto monitor = mori_echo::loop_monitor::create({
+      .probe_interval = std::chrono::milliseconds{5},
+      .shed_lag = std::chrono::milliseconds{20},
+      .shed_hold = std::chrono::milliseconds{100},
+  });
+
+  auto context = boost::asio::io_context{1};
+  auto samples = std::vector<bool>{};
+
+  monitor->watch(context.get_executor());
+
+  boost::asio::co_spawn(context, sample_shedding(monitor, samples),
+                        [](std::exception_ptr error) {
+                          if (error) {
+                            std::rethrow_exception(error);
+                          }
+                        });
+
+  // Holds the loop between the first two samples.
+  auto timer = boost::asio::steady_timer{context};
+  timer.expires_after(std::chrono::milliseconds{20});
+  timer.async_wait([](auto) {
+    std::this_thread::sleep_for(std::chrono::milliseconds{50});
+  });
+
+  context.run();
+
+  BOOST_CHECK(samples == std::vector<bool>({false, true, false}));
+  BOOST_CHECK(monitor->lag().percentile(1.0) >=
+              std::chrono::milliseconds{32});
+
+  // Not probed from this thread.
+  BOOST_CHECK(!monitor->is_shedding());
+}
+
+BOOST_AUTO_TEST_CASE(sheds_logins_and_accepts) {
+  spdlog::set_level(spdlog::level::info);
+
+  constexpr auto shed_hold = std::chrono::milliseconds{300};
+
+  const auto monitor = mori_echo::loop_monitor::create({
+      .probe_interval = std::chrono::milliseconds{5},
+      .shed_lag = std::chrono::milliseconds{50},
+      .shed_hold = shed_hold,
+  });
+
+  auto server = monitored_server{monitor};
+
+  const auto early_client = connect_to_monitored_server(server.port);
+  std::this_thread::sleep_for(std::chrono::milliseconds{50});
+
+  block_loop(server.context, std::chrono::milliseconds{100});
+  std::this_thread::sleep_for(std::chrono::milliseconds{150});
+
+  BOOST_REQUIRE(monitor->is_any_shedding());
+
+  // Accepted before the loop fell behind, and rejected at login.
+  BOOST_CHECK(!log_in_to_monitored_server(early_client));
+
+  // Left in the backlog until the loop catches up.
+  const auto shed_at = std::chrono::steady_clock::now();
+  const auto late_client = connect_to_monitored_server(server.port);
+
+  BOOST_CHECK(log_in_to_monitored_server(late_client));
+  BOOST_CHECK(std::chrono::steady_clock::now() - shed_at >= shed_hold / 2);
+
+  ::close(early_client);
+  ::close(late_client);
+
+  BOOST_CHECK(monitor->count(shed_action::REJECTED_LOGIN) == 1);
+  BOOST_CHECK(monitor->count(shed_action::PAUSED_ACCEPTS) >= 1);
+
+  monitor->log_summary();
+}
+
+BOOST_AUTO_TEST_CASE(times_session_handlers) {
+  const auto monitor = mori_echo::loop_monitor::create({
+      .handler_budget = std::chrono::milliseconds{5},
+  });
+
+  {
+    auto server = monitored_server{monitor,
+                                   std::make_shared<slow_authenticator>()};
+
+    const auto client = connect_to_monitored_server(server.port);
+
+    // Over its budget, but let through as the loop is not running late.
+    BOOST_CHECK(log_in_to_monitored_server(client));
+
+    ::close(client);
+  }
+
+  BOOST_CHECK(monitor->handlers().count() == 1);
+  BOOST_CHECK(monitor->handlers().percentile(1.0) >=
+              std::chrono::milliseconds{16});
+  BOOST_CHECK(monitor->count(shed_action::DROPPED_SESSION) == 0);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+} // namespace mori_echo::test
@@ -0,0 +1,208 @@
+#include <boost/asio/co_spawn.hpp>
+#include <boost/asio/detached.hpp>
+#include <boost/asio/io_context.hpp>
+#include <boost/asio/steady_timer.hpp>
+#include <boost/test/unit_test.hpp>
+#include <chrono>
+#include <spdlog/spdlog.h>
+#include <thread>
+
+#include "client_authenticator/allow_all_client_authenticator.hpp"
+#include "client_channel/client_channel.hpp"
+#include "client_crypto/test_client_crypto.hpp"
+#include "echo_client/blocking_echo_client.hpp"
+#include "echo_server/echo_server.hpp"
+#include "memory_transport/memory_acceptor.hpp"
+#include "message_receiver/test_message_receiver.hpp"
+#include "message_sender/test_message_sender.hpp"
+#include "message_types/echo_request.hpp"
+#include "message_types/echo_response.hpp"
+#include "test_session/test_session.hpp"
+
+namespace mori_echo::test {
+
+// Runs `session` as a client of a memory stream from `acceptor`, until done.
+template <typename Session>
+auto run_memory_client(boost::asio::io_context& io_context,
+                       const std::shared_ptr<memory_acceptor>& acceptor,
+                       Session session) -> void {
+  boost::asio::co_spawn(
+      io_context.get_executor(),
+      [&]() -> boost::asio::awaitable<void> {
+        auto channel = memory_client_channel{
+            acceptor->connect(io_context.get_executor())};
+
+        co_await session(channel);
+
+        io_context.stop();
+      },
+      [](std::exception_ptr error) {
+        if (error) {
+          std::rethrow_exception(error);
+        }
+      });
+
+  io_context.run();
+}
+
+BOOST_AUTO_TEST_SUITE(memory_transport)
+
+BOOST_AUTO_TEST_CASE(login_and_echo_in_memory) {
+  spdlog::set_level(spdlog::level::info);
+
+  auto io_context = boost::asio::io_context{1};
+  const auto acceptor = memory_acceptor::create();
+
+  mori_echo::spawn_server(
+      io_context.get_executor(),
+      {
+          .memory = acceptor,
+          .enable_decryption = true,
+          .authenticator =
+              mori_echo::auth::allow_all_client_authenticator::create(),
+      });
+
+  run_memory_client(
+      io_context, acceptor,
+      [](memory_client_channel& channel) -> boost::asio::awaitable<void> {
+        co_await log_in(channel);
+
+        const auto echo_message = make_payload(1000, 1);
+
+        constexpr auto echo_request_sequence = 1;
+
+        const auto echo_message_encrypted = crypto::encrypt(
+            {
+                .username_sum = crypto::calculate_checksum("testuser"),
+                .password_sum = crypto::calculate_checksum("testpass"),
+                .sequence = echo_request_sequence,
+            },
+            echo_message);
+
+        co_await send_message<messages::echo_request>{}(
+            channel, echo_request_sequence, echo_message_encrypted);
+
+        auto header = co_await receive_response_header(channel);
+        BOOST_CHECK(header.type == messages::message_type::ECHO_RESPONSE);
+        BOOST_CHECK(header.sequence == echo_request_sequence);
+
+        const auto echo = co_await receive_message<messages::echo_response>(
+            channel, std::move(header));
+        BOOST_CHECK(echo.plain_message == echo_message);
+      });
+}
+
+// Streams much smaller than the frames fill up and wrap around on every one.
+BOOST_AUTO_TEST_CASE(pipelined_echoes_through_small_streams) {
+  spdlog::set_level(spdlog::level::info);
+
+  auto io_context = boost::asio::io_context{1};
+  const auto acceptor = memory_acceptor::create(4096);
+
+  mori_echo::spawn_server(
+      io_context.get_executor(),
+      {
+          .memory = acceptor,
+          .enable_decryption = false,
+          .authenticator =
+              mori_echo::auth::allow_all_client_authenticator::create(),
+      });
+
+  run_memory_client(
+      io_context, acceptor,
+      [](memory_client_channel& channel) -> boost::asio::awaitable<void> {
+        co_await log_in(channel);
+
+        const auto payloads = std::vector<std::vector<std::byte>>{
+            make_payload(1024 * 1024, 1),
+            make_payload(60000, 2),
+            make_payload(100, 3),
+            make_payload(5000, 4),
+        };
+
+        boost::asio::co_spawn(co_await boost::asio::this_coro::executor,
+                              send_payloads(channel, payloads),
+                              boost::asio::detached);
+
+        for (auto i = std::size_t{0}; i < payloads.size(); ++i) {
+          auto header = co_await receive_response_header(channel);
+          BOOST_CHECK(header.sequence == i + 1);
+
+          const auto echo = co_await receive_message<messages::echo_response>(
+              channel, std::move(header));
+          BOOST_CHECK(echo.plain_message == payloads[i]);
+        }
+      });
+}
+
+BOOST_AUTO_TEST_CASE(closed_stream_disconnects) {
+  spdlog::set_level(spdlog::level::info);
+
+  auto io_context = boost::asio::io_context{1};
+  const auto acceptor = memory_acceptor::create();
+  const auto drops = drop_counters::create();
+
+  mori_echo::spawn_server(
+      io_context.get_executor(),
+      {
+          .memory = acceptor,
+          .authenticator =
+              mori_echo::auth::allow_all_client_authenticator::create(),
+          .drops = drops,
+      });
+
+  run_memory_client(
+      io_context, acceptor,
+      [&](memory_client_channel& channel) -> boost::asio::awaitable<void> {
+        co_await log_in(channel);
+
+        // Ends the channel's stream, as going out of scope does.
+        { auto closed = std::move(channel); }
+
+        auto timer = boost::asio::steady_timer{io_context};
+
+        for (auto i = 0;
+             i < 100 && drops->count(drop_reason::DISCONNECTED) == 0; ++i) {
+          timer.expires_after(std::chrono::milliseconds{10});
+          co_await timer.async_wait(boost::asio::use_awaitable);
+        }
+      });
+
+  BOOST_CHECK(drops->count(drop_reason::DISCONNECTED) == 1);
+}
+
+BOOST_AUTO_TEST_CASE(ephemeral_port_reported) {
+  spdlog::set_level(spdlog::level::info);
+
+  auto io_context = boost::asio::io_context{1};
+
+  const auto endpoint = mori_echo::spawn_server(
+      io_context.get_executor(),
+      {
+          .port = 0,
+          .enable_decryption = false,
+          .authenticator =
+              mori_echo::auth::allow_all_client_authenticator::create(),
+      });
+
+  BOOST_REQUIRE(endpoint.port() != 0);
+
+  auto server = std::thread{[&] { io_context.run(); }};
+
+  {
+    auto client = client::blocking_echo_client{
+        {boost::asio::ip::address_v4::loopback(), endpoint.port()},
+        {.username = "testuser", .password = "testpass"},
+        {.connections = 1, .connection = {.encrypt = false}}};
+
+    const auto payload = make_payload(3000, 5);
+    BOOST_CHECK(client.echo(payload) == payload);
+  }
+
+  io_context.stop();
+  server.join();
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+} // namespace mori_echo::test
@@ -1,102 +1,106 @@
-#include "message_receiver/message_receiver.hpp"
+#include "test_message_receiver.hpp"
 
-#include <boost/endian/conversion.hpp>
+#include <array>
+#include <boost/system/system_error.hpp>
 #include <cstdint>
-#include <limits>
+#include <string>
 
 #include "exceptions/server_error.hpp"
+#include "message_codec/message_codec.hpp"
 #include "message_types/echo_response.hpp"
 #include "message_types/login_response.hpp"
-#include "mori_echo/server_config.hpp"
+#include "mori_status/login_status.hpp"
 
 namespace mori_echo {
 
-static_assert(config::byte_order == config::endian_mode::LITTLE_ENDIAN_MODE ||
-                  config::byte_order == config::endian_mode::BIG_ENDIAN_MODE,
-              "Invalid byte order configuration.");
-
-inline constexpr auto header_size =
-    sizeof(std::uint16_t) + sizeof(std::uint8_t) + sizeof(std::uint8_t);
+[[nodiscard]] auto make_login_response(messages::message_header header,
+                                       std::uint16_t status_code)
+    -> messages::login_response {
+  auto message = messages::login_response{};
 
-template <>
-auto receive_message<messages::login_response>(client_channel& channel,
-                                               messages::message_header header)
-    -> boost::asio::awaitable<messages::login_response> {
-  constexpr auto min_message_size = header_size + sizeof(std::uint16_t);
+  message.header = std::move(header);
 
-  constexpr auto max_message_size = min_message_size;
+  switch (status_code) {
+    case static_cast<std::uint16_t>(mori_status::login_status::OK):
+    case static_cast<std::uint16_t>(mori_status::login_status::FAILED):
+      message.status_code = static_cast<mori_status::login_status>(status_code);
+      break;
 
-  if (header.type != messages::message_type::LOGIN_RESPONSE) {
-    throw exceptions::server_error{"Wrong message type."};
+    default:
+      throw exceptions::server_error{"Invalid login status code."};
   }
 
-  if (header.total_size < min_message_size) {
-    throw exceptions::server_error{"Message too short."};
-  } else if (header.total_size > max_message_size) {
-    throw exceptions::server_error{"Message too long."};
-  }
+  return message;
+}
 
-  auto status_code = co_await channel.receive_as<std::uint16_t>();
+template <typename AsyncStream>
+auto receive_response_header(basic_client_channel<AsyncStream>& channel)
+    -> boost::asio::awaitable<messages::message_header> {
+  auto header = co_await receive_header(channel);
 
-  if constexpr (config::byte_order == config::endian_mode::LITTLE_ENDIAN_MODE) {
-    boost::endian::little_to_native_inplace(status_code);
-  } else {
-    boost::endian::big_to_native_inplace(status_code);
-  }
+  if (!header) {
+    const auto fault = std::move(header).fault();
 
-  auto actual_status_code = mori_status::login_status{};
+    if (fault.error) {
+      throw boost::system::system_error{fault.error};
+    }
 
-  switch (status_code) {
-    case static_cast<std::uint16_t>(mori_status::login_status::OK):
-    case static_cast<std::uint16_t>(mori_status::login_status::FAILED):
-      actual_status_code = static_cast<mori_status::login_status>(status_code);
-      break;
+    throw exceptions::server_error{std::string{fault.detail}};
+  }
 
-    default:
-      throw exceptions::server_error{"Invalid login status code."};
+  co_return *std::move(header);
+}
+
+template <typename AsyncStream>
+auto message_receiver<messages::login_response>::operator()(
+    basic_client_channel<AsyncStream>& channel, messages::message_header header)
+    -> boost::asio::awaitable<messages::login_response> {
+  if (header.type != messages::message_type::LOGIN_RESPONSE) {
+    throw exceptions::server_error{"Wrong message type."};
   }
 
-  auto message = messages::login_response{};
+  if (header.is_extended ||
+      header.total_size != frame_prefix_size<messages::login_response>) {
+    throw exceptions::server_error{"Message size mismatch."};
+  }
 
-  message.header = std::move(header);
-  message.status_code = actual_status_code;
+  auto layout_data =
+      std::array<std::byte, messages::layout_size<messages::login_response>>{};
+  co_await channel.receive(layout_data);
 
-  co_return message;
+  co_return make_login_response(
+      std::move(header),
+      decode_fixed_part<messages::login_response>(layout_data).status_code);
 }
 
-template <>
-auto receive_message<messages::echo_response>(client_channel& channel,
-                                              messages::message_header header)
+template <typename AsyncStream>
+auto message_receiver<messages::echo_response>::operator()(
+    basic_client_channel<AsyncStream>& channel, messages::message_header header)
     -> boost::asio::awaitable<messages::echo_response> {
-  constexpr auto min_message_size = header_size + sizeof(std::uint16_t);
-
-  constexpr auto max_message_size = std::min(
-      std::size_t{
-          std::numeric_limits<decltype(std::declval<messages::message_header>()
-                                           .total_size)>::max()},
-      min_message_size + std::numeric_limits<std::uint16_t>::max());
+  using schema = messages::message_schema<messages::echo_response>;
 
   if (header.type != messages::message_type::ECHO_RESPONSE) {
     throw exceptions::server_error{"Wrong message type."};
   }
 
-  if (header.total_size < min_message_size) {
-    throw exceptions::server_error{"Message too short."};
-  } else if (header.total_size > max_message_size) {
-    throw exceptions::server_error{"Message too long."};
-  }
+  auto message_size = std::uint32_t{};
 
-  auto message_size = co_await channel.receive_as<std::uint16_t>();
+  if (header.is_extended) {
+    auto layout_data = std::array<std::byte, sizeof(schema::extended_layout)>{};
+    co_await channel.receive(layout_data);
 
-  if constexpr (config::byte_order == config::endian_mode::LITTLE_ENDIAN_MODE) {
-    boost::endian::little_to_native_inplace(message_size);
+    message_size =
+        decode_extended_fixed_part<messages::echo_response>(layout_data)
+            .*schema::extended_payload_size;
   } else {
-    boost::endian::big_to_native_inplace(message_size);
-  }
+    auto layout_data = std::array<std::byte, sizeof(schema::layout)>{};
+    co_await channel.receive(layout_data);
 
-  const auto final_message_size = min_message_size + message_size;
+    message_size = decode_fixed_part<messages::echo_response>(layout_data)
+                       .*schema::payload_size;
+  }
 
-  if (header.total_size != final_message_size) {
+  if (!sizes_payload<messages::echo_response>(header, message_size)) {
     throw exceptions::server_error{"Message size mismatch."};
   }
 
@@ -113,4 +117,84 @@ auto receive_message<messages::echo_response>(client_channel& channel,
   co_return message;
 }
 
+template auto receive_response_header(client_channel& channel)
+    -> boost::asio::awaitable<messages::message_header>;
+
+template auto receive_response_header(local_client_channel& channel)
+    -> boost::asio::awaitable<messages::message_header>;
+
+template auto receive_response_header(memory_client_channel& channel)
+    -> boost::asio::awaitable<messages::message_header>;
+
+template auto message_receiver<messages::login_response>::operator()(
+    client_channel& channel, messages::message_header header)
+    -> boost::asio::awaitable<messages::login_response>;
+
+template auto message_receiver<messages::login_response>::operator()(
+    local_client_channel& channel, messages::message_header header)
+    -> boost::asio::awaitable<messages::login_response>;
+
+template auto message_receiver<messages::login_response>::operator()(
+    memory_client_channel& channel, messages::message_header header)
+    -> boost::asio::awaitable<messages::login_response>;
+
+template auto message_receiver<messages::echo_response>::operator()(
+    client_channel& channel, messages::message_header header)
+    -> boost::asio::awaitable<messages::echo_response>;
+
+template auto message_receiver<messages::echo_response>::operator()(
+    local_client_channel& channel, messages::message_header header)
+    -> boost::asio::awaitable<messages::echo_response>;
+
+template auto message_receiver<messages::echo_response>::operator()(
+    memory_client_channel& channel, messages::message_header header)
+    -> boost::asio::awaitable<messages::echo_response>;
+
+template <>
+auto decode_message<messages::login_response>(std::span<std::byte>& data,
+                                              messages::message_header header)
+    -> messages::login_response {
+  if (header.type != messages::message_type::LOGIN_RESPONSE ||
+      data.size() != messages::layout_size<messages::login_response>) {
+    throw exceptions::server_error{"Malformed login response."};
+  }
+
+  const auto layout = decode_fixed_part<messages::login_response>(
+      data.first<messages::layout_size<messages::login_response>>());
+
+  return make_login_response(std::move(header), layout.status_code);
+}
+
+template <>
+auto decode_message<messages::echo_response>(std::span<std::byte>& data,
+                                             messages::message_header header)
+    -> messages::echo_response {
+  using schema = messages::message_schema<messages::echo_response>;
+
+  if (header.type != messages::message_type::ECHO_RESPONSE ||
+      data.size() < sizeof(schema::layout)) {
+    throw exceptions::server_error{"Malformed echo response."};
+  }
+
+  const auto message_size =
+      decode_fixed_part<messages::echo_response>(
+          data.first<sizeof(schema::layout)>())
+          .*schema::payload_size;
+
+  const auto payload = data.subspan(sizeof(schema::layout));
+
+  if (payload.size() != message_size ||
+      !sizes_payload<messages::echo_response>(header, message_size)) {
+    throw exceptions::server_error{"Message size mismatch."};
+  }
+
+  auto message = messages::echo_response{};
+
+  message.header = std::move(header);
+  message.message_size = message_size;
+  message.plain_message.assign(payload.begin(), payload.end());
+
+  return message;
+}
+
 } // namespace mori_echo
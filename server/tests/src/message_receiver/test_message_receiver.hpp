@@ -0,0 +1,30 @@
+#pragma once
+
+#include "message_receiver/message_receiver.hpp"
+#include "message_types/echo_response.hpp"
+#include "message_types/login_response.hpp"
+
+namespace mori_echo {
+
+// Receives the header of a server response, throwing a `system_error` once
+// the server closes the connection.
+template <typename AsyncStream>
+[[nodiscard]] auto
+receive_response_header(basic_client_channel<AsyncStream>& channel)
+    -> boost::asio::awaitable<messages::message_header>;
+
+template <> struct message_receiver<messages::login_response> {
+  template <typename AsyncStream>
+  auto operator()(basic_client_channel<AsyncStream>& channel,
+                  messages::message_header header)
+      -> boost::asio::awaitable<messages::login_response>;
+};
+
+template <> struct message_receiver<messages::echo_response> {
+  template <typename AsyncStream>
+  auto operator()(basic_client_channel<AsyncStream>& channel,
+                  messages::message_header header)
+      -> boost::asio::awaitable<messages::echo_response>;
+};
+
+} // namespace mori_echo
@@ -1,96 +1,130 @@
 #include "test_message_sender.hpp"
 
-#include <boost/endian/conversion.hpp>
+#include <algorithm>
 #include <cstdint>
 
 #include "exceptions/client_error.hpp"
+#include "message_codec/message_codec.hpp"
 #include "message_types/echo_request.hpp"
 #include "message_types/login_request.hpp"
 #include "mori_echo/server_config.hpp"
 
 namespace mori_echo {
 
-static_assert(config::byte_order == config::endian_mode::LITTLE_ENDIAN_MODE ||
-                  config::byte_order == config::endian_mode::BIG_ENDIAN_MODE,
-              "Invalid byte order configuration.");
-
-inline constexpr auto header_size =
-    sizeof(std::uint16_t) + sizeof(std::uint8_t) + sizeof(std::uint8_t);
-
-[[nodiscard]] auto
-send_header(client_channel& channel, std::uint16_t total_size,
-            messages::message_type type, std::uint8_t sequence)
-    -> boost::asio::awaitable<void>;
-
-auto send_message<messages::login_request>::operator()(
-    client_channel& channel, std::uint8_t sequence, std::string_view username,
-    std::string_view password) -> boost::asio::awaitable<void> {
-  auto total_size = std::uint16_t{header_size + config::username_size +
-                                  config::password_size};
-
-  if constexpr (config::byte_order == config::endian_mode::LITTLE_ENDIAN_MODE) {
-    boost::endian::native_to_little_inplace(total_size);
-  } else {
-    boost::endian::native_to_big_inplace(total_size);
-  }
-
+[[nodiscard]] auto make_login_layout(std::string_view username,
+                                     std::string_view password)
+    -> messages::message_schema<messages::login_request>::layout {
   if (username.size() >= config::username_size) {
     throw exceptions::client_error{"Username too long."};
   }
 
-  if (password.size() >= config::username_size) {
+  if (password.size() >= config::password_size) {
     throw exceptions::client_error{"Password too long."};
   }
 
-  co_await send_header(channel, total_size,
-                       messages::message_type::LOGIN_REQUEST, sequence);
+  auto layout = messages::message_schema<messages::login_request>::layout{};
 
-  auto username_data = std::vector<std::byte>{config::username_size};
-  auto password_data = std::vector<std::byte>{config::password_size};
+  const auto to_byte = [](char each) { return static_cast<std::byte>(each); };
 
-  std::transform(username.begin(), username.end(), username_data.begin(),
-                 [](char each) { return static_cast<std::byte>(each); });
+  std::transform(username.begin(), username.end(), layout.username.begin(),
+                 to_byte);
 
-  std::transform(password.begin(), password.end(), password_data.begin(),
-                 [](char each) { return static_cast<std::byte>(each); });
+  std::transform(password.begin(), password.end(), layout.password.begin(),
+                 to_byte);
 
-  co_await channel.send(username_data);
-  co_await channel.send(password_data);
+  return layout;
 }
 
+template <typename AsyncStream>
+auto send_message<messages::login_request>::operator()(
+    basic_client_channel<AsyncStream>& channel, std::uint8_t sequence,
+    std::string_view username, std::string_view password)
+    -> boost::asio::awaitable<void> {
+  co_await channel.send(encode_frame_prefix<messages::login_request>(
+      sequence, make_login_layout(username, password)));
+}
+
+template <typename AsyncStream>
 auto send_message<messages::echo_request>::operator()(
-    client_channel& channel, std::uint8_t sequence,
+    basic_client_channel<AsyncStream>& channel, std::uint8_t sequence,
     const std::vector<std::byte>& message) -> boost::asio::awaitable<void> {
-  constexpr auto max_message_size = std::numeric_limits<std::uint16_t>::max() -
-                                    sizeof(std::uint16_t) - header_size;
-
-  if (message.size() > max_message_size) {
+  if (message.size() <= max_payload_size<messages::echo_request>) {
+    co_await channel.send(encode_frame_prefix<messages::echo_request>(
+        sequence, {.message_size = static_cast<std::uint16_t>(message.size())},
+        message.size()));
+  } else if (message.size() <=
+             max_extended_payload_size<messages::echo_request>) {
+    co_await channel.send(encode_extended_frame_prefix<messages::echo_request>(
+        sequence, {.message_size = static_cast<std::uint32_t>(message.size())},
+        message.size()));
+  } else {
     throw exceptions::client_error{"Message too long."};
   }
 
-  auto total_size = static_cast<std::uint16_t>(
-      header_size + sizeof(std::uint16_t) + message.size());
+  co_await channel.send(message);
+}
 
-  if constexpr (config::byte_order == config::endian_mode::LITTLE_ENDIAN_MODE) {
-    boost::endian::native_to_little_inplace(total_size);
-  } else {
-    boost::endian::native_to_big_inplace(total_size);
-  }
+template auto send_message<messages::login_request>::operator()(
+    client_channel& channel, std::uint8_t sequence, std::string_view username,
+    std::string_view password) -> boost::asio::awaitable<void>;
 
-  co_await send_header(channel, total_size,
-                       messages::message_type::ECHO_REQUEST, sequence);
+template auto send_message<messages::login_request>::operator()(
+    local_client_channel& channel, std::uint8_t sequence,
+    std::string_view username, std::string_view password)
+    -> boost::asio::awaitable<void>;
 
-  auto message_size = static_cast<std::uint16_t>(message.size());
+template auto send_message<messages::login_request>::operator()(
+    memory_client_channel& channel, std::uint8_t sequence,
+    std::string_view username, std::string_view password)
+    -> boost::asio::awaitable<void>;
 
-  if constexpr (config::byte_order == config::endian_mode::LITTLE_ENDIAN_MODE) {
-    boost::endian::native_to_little_inplace(message_size);
-  } else {
-    boost::endian::native_to_big_inplace(message_size);
+template auto send_message<messages::echo_request>::operator()(
+    client_channel& channel, std::uint8_t sequence,
+    const std::vector<std::byte>& message) -> boost::asio::awaitable<void>;
+
+template auto send_message<messages::echo_request>::operator()(
+    local_client_channel& channel, std::uint8_t sequence,
+    const std::vector<std::byte>& message) -> boost::asio::awaitable<void>;
+
+template auto send_message<messages::echo_request>::operator()(
+    memory_client_channel& channel, std::uint8_t sequence,
+    const std::vector<std::byte>& message) -> boost::asio::awaitable<void>;
+
+auto encode_login_request(std::uint8_t sequence, std::string_view username,
+                          std::string_view password) -> std::vector<std::byte> {
+  const auto frame = encode_frame_prefix<messages::login_request>(
+      sequence, make_login_layout(username, password));
+
+  return {frame.begin(), frame.end()};
+}
+
+auto encode_echo_request(std::uint8_t sequence,
+                         const std::vector<std::byte>& message)
+    -> std::vector<std::byte> {
+  if (message.size() > max_payload_size<messages::echo_request>) {
+    throw exceptions::client_error{"Message too long."};
   }
 
-  co_await channel.send_as(message_size);
+  const auto framing = encode_frame_prefix<messages::echo_request>(
+      sequence, {.message_size = static_cast<std::uint16_t>(message.size())},
+      message.size());
 
-  co_await channel.send(message);
+  auto frame = std::vector<std::byte>(framing.begin(), framing.end());
+  frame.insert(frame.end(), message.begin(), message.end());
+
+  return frame;
+}
+
+auto encode_echo_probe(std::uint8_t login_sequence, std::string_view username,
+                       std::string_view password, std::uint8_t echo_sequence,
+                       const std::vector<std::byte>& message)
+    -> std::vector<std::byte> {
+  auto probe = encode_login_request(login_sequence, username, password);
+
+  const auto echo = encode_echo_request(echo_sequence, message);
+  probe.insert(probe.end(), echo.begin(), echo.end());
+
+  return probe;
 }
 
 } // namespace mori_echo
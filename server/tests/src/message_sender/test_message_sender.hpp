@@ -7,15 +7,36 @@
 namespace mori_echo {
 
 template <> struct send_message<messages::login_request> {
-  auto operator()(client_channel& channel, std::uint8_t sequence,
-                  std::string_view username, std::string_view password)
-      -> boost::asio::awaitable<void>;
+  template <typename AsyncStream>
+  auto operator()(basic_client_channel<AsyncStream>& channel,
+                  std::uint8_t sequence, std::string_view username,
+                  std::string_view password) -> boost::asio::awaitable<void>;
 };
 
 template <> struct send_message<messages::echo_request> {
-  auto operator()(client_channel& channel, std::uint8_t sequence,
-                  const std::vector<std::byte>& message)
+  template <typename AsyncStream>
+  auto operator()(basic_client_channel<AsyncStream>& channel,
+                  std::uint8_t sequence, const std::vector<std::byte>& message)
       -> boost::asio::awaitable<void>;
 };
 
+// Encode single frames, for transports that carry them as memory.
+[[nodiscard]] auto encode_login_request(std::uint8_t sequence,
+                                        std::string_view username,
+                                        std::string_view password)
+    -> std::vector<std::byte>;
+
+[[nodiscard]] auto encode_echo_request(std::uint8_t sequence,
+                                       const std::vector<std::byte>& message)
+    -> std::vector<std::byte>;
+
+// Encodes a self-contained UDP echo probe: a login request immediately
+// followed by an echo request.
+[[nodiscard]] auto encode_echo_probe(std::uint8_t login_sequence,
+                                     std::string_view username,
+                                     std::string_view password,
+                                     std::uint8_t echo_sequence,
+                                     const std::vector<std::byte>& message)
+    -> std::vector<std::byte>;
+
 } // namespace mori_echo
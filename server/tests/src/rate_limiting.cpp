@@ -0,0 +1,214 @@
+#include <boost/asio/co_spawn.hpp>
+#include <boost/asio/io_context.hpp>
+#include <boost/test/unit_test.hpp>
+#include <chrono>
+#include <spdlog/spdlog.h>
+
+#include "client_authenticator/allow_all_client_authenticator.hpp"
+#include "client_channel/client_channel.hpp"
+#include "echo_server/echo_server.hpp"
+#include "memory_transport/memory_acceptor.hpp"
+#include "message_receiver/test_message_receiver.hpp"
+#include "message_sender/test_message_sender.hpp"
+#include "message_types/echo_request.hpp"
+#include "message_types/echo_response.hpp"
+#include "rate_limiter/rate_limiter.hpp"
+#include "test_session/test_session.hpp"
+
+namespace mori_echo::test {
+
+using namespace std::chrono_literals;
+
+// Logs in as "testuser" over a memory stream, then runs `session`.
+template <typename Session>
+auto run_limited_client(boost::asio::io_context& io_context,
+                        const std::shared_ptr<memory_acceptor>& acceptor,
+                        Session session) -> void {
+  boost::asio::co_spawn(
+      io_context.get_executor(),
+      [&]() -> boost::asio::awaitable<void> {
+        auto channel = memory_client_channel{
+            acceptor->connect(io_context.get_executor())};
+
+        co_await log_in(channel);
+
+        co_await session(channel);
+
+        io_context.stop();
+      },
+      [](std::exception_ptr error) {
+        if (error) {
+          std::rethrow_exception(error);
+        }
+      });
+
+  io_context.run();
+}
+
+auto spawn_limited_server(boost::asio::io_context& io_context,
+                          const std::shared_ptr<memory_acceptor>& acceptor,
+                          std::shared_ptr<rate_limiter> limiter,
+                          std::shared_ptr<drop_counters> drops = nullptr)
+    -> void {
+  mori_echo::spawn_server(
+      io_context.get_executor(),
+      {
+          .memory = acceptor,
+          .enable_decryption = false,
+          .authenticator =
+              mori_echo::auth::allow_all_client_authenticator::create(),
+          .drops = std::move(drops),
+          .limiter = std::move(limiter),
+      });
+}
+
+BOOST_AUTO_TEST_SUITE(rate_limiting)
+
+BOOST_AUTO_TEST_CASE(buckets_refill_at_their_rate) {
+  const auto limiter = rate_limiter::create({
+      .defaults = {.messages_per_second = 100, .message_burst = 4},
+  });
+
+  auto state = rate_limit_state{};
+  const auto start = rate_limiter::clock::now();
+
+  for (auto i = 0; i < 4; ++i) {
+    BOOST_CHECK(limiter->take(state, 10, start) == 0ns);
+  }
+
+  // A message every 10ms, past the burst.
+  BOOST_CHECK(limiter->take(state, 10, start) == 10ms);
+  BOOST_CHECK(limiter->take(state, 10, start + 10ms) == 10ms);
+
+  // Back within the burst once idle long enough.
+  BOOST_CHECK(limiter->take(state, 10, start + 1s) == 0ns);
+}
+
+BOOST_AUTO_TEST_CASE(bytes_are_limited_apart_from_messages) {
+  const auto limiter = rate_limiter::create({
+      .defaults = {.bytes_per_second = 1000, .byte_burst = 1000},
+  });
+
+  auto state = rate_limit_state{};
+  const auto start = rate_limiter::clock::now();
+
+  BOOST_CHECK(limiter->take(state, 600, start) == 0ns);
+  BOOST_CHECK(limiter->take(state, 600, start) == 200ms);
+}
+
+BOOST_AUTO_TEST_CASE(users_get_their_own_limits) {
+  const auto limiter = rate_limiter::create({
+      .defaults = {.messages_per_second = 1, .message_burst = 1},
+      .users = {{"heavy", {.messages_per_second = 1000,
+                           .message_burst = 100}}},
+  });
+
+  const auto now = rate_limiter::clock::now();
+
+  auto heavy = rate_limit_state{};
+  limiter->assign(heavy, "heavy");
+
+  auto other = rate_limit_state{};
+  limiter->assign(other, "other");
+
+  for (auto i = 0; i < 100; ++i) {
+    BOOST_CHECK(limiter->take(heavy, 10, now) == 0ns);
+  }
+
+  BOOST_CHECK(limiter->take(other, 10, now) == 0ns);
+  BOOST_CHECK(limiter->take(other, 10, now) == 1s);
+}
+
+BOOST_AUTO_TEST_CASE(clients_over_their_limits_are_delayed) {
+  spdlog::set_level(spdlog::level::info);
+
+  auto io_context = boost::asio::io_context{1};
+  const auto acceptor = memory_acceptor::create();
+  const auto limiter = rate_limiter::create({
+      .defaults = {.messages_per_second = 100, .message_burst = 10},
+  });
+
+  spawn_limited_server(io_context, acceptor, limiter);
+
+  constexpr auto echoes = 40;
+
+  auto elapsed = std::chrono::steady_clock::duration{};
+
+  run_limited_client(
+      io_context, acceptor,
+      [&](memory_client_channel& channel) -> boost::asio::awaitable<void> {
+        const auto payload = std::vector<std::byte>(100, std::byte{'R'});
+        const auto start = std::chrono::steady_clock::now();
+
+        // Sent all at once, so that however slowly they are echoed, the
+        // bucket never refills between two of them.
+        auto requests = std::vector<std::byte>{};
+
+        for (auto i = 0; i < echoes; ++i) {
+          const auto request =
+              encode_echo_request(static_cast<std::uint8_t>(i), payload);
+          requests.insert(requests.end(), request.begin(), request.end());
+        }
+
+        co_await channel.send(requests);
+
+        for (auto i = 0; i < echoes; ++i) {
+          const auto echo = co_await receive_message<messages::echo_response>(
+              channel, co_await receive_response_header(channel));
+          BOOST_CHECK(echo.plain_message == payload);
+        }
+
+        elapsed = std::chrono::steady_clock::now() - start;
+      });
+
+  // All but the burst wait their turn, at 10ms each.
+  BOOST_CHECK(elapsed >= 290ms);
+  BOOST_CHECK(limiter->count(rate_limit_action::DELAY) >= echoes - 10);
+  BOOST_CHECK(limiter->count(rate_limit_action::DISCONNECT) == 0);
+  BOOST_CHECK(limiter->total_delay() > 0ns);
+}
+
+BOOST_AUTO_TEST_CASE(clients_over_their_limits_are_disconnected) {
+  spdlog::set_level(spdlog::level::info);
+
+  auto io_context = boost::asio::io_context{1};
+  const auto acceptor = memory_acceptor::create();
+  const auto drops = drop_counters::create();
+  const auto limiter = rate_limiter::create({
+      .defaults = {.messages_per_second = 10, .message_burst = 5},
+      .action = rate_limit_action::DISCONNECT,
+  });
+
+  spawn_limited_server(io_context, acceptor, limiter, drops);
+
+  auto echoed = 0;
+
+  run_limited_client(
+      io_context, acceptor,
+      [&](memory_client_channel& channel) -> boost::asio::awaitable<void> {
+        const auto payload = std::vector<std::byte>(100, std::byte{'R'});
+
+        try {
+          for (auto i = 0; i < 20; ++i) {
+            co_await send_message<messages::echo_request>{}(
+                channel, static_cast<std::uint8_t>(i), payload);
+
+            co_await receive_message<messages::echo_response>(
+                channel, co_await receive_response_header(channel));
+
+            ++echoed;
+          }
+        } catch (const boost::system::system_error& dropped) {
+          BOOST_CHECK(dropped.code() == boost::asio::error::eof ||
+                      dropped.code() == boost::asio::error::broken_pipe);
+        }
+      });
+
+  BOOST_CHECK(echoed == 5);
+  BOOST_CHECK(limiter->count(rate_limit_action::DISCONNECT) == 1);
+  BOOST_CHECK(drops->count(drop_reason::RATE_LIMITED) == 1);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+} // namespace mori_echo::test
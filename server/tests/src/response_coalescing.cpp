@@ -0,0 +1,190 @@
+#include <boost/asio/co_spawn.hpp>
+#include <boost/asio/io_context.hpp>
+#include <boost/asio/ip/tcp.hpp>
+#include <boost/test/unit_test.hpp>
+#include <spdlog/spdlog.h>
+
+#include "client_authenticator/allow_all_client_authenticator.hpp"
+#include "client_channel/client_channel.hpp"
+#include "client_channel/response_batch.hpp"
+#include "echo_server/echo_server.hpp"
+#include "message_receiver/test_message_receiver.hpp"
+#include "message_sender/test_message_sender.hpp"
+#include "message_types/echo_response.hpp"
+#include "test_session/test_session.hpp"
+
+namespace mori_echo::test {
+
+inline constexpr auto pipelined_echo_count = std::size_t{32};
+
+// Alternately copied into a batch and gathered from their own buffers.
+[[nodiscard]] auto make_pipelined_payloads()
+    -> std::vector<std::vector<std::byte>> {
+  auto payloads = std::vector<std::vector<std::byte>>{};
+
+  for (auto i = std::size_t{0}; i < pipelined_echo_count; ++i) {
+    const auto size = i % 2 == 0 ? std::size_t{16} : std::size_t{2000};
+    payloads.emplace_back(size, static_cast<std::byte>(i));
+  }
+
+  return payloads;
+}
+
+// Sends every request with a single write, so that they are all buffered by
+// the time the server reads the first, then reads their echoes in order.
+[[nodiscard]] auto
+check_pipelined_echoes(client_channel& channel,
+                        const std::vector<std::vector<std::byte>>& payloads)
+    -> boost::asio::awaitable<void> {
+  auto requests = std::vector<std::byte>{};
+
+  for (auto i = std::size_t{0}; i < payloads.size(); ++i) {
+    const auto request =
+        encode_echo_request(static_cast<std::uint8_t>(i + 1), payloads[i]);
+    requests.insert(requests.end(), request.begin(), request.end());
+  }
+
+  co_await channel.send(requests);
+
+  for (auto i = std::size_t{0}; i < payloads.size(); ++i) {
+    auto header = co_await receive_response_header(channel);
+
+    BOOST_CHECK(header.sequence == i + 1);
+
+    const auto echo = co_await receive_message<messages::echo_response>(
+        channel, std::move(header));
+
+    BOOST_CHECK(echo.plain_message == payloads[i]);
+  }
+}
+
+// Echoes one request at a time, waiting for each response.
+[[nodiscard]] auto
+check_lone_echoes(client_channel& channel,
+                   const std::vector<std::vector<std::byte>>& payloads)
+    -> boost::asio::awaitable<void> {
+  for (auto i = std::size_t{0}; i < payloads.size(); ++i) {
+    co_await send_message<messages::echo_request>{}(
+        channel, static_cast<std::uint8_t>(i + 1), payloads[i]);
+
+    const auto echo = co_await receive_message<messages::echo_response>(
+        channel, co_await receive_response_header(channel));
+
+    BOOST_CHECK(echo.plain_message == payloads[i]);
+  }
+}
+
+// Runs `check` against a server coalescing with `options`, on one thread.
+template <typename Check>
+auto run_coalescing_client(coalescing_options options, Check check) -> void {
+  auto io_context = boost::asio::io_context{1};
+
+  const auto endpoint = mori_echo::spawn_server(
+      io_context.get_executor(),
+      {
+          .enable_decryption = false,
+          .coalescing = std::move(options),
+          .authenticator =
+              mori_echo::auth::allow_all_client_authenticator::create(),
+      });
+
+  boost::asio::co_spawn(
+      io_context.get_executor(),
+      [&]() -> boost::asio::awaitable<void> {
+        auto socket = boost::asio::ip::tcp::socket{io_context};
+
+        co_await socket.async_connect(
+            {boost::asio::ip::address_v4::loopback(), endpoint.port()},
+            boost::asio::use_awaitable);
+
+        auto channel = client_channel{std::move(socket)};
+
+        co_await log_in(channel);
+        co_await check(channel, make_pipelined_payloads());
+
+        io_context.stop();
+      },
+      [](std::exception_ptr error) {
+        if (error) {
+          std::rethrow_exception(error);
+        }
+      });
+
+  io_context.run();
+}
+
+BOOST_AUTO_TEST_SUITE(response_coalescing)
+
+BOOST_AUTO_TEST_CASE(pipelined_responses_share_sends) {
+  spdlog::set_level(spdlog::level::info);
+
+  const auto counters = coalescing_counters::create();
+
+  // Generous enough a delay for slow builds to still batch everything.
+  run_coalescing_client(
+      {.max_delay = std::chrono::seconds{1}, .counters = counters},
+      check_pipelined_echoes);
+
+  BOOST_CHECK(counters->responses() == pipelined_echo_count);
+  BOOST_CHECK(counters->send_calls() == 1);
+}
+
+BOOST_AUTO_TEST_CASE(lone_requests_sent_at_once) {
+  spdlog::set_level(spdlog::level::info);
+
+  const auto counters = coalescing_counters::create();
+
+  // Were any response held, its client would wait on it for good.
+  run_coalescing_client(
+      {.max_delay = std::chrono::seconds{1}, .counters = counters},
+      check_lone_echoes);
+
+  // Prefix and payload still go out together.
+  BOOST_CHECK(counters->responses() == pipelined_echo_count);
+  BOOST_CHECK(counters->send_calls() == pipelined_echo_count);
+}
+
+BOOST_AUTO_TEST_CASE(byte_limit_bounds_batches) {
+  spdlog::set_level(spdlog::level::info);
+
+  const auto counters = coalescing_counters::create();
+
+  run_coalescing_client({.max_bytes = 4096,
+                         .max_delay = std::chrono::seconds{1},
+                         .counters = counters},
+                        check_pipelined_echoes);
+
+  // Each pair of responses takes about 2KiB.
+  BOOST_CHECK(counters->responses() == pipelined_echo_count);
+  BOOST_CHECK(counters->send_calls() > 1);
+  BOOST_CHECK(counters->send_calls() < pipelined_echo_count);
+}
+
+BOOST_AUTO_TEST_CASE(drained_batches_shrink) {
+  auto batch = response_batch{{}};
+  const auto prefix = std::vector<std::byte>(16, std::byte{'H'});
+
+  // Copied whole, growing the shared buffer well past what is retained.
+  for (auto i = 0; i < 256; ++i) {
+    batch.add(prefix, std::vector<std::byte>(max_copied_payload_size));
+  }
+
+  BOOST_REQUIRE(batch.buffers().size() == 1);
+  BOOST_CHECK(batch.capacity() > retained_batch_capacity);
+
+  batch.clear(1);
+
+  BOOST_CHECK(batch.is_empty());
+  BOOST_CHECK(batch.capacity() <= retained_batch_capacity);
+
+  batch.add(prefix, {});
+  static_cast<void>(batch.buffers());
+  batch.clear(1);
+  batch.release_storage();
+
+  BOOST_CHECK(batch.capacity() == 0);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+} // namespace mori_echo::test
@@ -0,0 +1,149 @@
+#include "test_shm_client.hpp"
+
+#include <algorithm>
+#include <array>
+#include <boost/asio/use_awaitable.hpp>
+#include <cassert>
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include "exceptions/client_error.hpp"
+#include "exceptions/server_error.hpp"
+
+namespace mori_echo {
+
+auto signal(boost::asio::posix::stream_descriptor& eventfd) -> void {
+  const auto value = std::uint64_t{1};
+
+  [[maybe_unused]] const auto written =
+      ::write(eventfd.native_handle(), &value, sizeof(value));
+}
+
+auto clear_signal(boost::asio::posix::stream_descriptor& eventfd) -> void {
+  auto value = std::uint64_t{};
+
+  [[maybe_unused]] const auto read =
+      ::read(eventfd.native_handle(), &value, sizeof(value));
+}
+
+shm_client::shm_client(
+    boost::asio::local::stream_protocol::socket control_socket,
+    shm::unique_fd memory, int request_fd, int response_fd)
+    : control{std::move(control_socket)}, mapping{memory},
+      request_signal{control.get_executor(), request_fd},
+      response_signal{control.get_executor(), response_fd} {}
+
+auto shm_client::connect(boost::asio::any_io_executor executor,
+                         std::string_view control_path)
+    -> boost::asio::awaitable<shm_client> {
+  auto control = boost::asio::local::stream_protocol::socket{executor};
+
+  co_await control.async_connect({std::string{control_path}},
+                                 boost::asio::use_awaitable);
+
+  auto fds = std::array<int, 3>{};
+
+  auto payload = std::byte{};
+  auto payload_data = ::iovec{.iov_base = &payload, .iov_len = sizeof(payload)};
+
+  alignas(::cmsghdr) auto control_data =
+      std::array<char, CMSG_SPACE(sizeof(fds))>{};
+
+  auto message = ::msghdr{};
+  message.msg_iov = &payload_data;
+  message.msg_iovlen = 1;
+  message.msg_control = control_data.data();
+  message.msg_controllen = control_data.size();
+
+  for (;;) {
+    const auto received = ::recvmsg(control.native_handle(), &message,
+                                    MSG_DONTWAIT | MSG_CMSG_CLOEXEC);
+
+    if (received > 0) {
+      break;
+    } else if (received == 0) {
+      throw exceptions::server_error{"The server closed the control socket."};
+    }
+
+    if (errno == EAGAIN || errno == EWOULDBLOCK) {
+      co_await control.async_wait(
+          boost::asio::local::stream_protocol::socket::wait_read,
+          boost::asio::use_awaitable);
+    } else if (errno != EINTR) {
+      throw boost::system::system_error{
+          boost::system::error_code{errno, boost::system::system_category()},
+          "recvmsg"};
+    }
+  }
+
+  const auto* rights = CMSG_FIRSTHDR(&message);
+
+  if (rights == nullptr || rights->cmsg_level != SOL_SOCKET ||
+      rights->cmsg_type != SCM_RIGHTS ||
+      rights->cmsg_len != CMSG_LEN(sizeof(fds))) {
+    throw exceptions::server_error{"Invalid shared memory handshake."};
+  }
+
+  std::memcpy(fds.data(), CMSG_DATA(rights), sizeof(fds));
+
+  co_return shm_client{std::move(control), shm::unique_fd{fds[0]}, fds[1],
+                       fds[2]};
+}
+
+auto shm_client::send(std::span<const std::byte> frame) -> void {
+  assert(frame.size() <= shm::slot_capacity);
+
+  auto& requests = mapping.region().requests;
+
+  auto* slot = requests.back();
+
+  if (slot == nullptr) {
+    throw exceptions::client_error{"Too many requests in flight."};
+  }
+
+  std::copy(frame.begin(), frame.end(), slot->data.begin());
+  slot->size = static_cast<std::uint32_t>(frame.size());
+
+  if (requests.push()) {
+    signal(request_signal);
+  }
+}
+
+auto shm_client::receive(std::size_t spin_count)
+    -> boost::asio::awaitable<std::vector<std::byte>> {
+  auto& region = mapping.region();
+
+  for (auto polls = std::size_t{0};; ++polls) {
+    // Read first: the server publishes its last responses before closing.
+    const auto is_closed = region.is_closed.load() != 0;
+
+    if (auto* slot = region.responses.front(); slot != nullptr) {
+      auto frame = std::vector<std::byte>(
+          slot->data.begin(),
+          slot->data.begin() + std::min(std::size_t{slot->size},
+                                        shm::slot_capacity));
+
+      region.responses.pop();
+
+      co_return frame;
+    }
+
+    if (is_closed) {
+      throw exceptions::server_error{"The server closed the session."};
+    }
+
+    if (polls >= spin_count) {
+      co_await response_signal.async_wait(
+          boost::asio::posix::stream_descriptor::wait_read,
+          boost::asio::use_awaitable);
+
+      clear_signal(response_signal);
+    }
+  }
+}
+
+} // namespace mori_echo
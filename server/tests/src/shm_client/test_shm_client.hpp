@@ -0,0 +1,45 @@
+#pragma once
+
+#include <boost/asio/any_io_executor.hpp>
+#include <boost/asio/awaitable.hpp>
+#include <boost/asio/local/stream_protocol.hpp>
+#include <boost/asio/posix/stream_descriptor.hpp>
+#include <cstddef>
+#include <span>
+#include <string_view>
+#include <vector>
+
+#include "shm_listener/shm_ring.hpp"
+
+namespace mori_echo {
+
+// Same-host client of the shared-memory transport. Frames are the same as on
+// TCP, one per ring slot.
+class [[nodiscard]] shm_client {
+public:
+  [[nodiscard]] static auto connect(boost::asio::any_io_executor executor,
+                                    std::string_view control_path)
+      -> boost::asio::awaitable<shm_client>;
+
+  // Publishes a frame to the request ring. At most `shm::ring_slots` requests
+  // may wait for their response.
+  auto send(std::span<const std::byte> frame) -> void;
+
+  // Waits for the next response frame, polling the ring `spin_count` times
+  // before sleeping on its eventfd.
+  [[nodiscard]] auto receive(std::size_t spin_count = 0)
+      -> boost::asio::awaitable<std::vector<std::byte>>;
+
+private:
+  shm_client(boost::asio::local::stream_protocol::socket control_socket,
+             shm::unique_fd memory, int request_fd, int response_fd);
+
+  boost::asio::local::stream_protocol::socket control;
+
+  shm::shm_mapping mapping;
+
+  boost::asio::posix::stream_descriptor request_signal;
+  boost::asio::posix::stream_descriptor response_signal;
+};
+
+} // namespace mori_echo
@@ -0,0 +1,166 @@
+#include <boost/asio/co_spawn.hpp>
+#include <boost/asio/io_context.hpp>
+#include <boost/test/framework.hpp>
+#include <boost/test/unit_test.hpp>
+#include <spdlog/spdlog.h>
+
+#include "client_authenticator/allow_all_client_authenticator.hpp"
+#include "client_authenticator/test_client_authenticator.hpp"
+#include "client_crypto/test_client_crypto.hpp"
+#include "echo_server/echo_server.hpp"
+#include "exceptions/server_error.hpp"
+#include "message_receiver/test_message_receiver.hpp"
+#include "message_sender/test_message_sender.hpp"
+#include "message_types/echo_response.hpp"
+#include "message_types/login_response.hpp"
+#include "mori_status/login_status.hpp"
+#include "shm_client/test_shm_client.hpp"
+#include "test_endpoints/test_endpoints.hpp"
+
+namespace mori_echo::test {
+
+[[nodiscard]] auto test_control_path() -> std::string {
+  return unique_temp_path("test_shm.sock");
+}
+
+BOOST_AUTO_TEST_SUITE(shm_listener)
+
+BOOST_AUTO_TEST_CASE(login_and_echo_success) {
+  spdlog::set_level(spdlog::level::debug);
+
+  auto io_context = boost::asio::io_context{1};
+
+  mori_echo::spawn_server(
+      io_context.get_executor(),
+      {
+          .shm_control_path = test_control_path(),
+          .enable_decryption = true,
+          .authenticator =
+              mori_echo::auth::allow_all_client_authenticator::create(),
+      });
+
+  boost::asio::co_spawn(
+      io_context.get_executor(),
+      [&]() -> boost::asio::awaitable<void> {
+        const auto username = std::string{"testuser"};
+        const auto password = std::string{"testpass"};
+
+        auto client = co_await shm_client::connect(io_context.get_executor(),
+                                                   test_control_path());
+
+        constexpr auto login_request_sequence = 0;
+        client.send(
+            encode_login_request(login_request_sequence, username, password));
+
+        auto login_reply = co_await client.receive();
+        auto login_data = std::span{login_reply};
+
+        const auto login_response_header = decode_header(login_data);
+        BOOST_CHECK(login_response_header.type ==
+                    messages::message_type::LOGIN_RESPONSE);
+        BOOST_CHECK(login_response_header.sequence == login_request_sequence);
+
+        const auto login_response = decode_message<messages::login_response>(
+            login_data, login_response_header);
+        BOOST_CHECK(login_response.status_code ==
+                    mori_status::login_status::OK);
+
+        const auto echo_message = std::string{"This is a MoriEcho unit test."};
+
+        auto echo_message_data = std::vector<std::byte>{echo_message.size()};
+
+        std::transform(echo_message.begin(), echo_message.end(),
+                       echo_message_data.begin(),
+                       [](char each) { return static_cast<std::byte>(each); });
+
+        // More than a ring's worth, so that the slots wrap around.
+        for (auto i = std::uint8_t{1}; i <= 2 * shm::ring_slots; ++i) {
+          const auto echo_request_sequence = i;
+
+          const auto echo_message_encrypted = crypto::encrypt(
+              {
+                  .username_sum = crypto::calculate_checksum(username),
+                  .password_sum = crypto::calculate_checksum(password),
+                  .sequence = echo_request_sequence,
+              },
+              echo_message_data);
+
+          client.send(encode_echo_request(echo_request_sequence,
+                                          echo_message_encrypted));
+
+          auto echo_reply = co_await client.receive();
+          auto echo_data = std::span{echo_reply};
+
+          const auto echo_response_header = decode_header(echo_data);
+          BOOST_CHECK(echo_response_header.type ==
+                      messages::message_type::ECHO_RESPONSE);
+          BOOST_CHECK(echo_response_header.sequence == echo_request_sequence);
+
+          const auto echo_response = decode_message<messages::echo_response>(
+              echo_data, echo_response_header);
+          BOOST_CHECK(echo_response.plain_message == echo_message_data);
+        }
+
+        io_context.stop();
+      },
+      [](std::exception_ptr error) {
+        if (error) {
+          std::rethrow_exception(error);
+        }
+      });
+
+  io_context.run();
+}
+
+BOOST_AUTO_TEST_CASE(login_failure) {
+  spdlog::set_level(spdlog::level::debug);
+
+  auto io_context = boost::asio::io_context{1};
+
+  mori_echo::spawn_server(
+      io_context.get_executor(),
+      {
+          .shm_control_path = test_control_path(),
+          .authenticator = mori_echo::auth::test_client_authenticator::create(),
+      });
+
+  boost::asio::co_spawn(
+      io_context.get_executor(),
+      [&]() -> boost::asio::awaitable<void> {
+        auto client = co_await shm_client::connect(io_context.get_executor(),
+                                                   test_control_path());
+
+        constexpr auto login_request_sequence = 7;
+        client.send(encode_login_request(login_request_sequence, "testuser",
+                                         "wrong_password"));
+
+        auto login_reply = co_await client.receive();
+        auto login_data = std::span{login_reply};
+
+        const auto login_response_header = decode_header(login_data);
+        BOOST_CHECK(login_response_header.type ==
+                    messages::message_type::LOGIN_RESPONSE);
+        BOOST_CHECK(login_response_header.sequence == login_request_sequence);
+
+        const auto login_response = decode_message<messages::login_response>(
+            login_data, login_response_header);
+        BOOST_CHECK(login_response.status_code ==
+                    mori_status::login_status::FAILED);
+
+        // The server ends the session after a failed login.
+        BOOST_CHECK_THROW(co_await client.receive(), exceptions::server_error);
+
+        io_context.stop();
+      },
+      [](std::exception_ptr error) {
+        if (error) {
+          std::rethrow_exception(error);
+        }
+      });
+
+  io_context.run();
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+} // namespace mori_echo::test
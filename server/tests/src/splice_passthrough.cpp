@@ -0,0 +1,199 @@
+#include <boost/asio/co_spawn.hpp>
+#include <boost/asio/detached.hpp>
+#include <boost/asio/io_context.hpp>
+#include <boost/asio/ip/tcp.hpp>
+#include <boost/asio/local/stream_protocol.hpp>
+#include <boost/test/unit_test.hpp>
+#include <spdlog/spdlog.h>
+
+#include "client_authenticator/allow_all_client_authenticator.hpp"
+#include "client_channel/client_channel.hpp"
+#include "echo_server/echo_server.hpp"
+#include "message_receiver/test_message_receiver.hpp"
+#include "message_sender/test_message_sender.hpp"
+#include "message_types/echo_request.hpp"
+#include "message_types/echo_response.hpp"
+#include "test_endpoints/test_endpoints.hpp"
+#include "test_session/test_session.hpp"
+
+namespace mori_echo::test {
+
+[[nodiscard]] auto splice_socket_path() -> std::string {
+  return unique_temp_path("test_splice.sock");
+}
+
+// Sends every payload back to back while reading their echoes, so that later
+// requests sit unread in the socket while earlier ones are spliced.
+template <typename AsyncStream>
+[[nodiscard]] auto check_echoes(basic_client_channel<AsyncStream>& channel,
+                                std::vector<std::vector<std::byte>> payloads)
+    -> boost::asio::awaitable<void> {
+  boost::asio::co_spawn(co_await boost::asio::this_coro::executor,
+                        send_payloads(channel, payloads),
+                        boost::asio::detached);
+
+  for (auto i = std::size_t{0}; i < payloads.size(); ++i) {
+    auto header = co_await receive_response_header(channel);
+
+    BOOST_CHECK(header.type == messages::message_type::ECHO_RESPONSE);
+    BOOST_CHECK(header.sequence == i + 1);
+
+    const auto echo = co_await receive_message<messages::echo_response>(
+        channel, std::move(header));
+
+    BOOST_CHECK(echo.plain_message == payloads[i]);
+  }
+}
+
+[[nodiscard]] auto mixed_payloads() -> std::vector<std::vector<std::byte>> {
+  // Extended and regular frames above the splice threshold, and one below.
+  return {
+      make_payload(1024 * 1024, 1),
+      make_payload(60000, 2),
+      make_payload(100, 3),
+      make_payload(3 * 1024 * 1024 + 7, 4),
+  };
+}
+
+BOOST_AUTO_TEST_SUITE(splice_passthrough)
+
+BOOST_AUTO_TEST_CASE(tcp_echoes_pass_through) {
+  spdlog::set_level(spdlog::level::info);
+
+  auto io_context = boost::asio::io_context{1};
+
+  const auto endpoint = mori_echo::spawn_server(
+      io_context.get_executor(),
+      {
+          .enable_decryption = false,
+          .authenticator =
+              mori_echo::auth::allow_all_client_authenticator::create(),
+      });
+
+  boost::asio::co_spawn(
+      io_context.get_executor(),
+      [&]() -> boost::asio::awaitable<void> {
+        auto socket = boost::asio::ip::tcp::socket{io_context};
+
+        co_await socket.async_connect(
+            {boost::asio::ip::address_v4::loopback(), endpoint.port()},
+            boost::asio::use_awaitable);
+
+        auto channel = client_channel{std::move(socket)};
+
+        co_await log_in(channel);
+        co_await check_echoes(channel, mixed_payloads());
+
+        // Pipes are reused from one echo to the next.
+        co_await check_echoes(channel, mixed_payloads());
+
+        io_context.stop();
+      },
+      [](std::exception_ptr error) {
+        if (error) {
+          std::rethrow_exception(error);
+        }
+      });
+
+  io_context.run();
+}
+
+BOOST_AUTO_TEST_CASE(local_echoes_pass_through) {
+  spdlog::set_level(spdlog::level::info);
+
+  auto io_context = boost::asio::io_context{1};
+
+  mori_echo::spawn_server(
+      io_context.get_executor(),
+      {
+          .local_socket_path = splice_socket_path(),
+          .enable_decryption = false,
+          .authenticator =
+              mori_echo::auth::allow_all_client_authenticator::create(),
+      });
+
+  boost::asio::co_spawn(
+      io_context.get_executor(),
+      [&]() -> boost::asio::awaitable<void> {
+        auto socket = boost::asio::local::stream_protocol::socket{io_context};
+
+        co_await socket.async_connect({splice_socket_path()},
+                                      boost::asio::use_awaitable);
+
+        auto channel = local_client_channel{std::move(socket)};
+
+        co_await log_in(channel);
+        co_await check_echoes(channel, mixed_payloads());
+
+        io_context.stop();
+      },
+      [](std::exception_ptr error) {
+        if (error) {
+          std::rethrow_exception(error);
+        }
+      });
+
+  io_context.run();
+}
+
+BOOST_AUTO_TEST_CASE(oversized_frames_still_rejected) {
+  spdlog::set_level(spdlog::level::info);
+
+  auto io_context = boost::asio::io_context{1};
+
+  const auto drops = drop_counters::create();
+
+  const auto endpoint = mori_echo::spawn_server(
+      io_context.get_executor(),
+      {
+          .enable_decryption = false,
+          .max_message_size = 100000,
+          .authenticator =
+              mori_echo::auth::allow_all_client_authenticator::create(),
+          .drops = drops,
+      });
+
+  boost::asio::co_spawn(
+      io_context.get_executor(),
+      [&]() -> boost::asio::awaitable<void> {
+        auto socket = boost::asio::ip::tcp::socket{io_context};
+
+        co_await socket.async_connect(
+            {boost::asio::ip::address_v4::loopback(), endpoint.port()},
+            boost::asio::use_awaitable);
+
+        auto channel = client_channel{std::move(socket)};
+
+        co_await log_in(channel);
+
+        auto error = boost::system::error_code{};
+
+        try {
+          co_await send_message<messages::echo_request>{}(
+              channel, 1, make_payload(200000, 1));
+
+          co_await receive_response_header(channel);
+        } catch (const boost::system::system_error& dropped) {
+          error = dropped.code();
+        }
+
+        BOOST_CHECK(error == boost::asio::error::eof ||
+                    error == boost::asio::error::connection_reset ||
+                    error == boost::asio::error::broken_pipe);
+
+        io_context.stop();
+      },
+      [](std::exception_ptr error) {
+        if (error) {
+          std::rethrow_exception(error);
+        }
+      });
+
+  io_context.run();
+
+  BOOST_CHECK(drops->count(drop_reason::MESSAGE_TOO_LONG) == 1);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+} // namespace mori_echo::test
@@ -0,0 +1,57 @@
+#include "test_endpoints.hpp"
+
+#include <boost/asio/io_context.hpp>
+#include <boost/asio/ip/udp.hpp>
+#include <filesystem>
+#include <mutex>
+#include <set>
+#include <unistd.h>
+
+namespace mori_echo {
+
+// Paths handed out by `unique_temp_path`, removed on exit.
+class temp_paths {
+public:
+  temp_paths() = default;
+
+  temp_paths(const temp_paths&) = delete;
+  temp_paths& operator=(const temp_paths&) = delete;
+
+  ~temp_paths() {
+    for (const auto& path : paths) {
+      auto error = std::error_code{};
+      std::filesystem::remove_all(path, error);
+    }
+  }
+
+  auto add(const std::filesystem::path& path) -> void {
+    const auto lock = std::scoped_lock{mutex};
+    paths.insert(path);
+  }
+
+private:
+  std::mutex mutex;
+  std::set<std::filesystem::path> paths;
+};
+
+auto free_udp_port() -> std::uint16_t {
+  auto io_context = boost::asio::io_context{1};
+  const auto socket = boost::asio::ip::udp::socket{
+      io_context, {boost::asio::ip::address_v4::loopback(), 0}};
+
+  return socket.local_endpoint().port();
+}
+
+auto unique_temp_path(std::string_view name) -> std::string {
+  auto file_name = "mori_echo_" + std::to_string(::getpid()) + '_';
+  file_name += name;
+
+  const auto path = std::filesystem::temp_directory_path() / file_name;
+
+  static auto created = temp_paths{};
+  created.add(path);
+
+  return path.string();
+}
+
+} // namespace mori_echo
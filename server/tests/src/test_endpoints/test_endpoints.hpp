@@ -0,0 +1,18 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+namespace mori_echo {
+
+// A UDP port the system just handed out, which it does not hand out again
+// right away, for a server which does not report the one it is given.
+[[nodiscard]] auto free_udp_port() -> std::uint16_t;
+
+// A path named after `name` in the temporary directory, which no other
+// process running tests or benchmarks at the same time uses, for socket and
+// dump files. Whatever is left there is removed when the process exits.
+[[nodiscard]] auto unique_temp_path(std::string_view name) -> std::string;
+
+} // namespace mori_echo
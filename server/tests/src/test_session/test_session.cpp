@@ -0,0 +1,68 @@
+#include "test_session.hpp"
+
+#include <boost/test/unit_test.hpp>
+
+#include "message_receiver/test_message_receiver.hpp"
+#include "message_sender/test_message_sender.hpp"
+#include "message_types/echo_request.hpp"
+#include "message_types/login_request.hpp"
+#include "message_types/login_response.hpp"
+#include "mori_status/login_status.hpp"
+
+namespace mori_echo {
+
+auto make_payload(std::size_t size, std::uint8_t seed)
+    -> std::vector<std::byte> {
+  auto payload = std::vector<std::byte>(size);
+
+  for (auto i = std::size_t{0}; i < payload.size(); ++i) {
+    payload[i] = static_cast<std::byte>((i * 31 + seed) % 251);
+  }
+
+  return payload;
+}
+
+template <typename AsyncStream>
+auto log_in(basic_client_channel<AsyncStream>& channel)
+    -> boost::asio::awaitable<void> {
+  co_await send_message<messages::login_request>{}(channel, 0, "testuser",
+                                                   "testpass");
+
+  const auto login_response =
+      co_await receive_message<messages::login_response>(
+          channel, co_await receive_response_header(channel));
+
+  BOOST_REQUIRE(login_response.status_code == mori_status::login_status::OK);
+}
+
+template <typename AsyncStream>
+auto send_payloads(basic_client_channel<AsyncStream>& channel,
+                   std::vector<std::vector<std::byte>> payloads)
+    -> boost::asio::awaitable<void> {
+  for (auto i = std::size_t{0}; i < payloads.size(); ++i) {
+    co_await send_message<messages::echo_request>{}(
+        channel, static_cast<std::uint8_t>(i + 1), payloads[i]);
+  }
+}
+
+template auto log_in(client_channel& channel) -> boost::asio::awaitable<void>;
+
+template auto log_in(local_client_channel& channel)
+    -> boost::asio::awaitable<void>;
+
+template auto log_in(memory_client_channel& channel)
+    -> boost::asio::awaitable<void>;
+
+template auto send_payloads(client_channel& channel,
+                            std::vector<std::vector<std::byte>> payloads)
+    -> boost::asio::awaitable<void>;
+
+template auto send_payloads(local_client_channel& channel,
+                            std::vector<std::vector<std::byte>> payloads)
+    -> boost::asio::awaitable<void>;
+
+template auto send_payloads(memory_client_channel& channel,
+                            std::vector<std::vector<std::byte>> payloads)
+    -> boost::asio::awaitable<void>;
+
+} // namespace mori_echo
@@ -0,0 +1,28 @@
+#pragma once
+
+#include <boost/asio/awaitable.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "client_channel/client_channel.hpp"
+
+namespace mori_echo {
+
+// A payload of `size` bytes whose pattern differs with `seed`, so that echoes
+// of different payloads cannot be mistaken for each other.
+[[nodiscard]] auto make_payload(std::size_t size, std::uint8_t seed)
+    -> std::vector<std::byte>;
+
+// Logs in as the test user, which the server must accept.
+template <typename AsyncStream>
+[[nodiscard]] auto log_in(basic_client_channel<AsyncStream>& channel)
+    -> boost::asio::awaitable<void>;
+
+// Sends an echo request for each of `payloads`, numbered from 1.
+template <typename AsyncStream>
+[[nodiscard]] auto send_payloads(basic_client_channel<AsyncStream>& channel,
+                                 std::vector<std::vector<std::byte>> payloads)
+    -> boost::asio::awaitable<void>;
+
+} // namespace mori_echo
@@ -0,0 +1,258 @@
+#include <boost/asio/co_spawn.hpp>
+#include <boost/asio/io_context.hpp>
+#include <boost/asio/ip/tcp.hpp>
+#include <boost/test/unit_test.hpp>
+#include <filesystem>
+#include <fstream>
+#include <optional>
+#include <sched.h>
+#include <spdlog/spdlog.h>
+#include <string>
+#include <thread>
+
+#include "client_authenticator/allow_all_client_authenticator.hpp"
+#include "client_channel/client_channel.hpp"
+#include "client_crypto/test_client_crypto.hpp"
+#include "echo_client/blocking_echo_client.hpp"
+#include "echo_server/echo_server.hpp"
+#include "exceptions/server_error.hpp"
+#include "message_receiver/test_message_receiver.hpp"
+#include "message_sender/test_message_sender.hpp"
+#include "message_types/echo_request.hpp"
+#include "message_types/echo_response.hpp"
+#include "message_types/login_request.hpp"
+#include "message_types/login_response.hpp"
+#include "mori_status/login_status.hpp"
+#include "test_endpoints/test_endpoints.hpp"
+#include "worker_pool/server_topology.hpp"
+#include "worker_pool/worker_pool.hpp"
+
+namespace mori_echo::test {
+
+// A sysfs tree of two NUMA nodes with four CPUs each.
+[[nodiscard]] auto make_fake_sysfs() -> std::filesystem::path {
+  const auto root =
+      std::filesystem::path{unique_temp_path("test_sysfs")};
+
+  std::filesystem::remove_all(root);
+
+  const auto write = [&](const std::filesystem::path& path,
+                         std::string_view content) {
+    std::filesystem::create_directories((root / path).parent_path());
+    std::ofstream{root / path} << content << '\n';
+  };
+
+  write("devices/system/cpu/online", "0-7");
+  write("devices/system/node/node0/cpulist", "0-3");
+  write("devices/system/node/node1/cpulist", "4-7");
+  write("devices/system/node/online", "0-1");
+
+  return root;
+}
+
+BOOST_AUTO_TEST_SUITE(thread_placement)
+
+BOOST_AUTO_TEST_CASE(cpu_list_parsing) {
+  BOOST_CHECK(parse_cpu_list("0-3,8, 10-11") ==
+              (std::vector<unsigned>{0, 1, 2, 3, 8, 10, 11}));
+  BOOST_CHECK(parse_cpu_list("") == std::vector<unsigned>{});
+  BOOST_CHECK(parse_cpu_list("3,1,1") == (std::vector<unsigned>{1, 3}));
+
+  BOOST_CHECK_THROW(static_cast<void>(parse_cpu_list("3-1")),
+                    exceptions::server_error);
+  BOOST_CHECK_THROW(static_cast<void>(parse_cpu_list("a")),
+                    exceptions::server_error);
+
+  // Rejected before a single CPU of the range is listed.
+  BOOST_CHECK_THROW(static_cast<void>(parse_cpu_list("0-4000000000")),
+                    exceptions::server_error);
+  BOOST_CHECK_THROW(static_cast<void>(parse_cpu_list("0-4294967295")),
+                    exceptions::server_error);
+  BOOST_CHECK_THROW(
+      static_cast<void>(parse_cpu_list(std::to_string(CPU_SETSIZE))),
+      exceptions::server_error);
+  BOOST_CHECK(parse_cpu_list(std::to_string(CPU_SETSIZE - 1)) ==
+              std::vector<unsigned>{CPU_SETSIZE - 1});
+}
+
+BOOST_AUTO_TEST_CASE(layout_parsing) {
+  const auto sysfs = make_fake_sysfs();
+
+  const auto topology = server_topology::parse("acceptor=0; 1-3; 4; 3-4", sysfs);
+
+  BOOST_CHECK(topology.acceptor.cpus == std::vector<unsigned>{0});
+  BOOST_CHECK(topology.acceptor.numa_node == 0u);
+
+  BOOST_REQUIRE(topology.workers.size() == 3);
+  BOOST_CHECK(topology.workers[0].numa_node == 0u);
+  BOOST_CHECK(topology.workers[1].numa_node == 1u);
+
+  // Spans both nodes.
+  BOOST_CHECK(!topology.workers[2].numa_node.has_value());
+
+  BOOST_CHECK_THROW(
+      static_cast<void>(server_topology::parse("acceptor=0", sysfs)),
+      exceptions::server_error);
+}
+
+BOOST_AUTO_TEST_CASE(layout_detection) {
+  const auto sysfs = make_fake_sysfs();
+
+  const auto topology = server_topology::detect(1, sysfs);
+
+  BOOST_CHECK(topology.acceptor.cpus == std::vector<unsigned>{0});
+
+  BOOST_REQUIRE(topology.workers.size() == 7);
+  BOOST_CHECK(topology.workers.front().cpus == std::vector<unsigned>{1});
+  BOOST_CHECK(topology.workers.front().numa_node == 0u);
+  BOOST_CHECK(topology.workers.back().cpus == std::vector<unsigned>{7});
+  BOOST_CHECK(topology.workers.back().numa_node == 1u);
+
+  // Without NUMA nodes in sysfs, and every core but one reserved.
+  std::filesystem::remove_all(sysfs / "devices/system/node");
+
+  const auto flat = server_topology::detect(100, sysfs);
+
+  BOOST_CHECK(flat.acceptor.cpus.size() == 7);
+  BOOST_REQUIRE(flat.workers.size() == 1);
+  BOOST_CHECK(!flat.workers.front().numa_node.has_value());
+}
+
+BOOST_AUTO_TEST_CASE(clients_served_by_workers) {
+  spdlog::set_level(spdlog::level::debug);
+
+  constexpr auto client_count = 4;
+
+  // Two workers sharing the first online CPU, which always exists.
+  const auto first_cpu = server_topology::detect().workers.front().cpus;
+
+  auto topology = server_topology{};
+  topology.workers.push_back({.cpus = first_cpu});
+  topology.workers.push_back({.cpus = first_cpu});
+
+  const auto workers = worker_pool::create(topology);
+
+  BOOST_CHECK(workers->size() == 2);
+
+  auto io_context = boost::asio::io_context{1};
+
+  const auto endpoint = mori_echo::spawn_server(
+      io_context.get_executor(),
+      {
+          .enable_decryption = true,
+          .authenticator =
+              mori_echo::auth::allow_all_client_authenticator::create(),
+          .workers = workers,
+      });
+
+  auto finished_clients = 0;
+
+  for (auto client = 0; client < client_count; ++client) {
+    boost::asio::co_spawn(
+        io_context.get_executor(),
+        [&]() -> boost::asio::awaitable<void> {
+          const auto username = std::string{"testuser"};
+          const auto password = std::string{"testpass"};
+
+          auto socket = boost::asio::ip::tcp::socket{io_context};
+
+          co_await socket.async_connect(
+              {boost::asio::ip::address_v4::loopback(), endpoint.port()},
+              boost::asio::use_awaitable);
+
+          auto channel = client_channel{std::move(socket)};
+
+          co_await send_message<messages::login_request>{}(channel, 0,
+                                                           username, password);
+
+          const auto login_response =
+              co_await receive_message<messages::login_response>(
+                  channel, co_await receive_response_header(channel));
+
+          BOOST_CHECK(login_response.status_code ==
+                      mori_status::login_status::OK);
+
+          const auto echo_message = std::vector<std::byte>(32, std::byte{'W'});
+
+          co_await send_message<messages::echo_request>{}(
+              channel, 1,
+              crypto::encrypt(
+                  {
+                      .username_sum = crypto::calculate_checksum(username),
+                      .password_sum = crypto::calculate_checksum(password),
+                      .sequence = 1,
+                  },
+                  echo_message));
+
+          const auto echo_response =
+              co_await receive_message<messages::echo_response>(
+                  channel, co_await receive_response_header(channel));
+
+          BOOST_CHECK(echo_response.plain_message == echo_message);
+
+          if (++finished_clients == client_count) {
+            io_context.stop();
+          }
+        },
+        [](std::exception_ptr error) {
+          if (error) {
+            std::rethrow_exception(error);
+          }
+        });
+  }
+
+  io_context.run();
+
+  workers->stop();
+
+  BOOST_CHECK(finished_clients == client_count);
+}
+
+// Sessions on the workers keep being served once their listener is gone,
+// along with the loop it ran on.
+BOOST_AUTO_TEST_CASE(sessions_outlive_their_listener) {
+  spdlog::set_level(spdlog::level::info);
+
+  const auto first_cpu = server_topology::detect().workers.front().cpus;
+
+  auto topology = server_topology{};
+  topology.workers.push_back({.cpus = first_cpu});
+
+  const auto workers = worker_pool::create(topology);
+
+  auto io_context = std::optional<boost::asio::io_context>{std::in_place, 1};
+
+  const auto endpoint = mori_echo::spawn_server(
+      io_context->get_executor(),
+      {
+          .port = 0,
+          .enable_decryption = false,
+          .authenticator =
+              mori_echo::auth::allow_all_client_authenticator::create(),
+          .workers = workers,
+      });
+
+  auto server_thread = std::thread{[&] { io_context->run(); }};
+
+  {
+    auto client = client::blocking_echo_client{
+        {boost::asio::ip::address_v4::loopback(), endpoint.port()},
+        {.username = "testuser", .password = "testpass"},
+        {.connections = 1, .connection = {.encrypt = false}}};
+
+    const auto payload = std::vector<std::byte>(64, std::byte{'L'});
+    BOOST_CHECK(client.echo(payload) == payload);
+
+    io_context->stop();
+    server_thread.join();
+    io_context.reset();
+
+    BOOST_CHECK(client.echo(payload) == payload);
+  }
+
+  workers->stop();
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+} // namespace mori_echo::test
@@ -0,0 +1,244 @@
+#include <algorithm>
+#include <array>
+#include <arpa/inet.h>
+#include <boost/asio/io_context.hpp>
+#include <boost/test/unit_test.hpp>
+#include <netinet/in.h>
+#include <spdlog/spdlog.h>
+#include <sys/socket.h>
+#include <thread>
+#include <unistd.h>
+#include <unordered_map>
+#include <vector>
+
+#include "client_authenticator/allow_all_client_authenticator.hpp"
+#include "echo_server/echo_server.hpp"
+#include "message_sender/test_message_sender.hpp"
+#include "test_endpoints/test_endpoints.hpp"
+#include "traffic_capture/traffic_capture.hpp"
+#include "traffic_capture/traffic_replay.hpp"
+
+namespace mori_echo::test {
+
+[[nodiscard]] auto test_capture_path() -> std::string {
+  return unique_temp_path("test.capture");
+}
+
+[[nodiscard]] auto test_record_data(std::size_t index)
+    -> std::vector<std::byte> {
+  return std::vector<std::byte>(index * 37 % 300 + 1,
+                                static_cast<std::byte>(index));
+}
+
+// Sends `requests` over a blocking TCP connection to `port`, then reads until
+// the server closes it. Returns the number of bytes received.
+[[nodiscard]] auto exchange_with_server(std::uint16_t port,
+                                        const std::vector<std::byte>& requests)
+    -> std::size_t {
+  const auto client = ::socket(AF_INET, SOCK_STREAM, 0);
+  BOOST_REQUIRE(client >= 0);
+
+  auto address = sockaddr_in{};
+  address.sin_family = AF_INET;
+  address.sin_port = htons(port);
+  address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+
+  BOOST_REQUIRE(::connect(client, reinterpret_cast<sockaddr*>(&address),
+                          sizeof(address)) == 0);
+
+  BOOST_REQUIRE(::write(client, requests.data(), requests.size()) ==
+                static_cast<ssize_t>(requests.size()));
+
+  ::shutdown(client, SHUT_WR);
+
+  auto received = std::size_t{};
+  auto buffer = std::array<std::byte, 4096>{};
+
+  for (;;) {
+    const auto count = ::read(client, buffer.data(), buffer.size());
+    BOOST_REQUIRE(count >= 0);
+
+    if (count == 0) {
+      break;
+    }
+
+    received += static_cast<std::size_t>(count);
+  }
+
+  ::close(client);
+
+  return received;
+}
+
+// Runs a server for the duration of `run`, given the port it listens on.
+// Destroying the server context ends the sessions it still holds, and records
+// their end in the capture.
+template <typename Function>
+auto with_server(std::shared_ptr<capture::traffic_capture> capture,
+                 Function run) -> void {
+  auto server_context = boost::asio::io_context{1};
+
+  const auto endpoint = mori_echo::spawn_server(
+      server_context.get_executor(),
+      {
+          .authenticator =
+              mori_echo::auth::allow_all_client_authenticator::create(),
+          .capture = std::move(capture),
+      });
+
+  server_context.poll();
+
+  auto server_work = boost::asio::make_work_guard(server_context);
+  auto server_thread = std::thread{[&] { server_context.run(); }};
+
+  run(endpoint.port());
+
+  server_context.stop();
+  server_thread.join();
+}
+
+BOOST_AUTO_TEST_SUITE(traffic_capture)
+
+BOOST_AUTO_TEST_CASE(ring_keeps_newest_records) {
+  constexpr auto record_count = std::size_t{200};
+  constexpr auto snap_length = std::size_t{256};
+
+  {
+    auto capture = capture::traffic_capture::create(test_capture_path(), 4096,
+                                                    snap_length);
+
+    auto session = capture->open_session();
+
+    for (auto i = std::size_t{0}; i < record_count; ++i) {
+      session.record(test_record_data(i));
+    }
+  }
+
+  const auto log = capture::read_capture(test_capture_path());
+
+  BOOST_REQUIRE(log.records.size() > 2);
+  BOOST_CHECK(log.records.back().kind == capture::record_kind::CLOSE);
+
+  // Whatever the ring kept is the newest data, in order and intact.
+  const auto kept = log.records.size() - 1;
+
+  for (auto i = std::size_t{0}; i < kept; ++i) {
+    const auto& record = log.records[i];
+    const auto expected = test_record_data(record_count - kept + i);
+
+    BOOST_REQUIRE(record.kind == capture::record_kind::DATA);
+    BOOST_CHECK(record.original_size == expected.size());
+    BOOST_CHECK(record.data.size() ==
+                std::min(expected.size(), snap_length));
+    BOOST_CHECK(std::equal(record.data.begin(), record.data.end(),
+                           expected.begin()));
+  }
+}
+
+BOOST_AUTO_TEST_CASE(threads_record_to_rings_of_their_own) {
+  constexpr auto thread_count = std::size_t{4};
+  constexpr auto record_count = std::size_t{100};
+
+  {
+    // One ring left over, shared by the threads without one.
+    auto capture = capture::traffic_capture::create(
+        test_capture_path(), (thread_count + 1) * 64 * 1024, 512,
+        thread_count);
+
+    auto threads = std::vector<std::thread>{};
+
+    for (auto i = std::size_t{0}; i < thread_count + 1; ++i) {
+      threads.emplace_back([&] {
+        auto session = capture->open_session();
+
+        for (auto j = std::size_t{0}; j < record_count; ++j) {
+          session.record(test_record_data(j));
+        }
+      });
+    }
+
+    for (auto& thread : threads) {
+      thread.join();
+    }
+  }
+
+  const auto log = capture::read_capture(test_capture_path());
+
+  BOOST_REQUIRE(log.records.size() == (thread_count + 1) * (record_count + 2));
+
+  // Each session's records come back whole and in order, among the others.
+  auto next = std::unordered_map<std::uint32_t, std::size_t>{};
+
+  for (const auto& record : log.records) {
+    auto& index = next[record.session];
+
+    if (index == 0) {
+      BOOST_CHECK(record.kind == capture::record_kind::OPEN);
+    } else if (index == record_count + 1) {
+      BOOST_CHECK(record.kind == capture::record_kind::CLOSE);
+    } else {
+      const auto expected = test_record_data(index - 1);
+
+      BOOST_REQUIRE(record.kind == capture::record_kind::DATA);
+      BOOST_CHECK(std::equal(record.data.begin(), record.data.end(),
+                             expected.begin(), expected.end()));
+    }
+
+    ++index;
+  }
+
+  BOOST_CHECK(next.size() == thread_count + 1);
+}
+
+BOOST_AUTO_TEST_CASE(replays_captured_sessions) {
+  spdlog::set_level(spdlog::level::info);
+
+  auto requests = encode_login_request(0, "testuser", "testpass");
+
+  for (auto sequence = std::uint8_t{1}; sequence <= 3; ++sequence) {
+    const auto echo = encode_echo_request(
+        sequence, std::vector<std::byte>(100 * sequence, std::byte{0x5A}));
+
+    requests.insert(requests.end(), echo.begin(), echo.end());
+  }
+
+  auto originally_received = std::size_t{};
+
+  with_server(capture::traffic_capture::create(test_capture_path(),
+                                               1024 * 1024),
+              [&](std::uint16_t port) {
+                originally_received = exchange_with_server(port, requests);
+              });
+
+  const auto log = capture::read_capture(test_capture_path());
+
+  BOOST_REQUIRE(log.records.size() > 2);
+  BOOST_CHECK(log.records.front().kind == capture::record_kind::OPEN);
+  BOOST_CHECK(log.records.back().kind == capture::record_kind::CLOSE);
+
+  auto captured = std::vector<std::byte>{};
+
+  for (const auto& record : log.records) {
+    BOOST_CHECK(record.session == log.records.front().session);
+    captured.insert(captured.end(), record.data.begin(), record.data.end());
+  }
+
+  BOOST_CHECK(captured == requests);
+
+  auto stats = capture::replay_stats{};
+
+  with_server(nullptr, [&](std::uint16_t port) {
+    stats = capture::replay(
+        log, {boost::asio::ip::address_v4::loopback(), port},
+        {.speed = 0});
+  });
+
+  BOOST_CHECK(stats.sessions == 1);
+  BOOST_CHECK(stats.failed_sessions == 0);
+  BOOST_CHECK(stats.bytes_sent == requests.size());
+  BOOST_CHECK(stats.bytes_received == originally_received);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+} // namespace mori_echo::test
@@ -0,0 +1,165 @@
+#include <boost/asio/co_spawn.hpp>
+#include <boost/asio/io_context.hpp>
+#include <boost/asio/ip/udp.hpp>
+#include <boost/asio/use_awaitable.hpp>
+#include <boost/test/framework.hpp>
+#include <boost/test/unit_test.hpp>
+#include <spdlog/spdlog.h>
+
+#include "client_authenticator/allow_all_client_authenticator.hpp"
+#include "client_authenticator/test_client_authenticator.hpp"
+#include "client_crypto/test_client_crypto.hpp"
+#include "echo_server/echo_server.hpp"
+#include "message_receiver/test_message_receiver.hpp"
+#include "message_sender/test_message_sender.hpp"
+#include "message_types/echo_response.hpp"
+#include "message_types/login_response.hpp"
+#include "mori_status/login_status.hpp"
+#include "test_endpoints/test_endpoints.hpp"
+
+namespace mori_echo::test {
+
+BOOST_AUTO_TEST_SUITE(udp_listener)
+
+BOOST_AUTO_TEST_CASE(echo_probe_success) {
+  spdlog::set_level(spdlog::level::debug);
+
+  auto io_context = boost::asio::io_context{1};
+  const auto udp_port = free_udp_port();
+
+  mori_echo::spawn_server(
+      io_context.get_executor(),
+      {
+          .udp_port = udp_port,
+          .enable_decryption = true,
+          .authenticator =
+              mori_echo::auth::allow_all_client_authenticator::create(),
+      });
+
+  boost::asio::co_spawn(
+      io_context.get_executor(),
+      [&]() -> boost::asio::awaitable<void> {
+        const auto username = std::string{"testuser"};
+        const auto password = std::string{"testpass"};
+
+        auto socket = boost::asio::ip::udp::socket{
+            io_context, boost::asio::ip::udp::v4()};
+
+        const auto server = boost::asio::ip::udp::endpoint{
+            boost::asio::ip::address_v4::loopback(), udp_port};
+
+        const auto echo_message = std::string{"This is a MoriEcho unit test."};
+
+        auto echo_message_data = std::vector<std::byte>{echo_message.size()};
+
+        std::transform(echo_message.begin(), echo_message.end(),
+                       echo_message_data.begin(),
+                       [](char each) { return static_cast<std::byte>(each); });
+
+        constexpr auto login_request_sequence = 0;
+        constexpr auto echo_request_sequence = 1;
+
+        const auto echo_message_encrypted = crypto::encrypt(
+            {
+                .username_sum = crypto::calculate_checksum(username),
+                .password_sum = crypto::calculate_checksum(password),
+                .sequence = echo_request_sequence,
+            },
+            echo_message_data);
+
+        const auto probe = encode_echo_probe(
+            login_request_sequence, username, password, echo_request_sequence,
+            echo_message_encrypted);
+
+        co_await socket.async_send_to(boost::asio::buffer(probe), server,
+                                      boost::asio::use_awaitable);
+
+        auto reply = std::vector<std::byte>(65536);
+
+        const auto reply_size = co_await socket.async_receive(
+            boost::asio::buffer(reply), boost::asio::use_awaitable);
+
+        auto data = std::span{reply}.first(reply_size);
+
+        const auto echo_response_header = decode_header(data);
+        BOOST_CHECK(echo_response_header.type ==
+                    messages::message_type::ECHO_RESPONSE);
+        BOOST_CHECK(echo_response_header.sequence == echo_request_sequence);
+
+        const auto echo_response =
+            decode_message<messages::echo_response>(data, echo_response_header);
+        BOOST_CHECK(echo_response.plain_message == echo_message_data);
+
+        io_context.stop();
+      },
+      [](std::exception_ptr error) {
+        if (error) {
+          std::rethrow_exception(error);
+        }
+      });
+
+  io_context.run();
+}
+
+BOOST_AUTO_TEST_CASE(echo_probe_login_failure) {
+  spdlog::set_level(spdlog::level::debug);
+
+  auto io_context = boost::asio::io_context{1};
+  const auto udp_port = free_udp_port();
+
+  mori_echo::spawn_server(
+      io_context.get_executor(),
+      {
+          .udp_port = udp_port,
+          .authenticator = mori_echo::auth::test_client_authenticator::create(),
+      });
+
+  boost::asio::co_spawn(
+      io_context.get_executor(),
+      [&]() -> boost::asio::awaitable<void> {
+        auto socket = boost::asio::ip::udp::socket{
+            io_context, boost::asio::ip::udp::v4()};
+
+        const auto server = boost::asio::ip::udp::endpoint{
+            boost::asio::ip::address_v4::loopback(), udp_port};
+
+        constexpr auto login_request_sequence = 7;
+
+        const auto probe =
+            encode_echo_probe(login_request_sequence, "testuser",
+                              "wrong_password", 8, std::vector<std::byte>(16));
+
+        co_await socket.async_send_to(boost::asio::buffer(probe), server,
+                                      boost::asio::use_awaitable);
+
+        auto reply = std::vector<std::byte>(65536);
+
+        const auto reply_size = co_await socket.async_receive(
+            boost::asio::buffer(reply), boost::asio::use_awaitable);
+
+        auto data = std::span{reply}.first(reply_size);
+
+        const auto login_response_header = decode_header(data);
+        BOOST_CHECK(login_response_header.type ==
+                    messages::message_type::LOGIN_RESPONSE);
+        BOOST_CHECK(login_response_header.sequence == login_request_sequence);
+
+        const auto login_response = decode_message<messages::login_response>(
+            data, login_response_header);
+        BOOST_CHECK(login_response.status_code ==
+                    mori_status::login_status::FAILED);
+
+        io_context.stop();
+      },
+      [](std::exception_ptr error) {
+        if (error) {
+          std::rethrow_exception(error);
+        }
+      });
+
+  io_context.run();
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+} // namespace mori_echo::test
@@ -0,0 +1,179 @@
+#include <boost/asio/io_context.hpp>
+#include <boost/asio/ip/tcp.hpp>
+#include <boost/test/unit_test.hpp>
+#include <chrono>
+#include <spdlog/spdlog.h>
+#include <sys/socket.h>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+#include "client_authenticator/test_client_authenticator.hpp"
+#include "client_channel/zerocopy_sender.hpp"
+#include "echo_client/blocking_echo_client.hpp"
+#include "echo_server/echo_server.hpp"
+
+namespace mori_echo::test {
+
+inline constexpr auto large_echo_size = std::size_t{40000};
+inline constexpr auto large_echo_count = std::uint64_t{20};
+
+// Serves with zero-copy sends on a thread of its own until destroyed.
+class zerocopy_server {
+public:
+  explicit zerocopy_server(zerocopy_options options) {
+    const auto bound = mori_echo::spawn_server(
+        context.get_executor(),
+        {
+            .enable_decryption = true,
+            .enable_zerocopy = true,
+            .zerocopy = std::move(options),
+            .authenticator =
+                mori_echo::auth::test_client_authenticator::create(),
+        });
+
+    endpoint = {boost::asio::ip::address_v4::loopback(), bound.port()};
+
+    context.poll();
+
+    thread = std::thread{[this] { context.run(); }};
+  }
+
+  ~zerocopy_server() {
+    context.stop();
+    thread.join();
+  }
+
+  // Where clients reach the server, over loopback.
+  boost::asio::ip::tcp::endpoint endpoint;
+
+private:
+  boost::asio::io_context context{1};
+
+  boost::asio::executor_work_guard<boost::asio::io_context::executor_type>
+      work = boost::asio::make_work_guard(context);
+
+  std::thread thread;
+};
+
+// Echoes large and small payloads one at a time to the server at `endpoint`,
+// then disconnects.
+auto echo_mixed_sizes(const boost::asio::ip::tcp::endpoint& endpoint) -> void {
+  auto client = client::blocking_echo_client{
+      endpoint,
+      {.username = "testuser", .password = "testpass"},
+      {.connections = 1}};
+
+  for (auto i = std::uint64_t{0}; i < large_echo_count; ++i) {
+    const auto large =
+        std::vector<std::byte>(large_echo_size, static_cast<std::byte>(i));
+    BOOST_REQUIRE(client.echo(large) == large);
+
+    const auto small = std::vector<std::byte>(100, static_cast<std::byte>(i));
+    BOOST_REQUIRE(client.echo(small) == small);
+  }
+}
+
+[[nodiscard]] auto total_outcomes(const zerocopy_counters& counters)
+    -> std::uint64_t {
+  return counters.count(zerocopy_outcome::ZERO_COPIED) +
+         counters.count(zerocopy_outcome::KERNEL_COPIED) +
+         counters.count(zerocopy_outcome::SEND_COPIED);
+}
+
+// Outcomes of the last sends are reaped once their session ends.
+auto wait_for_outcomes(const zerocopy_counters& counters, std::uint64_t count)
+    -> void {
+  const auto deadline =
+      std::chrono::steady_clock::now() + std::chrono::seconds{5};
+
+  while (total_outcomes(counters) < count &&
+         std::chrono::steady_clock::now() < deadline) {
+    std::this_thread::sleep_for(std::chrono::milliseconds{10});
+  }
+}
+
+BOOST_AUTO_TEST_SUITE(zerocopy_sends)
+
+BOOST_AUTO_TEST_CASE(large_responses_pinned_until_completed) {
+  spdlog::set_level(spdlog::level::info);
+
+  const auto counters = zerocopy_counters::create();
+
+  const auto server = zerocopy_server{{
+      .threshold = 1024,
+      .counters = counters,
+  }};
+
+  echo_mixed_sizes(server.endpoint);
+  wait_for_outcomes(*counters, large_echo_count);
+
+  // Only large responses count, and loopback makes the kernel copy them.
+  BOOST_CHECK(total_outcomes(*counters) == large_echo_count);
+  BOOST_CHECK(counters->count(zerocopy_outcome::SEND_COPIED) == 0);
+}
+
+BOOST_AUTO_TEST_CASE(pin_limit_falls_back_to_copies) {
+  spdlog::set_level(spdlog::level::info);
+
+  const auto counters = zerocopy_counters::create();
+
+  const auto server = zerocopy_server{{
+      .threshold = 1024,
+      .max_pinned = large_echo_size - 1,
+      .counters = counters,
+  }};
+
+  echo_mixed_sizes(server.endpoint);
+
+  BOOST_CHECK(counters->count(zerocopy_outcome::SEND_COPIED) ==
+              large_echo_count);
+  BOOST_CHECK(counters->count(zerocopy_outcome::ZERO_COPIED) == 0);
+  BOOST_CHECK(counters->count(zerocopy_outcome::KERNEL_COPIED) == 0);
+}
+
+// Waits on the kernel for what it pinned, rather than freeing it under it.
+BOOST_AUTO_TEST_CASE(closing_senders_drain_pinned_payloads) {
+  const auto counters = zerocopy_counters::create();
+
+  auto io_context = boost::asio::io_context{1};
+
+  auto acceptor = boost::asio::ip::tcp::acceptor{
+      io_context, {boost::asio::ip::address_v4::loopback(), 0}};
+
+  auto client = boost::asio::ip::tcp::socket{io_context};
+  client.connect(acceptor.local_endpoint());
+
+  auto server = acceptor.accept();
+
+  {
+    auto sender = zerocopy_sender::create(server.native_handle(),
+                                          {.counters = counters});
+    BOOST_REQUIRE(sender != nullptr);
+
+    auto payload = std::vector<std::byte>(large_echo_size, std::byte{'Z'});
+
+    BOOST_REQUIRE(::send(server.native_handle(), payload.data(),
+                         payload.size(), MSG_ZEROCOPY) ==
+                  static_cast<ssize_t>(payload.size()));
+
+    sender->pin(std::move(payload), 1, false);
+  }
+
+  BOOST_CHECK(total_outcomes(*counters) == 1);
+  BOOST_CHECK(counters->abandoned_bytes() == 0);
+}
+
+BOOST_AUTO_TEST_CASE(unix_sockets_not_supported) {
+  int fds[2] = {};
+  BOOST_REQUIRE(::socketpair(AF_UNIX, SOCK_STREAM, 0, fds) == 0);
+
+  BOOST_CHECK(zerocopy_sender::create(fds[0], {}) == nullptr);
+
+  ::close(fds[0]);
+  ::close(fds[1]);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+} // namespace mori_echo::test
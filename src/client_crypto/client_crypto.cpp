@@ -24,11 +24,14 @@ auto calculate_cipher_key(std::uint8_t key) -> std::uint8_t {
   return static_cast<std::uint8_t>(key % 256);
 }
 
-auto decrypt(crypto_message_params args, std::vector<std::byte> message)
-    -> std::vector<std::byte> {
-  auto key = calculate_initial_key(std::move(args));
+auto make_cipher_state(crypto_message_params args) -> cipher_state {
+  return {.key = calculate_initial_key(std::move(args))};
+}
+
+auto decrypt_chunk(cipher_state& state, std::span<std::byte> chunk) -> void {
+  auto key = state.key;
 
-  for (auto& each : message) {
+  for (auto& each : chunk) {
     key = calculate_next_key(key);
 
     const auto cipher_key = calculate_cipher_key(key);
@@ -39,7 +42,21 @@ auto decrypt(crypto_message_params args, std::vector<std::byte> message)
     each = static_cast<std::byte>(decrypted);
   }
 
+  state.key = key;
+}
+
+auto decrypt(crypto_message_params args, std::vector<std::byte> message)
+    -> std::vector<std::byte> {
+  auto state = make_cipher_state(std::move(args));
+
+  decrypt_chunk(state, message);
+
   return message;
 }
 
+auto encrypt(crypto_message_params args, std::vector<std::byte> message)
+    -> std::vector<std::byte> {
+  return decrypt(std::move(args), std::move(message));
+}
+
 } // namespace mori_echo::crypto